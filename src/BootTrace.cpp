@@ -0,0 +1,38 @@
+#include "BootTrace.h"
+#include <esp_timer.h>
+#include "Log.h"
+
+const char* BootTrace::_names[BOOT_TRACE_MAX_PHASES];
+uint32_t BootTrace::_endUs[BOOT_TRACE_MAX_PHASES];
+uint8_t BootTrace::_count = 0;
+bool BootTrace::_sent = false;
+
+void BootTrace::mark(const char* phase) {
+    if (_count >= BOOT_TRACE_MAX_PHASES) {
+        return;
+    }
+    // esp_timer part du lancement de l'application (chargeur de démarrage exclu)
+    _names[_count] = phase;
+    _endUs[_count] = (uint32_t)esp_timer_get_time();
+    _count++;
+}
+
+void BootTrace::finish() {
+    mark("ready");
+    for (uint8_t i = 0; i < _count; i++) {
+        LOG_I("⏱️ Démarrage: %s %u ms", _names[i], durationMs(i));
+    }
+    LOG_I("⏱️ Démarrage terminé en %u ms", _endUs[_count - 1] / 1000);
+}
+
+void BootTrace::writeTo(JsonObject out) {
+    for (uint8_t i = 0; i < _count; i++) {
+        out[_names[i]] = durationMs(i);
+    }
+}
+
+void BootTrace::writeCompact(JsonArray out) {
+    for (uint8_t i = 0; i < _count; i++) {
+        out.add(durationMs(i));
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#define BOOT_TRACE_MAX_PHASES 8
+
+/**
+ * @brief Chronologie du démarrage : chaque phase (système de fichiers,
+ * config, capteurs, radio...) est horodatée depuis le lancement de
+ * l'application. La trace est journalisée une fois à la fin de setup(),
+ * puis jointe au premier message sortant du nœud (instantané de métriques
+ * du Master, première télémétrie d'un Follower).
+ */
+class BootTrace {
+public:
+    /**
+     * @brief Clôt la phase en cours. Le nom doit être un littéral.
+     */
+    static void mark(const char* phase);
+
+    /**
+     * @brief Dernière phase ("ready") et journalisation de la trace.
+     */
+    static void finish();
+
+    /**
+     * @brief Vrai tant que la trace n'a pas été jointe à un message.
+     */
+    static bool unsent() { return !_sent && _count > 0; }
+    static void markSent() { _sent = true; }
+
+    /**
+     * @brief Durée de chaque phase en ms : {"fs":12,"config":30,...}
+     */
+    static void writeTo(JsonObject out);
+
+    /**
+     * @brief Version condensée (Follower) : durées en ms, dans l'ordre des phases.
+     */
+    static void writeCompact(JsonArray out);
+
+private:
+    static const char* _names[BOOT_TRACE_MAX_PHASES];
+    static uint32_t _endUs[BOOT_TRACE_MAX_PHASES];
+    static uint8_t _count;
+    static bool _sent;
+
+    static uint32_t durationMs(uint8_t i) { return (_endUs[i] - (i > 0 ? _endUs[i - 1] : 0)) / 1000; }
+};
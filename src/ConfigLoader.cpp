@@ -1,6 +1,9 @@
 #include "ConfigLoader.h"
 #include <SPIFFS.h>
 #include <ArduinoJson.h>
+#include "logic/SendSchedule.h"
+#include "logic/ZoneTable.h"
+#include "ConfigSnapshot.h"
 
 bool parseMacAddress(const char* macStr, uint8_t* macArray) {
     if (sscanf(macStr, "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx", 
@@ -11,17 +14,333 @@ bool parseMacAddress(const char* macStr, uint8_t* macArray) {
     return false;
 }
 
-bool loadConfig(Config& config) {
+// Chaîne de config copiée dans sa capacité fixe (tronquée avec avertissement)
+template <size_t N>
+static void readString(FixedString<N>& dst, const char* value, const char* key) {
+    if (!dst.assign(value)) {
+        Serial.print("Avertissement: valeur tronquée à ");
+        Serial.print(N - 1);
+        Serial.print(" caractères: ");
+        Serial.println(key);
+    }
+}
+
+// Zone : {"valves":[1,3],"policy":"median","min":30,"max":70,"duration_ms":180000,
+//         "probes":[{"node":"NODE_1","sensor":1}, ...]}
+static void compileZone(Config& config, JsonObject zc) {
+    ConfigZones& zones = config.logic.zones;
+    if (zones.count >= MAX_ZONES) {
+        Serial.println("Avertissement: Max zones atteint.");
+        return;
+    }
+    uint8_t index = zones.count;
+    ConfigZone& zone = zones.zones[index];
+    zone.num_valves = 0;
+    zone.num_probes = 0;
+    zone.policy = ZoneTable::parsePolicy(zc["policy"] | "min");
+    zone.threshold_min = zc["min"] | config.logic.humidity_thresholdMin;
+    zone.threshold_max = zc["max"] | config.logic.humidity_thresholdMax;
+    zone.duration_ms = zc["duration_ms"] | config.logic.defaultIrrigationDurationMs;
+
+    for (JsonVariant v : zc["valves"].as<JsonArray>()) {
+        uint8_t valve = v.as<uint8_t>();
+        if (valve >= 1 && valve <= MAX_ELECTROVALVES && zone.num_valves < MAX_ZONE_VALVES) {
+            zone.valves[zone.num_valves++] = valve;
+        }
+    }
+    // Zone refusée avant toute insertion : ses sondes ne doivent pas rester
+    // routées vers cet index, réutilisé par la zone suivante
+    if (zone.num_valves == 0) {
+        Serial.println("Avertissement: zone sans vanne valide ignorée.");
+        return;
+    }
+    for (JsonObject p : zc["probes"].as<JsonArray>()) {
+        // Sans "node", la sonde est celle du nœud local
+        const char* node = p["node"] | config.identity.nodeId.c_str();
+        if (zone.num_probes >= MAX_ZONE_PROBES ||
+            !ZoneTable::addProbe(zones, node, p["sensor"] | 0, index, zone.num_probes)) {
+            Serial.print("Avertissement: sonde de zone ignorée (");
+            Serial.print(node);
+            Serial.println(")");
+            continue;
+        }
+        zone.num_probes++;
+    }
+    // Aucune route insérée si aucune sonde n'a été retenue
+    if (zone.num_probes > 0) {
+        zones.count++;
+    } else {
+        Serial.println("Avertissement: zone sans sonde valide ignorée.");
+    }
+}
+
+// Fenêtre de planning : {"start":"08:00","end":"23:55","interval_min":5,"weekdays":127}
+static void compileScheduleWindow(ConfigSchedule& schedule, JsonObject w) {
+    unsigned sh = 0, sm = 0, eh = 23, em = 59;
+    sscanf(w["start"] | "00:00", "%u:%u", &sh, &sm);
+    sscanf(w["end"] | "23:59", "%u:%u", &eh, &em);
+    // Jours propres à la fenêtre (bit 0 = dimanche), tous par défaut
+    uint8_t weekdays = (w["weekdays"] | 0x7F) & 0x7F;
+    if (!SendSchedule::addInterval(schedule, sh * 60 + sm, eh * 60 + em, w["interval_min"] | 5, weekdays)) {
+        Serial.println("Avertissement: fenêtre de planning invalide ignorée.");
+    }
+}
+
+/**
+ * @brief Allocateur des documents du parsing : le tas, avec comptage du pic
+ * (chaque bloc est précédé de sa taille pour décompter les libérations).
+ */
+class ParseAllocator : public ArduinoJson::Allocator {
+public:
+    void reset() { _current = _peak = 0; }
+    size_t peak() const { return _peak; }
+
+    void* allocate(size_t size) override {
+        uint8_t* block = (uint8_t*)malloc(HEADER + size);
+        if (block == nullptr) {
+            return nullptr;
+        }
+        *(size_t*)block = size;
+        grow(size);
+        return block + HEADER;
+    }
+
+    void deallocate(void* ptr) override {
+        if (ptr == nullptr) {
+            return;
+        }
+        uint8_t* block = (uint8_t*)ptr - HEADER;
+        _current -= *(size_t*)block;
+        free(block);
+    }
+
+    void* reallocate(void* ptr, size_t size) override {
+        if (ptr == nullptr) {
+            return allocate(size);
+        }
+        uint8_t* block = (uint8_t*)ptr - HEADER;
+        size_t old = *(size_t*)block;
+        block = (uint8_t*)realloc(block, HEADER + size);
+        if (block == nullptr) {
+            return nullptr;
+        }
+        *(size_t*)block = size;
+        _current -= old;
+        grow(size);
+        return block + HEADER;
+    }
+
+private:
+    static constexpr size_t HEADER = 8; // Taille du bloc, alignement conservé
+    size_t _current = 0;
+    size_t _peak = 0;
+
+    void grow(size_t size) {
+        _current += size;
+        if (_current > _peak) {
+            _peak = _current;
+        }
+    }
+};
+
+static ParseAllocator s_parseAllocator;
+
+size_t configParsePeakBytes() {
+    return s_parseAllocator.peak();
+}
+
+// Clés de "logic" conservées par le filtre (send_times est lu à part, élément par élément)
+static const char* const LOGIC_KEYS[] = {
+    "humidity_thresholdMin", "humidity_thresholdMax", "defaultIrrigationDurationMs",
+    "tdma_window_ms", "tdma_node_expiry_ms", "beacon_interval_ms", "time_resync_ms",
+    "aggregate_period_ms", "sample_period_ms", "raw_burst", "backfill_interval_ms",
+    "reporting", "edge_irrigation_ms", "low_power", "sleep_mode", "wake_lead_ms",
+    "min_sleep_ms", "schedule", "zone_stale_ms", "zones", "hydraulics", "metrics_interval_ms"
+};
+
+static void buildConfigFilter(JsonDocument& filter) {
+    filter["identity"] = true;
+    filter["pins"] = true;
+    filter["network"] = true;
+    filter["sensors_config"] = true;
+    filter["electrovalves"] = true;
+    for (const char* key : LOGIC_KEYS) {
+        filter["logic"][key] = true;
+    }
+}
+
+static bool keyIs(const char* key, uint8_t len, const char* name) {
+    return strlen(name) == len && memcmp(key, name, len) == 0;
+}
+
+/**
+ * @brief Avance le fichier juste après le '[' de logic.send_times.
+ * Seule la clé directe de l'objet "logic" racine compte : le même texte dans
+ * une valeur chaîne ou dans un autre objet est ignoré.
+ */
+static bool seekSendTimes(File& f) {
+    char key[12];                // Assez pour "send_times" : les clés plus longues ne comptent pas
+    uint8_t keyLen = 0;
+    bool keyValid = false;       // Chaîne complète, sans échappement, tenant dans key
+    bool inString = false;
+    bool escaped = false;
+    bool afterString = false;    // Chaîne terminée : ':' en fait une clé
+    bool logicNext = false;      // Clé "logic" de la racine lue, valeur attendue
+    bool sendTimesNext = false;  // Clé "send_times" de logic lue, valeur attendue
+    int depth = 0;
+    int logicDepth = -1;
+    int c;
+    while ((c = f.read()) >= 0) {
+        if (inString) {
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+                keyValid = false;
+            } else if (c == '"') {
+                inString = false;
+                afterString = true;
+            } else if (keyLen < sizeof(key)) {
+                key[keyLen++] = (char)c;
+            } else {
+                keyValid = false;
+            }
+            continue;
+        }
+        switch (c) {
+            case ' ': case '\t': case '\r': case '\n':
+                break;
+            case '"':
+                inString = true;
+                keyLen = 0;
+                keyValid = true;
+                logicNext = sendTimesNext = false;
+                break;
+            case ':':
+                if (afterString && keyValid) {
+                    logicNext = depth == 1 && keyIs(key, keyLen, "logic");
+                    sendTimesNext = depth == logicDepth && keyIs(key, keyLen, "send_times");
+                }
+                afterString = false;
+                break;
+            case '{':
+            case '[':
+                depth++;
+                if (c == '[' && sendTimesNext) {
+                    return true;
+                }
+                if (c == '{' && logicNext) {
+                    logicDepth = depth;
+                }
+                logicNext = sendTimesNext = afterString = false;
+                break;
+            case '}':
+            case ']':
+                if (depth == logicDepth) {
+                    return false; // Fin de l'objet logic
+                }
+                depth--;
+                logicNext = sendTimesNext = afterString = false;
+                break;
+            default:
+                logicNext = sendTimesNext = afterString = false;
+                break;
+        }
+    }
+    return false;
+}
+
+bool copySendTimes(const char* path, File& out) {
+    File in = SPIFFS.open(path, "r");
+    if (!in) {
+        return false;
+    }
+    if (!seekSendTimes(in)) {
+        in.close();
+        return false;
+    }
+    static const char KEY[] = "\"send_times\":[";
+    out.write((const uint8_t*)KEY, sizeof(KEY) - 1);
+
+    // Copie jusqu'au ']' fermant, chaînes et tableaux imbriqués compris
+    uint8_t buf[64];
+    size_t n = 0;
+    int depth = 0;
+    bool inString = false;
+    bool escaped = false;
+    int c;
+    while ((c = in.read()) >= 0) {
+        buf[n++] = (uint8_t)c;
+        if (inString) {
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == '"') {
+                inString = false;
+            }
+        } else if (c == '"') {
+            inString = true;
+        } else if (c == '[' || c == '{') {
+            depth++;
+        } else if (c == ']' || c == '}') {
+            if (depth-- == 0) {
+                break;
+            }
+        }
+        if (n == sizeof(buf)) {
+            out.write(buf, n);
+            n = 0;
+        }
+    }
+    out.write(buf, n);
+    in.close();
+    return true;
+}
+
+/**
+ * @brief Lit logic.send_times élément par élément, directement depuis le fichier :
+ * la mémoire utilisée ne dépend pas de la longueur du planning.
+ * @return Nombre d'entrées lues
+ */
+static uint16_t streamSendTimes(ConfigSchedule& schedule, const char* path) {
+    File f = SPIFFS.open(path, "r");
+    if (!f) {
+        return 0;
+    }
+    uint16_t n = 0;
+    if (seekSendTimes(f)) {
+        JsonDocument entry(&s_parseAllocator); // {"hour":8,"minute":0}
+        do {
+            if (deserializeJson(entry, f) != DeserializationError::Ok) {
+                break; // Tableau vide ou entrée invalide
+            }
+            SendSchedule::addMinute(schedule, entry["hour"].as<uint8_t>() * 60 + entry["minute"].as<uint8_t>());
+            n++;
+        } while (f.findUntil(",", "]"));
+    }
+    f.close();
+    return n;
+}
+
+bool parseConfigFile(Config& config, const char* path) {
+    unsigned long t0 = micros();
+    s_parseAllocator.reset();
    
-    File configFile = SPIFFS.open("/config.json", "r");
+    File configFile = SPIFFS.open(path, "r");
     if (!configFile) {
-        Serial.println("Échec: Fichier /config.json introuvable sur SPIFFS.");
+        Serial.print("Échec: Fichier ");
+        Serial.print(path);
+        Serial.println(" introuvable sur SPIFFS.");
         return false;
     }
+    size_t fileSize = configFile.size();
 
-
-    StaticJsonDocument<1536> doc; 
-    DeserializationError error = deserializeJson(doc, configFile);
+    // Parsing filtré en flux : seules les sections utiles sont matérialisées
+    JsonDocument filter(&s_parseAllocator);
+    buildConfigFilter(filter);
+    JsonDocument doc(&s_parseAllocator);
+    DeserializationError error = deserializeJson(doc, configFile, DeserializationOption::Filter(filter));
     configFile.close(); 
 
     if (error) {
@@ -32,9 +351,9 @@ bool loadConfig(Config& config) {
 
   
     
-    config.identity.farmId = doc["identity"]["farmId"] | "default_farm";
-    config.identity.zoneId = doc["identity"]["zoneId"] | "default_zone";
-    config.identity.nodeId = doc["identity"]["nodeId"] | "default_node";
+    readString(config.identity.farmId, doc["identity"]["farmId"] | "default_farm", "farmId");
+    readString(config.identity.zoneId, doc["identity"]["zoneId"] | "default_zone", "zoneId");
+    readString(config.identity.nodeId, doc["identity"]["nodeId"] | "default_node", "nodeId");
     config.identity.isMaster = doc["identity"]["isMaster"];
 
 
@@ -53,8 +372,11 @@ bool loadConfig(Config& config) {
     JsonObject tempConfig = sensorsConfig["temperature_sensor"];
     config.sensors.temp_sensor.enabled = tempConfig["enabled"] | false;
     config.sensors.temp_sensor.pin = tempConfig["pin"];
+    config.sensors.temp_sensor.refresh_ms = tempConfig["refresh_ms"] | 10000;
 
     // Charger les capteurs d'humidité
+    config.sensors.soil_settle_ms = sensorsConfig["soil_settle_ms"] | 50;
+    config.sensors.soil_oversample = sensorsConfig["soil_oversample"] | 32;
     JsonArray soilSensorsConfig = sensorsConfig["soil_humidity_sensors"];
     config.sensors.num_soil_sensors = 0;
     for (JsonObject s_cfg : soilSensorsConfig) {
@@ -76,40 +398,99 @@ bool loadConfig(Config& config) {
 
  
 
-    config.network.master_mac_str = doc["network"]["master_mac"] | "00:00:00:00:00:00";
+    readString(config.network.master_mac_str, doc["network"]["master_mac"] | "00:00:00:00:00:00", "master_mac");
     config.network.enableESPNow = doc["network"]["enableESPNow"] | true;  
     config.network.enableLora = doc["network"]["enableLora"] | true;   
     config.network.enableMqtt = doc["network"]["enableMqtt"] | false; 
     config.network.lora_node_addr = doc["network"]["lora_node_addr"] | 1;
     config.network.lora_peer_addr = doc["network"]["lora_peer_addr"] | 2;
     config.network.lora_channel = doc["network"]["lora_channel"] | 23;
+    config.network.lora_beacon_channel = doc["network"]["lora_beacon_channel"] | config.network.lora_channel;
 
-    config.network.wifi_ssid = doc["network"]["wifi_ssid"] | "";
-    config.network.wifi_password = doc["network"]["wifi_password"] | "";
-    config.network.mqtt_broker = doc["network"]["mqtt_broker"] | "";
+    readString(config.network.wifi_ssid, doc["network"]["wifi_ssid"] | "", "wifi_ssid");
+    readString(config.network.wifi_password, doc["network"]["wifi_password"] | "", "wifi_password");
+    readString(config.network.mqtt_broker, doc["network"]["mqtt_broker"] | "", "mqtt_broker");
     config.network.mqtt_port = doc["network"]["mqtt_port"] | 1883;
-    config.network.mqtt_user = doc["network"]["mqtt_user"] | "";
-    config.network.mqtt_pass = doc["network"]["mqtt_pass"] | "";
-    config.network.topic_telemetry_up = doc["network"]["topic_telemetry_up"] | "farm/telemetry";
-    config.network.topic_commands_down = doc["network"]["topic_commands_down"] | "farm/commands/master/set";
+    readString(config.network.mqtt_user, doc["network"]["mqtt_user"] | "", "mqtt_user");
+    readString(config.network.mqtt_pass, doc["network"]["mqtt_pass"] | "", "mqtt_pass");
+    readString(config.network.topic_telemetry_up, doc["network"]["topic_telemetry_up"] | "farm/telemetry", "topic_telemetry_up");
+    readString(config.network.topic_commands_down, doc["network"]["topic_commands_down"] | "farm/commands/master/set", "topic_commands_down");
+    config.network.telemetry_envelope = doc["network"]["telemetry_envelope"] | false;
 
   
     config.logic.humidity_thresholdMin = doc["logic"]["humidity_thresholdMin"] | 40.0;
     config.logic.humidity_thresholdMax = doc["logic"]["humidity_thresholdMax"] | 60.0;
     config.logic.defaultIrrigationDurationMs = doc["logic"]["defaultIrrigationDurationMs"] | 30000; // 30 sec par défaut
-    config.logic.num_send_times = 0;
-    JsonArray sendTimes = doc["logic"]["send_times"];
-    if (!sendTimes.isNull()) {
-        for (JsonObject t : sendTimes) {
-            if (config.logic.num_send_times < MAX_SEND_TIMES) {
-                
-                config.logic.send_times[config.logic.num_send_times].hour = t["hour"].as<uint8_t>();
-                config.logic.send_times[config.logic.num_send_times].minute = t["minute"].as<uint8_t>();
-                
-                Serial.print("Heure d'envoi chargée: ");
-                config.logic.num_send_times++;
-            }
+    config.logic.tdma_window_ms = doc["logic"]["tdma_window_ms"] | 50000; // 50 s sur la minute
+    config.logic.tdma_node_expiry_ms = doc["logic"]["tdma_node_expiry_ms"] | 1800000; // 30 min
+    config.logic.beacon_interval_ms = doc["logic"]["beacon_interval_ms"] | 10000;
+    config.logic.time_resync_ms = doc["logic"]["time_resync_ms"] | 900000; // 15 min
+    config.logic.aggregate_period_ms = doc["logic"]["aggregate_period_ms"] | 0;
+    config.logic.sample_period_ms = doc["logic"]["sample_period_ms"] | 0;
+    config.logic.raw_burst = doc["logic"]["raw_burst"] | 0;
+    config.logic.backfill_interval_ms = doc["logic"]["backfill_interval_ms"] | 1000;
+    config.logic.metrics_interval_ms = doc["logic"]["metrics_interval_ms"] | 60000;
+    // Politique d'envoi événementielle (seuils par défaut = seuils d'irrigation)
+    JsonObject reportCfg = doc["logic"]["reporting"];
+    ConfigReporting& rep = config.logic.reporting;
+    rep.event_driven = strcmp(reportCfg["mode"] | "schedule", "event") == 0;
+    rep.num_thresholds = 0;
+    if (reportCfg["thresholds"].is<JsonArray>()) {
+        for (JsonVariant v : reportCfg["thresholds"].as<JsonArray>()) {
+            if (rep.num_thresholds >= MAX_REPORT_THRESHOLDS) break;
+            rep.thresholds[rep.num_thresholds++] = v.as<float>();
+        }
+    } else {
+        rep.thresholds[rep.num_thresholds++] = config.logic.humidity_thresholdMin;
+        rep.thresholds[rep.num_thresholds++] = config.logic.humidity_thresholdMax;
+    }
+    rep.hysteresis = reportCfg["hysteresis"] | 1.0;
+    rep.min_delta = reportCfg["min_delta"] | 2.0;
+    rep.max_slope_per_min = reportCfg["max_slope_per_min"] | 0.5;
+    rep.check_interval_ms = reportCfg["check_interval_ms"] | 30000;
+    rep.min_interval_ms = reportCfg["min_interval_ms"] | 10000;
+    rep.heartbeat_ms = reportCfg["heartbeat_ms"] | 3600000; // 1 h
+
+    config.logic.edge_irrigation_ms = doc["logic"]["edge_irrigation_ms"] | 0;
+    config.logic.low_power = doc["logic"]["low_power"] | false;
+    config.logic.deep_sleep = strcmp(doc["logic"]["sleep_mode"] | "deep", "light") != 0;
+    config.logic.wake_lead_ms = doc["logic"]["wake_lead_ms"] | 2000;
+    config.logic.min_sleep_ms = doc["logic"]["min_sleep_ms"] | 5000;
+    // Planning d'envoi : expression(s) compacte(s) et/ou liste send_times (ancien format)
+    SendSchedule::clear(config.logic.schedule);
+    JsonVariant scheduleCfg = doc["logic"]["schedule"];
+    if (scheduleCfg.is<JsonArray>()) {
+        for (JsonObject w : scheduleCfg.as<JsonArray>()) {
+            compileScheduleWindow(config.logic.schedule, w);
         }
+    } else if (scheduleCfg.is<JsonObject>()) {
+        compileScheduleWindow(config.logic.schedule, scheduleCfg.as<JsonObject>());
+    }
+    uint16_t legacyTimes = streamSendTimes(config.logic.schedule, path);
+    if (legacyTimes > 0) {
+        Serial.print("send_times: ");
+        Serial.print(legacyTimes);
+        Serial.println(" entrées lues en flux.");
+    }
+    Serial.print("Planning compilé: ");
+    Serial.print(config.logic.schedule.count);
+    Serial.println(" envois par semaine.");
+
+    // Budget hydraulique des ouvertures simultanées
+    JsonObject hydCfg = doc["logic"]["hydraulics"];
+    config.logic.hydraulics.max_concurrent = hydCfg["max_concurrent"] | 2;
+    config.logic.hydraulics.flow_budget = hydCfg["flow_budget"] | 0.0;
+    config.logic.hydraulics.stagger_ms = hydCfg["stagger_ms"] | 2000;
+
+    // Zones d'irrigation (sinon sonde i -> vanne i)
+    ZoneTable::clear(config.logic.zones);
+    config.logic.zones.stale_ms = doc["logic"]["zone_stale_ms"] | 1800000; // 30 min
+    for (JsonObject zc : doc["logic"]["zones"].as<JsonArray>()) {
+        compileZone(config, zc);
+    }
+    if (config.logic.zones.count > 0) {
+        Serial.print("Zones d'irrigation compilées: ");
+        Serial.println(config.logic.zones.count);
     }
 
     // Charger les électrovannes
@@ -125,6 +506,7 @@ bool loadConfig(Config& config) {
 
             config.electrovalves[config.num_electrovalves].enabled = v["enabled"] | false;
             config.electrovalves[config.num_electrovalves].pin = v["pin"] | 0;
+            config.electrovalves[config.num_electrovalves].flow = v["flow"] | 0.0;
 
             config.num_electrovalves++;
         }
@@ -138,7 +520,7 @@ bool loadConfig(Config& config) {
 
     Serial.println("Configuration chargée avec succès.");
     Serial.print("Node ID: ");
-    Serial.println(config.identity.nodeId);
+    Serial.println(config.identity.nodeId.c_str());
     Serial.print("Rôle: ");
     Serial.println(config.identity.isMaster ? "Master" : "Follower");
     Serial.print(config.sensors.num_soil_sensors);
@@ -146,5 +528,60 @@ bool loadConfig(Config& config) {
     Serial.print("Capteur de température activé: ");
     Serial.println(config.sensors.temp_sensor.enabled ? "Oui" : "Non");
 
+    Serial.print("Config: ");
+    Serial.print(fileSize);
+    Serial.print(" octets lus en ");
+    Serial.print((micros() - t0) / 1000.0, 1);
+    Serial.print(" ms, pic JSON ");
+    Serial.print(configParsePeakBytes());
+    Serial.print(" octets, tas libre min ");
+    Serial.println(ESP.getMinFreeHeap());
+
     return true;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief /config.json absent : remplacement interrompu par une coupure (voir
+ * ConfigUpdate::stageFile). La version précédente, qui a déjà démarré ce nœud,
+ * est préférée ; à défaut, la nouvelle version, validée avant le remplacement.
+ */
+static void recoverConfigFile() {
+    if (SPIFFS.exists(CONFIG_FILE)) {
+        return;
+    }
+    const char* from = SPIFFS.exists(CONFIG_BACKUP_FILE) ? CONFIG_BACKUP_FILE
+                     : SPIFFS.exists(CONFIG_STAGING_FILE) ? CONFIG_STAGING_FILE : nullptr;
+    if (from == nullptr) {
+        return;
+    }
+    Serial.print("⚠️ config.json absent, restauration depuis ");
+    Serial.println(from);
+    if (!SPIFFS.rename(from, CONFIG_FILE)) {
+        Serial.println("❌ Restauration impossible.");
+    }
+}
+
+bool loadConfig(Config& config) {
+    unsigned long t0 = micros();
+    recoverConfigFile();
+
+    // Image binaire valide pour ce config.json : une lecture NVS, pas de parsing
+    ConfigSourceStamp stamp;
+    bool haveStamp = configSourceStamp(stamp);
+    if (haveStamp && loadConfigSnapshot(config, stamp)) {
+        Serial.print("⚡ Config chargée depuis l'image binaire en ");
+        Serial.print((micros() - t0) / 1000.0, 1);
+        Serial.print(" ms (nœud ");
+        Serial.print(config.identity.nodeId.c_str());
+        Serial.println(")");
+        return true;
+    }
+
+    if (!parseConfigFile(config, CONFIG_FILE)) {
+        return false;
+    }
+    if (haveStamp) {
+        saveConfigSnapshot(config, stamp);
+    }
+    return true;
+}
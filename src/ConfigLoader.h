@@ -1,10 +1,28 @@
 #pragma once
 #include <Arduino.h>
+#include <FS.h>
+#include <type_traits>
+#include "FixedString.h"
 
 #define MAX_PAYLOAD_SIZE 250
+// Taille du tampon PubSubClient (entrant et sortant) : doit contenir une trame
+// de télémétrie enveloppée et une table de programmes complète
+#define MQTT_BUFFER_SIZE 2048
 #define MAX_SOIL_SENSORS 5 // Définit une limite max de capteurs d'humidité
-#define MAX_SEND_TIMES 200
+#define MINUTES_PER_DAY 1440
+#define SCHEDULE_WORDS (MINUTES_PER_DAY / 32)
 #define MAX_ELECTROVALVES 20
+#define CONFIG_FILE "/config.json"
+#define CONFIG_STAGING_FILE "/config.new" // Patch fusionné, en attente de validation
+#define CONFIG_BACKUP_FILE "/config.bak"  // Version précédente, conservée pendant le remplacement
+
+// Capacités des chaînes de configuration ('\0' compris)
+#define CONFIG_ID_LEN 32
+#define CONFIG_MAC_LEN 18     // "AA:BB:CC:DD:EE:FF"
+#define CONFIG_SSID_LEN 33    // 32 octets max (802.11)
+#define CONFIG_SECRET_LEN 65  // Clé WPA2 : 64 caractères max
+#define CONFIG_HOST_LEN 64
+#define CONFIG_TOPIC_LEN 96
 
 
 // Structure pour les pins
@@ -27,9 +45,9 @@ struct ConfigPins {
 
 // Structure pour l'identité
 struct ConfigIdentity {
-    String farmId;
-    String zoneId;
-    String nodeId;
+    FixedString<CONFIG_ID_LEN> farmId;
+    FixedString<CONFIG_ID_LEN> zoneId;
+    FixedString<CONFIG_ID_LEN> nodeId;
     bool isMaster;
 };
 
@@ -45,45 +63,107 @@ struct ConfigSensorSoil {
 struct ConfigSensorTemp {
     bool enabled;
     uint8_t pin;
+    uint32_t refresh_ms;   // Période de rafraîchissement du cache DHT
 };
 
 struct ConfigSensors {
     ConfigSensorTemp temp_sensor;
     ConfigSensorSoil soil_sensors[MAX_SOIL_SENSORS];
     uint8_t num_soil_sensors; 
+    uint16_t soil_settle_ms;   // Fenêtre de stabilisation commune après mise sous tension
+    uint8_t soil_oversample;   // Échantillons par sonde et par acquisition
 };
 
 struct ConfigElectrovalve {
     bool enabled;
     uint8_t pin;
+    float flow;     // Débit nominal (L/min), pris sur le budget hydraulique
+};
+
+// Limites hydrauliques / électriques pour les ouvertures simultanées
+struct ConfigHydraulics {
+    uint8_t max_concurrent;   // Vannes ouvertes simultanément (0 = illimité)
+    float flow_budget;        // Débit total disponible (L/min, 0 = illimité)
+    uint32_t stagger_ms;      // Écart minimal entre deux ouvertures (appel de courant)
 };
 
 // FIN NOUVELLES STRUCTURES
 
 // Structure pour le réseau
 struct ConfigNetwork {
-    String master_mac_str;
+    FixedString<CONFIG_MAC_LEN> master_mac_str;
     uint8_t master_mac_bytes[6]; 
     bool enableESPNow;          
     bool enableLora;            
     uint16_t lora_node_addr; 
     uint16_t lora_peer_addr;
     uint8_t  lora_channel;
+    uint8_t  lora_beacon_channel; // Canal dédié aux beacons de synchro horaire
 
-    String wifi_ssid;
-    String wifi_password;
-    String mqtt_broker;
+    FixedString<CONFIG_SSID_LEN> wifi_ssid;
+    FixedString<CONFIG_SECRET_LEN> wifi_password;
+    FixedString<CONFIG_HOST_LEN> mqtt_broker;
     uint16_t mqtt_port;
-    String mqtt_user;
-    String mqtt_pass;
-    String topic_telemetry_up;
-    String topic_commands_down;
+    FixedString<CONFIG_HOST_LEN> mqtt_user;
+    FixedString<CONFIG_SECRET_LEN> mqtt_pass;
+    FixedString<CONFIG_TOPIC_LEN> topic_telemetry_up;
+    FixedString<CONFIG_TOPIC_LEN> topic_commands_down;
     bool enableMqtt;
+    bool telemetry_envelope; // Ajoute {"src","rx"} autour de la télémétrie transférée
+};
+
+// Planning d'envoi compilé (voir logic/SendSchedule)
+struct ConfigSchedule {
+    uint32_t minute_bitmap[7][SCHEDULE_WORDS]; // Par jour (tm_wday, 0 = dimanche), 1 bit par minute
+    uint16_t count;                            // Nombre de couples (jour, minute) d'envoi
+};
+
+#define MAX_REPORT_THRESHOLDS 4
+#define MAX_ZONES 8
+#define MAX_ZONE_VALVES 4
+#define MAX_ZONE_PROBES 8
+#define ZONE_ROUTE_SLOTS 128 // Puissance de 2, >= 2x le nombre total de sondes
+
+// Agrégation des sondes d'une zone avant régulation
+enum class ZonePolicy : uint8_t { MIN, MEAN, MEDIAN };
+
+// Zone d'irrigation : un ensemble de vannes régulé sur plusieurs sondes
+struct ConfigZone {
+    uint8_t valves[MAX_ZONE_VALVES]; // Numéros de vannes (1 à MAX_ELECTROVALVES)
+    uint8_t num_valves;
+    uint8_t num_probes;
+    ZonePolicy policy;
+    float threshold_min;
+    float threshold_max;
+    uint32_t duration_ms;
+};
+
+// Entrée de la table de dispatch (node, sonde) -> (zone, sonde de zone)
+struct ZoneRoute {
+    uint32_t node_hash;   // FNV-1a du nodeId
+    uint8_t sensor;       // 1 à MAX_SOIL_SENSORS, 0 = emplacement libre
+    uint8_t zone;
+    uint8_t probe;
+};
+
+struct ConfigZones {
+    ConfigZone zones[MAX_ZONES];
+    uint8_t count;                         // 0 = correspondance historique sonde i -> vanne i
+    uint32_t stale_ms;                     // Mesure ignorée au-delà de cet âge
+    ZoneRoute routes[ZONE_ROUTE_SLOTS];    // Table de hachage compilée au chargement
 };
 
-struct ConfigSendTime {
-  uint8_t hour;
-  uint8_t minute;
+// Politique d'envoi événementielle du Follower
+struct ConfigReporting {
+    bool event_driven;             // "mode": "event" (sinon planning fixe)
+    float thresholds[MAX_REPORT_THRESHOLDS]; // Seuils d'humidité (%) dont le franchissement déclenche un envoi
+    uint8_t num_thresholds;
+    float hysteresis;              // Marge autour des seuils (%)
+    float min_delta;               // Variation minimale jugée significative (%)
+    float max_slope_per_min;       // Pente (%/min) au-delà de laquelle on envoie immédiatement
+    uint32_t check_interval_ms;    // Période d'évaluation
+    uint32_t min_interval_ms;      // Délai minimal entre deux envois
+    uint32_t heartbeat_ms;         // Envoi forcé au-delà de ce silence
 };
 
 // Structure pour la logique
@@ -91,8 +171,24 @@ struct ConfigLogic {
     float humidity_thresholdMin;  
     float humidity_thresholdMax;    
     uint32_t defaultIrrigationDurationMs; //  Durée d'arrosage en ms
-    ConfigSendTime send_times[MAX_SEND_TIMES];
-    uint8_t num_send_times;
+    ConfigSchedule schedule;
+    uint32_t tdma_window_ms;       // Fenêtre d'émission répartie entre les Followers
+    uint32_t tdma_node_expiry_ms;  // Nœud retiré du plan TDMA après ce silence
+    uint32_t beacon_interval_ms;   // Période du beacon horaire diffusé par le Master (0 = désactivé)
+    uint32_t time_resync_ms;       // Période des échanges timeReq/timeResp côté Follower
+    uint32_t aggregate_period_ms;  // Période des agrégats min/max/moyenne (0 = télémétrie brute)
+    bool low_power;                // Follower: sommeil entre deux envois
+    bool deep_sleep;               // true = deep sleep, false = light sleep
+    uint32_t wake_lead_ms;         // Réveil anticipé avant l'heure d'envoi
+    uint32_t min_sleep_ms;         // Pas de sommeil si le prochain envoi est plus proche
+    uint32_t sample_period_ms;     // Follower: période d'échantillonnage local (0 = désactivé)
+    uint8_t raw_burst;             // Nombre de valeurs brutes (sonde 1) jointes à chaque envoi
+    uint32_t backfill_interval_ms; // Intervalle minimal entre deux trames de rattrapage
+    ConfigReporting reporting;
+    ConfigZones zones;
+    ConfigHydraulics hydraulics;
+    uint32_t edge_irrigation_ms;   // Follower: période de la régulation locale des vannes (0 = désactivée)
+    uint32_t metrics_interval_ms;  // Période des métriques de santé (Master: publication, Follower: jointes à la télémétrie ; 0 = désactivé)
 };
 
 
@@ -109,9 +205,31 @@ struct Config {
   
 };
 
+// Aucune allocation dans Config : copie, comparaison et sauvegarde par memcpy
+static_assert(std::is_trivially_copyable<Config>::value, "Config doit rester trivialement copiable");
+
 /**
  * @brief 
  * @param config 
  * @return 
  */
-bool loadConfig(Config& config);
\ No newline at end of file
+bool loadConfig(Config& config);
+
+/**
+ * @brief Parse un fichier de configuration JSON (sans passer par l'image binaire).
+ * @param path Chemin SPIFFS du fichier
+ */
+bool parseConfigFile(Config& config, const char* path);
+
+/**
+ * @brief Pic de mémoire des documents JSON (filtre, document, entrée de
+ * send_times) pendant le dernier parseConfigFile(), en octets.
+ */
+size_t configParsePeakBytes();
+
+/**
+ * @brief Recopie telle quelle l'entrée "send_times":[...] de l'objet logic de
+ * path dans out, par petits blocs (mise à jour de config.json en mémoire bornée).
+ * @return false si path n'a pas de logic.send_times (rien n'est écrit)
+ */
+bool copySendTimes(const char* path, File& out);
\ No newline at end of file
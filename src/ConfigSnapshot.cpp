@@ -0,0 +1,104 @@
+#include "ConfigSnapshot.h"
+#include <SPIFFS.h>
+#include <Preferences.h>
+#include <esp_crc.h>
+
+#define SNAPSHOT_MAGIC 0x31474643 // "CFG1"
+
+struct SnapshotHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t layout;        // sizeof(Config)
+    ConfigSourceStamp source;
+    uint32_t payloadLen;
+    uint32_t crc;           // CRC32 de la charge utile
+};
+
+// Config est trivialement copiable : l'image est la structure elle-même
+static uint16_t layoutSize() {
+    return (uint16_t)sizeof(Config);
+}
+
+bool configSourceStamp(ConfigSourceStamp& stamp) {
+    File f = SPIFFS.open(CONFIG_FILE, "r");
+    if (!f) {
+        return false;
+    }
+    stamp.size = f.size();
+    stamp.crc = 0;
+    uint8_t chunk[256];
+    size_t n;
+    while ((n = f.read(chunk, sizeof(chunk))) > 0) {
+        stamp.crc = esp_crc32_le(stamp.crc, chunk, n);
+    }
+    f.close();
+    return true;
+}
+
+bool loadConfigSnapshot(Config& config, const ConfigSourceStamp& stamp) {
+    Preferences prefs;
+    if (!prefs.begin(CONFIG_SNAPSHOT_NS, true)) {
+        return false;
+    }
+    size_t len = prefs.getBytesLength("img");
+    if (len != sizeof(SnapshotHeader) + sizeof(Config)) {
+        prefs.end();
+        if (len > 0) {
+            Serial.println("Image de config d'un autre format, parsing du JSON.");
+        }
+        return false;
+    }
+    uint8_t* buf = (uint8_t*)malloc(len);
+    if (buf == nullptr) {
+        prefs.end();
+        return false;
+    }
+    prefs.getBytes("img", buf, len); // Une seule lecture
+    prefs.end();
+
+    SnapshotHeader h;
+    memcpy(&h, buf, sizeof(h));
+    const uint8_t* payload = buf + sizeof(h);
+    bool valid = h.magic == SNAPSHOT_MAGIC && h.version == CONFIG_SNAPSHOT_VERSION &&
+                 h.layout == layoutSize() && h.payloadLen == sizeof(Config) &&
+                 h.source.size == stamp.size && h.source.crc == stamp.crc &&
+                 esp_crc32_le(0, payload, h.payloadLen) == h.crc;
+
+    if (valid) {
+        memcpy(&config, payload, sizeof(Config));
+    }
+    free(buf);
+
+    if (!valid) {
+        Serial.println("Image de config absente ou périmée, parsing du JSON.");
+    }
+    return valid;
+}
+
+bool saveConfigSnapshot(const Config& config, const ConfigSourceStamp& stamp) {
+    SnapshotHeader h;
+    h.magic = SNAPSHOT_MAGIC;
+    h.version = CONFIG_SNAPSHOT_VERSION;
+    h.layout = layoutSize();
+    h.source = stamp;
+    h.payloadLen = sizeof(Config);
+    h.crc = esp_crc32_le(0, (const uint8_t*)&config, sizeof(Config));
+
+    size_t len = sizeof(h) + sizeof(Config);
+    uint8_t* buf = (uint8_t*)malloc(len);
+    if (buf == nullptr) {
+        return false;
+    }
+    memcpy(buf, &h, sizeof(h));
+    memcpy(buf + sizeof(h), &config, sizeof(Config));
+
+    Preferences prefs;
+    bool ok = prefs.begin(CONFIG_SNAPSHOT_NS, false) && prefs.putBytes("img", buf, len) == len;
+    prefs.end();
+    free(buf);
+
+    Serial.print(ok ? "💾 Image de config enregistrée (" : "⚠️ Échec écriture image de config (");
+    Serial.print(len);
+    Serial.println(" octets).");
+    return ok;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <Arduino.h>
+#include "ConfigLoader.h"
+
+// Version du format : à incrémenter à chaque changement de l'ordre des champs
+// (un changement de taille de Config est détecté automatiquement)
+#define CONFIG_SNAPSHOT_VERSION 3
+#define CONFIG_SNAPSHOT_NS "cfgsnap"
+
+/**
+ * @brief Empreinte du fichier source (taille + CRC32 du contenu).
+ */
+struct ConfigSourceStamp {
+    uint32_t size;
+    uint32_t crc;
+};
+
+/**
+ * @brief Calcule l'empreinte de /config.json (lecture par blocs, sans parsing).
+ */
+bool configSourceStamp(ConfigSourceStamp& stamp);
+
+/**
+ * @brief Charge l'image binaire de Config depuis la NVS.
+ * @return false si absente, corrompue (CRC), d'un autre format, ou si
+ * config.json a changé depuis sa création.
+ */
+bool loadConfigSnapshot(Config& config, const ConfigSourceStamp& stamp);
+
+/**
+ * @brief Enregistre l'image binaire de Config (CRC32) en NVS.
+ */
+bool saveConfigSnapshot(const Config& config, const ConfigSourceStamp& stamp);
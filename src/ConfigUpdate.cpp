@@ -0,0 +1,282 @@
+#include "ConfigUpdate.h"
+#include <SPIFFS.h>
+#include "ConfigSnapshot.h"
+#include "logic/EventLoop.h"
+
+Config* ConfigUpdate::_active = nullptr;
+Config ConfigUpdate::_standby;
+bool ConfigUpdate::_staged = false;
+uint32_t ConfigUpdate::_stagedChanges = 0;
+
+void ConfigUpdate::begin(Config* active) {
+    _active = active;
+}
+
+void ConfigUpdate::mergePatch(JsonObject dst, JsonObjectConst patch) {
+    for (JsonPairConst kv : patch) {
+        JsonVariantConst value = kv.value();
+        if (value.isNull()) {
+            dst.remove(kv.key()); // null = suppression de la clé
+        } else if (value.is<JsonObjectConst>()) {
+            JsonObject child = dst[kv.key()].is<JsonObject>() ? dst[kv.key()].as<JsonObject>()
+                                                              : dst[kv.key()].to<JsonObject>();
+            mergePatch(child, value.as<JsonObjectConst>());
+        } else {
+            dst[kv.key()] = value; // Valeurs et tableaux remplacés en bloc
+        }
+    }
+}
+
+// Clé JSON échappée, suivie de ':'
+static void writeKey(File& out, const char* key) {
+    out.write('"');
+    for (const char* p = key; *p; p++) {
+        uint8_t c = (uint8_t)*p;
+        if (c == '"' || c == '\\') {
+            out.write('\\');
+            out.write(c);
+        } else if (c < 0x20) {
+            char esc[7];
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            out.write((const uint8_t*)esc, 6);
+        } else {
+            out.write(c);
+        }
+    }
+    out.write((const uint8_t*)"\":", 2);
+}
+
+bool ConfigUpdate::writeMerged(File& out, JsonObjectConst merged, bool keepSendTimes) {
+    // Une section racine par ligne ; un fichier tronqué (SPIFFS plein) est refusé
+    // ensuite par le parsing de validation
+    out.write('{');
+    bool first = true;
+    for (JsonPairConst kv : merged) {
+        out.write((const uint8_t*)(first ? "\n  " : ",\n  "), first ? 3 : 4);
+        first = false;
+        writeKey(out, kv.key().c_str());
+        if (!keepSendTimes || strcmp(kv.key().c_str(), "logic") != 0 || !kv.value().is<JsonObjectConst>()) {
+            serializeJson(kv.value(), out);
+            continue;
+        }
+        // logic : send_times recopié du fichier courant, puis les autres clés
+        out.write('{');
+        bool firstLogic = !copySendTimes(CONFIG_FILE, out);
+        for (JsonPairConst lk : kv.value().as<JsonObjectConst>()) {
+            if (!firstLogic) {
+                out.write(',');
+            }
+            firstLogic = false;
+            writeKey(out, lk.key().c_str());
+            serializeJson(lk.value(), out);
+        }
+        out.write('}');
+    }
+    return out.write((const uint8_t*)"\n}\n", 3) == 3;
+}
+
+bool ConfigUpdate::validate(const Config& next, String& error) {
+    if (next.identity.isMaster != _active->identity.isMaster) {
+        error = "role change requires reflash";
+        return false;
+    }
+    if (next.logic.humidity_thresholdMin >= next.logic.humidity_thresholdMax) {
+        error = "thresholdMin >= thresholdMax";
+        return false;
+    }
+    for (uint8_t z = 0; z < next.logic.zones.count; z++) {
+        if (next.logic.zones.zones[z].threshold_min >= next.logic.zones.zones[z].threshold_max) {
+            error = "zone thresholds";
+            return false;
+        }
+    }
+    if (!next.identity.isMaster && next.logic.schedule.count == 0 && !next.logic.reporting.event_driven) {
+        error = "empty schedule";
+        return false;
+    }
+    return true;
+}
+
+uint32_t ConfigUpdate::diff(const Config& a, const Config& b) {
+    uint32_t changes = 0;
+    const ConfigLogic& la = a.logic;
+    const ConfigLogic& lb = b.logic;
+
+    if (memcmp(&la.schedule, &lb.schedule, sizeof(la.schedule)) != 0) {
+        changes |= CFG_CHANGED_SCHEDULE;
+    }
+    if (la.humidity_thresholdMin != lb.humidity_thresholdMin ||
+        la.humidity_thresholdMax != lb.humidity_thresholdMax ||
+        la.defaultIrrigationDurationMs != lb.defaultIrrigationDurationMs ||
+        memcmp(&la.zones, &lb.zones, sizeof(la.zones)) != 0) {
+        changes |= CFG_CHANGED_IRRIGATION;
+    }
+    if (memcmp(&la.hydraulics, &lb.hydraulics, sizeof(la.hydraulics)) != 0) {
+        changes |= CFG_CHANGED_HYDRAULICS;
+    }
+    if (a.num_electrovalves != b.num_electrovalves ||
+        memcmp(a.electrovalves, b.electrovalves, sizeof(a.electrovalves)) != 0 ||
+        la.edge_irrigation_ms != lb.edge_irrigation_ms) {
+        changes |= CFG_CHANGED_VALVES; // Vannes locales du Follower créées selon edge_irrigation_ms
+    }
+    if (memcmp(&la.reporting, &lb.reporting, sizeof(la.reporting)) != 0) {
+        changes |= CFG_CHANGED_REPORTING;
+    }
+
+    const ConfigNetwork& na = a.network;
+    const ConfigNetwork& nb = b.network;
+    if (na.wifi_ssid != nb.wifi_ssid || na.wifi_password != nb.wifi_password ||
+        na.mqtt_broker != nb.mqtt_broker || na.mqtt_port != nb.mqtt_port ||
+        na.mqtt_user != nb.mqtt_user || na.mqtt_pass != nb.mqtt_pass ||
+        na.topic_telemetry_up != nb.topic_telemetry_up ||
+        na.topic_commands_down != nb.topic_commands_down || na.enableMqtt != nb.enableMqtt) {
+        changes |= CFG_CHANGED_WIFI;
+    }
+
+    // Copiées par CommManager::begin() : radio réinitialisée
+    const ConfigPins& pa = a.pins;
+    const ConfigPins& pb = b.pins;
+    if (na.master_mac_str != nb.master_mac_str || na.enableESPNow != nb.enableESPNow ||
+        na.enableLora != nb.enableLora || na.lora_node_addr != nb.lora_node_addr ||
+        na.lora_peer_addr != nb.lora_peer_addr || na.lora_channel != nb.lora_channel ||
+        na.lora_beacon_channel != nb.lora_beacon_channel ||
+        pa.lora_m0 != pb.lora_m0 || pa.lora_m1 != pb.lora_m1 || pa.lora_aux != pb.lora_aux ||
+        pa.lora_rx != pb.lora_rx || pa.lora_tx != pb.lora_tx) {
+        changes |= CFG_CHANGED_RADIO;
+    }
+    if (a.identity.farmId != b.identity.farmId || a.identity.zoneId != b.identity.zoneId ||
+        a.identity.nodeId != b.identity.nodeId) {
+        changes |= CFG_CHANGED_IDENTITY;
+    }
+
+    // Valeurs copiées par les modules à leur construction : redémarrage
+    if (pa.led != pb.led || pa.led_brightness != pb.led_brightness ||
+        memcmp(&a.sensors, &b.sensors, sizeof(a.sensors)) != 0 ||
+        la.tdma_window_ms != lb.tdma_window_ms || la.tdma_node_expiry_ms != lb.tdma_node_expiry_ms ||
+        la.aggregate_period_ms != lb.aggregate_period_ms || la.sample_period_ms != lb.sample_period_ms) {
+        changes |= CFG_CHANGED_REBOOT;
+    }
+
+    // Reste (ex: network.telemetry_envelope, logic.beacon_interval_ms) : relu à chaque usage
+    if (changes == 0 && memcmp(&a, &b, sizeof(Config)) != 0) {
+        changes |= CFG_CHANGED_OTHER;
+    }
+    return changes;
+}
+
+bool ConfigUpdate::stage(JsonObjectConst patch, uint32_t& changes, String& error) {
+    if (_active == nullptr) {
+        error = "not initialized";
+        return false;
+    }
+
+    // 1. Fusion du patch avec le fichier courant, lu en flux filtré comme au
+    // démarrage : logic.send_times, de taille non bornée, reste dans le fichier
+    // et n'est recopié qu'à l'écriture
+    JsonDocument filter;
+    filter["*"] = true;
+    filter["logic"]["*"] = true;
+    filter["logic"]["send_times"] = false;
+    JsonDocument doc;
+    File in = SPIFFS.open(CONFIG_FILE, "r");
+    if (!in) {
+        error = "config.json missing";
+        return false;
+    }
+    DeserializationError err = deserializeJson(doc, in, DeserializationOption::Filter(filter));
+    in.close();
+    filter.clear();
+    if (err) {
+        error = err.c_str();
+        return false;
+    }
+    if (!doc.is<JsonObject>()) {
+        error = "config.json not an object";
+        return false;
+    }
+
+    // send_times du patch (remplacement ou null) prioritaire sur celui du fichier
+    bool keepSendTimes = true;
+    for (JsonPairConst kv : patch["logic"].as<JsonObjectConst>()) {
+        if (strcmp(kv.key().c_str(), "send_times") == 0) {
+            keepSendTimes = false;
+        }
+    }
+    mergePatch(doc.as<JsonObject>(), patch);
+
+    File out = SPIFFS.open(CONFIG_STAGING_FILE, "w");
+    if (!out) {
+        error = "spiffs write";
+        return false;
+    }
+    bool written = writeMerged(out, doc.as<JsonObjectConst>(), keepSendTimes);
+    out.close();
+    doc.clear();
+    if (!written) {
+        SPIFFS.remove(CONFIG_STAGING_FILE);
+        error = "spiffs write";
+        return false;
+    }
+
+    return stageFile(CONFIG_STAGING_FILE, changes, error);
+}
+
+bool ConfigUpdate::stageFile(const char* path, uint32_t& changes, String& error) {
+    if (_active == nullptr) {
+        error = "not initialized";
+        return false;
+    }
+
+    // 2. Validation : parsing complet dans le tampon de réserve
+    // Remise à zéro : pas de reste d'un patch précédent, bourrage comparable
+    memset((void*)&_standby, 0, sizeof(_standby));
+    if (!parseConfigFile(_standby, path) || !validate(_standby, error)) {
+        SPIFFS.remove(path);
+        if (error.isEmpty()) {
+            error = "invalid config";
+        }
+        return false;
+    }
+
+    changes = diff(*_active, _standby);
+    if (changes == 0) {
+        SPIFFS.remove(path);
+        return true;
+    }
+
+    // 3. Persistance : l'ancien fichier devient la sauvegarde, le nouveau prend sa place,
+    // l'image binaire suit. Une coupure entre les deux renommages est rattrapée au
+    // démarrage (loadConfig) : /config.json n'est jamais simplement supprimé.
+    SPIFFS.remove(CONFIG_BACKUP_FILE);
+    if (!SPIFFS.rename(CONFIG_FILE, CONFIG_BACKUP_FILE)) {
+        error = "spiffs rename";
+        return false;
+    }
+    if (!SPIFFS.rename(path, CONFIG_FILE)) {
+        SPIFFS.rename(CONFIG_BACKUP_FILE, CONFIG_FILE); // Retour à la version courante
+        error = "spiffs rename";
+        return false;
+    }
+    ConfigSourceStamp stamp;
+    if (configSourceStamp(stamp)) {
+        saveConfigSnapshot(_standby, stamp);
+    }
+
+    _staged = true;
+    _stagedChanges = changes;
+    EventLoop::post(EVT_CONFIG); // Bascule au prochain tour de boucle, sans attendre l'échéance
+    return true;
+}
+
+uint32_t ConfigUpdate::commitStagedConfig() {
+    if (!_staged) {
+        return 0;
+    }
+    *_active = _standby;
+    _staged = false;
+
+    Serial.print("🔧 Nouvelle configuration active (changements 0x");
+    Serial.print(_stagedChanges, HEX);
+    Serial.println(")");
+    return _stagedChanges;
+}
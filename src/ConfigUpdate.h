@@ -0,0 +1,71 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "ConfigLoader.h"
+
+// Sous-systèmes touchés par une mise à jour de configuration
+#define CFG_CHANGED_SCHEDULE   (1UL << 0)  // Planning d'envoi (lu par référence)
+#define CFG_CHANGED_IRRIGATION (1UL << 1)  // Seuils, durées, zones
+#define CFG_CHANGED_HYDRAULICS (1UL << 2)  // Budget hydraulique (lu par référence)
+#define CFG_CHANGED_VALVES     (1UL << 3)  // Broches / débits des électrovannes
+#define CFG_CHANGED_REPORTING  (1UL << 4)  // Politique d'envoi événementielle
+#define CFG_CHANGED_WIFI       (1UL << 5)  // Wi-Fi / MQTT
+#define CFG_CHANGED_REBOOT     (1UL << 6)  // LED, capteurs, périodes figées au démarrage
+#define CFG_CHANGED_OTHER      (1UL << 7)  // Paramètres relus à chaque usage
+#define CFG_CHANGED_RADIO      (1UL << 8)  // ESP-NOW / LoRa : radio réinitialisée
+#define CFG_CHANGED_IDENTITY   (1UL << 9)  // Identité (en-tête de télémétrie réencodé)
+
+/**
+ * @brief Mise à jour de configuration à chaud, en double tampon.
+ * Le patch (JSON merge patch, RFC 7386) est fusionné avec config.json,
+ * validé par un parsing complet dans le tampon de réserve, puis persisté.
+ * config.json est lu en flux filtré : logic.send_times, seule section dont la
+ * taille n'est pas bornée, est recopié tel quel du fichier courant.
+ * La bascule vers la config active est faite plus tard par commitStagedConfig(),
+ * depuis la loop(), entre deux mises à jour des sous-systèmes.
+ */
+class ConfigUpdate {
+public:
+    /**
+     * @brief Enregistre la configuration active (référencée par tous les modules).
+     */
+    static void begin(Config* active);
+
+    /**
+     * @brief Fusionne, valide et persiste le patch dans le tampon de réserve.
+     * @param changes Masque CFG_CHANGED_* (0 = aucun changement)
+     * @param error Motif du refus
+     * @return false si le patch est refusé (config active inchangée)
+     */
+    static bool stage(JsonObjectConst patch, uint32_t& changes, String& error);
+
+    /**
+     * @brief Valide et persiste un fichier de configuration complet (ex: reçu par OTA).
+     * Le fichier est renommé en config.json s'il est accepté, supprimé sinon.
+     */
+    static bool stageFile(const char* path, uint32_t& changes, String& error);
+
+    static bool hasStaged() { return _staged; }
+
+    /**
+     * @brief Recopie le tampon de réserve dans la config active.
+     * Les références détenues par les modules restent valides.
+     * @return Masque CFG_CHANGED_* appliqué
+     */
+    static uint32_t commitStagedConfig();
+
+    /**
+     * @brief Compare deux configurations, section par section.
+     */
+    static uint32_t diff(const Config& a, const Config& b);
+
+private:
+    static Config* _active;
+    static Config _standby;
+    static bool _staged;
+    static uint32_t _stagedChanges;
+
+    static void mergePatch(JsonObject dst, JsonObjectConst patch);
+    static bool writeMerged(File& out, JsonObjectConst merged, bool keepSendTimes);
+    static bool validate(const Config& next, String& error);
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <Arduino.h>
+
+/**
+ * @brief Chaîne à capacité fixe, stockée dans l'objet (aucune allocation).
+ * Reste trivialement copiable : une structure qui en contient peut être
+ * copiée ou sauvegardée avec memcpy. Les valeurs trop longues sont tronquées.
+ * @tparam N Taille du tampon, '\0' final compris
+ */
+template <size_t N>
+class FixedString {
+public:
+    // Vide dès la construction : c_str() reste valide sans assign() préalable
+    FixedString() { _buf[0] = '\0'; }
+
+    /**
+     * @brief Copie au plus N - 1 caractères.
+     * @return false si la valeur a été tronquée
+     */
+    bool assign(const char* s, size_t len) {
+        if (s == nullptr) {
+            len = 0;
+        }
+        bool fits = len < N;
+        if (!fits) {
+            len = N - 1;
+        }
+        memcpy(_buf, s, len);
+        _buf[len] = '\0';
+        return fits;
+    }
+    bool assign(const char* s) { return assign(s, s ? strlen(s) : 0); }
+
+    FixedString& operator=(const char* s) {
+        assign(s);
+        return *this;
+    }
+
+    const char* c_str() const { return _buf; }
+    size_t length() const { return strlen(_buf); }
+    bool isEmpty() const { return _buf[0] == '\0'; }
+    static constexpr size_t capacity() { return N - 1; }
+
+    bool operator==(const char* s) const { return s != nullptr && strcmp(_buf, s) == 0; }
+    bool operator!=(const char* s) const { return !(*this == s); }
+    bool operator==(const FixedString& o) const { return strcmp(_buf, o._buf) == 0; }
+    bool operator!=(const FixedString& o) const { return !(*this == o); }
+
+private:
+    char _buf[N];
+};
@@ -0,0 +1,87 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+/**
+ * @brief Allocateur ArduinoJson v7 sur un tampon fixe : un JsonDocument construit
+ * avec ce pool n'alloue jamais sur le tas (remplace StaticJsonDocument).
+ * Allocation en pile : chaque bloc est précédé de sa taille, le dernier bloc
+ * grandit ou rétrécit sur place (shrinkToFit), et le tampon entier redevient
+ * disponible dès que tous les blocs sont libérés (clear(), nouveau
+ * deserializeJson() ou destruction des documents qui l'utilisent).
+ * Plusieurs documents peuvent partager un pool ; un dépassement est signalé
+ * par ArduinoJson (DeserializationError::NoMemory, overflowed()).
+ * @tparam N Taille du tampon en octets
+ */
+template <size_t N>
+class JsonPool : public ArduinoJson::Allocator {
+public:
+    JsonPool() : _used(0), _last(NONE), _live(0) {}
+    JsonPool(const JsonPool&) = delete;
+    JsonPool& operator=(const JsonPool&) = delete;
+
+    void* allocate(size_t size) override {
+        size_t need = HEADER + align(size);
+        if (need > N - _used) {
+            return nullptr;
+        }
+        *(size_t*)(_buf + _used) = size;
+        _last = _used;
+        _used += need;
+        _live++;
+        return _buf + _last + HEADER;
+    }
+
+    void deallocate(void* ptr) override {
+        if (ptr == nullptr) {
+            return;
+        }
+        if (--_live == 0) {
+            _used = 0; // Plus aucun bloc vivant : tout le tampon est récupéré
+            _last = NONE;
+        } else if (offsetOf(ptr) == _last) {
+            _used = _last; // Dernier bloc : récupéré tout de suite
+            _last = NONE;
+        }
+    }
+
+    void* reallocate(void* ptr, size_t size) override {
+        if (ptr == nullptr) {
+            return allocate(size);
+        }
+        size_t offset = offsetOf(ptr);
+        if (offset == _last) {
+            // Dernier bloc : redimensionné sur place
+            if (HEADER + align(size) > N - offset) {
+                return nullptr;
+            }
+            *(size_t*)(_buf + offset) = size;
+            _used = offset + HEADER + align(size);
+            return ptr;
+        }
+        size_t old = *(size_t*)(_buf + offset);
+        void* moved = allocate(size);
+        if (moved == nullptr) {
+            return nullptr;
+        }
+        memcpy(moved, ptr, old < size ? old : size);
+        deallocate(ptr);
+        return moved;
+    }
+
+    size_t used() const { return _used; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    static constexpr size_t ALIGN = 8;
+    static constexpr size_t HEADER = ALIGN; // Taille du bloc, alignée
+    static constexpr size_t NONE = (size_t)-1;
+
+    static size_t align(size_t n) { return (n + ALIGN - 1) & ~(ALIGN - 1); }
+    size_t offsetOf(void* ptr) const { return (size_t)((uint8_t*)ptr - _buf) - HEADER; }
+
+    alignas(ALIGN) uint8_t _buf[N];
+    size_t _used;
+    size_t _last;    // Décalage du dernier bloc alloué (NONE s'il a été libéré)
+    uint16_t _live;  // Blocs alloués non libérés
+};
@@ -0,0 +1,188 @@
+#include "Log.h"
+
+Log::Slot Log::_ring[LOG_RING_SLOTS];
+std::atomic<uint32_t> Log::_head(0);
+std::atomic<uint32_t> Log::_tail(0);
+std::atomic<uint32_t> Log::_dropped(0);
+TaskHandle_t Log::_task = nullptr;
+
+void Log::begin() {
+    // Priorité minimale : le port série n'est alimenté que quand la loop est bloquée
+    xTaskCreate(drainTask, "log", 3072, nullptr, tskIDLE_PRIORITY, &_task);
+}
+
+void Log::put(Record& r, double v) {
+    float f = (float)v;
+    putRaw(r, &f, sizeof(f));
+}
+
+void Log::put(Record& r, const char* s) {
+    size_t n = s ? strlen(s) : 0;
+    if (n > LOG_STR_MAX) {
+        n = LOG_STR_MAX;
+    }
+    uint8_t buf[1 + LOG_STR_MAX];
+    buf[0] = (uint8_t)n;
+    memcpy(buf + 1, s, n);
+    putRaw(r, buf, 1 + n);
+}
+
+void Log::putRaw(Record& r, const void* data, size_t n) {
+    // Un argument qui ne tient pas invalide la suite (décodage positionnel)
+    if ((r.level & LOG_TRUNCATED) || r.len + n > LOG_PAYLOAD_SIZE) {
+        r.level |= LOG_TRUNCATED;
+        return;
+    }
+    memcpy(r.payload + r.len, data, n);
+    r.len += n;
+}
+
+void Log::push(const Record& r) {
+    // Réservation d'un emplacement par CAS : plusieurs producteurs (loop, tâche Wi-Fi, timers)
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    do {
+        if (head - _tail.load(std::memory_order_acquire) >= LOG_RING_SLOTS) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    } while (!_head.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+    Slot& s = _ring[head % LOG_RING_SLOTS];
+    s.rec = r;
+    s.ready.store(1, std::memory_order_release);
+}
+
+void Log::drainTask(void* arg) {
+    (void)arg;
+    for (;;) {
+        drain();
+        vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_PERIOD_MS));
+    }
+}
+
+void Log::drain() {
+    static uint32_t reportedDrops = 0;
+
+    uint32_t tail = _tail.load(std::memory_order_relaxed);
+    while (tail != _head.load(std::memory_order_acquire)) {
+        Slot& s = _ring[tail % LOG_RING_SLOTS];
+        if (!s.ready.load(std::memory_order_acquire)) {
+            break; // Emplacement réservé, pas encore rempli
+        }
+        Record r = s.rec;
+        s.ready.store(0, std::memory_order_relaxed);
+        _tail.store(++tail, std::memory_order_release);
+        emit(r);
+    }
+
+    uint32_t drops = dropped();
+    if (drops != reportedDrops) {
+        Record r;
+        r.level = LOG_LEVEL_WARN;
+        r.len = 0;
+        r.ms = millis();
+        r.fmt = "⚠️ Journal: %u enregistrement(s) perdu(s) (anneau plein)";
+        uint32_t lost = drops - reportedDrops;
+        putRaw(r, &lost, sizeof(lost));
+        reportedDrops = drops;
+        emit(r);
+    }
+}
+
+void Log::emit(const Record& r) {
+#if LOG_BINARY
+    uint8_t frame[11 + LOG_PAYLOAD_SIZE + 1];
+    uint32_t fmt = (uint32_t)(uintptr_t)r.fmt;
+    frame[0] = LOG_FRAME_START;
+    frame[1] = r.level;
+    frame[2] = r.len;
+    memcpy(frame + 3, &r.ms, 4);
+    memcpy(frame + 7, &fmt, 4);
+    memcpy(frame + 11, r.payload, r.len);
+    uint8_t sum = 0;
+    for (size_t i = 1; i < 11u + r.len; i++) {
+        sum += frame[i];
+    }
+    frame[11 + r.len] = sum;
+    Serial.write(frame, 12 + r.len);
+#else
+    char text[192];
+    format(r, text, sizeof(text));
+    Serial.println(text);
+#endif
+}
+
+size_t Log::format(const Record& r, char* out, size_t size) {
+    const char* f = r.fmt;
+    size_t n = 0;
+    uint8_t pos = 0;
+
+    while (*f && n + 1 < size) {
+        if (*f != '%') {
+            out[n++] = *f++;
+            continue;
+        }
+        if (f[1] == '%') {
+            out[n++] = '%';
+            f += 2;
+            continue;
+        }
+
+        // Spécification complète : %[drapeaux][largeur][.précision][longueur]conversion
+        const char* start = f++;
+        while (*f && strchr("-+ #0123456789.", *f)) {
+            f++;
+        }
+        bool wide = false;
+        while (*f == 'l' || *f == 'h' || *f == 'z') {
+            if (f[0] == 'l' && f[1] == 'l') {
+                wide = true;
+            }
+            f++;
+        }
+        if (*f == '\0') {
+            break;
+        }
+        char conv = *f++;
+        char spec[16];
+        size_t specLen = min((size_t)(f - start), sizeof(spec) - 1);
+        memcpy(spec, start, specLen);
+        spec[specLen] = '\0';
+
+        int w = -1;
+        if (conv == 's' && pos < r.len) {
+            uint8_t len = r.payload[pos];
+            if (pos + 1 + len <= r.len) {
+                char s[LOG_STR_MAX + 1];
+                memcpy(s, r.payload + pos + 1, len);
+                s[len] = '\0';
+                pos += 1 + len;
+                w = snprintf(out + n, size - n, spec, s);
+            }
+        } else if ((conv == 'f' || conv == 'e' || conv == 'g') && pos + 4 <= r.len) {
+            float v;
+            memcpy(&v, r.payload + pos, 4);
+            pos += 4;
+            w = snprintf(out + n, size - n, spec, (double)v);
+        } else if (strchr("cdiuxXo", conv) && pos + (wide ? 8 : 4) <= r.len) {
+            if (wide) {
+                int64_t v;
+                memcpy(&v, r.payload + pos, 8);
+                pos += 8;
+                w = snprintf(out + n, size - n, spec, v);
+            } else {
+                uint32_t v;
+                memcpy(&v, r.payload + pos, 4);
+                pos += 4;
+                w = snprintf(out + n, size - n, spec, v);
+            }
+        }
+        if (w < 0) {
+            // Argument absent (tronqué) ou conversion inconnue : spécification recopiée
+            w = snprintf(out + n, size - n, "%s", spec);
+        }
+        n += min((size_t)w, size - n - 1);
+    }
+    out[n] = '\0';
+    return n;
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <type_traits>
+
+// Niveaux, filtrés à la compilation (build_flags = -DLOG_LEVEL=LOG_LEVEL_WARN)
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// 1 : trames binaires, décodées sur l'hôte par tools/logdecode.py
+// 0 : texte formaté par la tâche de vidage (moniteur série sans décodeur)
+#ifndef LOG_BINARY
+#define LOG_BINARY 1
+#endif
+
+#define LOG_RING_SLOTS 64
+#define LOG_PAYLOAD_SIZE 36       // Arguments encodés d'un enregistrement
+#define LOG_STR_MAX 23            // Chaîne copiée dans l'enregistrement (tronquée au-delà)
+#define LOG_DRAIN_PERIOD_MS 20
+#define LOG_FRAME_START 0xFE      // N'apparaît jamais dans un texte UTF-8
+#define LOG_TRUNCATED 0x80        // Bit du niveau : arguments incomplets
+
+/**
+ * @brief Journal différé : l'appelant n'écrit que l'adresse du format et ses
+ * arguments en binaire dans un anneau sans verrou ; une tâche de basse
+ * priorité vide l'anneau vers le port série.
+ * Le format doit être un littéral (son adresse en flash sert d'identifiant,
+ * résolue sur l'hôte à partir du .elf). Les arguments suivent le format :
+ * entiers sur 4 octets (8 avec %ll), flottants en float, chaînes (%s)
+ * copiées dans l'enregistrement.
+ * Trame : 0xFE, niveau, longueur, millis (4), format (4), arguments, somme.
+ */
+class Log {
+public:
+    /**
+     * @brief Démarre la tâche de vidage. Les enregistrements antérieurs sont conservés.
+     */
+    static void begin();
+
+    template <typename... Args>
+    static void write(uint8_t level, const char* fmt, Args... args) {
+        Record r;
+        r.level = level;
+        r.len = 0;
+        r.ms = millis();
+        r.fmt = fmt;
+        encode(r, args...);
+        push(r);
+    }
+
+    static uint32_t dropped() { return _dropped.load(std::memory_order_relaxed); }
+    static uint32_t pending() { return _head.load(std::memory_order_relaxed) - _tail.load(std::memory_order_relaxed); }
+    static TaskHandle_t taskHandle() { return _task; }
+
+private:
+    struct Record {
+        uint8_t level;
+        uint8_t len;
+        uint32_t ms;
+        const char* fmt;
+        uint8_t payload[LOG_PAYLOAD_SIZE];
+    };
+    struct Slot {
+        std::atomic<uint8_t> ready;
+        Record rec;
+    };
+
+    static Slot _ring[LOG_RING_SLOTS];
+    static std::atomic<uint32_t> _head;   // Prochain emplacement réservé (producteurs)
+    static std::atomic<uint32_t> _tail;   // Prochain emplacement lu (tâche de vidage)
+    static std::atomic<uint32_t> _dropped;
+    static TaskHandle_t _task;
+
+    static void encode(Record&) {}
+    template <typename T, typename... Rest>
+    static void encode(Record& r, T v, Rest... rest) {
+        put(r, v);
+        encode(r, rest...);
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+    put(Record& r, T v) {
+        if (sizeof(T) > 4) {
+            int64_t w = (int64_t)v;
+            putRaw(r, &w, sizeof(w));
+        } else {
+            uint32_t w = (uint32_t)v;
+            putRaw(r, &w, sizeof(w));
+        }
+    }
+    static void put(Record& r, double v);
+    static void put(Record& r, const char* s);
+    static void putRaw(Record& r, const void* data, size_t n);
+
+    static void push(const Record& r);
+    static void drainTask(void* arg);
+    static void drain();
+    static void emit(const Record& r);
+    static size_t format(const Record& r, char* out, size_t size);
+};
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_E(fmt, ...) Log::write(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_E(fmt, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_W(fmt, ...) Log::write(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_W(fmt, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_I(fmt, ...) Log::write(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_I(fmt, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_D(fmt, ...) Log::write(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_D(fmt, ...) do {} while (0)
+#endif
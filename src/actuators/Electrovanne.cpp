@@ -1,4 +1,5 @@
 #include "Electrovanne.h"
+#include "logic/ValveTimer.h"
 
 // Suppose que HIGH = Relais ON = Vanne OUVERTE
 #define VALVE_OPEN_STATE HIGH
@@ -7,7 +8,10 @@
 Electrovanne::Electrovanne(uint8_t pin)
     : _pin(pin),
       _isOpen(false),
-      _autoCloseTime(0) {}
+      _openedAtMs(0),
+      _durationMs(0),
+      _timer(nullptr),
+      _timerId(0) {}
 
 void Electrovanne::begin() {
     if (_pin == 0) {
@@ -17,6 +21,11 @@ void Electrovanne::begin() {
     close(); // S'assurer que la vanne est fermée au démarrage
 }
 
+void Electrovanne::attachTimer(ValveTimer* timer, uint8_t id) {
+    _timer = timer;
+    _timerId = id;
+}
+
 void Electrovanne::open(uint32_t duration_ms) {
     if (_pin == 0) {
         return;
@@ -24,12 +33,16 @@ void Electrovanne::open(uint32_t duration_ms) {
     digitalWrite(_pin, VALVE_OPEN_STATE);
     _isOpen = true;
 
-    if (duration_ms > 0) {
-        // Définit un temps de fermeture auto
-        _autoCloseTime = millis() + duration_ms;
-    } else {
-        // 0 = reste ouvert
-        _autoCloseTime = 0;
+    // Début + durée plutôt qu'une échéance absolue : robuste au débordement de millis()
+    _openedAtMs = millis();
+    _durationMs = duration_ms; // 0 = reste ouvert
+
+    if (_timer) {
+        if (duration_ms > 0) {
+            _timer->schedule(_timerId, duration_ms, onTimerExpired, this);
+        } else {
+            _timer->cancel(_timerId);
+        }
     }
 }
 
@@ -38,19 +51,27 @@ void Electrovanne::close() {
     return;
     digitalWrite(_pin, VALVE_CLOSED_STATE);
     _isOpen = false;
-    _autoCloseTime = 0; // Annule tout minuteur
+    _durationMs = 0; // Annule tout minuteur
+    if (_timer) {
+        _timer->cancel(_timerId);
+    }
 }
 
 bool Electrovanne::isOpen() const {
     return _isOpen;
 }
 
+void Electrovanne::onTimerExpired(void* ctx) {
+    Electrovanne* valve = static_cast<Electrovanne*>(ctx);
+    valve->close();
+    Serial.print("Vanne sur pin ");
+    Serial.print(valve->_pin);
+    Serial.println(" fermée par le minuteur.");
+}
+
 void Electrovanne::update() {
-    // Vérifie s'il y a un minuteur actif et s'il est temps de fermer
-    if (_autoCloseTime > 0 && millis() >= _autoCloseTime) {
-        close();
-        Serial.print("Vanne sur pin ");
-        Serial.print(_pin);
-        Serial.println(" fermée par le minuteur.");
+    // Sans échéancier : vérification locale, par différence non signée
+    if (_timer == nullptr && _durationMs > 0 && millis() - _openedAtMs >= _durationMs) {
+        onTimerExpired(this);
     }
-}
\ No newline at end of file
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include <Arduino.h>
 
+class ValveTimer;
+
 class Electrovanne {
 public:
     /**
@@ -14,6 +16,13 @@ public:
      */
     void begin();
 
+    /**
+     * @brief Confie la fermeture automatique à l'échéancier central.
+     * @param timer L'échéancier partagé par toutes les vannes
+     * @param id Identifiant unique de la vanne dans l'échéancier
+     */
+    void attachTimer(ValveTimer* timer, uint8_t id);
+
     /**
      * @brief Ouvre la vanne.
      * @param duration_ms Durée en millisecondes avant fermeture auto.
@@ -28,7 +37,7 @@ public:
 
     /**
      * @brief Fonction à appeler dans la loop() principale.
-     * Gère le minuteur de fermeture automatique.
+     * Gère le minuteur de fermeture automatique (inutile si un échéancier est attaché).
      */
     void update();
 
@@ -40,5 +49,10 @@ public:
 private:
     uint8_t _pin;
     bool _isOpen;
-    unsigned long _autoCloseTime; // Timestamp (millis()) de fermeture
-};
\ No newline at end of file
+    uint32_t _openedAtMs;   // millis() à l'ouverture
+    uint32_t _durationMs;   // 0 = pas de fermeture auto
+    ValveTimer* _timer;
+    uint8_t _timerId;
+
+    static void onTimerExpired(void* ctx);
+};
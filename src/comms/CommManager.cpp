@@ -1,6 +1,11 @@
 #include "CommManager.h"
 #include <Arduino.h>
 #include <esp_wifi.h>
+#include <sys/time.h>
+#include "logic/EventLoop.h"
+#include "logic/ClockSync.h"
+#include "Log.h"
+#include "logic/Metrics.h"
 
 // MODIFIÉ : Le constructeur initialise espNow et lora avec l'Actuator
 CommManager::CommManager(Actuator* actuator) 
@@ -10,14 +15,18 @@ CommManager::CommManager(Actuator* actuator)
       espnowPeerMac(nullptr),
       loraPeerAddress(0),
       espnowChannel(1),
+      loraBeaconChannel(0),
       userRecvCallback(nullptr),
       userSendCallback(nullptr),
+      rxHead(0),
+      rxTail(0),
       actuator(actuator) {}
 
 
 bool CommManager::begin(const ConfigNetwork& netConfig, const ConfigPins& pinConfig, bool isMaster) {
     
     this->loraPeerAddress = netConfig.lora_peer_addr;
+    this->loraBeaconChannel = netConfig.lora_beacon_channel;
 
     // IMPORTANT :
     //  - Follower : peer fixe = MAC du Master (master_mac_bytes)
@@ -107,6 +116,30 @@ bool CommManager::begin(const ConfigNetwork& netConfig, const ConfigPins& pinCon
     return false;
 }
 
+void CommManager::end() {
+    switch (activeMode) {
+        case CommMode::ESP_NOW:
+            espNow.end();
+            break;
+        case CommMode::LORA:
+            lora.end();
+            break;
+        case CommMode::NONE:
+        default:
+            break;
+    }
+    activeMode = CommMode::NONE;
+    // Plus aucun callback radio : la file peut être vidée sans concurrence
+    rxHead = 0;
+    rxTail = 0;
+}
+
+bool CommManager::restart(const ConfigNetwork& netConfig, const ConfigPins& pinConfig, bool isMaster) {
+    Serial.println("🔧 CommManager: réinitialisation de la radio...");
+    end();
+    return begin(netConfig, pinConfig, isMaster);
+}
+
 void CommManager::registerRecvCallback(DataRecvCallback cb) {
     this->userRecvCallback = cb;
 }
@@ -125,33 +158,29 @@ bool CommManager::isEspNowPeerExist(const uint8_t* mac_addr) {
 }
 
 bool CommManager::sendData(const char* jsonData) {
-    const uint8_t* data = (const uint8_t*)jsonData;
-    int len = strlen(jsonData); 
-    
+    return sendBytes((const uint8_t*)jsonData, strlen(jsonData));
+}
+
+bool CommManager::sendBytes(const uint8_t* data, int len) {
     if (len > MAX_PAYLOAD_SIZE) {
-        Serial.println("❌ Erreur: Payload JSON trop grand pour être envoyé !");
+        LOG_E("❌ Erreur: Payload JSON trop grand pour être envoyé !");
         return false;
     }
 
     switch(activeMode) {
         case CommMode::ESP_NOW:
-            Serial.print("📡 Envoi ESP-NOW (");
-            Serial.print(len);
-            Serial.println(" octets)...");
+            LOG_D("📡 Envoi ESP-NOW (%d octets)...", len);
             if (!espnowPeerMac) {
-                Serial.println("❌ ESP-NOW: Aucun peer configuré (espnowPeerMac = NULL).");
+                LOG_E("❌ ESP-NOW: Aucun peer configuré (espnowPeerMac = NULL).");
                 return false;
             }
             return espNow.sendData(espnowPeerMac, data, len);
         
         case CommMode::LORA: {
-            Serial.print("📡 Envoi LoRa vers 0x");
-            Serial.print(loraPeerAddress, HEX);
-            Serial.print(" (");
-            Serial.print(len);
-            Serial.println(" octets)...");
+            LOG_D("📡 Envoi LoRa vers 0x%X (%d octets)...", loraPeerAddress, len);
             
             bool success = lora.sendData(loraPeerAddress, data, len);
+            Metrics::inc(success ? MC_RADIO_TX_OK : MC_RADIO_TX_FAIL);
             if (userSendCallback) {
                 userSendCallback(success);
             }
@@ -160,49 +189,45 @@ bool CommManager::sendData(const char* jsonData) {
         
         case CommMode::NONE:
         default:
-            Serial.println("❌ Aucun mode de comm actif !");
+            LOG_E("❌ Aucun mode de comm actif !");
             return false;
     }
 }
 
 bool CommManager::sendDataToSender(const SenderInfo& recipient, const char* jsonData) {
-    const uint8_t* data = (const uint8_t*)jsonData;
-    int len = strlen(jsonData); 
-    
+    return sendBytesToSender(recipient, (const uint8_t*)jsonData, strlen(jsonData));
+}
+
+bool CommManager::sendBytesToSender(const SenderInfo& recipient, const uint8_t* data, int len) {
     if (len > MAX_PAYLOAD_SIZE) {
-        Serial.println("❌ Erreur: Payload JSON trop grand pour être envoyé !");
+        LOG_E("❌ Erreur: Payload JSON trop grand pour être envoyé !");
         return false;
     }
 
     switch(recipient.mode) {
         case CommMode::ESP_NOW:
             if (recipient.macAddress == nullptr) {
-                Serial.println("❌ Adresse MAC destinataire NULL !");
+                LOG_E("❌ Adresse MAC destinataire NULL !");
                 return false;
             }
             // S'assurer que le peer existe (Master)
             if (!espNow.isPeerExist(recipient.macAddress)) {
-                Serial.println("ℹ️ Ajout dynamique du peer ESP-NOW côté Master.");
+                LOG_I("ℹ️ Ajout dynamique du peer ESP-NOW côté Master.");
                 espNow.addPeer(recipient.macAddress, 0);
             }
-            Serial.print("📡 Réponse ESP-NOW (");
-            Serial.print(len);
-            Serial.println(" octets)...");
+            LOG_D("📡 Réponse ESP-NOW (%d octets)...", len);
             return espNow.sendData(recipient.macAddress, data, len);
         
         case CommMode::LORA: {
             if (recipient.loraAddress == 0) {
-                Serial.println("❌ Adresse LoRa destinataire invalide !");
+                LOG_E("❌ Adresse LoRa destinataire invalide !");
                 return false;
             }
             
-            Serial.print("📡 Réponse LoRa vers 0x");
-            Serial.print(recipient.loraAddress, HEX);
-            Serial.print(" (");
-            Serial.print(len);
-            Serial.println(" octets)...");
+            LOG_D("📡 Réponse LoRa vers 0x%X (%d octets)...", recipient.loraAddress, len);
             
             bool success = lora.sendData(recipient.loraAddress, data, len);
+            Metrics::inc(success ? MC_RADIO_TX_OK : MC_RADIO_TX_FAIL);
             if (userSendCallback) {
                 userSendCallback(success);
             }
@@ -211,55 +236,105 @@ bool CommManager::sendDataToSender(const SenderInfo& recipient, const char* json
         
         case CommMode::NONE:
         default:
-            Serial.println("❌ Mode de comm destinataire invalide !");
+            LOG_E("❌ Mode de comm destinataire invalide !");
             return false;
     }
 }
 
-void CommManager::onEspNowDataRecv(const uint8_t* mac, const uint8_t* data, int len) {
-    Serial.print("✅ ESP-NOW: Réception de ");
-    Serial.print(len);
-    Serial.print(" octets depuis ");
-    for (int i = 0; i < 6; i++) {
-        if (mac[i] < 0x10) Serial.print("0");
-        Serial.print(mac[i], HEX);
-        if (i < 5) Serial.print(":");
+bool CommManager::broadcastData(const char* jsonData) {
+    return broadcastBytes((const uint8_t*)jsonData, strlen(jsonData));
+}
+
+bool CommManager::broadcastBytes(const uint8_t* data, int len) {
+    if (len > MAX_PAYLOAD_SIZE) {
+        LOG_E("❌ Erreur: Payload JSON trop grand pour être diffusé !");
+        return false;
     }
-    Serial.println();
-    
-    if (userRecvCallback) {
-        SenderInfo sender = {};
-        sender.mode       = CommMode::ESP_NOW;
-        sender.macAddress = mac;
-        sender.loraAddress = 0;
-        userRecvCallback(sender, data, len); 
+
+    switch(activeMode) {
+        case CommMode::ESP_NOW:
+            return espNow.broadcast(data, len);
+
+        case CommMode::LORA:
+            return lora.broadcast(loraBeaconChannel, data, len);
+
+        case CommMode::NONE:
+        default:
+            return false;
     }
 }
 
+void CommManager::onEspNowDataRecv(const uint8_t* mac, const uint8_t* data, int len) {
+    Metrics::inc(MC_RADIO_RX);
+    LOG_I("✅ ESP-NOW: Réception de %d octets depuis %02X:%02X:%02X:%02X:%02X:%02X",
+          len, mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+
+    // Tâche Wi-Fi : copie seulement, le traitement se fait dans la loop
+    enqueueRx(CommMode::ESP_NOW, mac, 0, data, len);
+    EventLoop::post(EVT_RADIO);
+}
+
 void CommManager::onEspNowSendStatus(bool success) {
+    Metrics::inc(success ? MC_RADIO_TX_OK : MC_RADIO_TX_FAIL);
     if (success) {
-        Serial.println("✅ ESP-NOW: Envoi réussi !");
+        LOG_D("✅ ESP-NOW: Envoi réussi !");
     } else {
-        Serial.println("❌ ESP-NOW: Échec d'envoi !");
+        LOG_W("❌ ESP-NOW: Échec d'envoi !");
     }
     
     if (userSendCallback) {
         userSendCallback(success);
     }
+    EventLoop::post(EVT_RADIO);
 }
 
 void CommManager::onLoraDataRecv(const uint8_t* data, int len, uint16_t from) {
-    Serial.print("✅ LoRa: Réception de ");
-    Serial.print(len);
-    Serial.print(" octets depuis 0x");
-    Serial.println(from, HEX);
-    
-    if (userRecvCallback) {
-        SenderInfo sender = {};
-        sender.mode       = CommMode::LORA;
-        sender.macAddress = nullptr;
-        sender.loraAddress = from;
-        userRecvCallback(sender, data, len); 
+    Metrics::inc(MC_RADIO_RX);
+    LOG_I("✅ LoRa: Réception de %d octets depuis 0x%X", len, from);
+
+    enqueueRx(CommMode::LORA, nullptr, from, data, len);
+    EventLoop::post(EVT_RADIO);
+}
+
+void CommManager::enqueueRx(CommMode mode, const uint8_t* mac, uint16_t loraAddress, const uint8_t* data, int len) {
+    if (len <= 0 || len > MAX_PAYLOAD_SIZE) {
+        return;
+    }
+    uint8_t next = (rxHead + 1) % RADIO_RX_QUEUE_LEN;
+    if (next == rxTail) {
+        LOG_W("⚠️ Radio: file de réception pleine, trame de %d octets perdue.", len);
+        return;
+    }
+    RxSlot& slot = rxQueue[rxHead];
+    // Horodatage immédiat : l'attente en file et les traitements de la loop
+    // ne doivent pas s'ajouter aux échantillons de synchro horaire (t2, t4, beacons)
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    slot.rxEpochMs = (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    slot.rxLocalMs = ClockSync::localMs();
+    slot.mode = mode;
+    if (mac != nullptr) {
+        memcpy(slot.mac, mac, 6);
+    }
+    slot.loraAddress = loraAddress;
+    slot.len = (uint8_t)len;
+    memcpy(slot.data, data, len);
+    rxHead = next;
+}
+
+void CommManager::dispatchRx() {
+    while (rxTail != rxHead) {
+        const RxSlot& slot = rxQueue[rxTail];
+        if (userRecvCallback) {
+            SenderInfo sender = {};
+            sender.mode        = slot.mode;
+            sender.macAddress  = slot.mode == CommMode::ESP_NOW ? slot.mac : nullptr;
+            sender.loraAddress = slot.loraAddress;
+            sender.rxLocalMs   = slot.rxLocalMs;
+            sender.rxEpochMs   = slot.rxEpochMs;
+            userRecvCallback(sender, slot.data, slot.len);
+        }
+        rxTail = (rxTail + 1) % RADIO_RX_QUEUE_LEN;
     }
 }
 
@@ -267,6 +342,7 @@ void CommManager::update() {
     if (activeMode == CommMode::LORA) {
         lora.update();
     }
+    dispatchRx();
 }
 
 void CommManager::sleepIfLora() {
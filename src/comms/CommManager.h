@@ -3,20 +3,10 @@
 #include "comms/LoraComms.h"
 #include "ConfigLoader.h"
 #include "actuators/Actuator.h" // Inclure Actuator.h
+#include "comms/SenderInfo.h"
 
-enum class CommMode {
-    NONE,
-    ESP_NOW,
-    LORA
-};
-
-struct SenderInfo {
-    CommMode mode;
-    const uint8_t* macAddress;
-    uint8_t loraAddress;
-};
-
-
+#define LORA_POLL_MS 10
+#define RADIO_RX_QUEUE_LEN 8 // Trames reçues en attente de traitement par la loop
 
 class CommManager {
 public:
@@ -30,13 +20,35 @@ public:
 
     bool begin(const ConfigNetwork& netConfig, const ConfigPins& pinConfig, bool isMaster);
 
+    /**
+     * @brief Arrête la radio active puis la réinitialise avec une nouvelle configuration
+     * (mise à jour à chaud). Les callbacks utilisateur sont conservés, les trames
+     * en attente de traitement sont abandonnées.
+     */
+    bool restart(const ConfigNetwork& netConfig, const ConfigPins& pinConfig, bool isMaster);
+
     void registerRecvCallback(DataRecvCallback cb);
     void registerSendCallback(SendStatusCallback cb);
 
     bool sendData(const char* jsonData);
     bool sendDataToSender(const SenderInfo& recipient, const char* jsonData);
 
+    // Diffusion à tous les nœuds à portée (ESP-NOW broadcast / LoRa 0xFFFF)
+    bool broadcastData(const char* jsonData);
+
+    // Variantes binaires (trames OTA) : longueur explicite, pas de strlen
+    bool sendBytes(const uint8_t* data, int len);
+    bool sendBytesToSender(const SenderInfo& recipient, const uint8_t* data, int len);
+    bool broadcastBytes(const uint8_t* data, int len);
+
+    /**
+     * @brief À appeler depuis la loop : interroge le LoRa et transmet les trames
+     * reçues au callback utilisateur (jamais appelé depuis la tâche Wi-Fi).
+     */
     void update();
+
+    // Période d'appel de update() : l'UART LoRa est interrogé, ESP-NOW signale ses trames (0)
+    uint32_t pollIntervalMs() const { return activeMode == CommMode::LORA ? LORA_POLL_MS : 0; }
     
     CommMode getActiveMode() const { return activeMode; }
 
@@ -56,10 +68,29 @@ private:
     const uint8_t* espnowPeerMac;  // côté Follower = MAC du Master, côté Master = nullptr
     uint16_t      loraPeerAddress; 
     uint8_t       espnowChannel;
+    uint8_t       loraBeaconChannel;
 
     DataRecvCallback  userRecvCallback;
     SendStatusCallback userSendCallback;
 
+    // File producteur (callback radio) / consommateur (loop), comme OtaReceiver
+    struct RxSlot {
+        CommMode mode;
+        uint8_t mac[6];
+        uint16_t loraAddress;
+        int64_t rxLocalMs;   // Horodatage à la réception, pas au traitement
+        int64_t rxEpochMs;
+        uint8_t len;
+        uint8_t data[MAX_PAYLOAD_SIZE];
+    };
+    RxSlot rxQueue[RADIO_RX_QUEUE_LEN];
+    volatile uint8_t rxHead;
+    volatile uint8_t rxTail;
+
+    void end();
+    void enqueueRx(CommMode mode, const uint8_t* mac, uint16_t loraAddress, const uint8_t* data, int len);
+    void dispatchRx();
+
     void onEspNowDataRecv(const uint8_t* mac, const uint8_t* data, int len);
     void onEspNowSendStatus(bool success);
     void onLoraDataRecv(const uint8_t* data, int len, uint16_t from); 
@@ -1,5 +1,6 @@
 #include "ESPNowComms.h"
 #include <Arduino.h>
+#include "Log.h"
 
 ESPNowComms* ESPNowComms::instance = nullptr;
 
@@ -34,6 +35,13 @@ bool ESPNowComms::begin(bool wifiAlreadyInited) {
     return true;
 }
 
+void ESPNowComms::end() {
+    esp_now_unregister_recv_cb();
+    esp_now_unregister_send_cb();
+    esp_now_deinit();
+    Serial.println("ESPNowComms: ESP-NOW arrêté.");
+}
+
 void ESPNowComms::registerRecvCallback(DataRecvCallback cb) {
     this->onDataReceived = cb;
     esp_now_register_recv_cb(onDataRecv_static);
@@ -91,7 +99,7 @@ bool ESPNowComms::isPeerExist(const uint8_t* mac_addr) {
 
 bool ESPNowComms::sendData(const uint8_t* mac_addr, const uint8_t* data, int len) {
     if (!mac_addr) {
-        Serial.println("❌ ESP-NOW sendData: mac_addr = NULL");
+        LOG_E("❌ ESP-NOW sendData: mac_addr = NULL");
         return false;
     }
 
@@ -102,16 +110,9 @@ bool ESPNowComms::sendData(const uint8_t* mac_addr, const uint8_t* data, int len
     esp_err_t result = esp_now_send(mac_addr, data, len); 
 
     if (result != ESP_OK) {
-        Serial.print("❌ ESP-NOW send error vers ");
-        for (int i = 0; i < 6; i++) {
-            if (i) Serial.print(":");
-            if (mac_addr[i] < 0x10) Serial.print("0");
-            Serial.print(mac_addr[i], HEX);
-        }
-        Serial.print(" -> code=");
-        Serial.print(result);
-        Serial.print(" / ");
-        Serial.println(esp_err_to_name(result));
+        // Partie basse de la MAC (l'OUI est commun à toutes les cartes) : l'enregistrement reste court
+        LOG_E("❌ ESP-NOW send error vers ..:%02X:%02X:%02X -> %s",
+              mac_addr[3], mac_addr[4], mac_addr[5], esp_err_to_name(result));
         return false;
     }
 
@@ -120,6 +121,14 @@ bool ESPNowComms::sendData(const uint8_t* mac_addr, const uint8_t* data, int len
     return true;
 }
 
+bool ESPNowComms::broadcast(const uint8_t* data, int len) {
+    static const uint8_t broadcastMac[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    if (!esp_now_is_peer_exist(broadcastMac)) {
+        addPeer(broadcastMac, 0);
+    }
+    return sendData(broadcastMac, data, len);
+}
+
 // ----- Gestion des Callbacks -----
 
 void ESPNowComms::onDataRecv_static(const uint8_t* mac, const uint8_t* data, int len) {
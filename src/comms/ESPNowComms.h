@@ -22,6 +22,9 @@ public:
      */
     bool begin(bool isMaster = false); // Renommé 'wifiAlreadyInited' en 'isMaster' pour plus de clarté
 
+    // Arrêt d'ESP-NOW (peers et callbacks supprimés), le Wi-Fi reste actif
+    void end();
+
     void registerRecvCallback(DataRecvCallback cb);
     void registerSendCallback(SendStatusCallback cb);
 
@@ -30,6 +33,9 @@ public:
     
     bool sendData(const uint8_t* mac_addr, const uint8_t* data, int len);
 
+    // Diffusion vers FF:FF:FF:FF:FF:FF (peer ajouté au premier appel)
+    bool broadcast(const uint8_t* data, int len);
+
 private:
     static void onDataRecv_static(const uint8_t* mac, const uint8_t* data, int len);
     static void onDataSent_static(const uint8_t* mac, esp_now_send_status_t status);
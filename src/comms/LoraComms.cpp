@@ -1,5 +1,6 @@
 #include "LoraComms.h"
 #include <Arduino.h>
+#include "Log.h"
 
 LoraComms::LoraComms(HardwareSerial& serial, Actuator* actuator)
     : loraSerial(serial),
@@ -10,6 +11,9 @@ LoraComms::LoraComms(HardwareSerial& serial, Actuator* actuator)
       onDataReceived(nullptr),
       onSendComplete(nullptr),
       rxIndex(0),
+      rxState(RxState::WAIT_START),
+      rxLen(0),
+      rxLastByteMs(0),
       awaitingAck(false),
       sendTime(0)
 {
@@ -41,6 +45,15 @@ bool LoraComms::begin(const ConfigPins& pinConfig, const ConfigNetwork& netConfi
     return true;
 }
 
+void LoraComms::end() {
+    setMode(MODE_SLEEP);
+    loraSerial.end();
+    rxState = RxState::WAIT_START;
+    rxIndex = 0;
+    awaitingAck = false;
+    Serial.println("[LoRa] Arrêté.");
+}
+
 void LoraComms::registerRecvCallback(DataRecvCallback cb) {
     onDataReceived = cb;
 }
@@ -59,7 +72,7 @@ bool LoraComms::sendData(const uint8_t* data, int len) {
 bool LoraComms::sendData(uint16_t destId, const uint8_t* data, int len) {
     // On garde la vérification ici pour les appels "normaux"
     if (len <= 0 || len > MAX_LORA_PAYLOAD - 4) { // <, srcId, len, >
-        Serial.println("[LoRa] Payload trop long !");
+        LOG_E("[LoRa] Payload trop long !");
         return false;
     }
 
@@ -72,8 +85,7 @@ bool LoraComms::sendData(uint16_t destId, const uint8_t* data, int len) {
     awaitingAck = true;
     sendTime    = millis();
 
-    Serial.print("[LoRa] --> TX OK (attend ACK) vers ");
-    Serial.println(destId);
+    LOG_D("[LoRa] --> TX OK (attend ACK) vers %u", destId);
 
     return true;
 }
@@ -81,16 +93,29 @@ bool LoraComms::sendData(uint16_t destId, const uint8_t* data, int len) {
 // -----------------------------------------------------------------------------
 // Envoi brut d'une trame LoRa (utilisé par sendData ET sendAck)
 // -----------------------------------------------------------------------------
-bool LoraComms::sendRawFrame(uint16_t destId, const uint8_t* data, int len) {
+bool LoraComms::broadcast(uint8_t channel, const uint8_t* data, int len) {
+    if (len <= 0 || len > MAX_LORA_PAYLOAD - 5) { // <, srcId, len, marqueur, >
+        LOG_E("[LoRa] Payload diffusé trop long !");
+        return false;
+    }
+
+    // Le marqueur permet au récepteur de ne pas répondre par un ACK
+    uint8_t frame[MAX_LORA_PAYLOAD];
+    frame[0] = LORA_BCAST_ID;
+    memcpy(&frame[1], data, len);
+    return sendRawFrame(LORA_BROADCAST_ADDR, frame, len + 1, channel);
+}
+
+bool LoraComms::sendRawFrame(uint16_t destId, const uint8_t* data, int len, uint8_t channel) {
     if (len <= 0 || len > MAX_LORA_PAYLOAD - 4) { // sécurité interne
-        Serial.println("[LoRa] (sendRawFrame) Payload trop long !");
+        LOG_E("[LoRa] (sendRawFrame) Payload trop long !");
         return false;
     }
 
     // Réveiller le module si besoin
     setMode(MODE_WAKE);
     if (!waitForAux(2000)) {
-        Serial.println("[LoRa] ❌ Timeout AUX avant envoi !");
+        LOG_E("[LoRa] ❌ Timeout AUX avant envoi !");
         return false;
     }
 
@@ -118,7 +143,7 @@ bool LoraComms::sendRawFrame(uint16_t destId, const uint8_t* data, int len) {
 
     loraSerial.write(dest_addr_h);
     loraSerial.write(dest_addr_l);
-    loraSerial.write(0); // 3ème octet de l'en-tête (Channel / options)
+    loraSerial.write(channel); // 3ème octet de l'en-tête (Channel / options)
 
     // --- 3. Envoi de la trame encapsulée ---
     loraSerial.write(payload_frame, payload_idx);
@@ -126,13 +151,12 @@ bool LoraComms::sendRawFrame(uint16_t destId, const uint8_t* data, int len) {
 
     // Attendre que l'envoi RF soit terminé (AUX remonte)
     if (!waitForAux(5000)) {
-        Serial.println("[LoRa] ❌ Timeout AUX après l'envoi physique.");
+        LOG_E("[LoRa] ❌ Timeout AUX après l'envoi physique.");
         return false;
     }
 
     // Log générique TX
-    Serial.print("[LoRa] --> TX brut vers ");
-    Serial.println(destId);
+    LOG_D("[LoRa] --> TX brut vers %u", destId);
 
     return true;
 }
@@ -142,11 +166,16 @@ bool LoraComms::sendRawFrame(uint16_t destId, const uint8_t* data, int len) {
 // -----------------------------------------------------------------------------
 void LoraComms::update() {
     // Gestion réception
+    // Trame tronquée (octets perdus) : resynchronisation sur le prochain '<'
+    if (rxState != RxState::WAIT_START && millis() - rxLastByteMs > LORA_RX_BYTE_TIMEOUT_MS) {
+        rxState = RxState::WAIT_START;
+    }
+
     while (loraSerial.available()) {
-        char c = loraSerial.read();
+        uint8_t c = loraSerial.read();
         
         // ACTUATOR : Afficher RX si c'est le début d'une nouvelle trame
-        if (c == '<' && actuator) {
+        if (c == '<' && rxState == RxState::WAIT_START && actuator) {
             actuator->showLoraTxRx();
         }
         
@@ -159,25 +188,50 @@ void LoraComms::update() {
         if (onSendComplete) {
             onSendComplete(false);
         }
-        Serial.println("[LoRa] ❌ Pas d’ACK: échec envoi");
+        LOG_W("[LoRa] ❌ Pas d’ACK: échec envoi");
     }
 }
 
 // -----------------------------------------------------------------------------
-// Parsing de la trame entrée (framing '<' ... '>')
+// Parsing de la trame entrée ('<' | srcId | len | données | '>', découpage par longueur)
 // -----------------------------------------------------------------------------
-void LoraComms::processIncomingByte(char c) {
-    if (c == '<') {
-        rxIndex = 0; // Reset buffer
-    } else if (c == '>') {
-        // Fin de trame
-        handleCompleteFrame();
-        rxIndex = 0;
-    } else if (rxIndex < MAX_LORA_PAYLOAD) {
-        rxBuffer[rxIndex++] = (uint8_t)c;
-    } else {
-        // Débordement ou bruit -> reset
-        rxIndex = 0;
+void LoraComms::processIncomingByte(uint8_t c) {
+    rxLastByteMs = millis();
+    switch (rxState) {
+        case RxState::WAIT_START:
+            if (c == '<') {
+                rxState = RxState::SRC;
+            }
+            break;
+        case RxState::SRC:
+            rxBuffer[0] = c;
+            rxState = RxState::LEN;
+            break;
+        case RxState::LEN:
+            rxBuffer[1] = c;
+            rxLen = c;
+            rxIndex = 2;
+            if (rxLen == 0 || rxLen + 2 > MAX_LORA_PAYLOAD) {
+                rxState = RxState::WAIT_START; // Longueur impossible : bruit
+            } else {
+                rxState = RxState::DATA;
+            }
+            break;
+        case RxState::DATA:
+            rxBuffer[rxIndex++] = c;
+            if (rxIndex == rxLen + 2) {
+                rxState = RxState::END;
+            }
+            break;
+        case RxState::END:
+            // Le '>' final valide la longueur annoncée
+            if (c == '>') {
+                handleCompleteFrame();
+            } else {
+                LOG_W("[LoRa] ⚠️ Trame invalide (fin de trame absente)");
+            }
+            rxState = RxState::WAIT_START;
+            break;
     }
 }
 
@@ -188,7 +242,7 @@ void LoraComms::handleCompleteFrame() {
     uint8_t jsonLen = rxBuffer[1];
 
     if (jsonLen + 2 != rxIndex) { 
-        Serial.println("[LoRa] ⚠️ Trame invalide (taille incohérente)");
+        LOG_W("[LoRa] ⚠️ Trame invalide (taille incohérente)");
         return;
     }
 
@@ -201,16 +255,21 @@ void LoraComms::handleCompleteFrame() {
             if (onSendComplete) {
                 onSendComplete(true);
             }
-            Serial.println("[LoRa] ✔️ ACK reçu");
+            LOG_D("[LoRa] ✔️ ACK reçu");
+        }
+        return;
+    }
+
+    // Trame diffusée : pas d'ACK, on retire le marqueur
+    if (jsonLen >= 1 && jsonData[0] == LORA_BCAST_ID) {
+        if (onDataReceived && jsonLen > 1) {
+            onDataReceived(jsonData + 1, jsonLen - 1, srcId);
         }
         return;
     }
 
     // Sinon, c’est un message applicatif normal
-    Serial.print("[LoRa] <-- Réception (");
-    Serial.print(jsonLen);
-    Serial.print(" octets) De: ");
-    Serial.println(srcId);
+    LOG_D("[LoRa] <-- Réception (%u octets) De: %u", jsonLen, srcId);
 
     // Répondre automatiquement ACK (sans attente d'ACK pour l'ACK lui-même)
     sendAck(srcId);
@@ -228,11 +287,9 @@ bool LoraComms::sendAck(uint16_t destId) {
     bool ok = sendRawFrame(destId, &ackPayload, 1);
 
     if (ok) {
-        Serial.print("[LoRa] --> ACK envoyé vers ");
-        Serial.println(destId);
+        LOG_D("[LoRa] --> ACK envoyé vers %u", destId);
     } else {
-        Serial.print("[LoRa] ❌ Échec envoi ACK vers ");
-        Serial.println(destId);
+        LOG_W("[LoRa] ❌ Échec envoi ACK vers %u", destId);
     }
 
     return ok;
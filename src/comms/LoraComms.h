@@ -8,6 +8,9 @@
 #define MAX_LORA_PAYLOAD 200 // Taille max de la trame UART incluant en-tête/pied
 #define LORA_FRAME_TIMEOUT 5000 // Timeout pour l'ACK (5 secondes)
 #define LORA_ACK_ID 0xFE // Identifiant pour l'ACK
+#define LORA_BCAST_ID 0xFD // Préfixe des trames diffusées (pas d'ACK)
+#define LORA_BROADCAST_ADDR 0xFFFF
+#define LORA_RX_BYTE_TIMEOUT_MS 100 // Trame abandonnée après ce silence au milieu d'une réception
 
 // Modes du DX-LR03 basés sur M1
 #define MODE_SLEEP 0 // M1 LOW : Entrer en mode veille
@@ -23,6 +26,9 @@ public:
     
     // Le begin utilise ConfigPins et ConfigNetwork pour l'ID et les broches
     bool begin(const ConfigPins& pins, const ConfigNetwork& netConfig);
+
+    // Module en veille, UART libéré (avant un begin() avec d'autres broches)
+    void end();
     
     void registerRecvCallback(DataRecvCallback cb);
     void registerSendCallback(SendCallback cb);
@@ -32,6 +38,9 @@ public:
     
     // Envoi à un destinataire spécifique (nécessite l'ID pour l'adressage physique)
     bool sendData(uint16_t destId, const uint8_t* data, int len);
+
+    // Diffusion sur un canal donné (sans ACK)
+    bool broadcast(uint8_t channel, const uint8_t* data, int len);
     
     void update();
     
@@ -58,16 +67,21 @@ private:
     DataRecvCallback onDataReceived;
     SendCallback onSendComplete;
     
-    // Réception du protocole Frame [ < | srcId | len | json... | > ]
+    // Réception du protocole Frame [ < | srcId | len | data... | > ]
+    // Découpage par longueur : les données binaires peuvent contenir '<' et '>'
+    enum class RxState : uint8_t { WAIT_START, SRC, LEN, DATA, END };
     uint8_t rxBuffer[MAX_LORA_PAYLOAD];
     int rxIndex;
-    void processIncomingByte(char c);
+    RxState rxState;
+    uint8_t rxLen;
+    unsigned long rxLastByteMs;
+    void processIncomingByte(uint8_t c);
     void handleCompleteFrame();
 
     // Gestion de l'ACK
     bool awaitingAck;
     unsigned long sendTime;
-    bool sendRawFrame(uint16_t destId, const uint8_t* data, int len);
+    bool sendRawFrame(uint16_t destId, const uint8_t* data, int len, uint8_t channel = 0);
     
     // Fonctions d'assistance pour le protocole
     bool sendAck(uint16_t srcId);
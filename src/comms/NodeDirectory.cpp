@@ -0,0 +1,55 @@
+#include "NodeDirectory.h"
+
+NodeDirectory::NodeDirectory() : _count(0) {}
+
+int NodeDirectory::find(const char* nodeId) const {
+    for (size_t i = 0; i < _count; i++) {
+        if (strncmp(_entries[i].nodeId, nodeId, NODE_ID_MAX_LEN) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void NodeDirectory::learn(const char* nodeId, const SenderInfo& sender, unsigned long nowMs) {
+    if (nodeId == nullptr || sender.mode == CommMode::NONE) {
+        return;
+    }
+
+    int idx = find(nodeId);
+    if (idx < 0) {
+        if (_count < MAX_DIRECTORY_NODES) {
+            idx = (int)_count++;
+        } else {
+            // Remplacer le nœud silencieux depuis le plus longtemps
+            idx = 0;
+            for (size_t i = 1; i < _count; i++) {
+                if (nowMs - _entries[i].lastSeenMs > nowMs - _entries[idx].lastSeenMs) {
+                    idx = (int)i;
+                }
+            }
+        }
+        strncpy(_entries[idx].nodeId, nodeId, NODE_ID_MAX_LEN - 1);
+        _entries[idx].nodeId[NODE_ID_MAX_LEN - 1] = '\0';
+    }
+
+    Entry& e = _entries[idx];
+    e.mode = sender.mode;
+    if (sender.mode == CommMode::ESP_NOW && sender.macAddress != nullptr) {
+        memcpy(e.mac, sender.macAddress, 6);
+    }
+    e.loraAddress = sender.loraAddress;
+    e.lastSeenMs = nowMs;
+}
+
+bool NodeDirectory::lookup(const char* nodeId, SenderInfo& out) const {
+    int idx = find(nodeId);
+    if (idx < 0) {
+        return false;
+    }
+    const Entry& e = _entries[idx];
+    out.mode = e.mode;
+    out.macAddress = e.mac;
+    out.loraAddress = e.loraAddress;
+    return true;
+}
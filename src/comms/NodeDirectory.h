@@ -0,0 +1,42 @@
+#pragma once
+#include <Arduino.h>
+#include "comms/CommManager.h"
+
+#define MAX_DIRECTORY_NODES 32
+#define NODE_ID_MAX_LEN 32
+
+/**
+ * @brief Annuaire nodeId -> adresse radio, côté Master.
+ * Alimenté à chaque message reçu, il permet d'adresser une commande
+ * (ex: valveCmd reçue par MQTT) au Follower désigné par son nodeId.
+ * Table pleine : l'entrée la plus ancienne est remplacée.
+ */
+class NodeDirectory {
+public:
+    NodeDirectory();
+
+    void learn(const char* nodeId, const SenderInfo& sender, unsigned long nowMs);
+
+    /**
+     * @brief Adresse du nœud. out.macAddress pointe dans l'annuaire.
+     * @return false si le nœud est inconnu
+     */
+    bool lookup(const char* nodeId, SenderInfo& out) const;
+
+    size_t count() const { return _count; }
+    const char* nodeIdAt(size_t i) const { return i < _count ? _entries[i].nodeId : nullptr; }
+
+private:
+    struct Entry {
+        char nodeId[NODE_ID_MAX_LEN];
+        CommMode mode;
+        uint8_t mac[6];
+        uint16_t loraAddress;
+        unsigned long lastSeenMs;
+    };
+
+    Entry _entries[MAX_DIRECTORY_NODES];
+    size_t _count;
+
+    int find(const char* nodeId) const;
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <Arduino.h>
+
+// Trames binaires de distribution d'images (config ou firmware) Master -> Followers.
+// Le premier octet les distingue des messages JSON (qui commencent par '{').
+#define OTA_FRAME_MAGIC 0xA5
+#define OTA_CHUNK_SIZE 176          // Tient dans une trame LoRa diffusée (195 octets utiles)
+#define OTA_WINDOW 32               // Blocs envoyés entre deux relevés d'état
+#define OTA_STATUS_BITS 64          // Blocs décrits par un STATUS à partir du premier manquant
+#define OTA_MAX_IMAGE_SIZE (1536UL * 1024UL)
+#define OTA_MAX_CHUNKS ((OTA_MAX_IMAGE_SIZE + OTA_CHUNK_SIZE - 1) / OTA_CHUNK_SIZE)
+#define OTA_MAX_CONFIG_SIZE 16384
+
+enum class OtaFrameType : uint8_t {
+    OFFER = 1,   // Annonce de l'image + demande d'état (réponse étalée sur slotMs)
+    CHUNK = 2,   // Un bloc de l'image
+    STATUS = 3,  // Follower -> Master : blocs reçus / manquants
+    ABORT = 4    // Transfert annulé par le Master
+};
+
+enum class OtaKind : uint8_t { CONFIG = 1, FIRMWARE = 2 };
+
+enum class OtaState : uint8_t { IDLE = 0, RECEIVING = 1, COMPLETE = 2, FAILED = 3 };
+
+#pragma pack(push, 1)
+struct OtaHeader {
+    uint8_t magic;
+    uint8_t type;          // OtaFrameType
+    uint32_t transferId;   // CRC de l'image et de sa taille : identique après un redémarrage
+};
+
+struct OtaOffer {
+    OtaHeader h;
+    uint8_t kind;          // OtaKind
+    uint32_t size;
+    uint16_t chunkSize;
+    uint32_t imageCrc;
+    uint16_t slotMs;       // Fenêtre de réponse (chaque Follower tire un délai au hasard)
+};
+
+struct OtaChunk {
+    OtaHeader h;
+    uint16_t index;
+    uint32_t crc;          // CRC32 des données du bloc
+    uint8_t data[OTA_CHUNK_SIZE]; // Le dernier bloc peut être plus court
+};
+
+struct OtaStatus {
+    OtaHeader h;
+    uint32_t nodeHash;     // FNV-1a du nodeId (voir ZoneTable::hashNodeId)
+    uint8_t state;         // OtaState
+    uint16_t received;     // Blocs reçus
+    uint16_t firstMissing; // Premier bloc manquant (= nombre de blocs si complet)
+    uint64_t missing;      // Bit i : bloc firstMissing + i manquant
+};
+#pragma pack(pop)
+
+#define OTA_CHUNK_HEADER_SIZE (sizeof(OtaChunk) - OTA_CHUNK_SIZE)
+
+inline bool isOtaFrame(const uint8_t* data, int len) {
+    return len >= (int)sizeof(OtaHeader) && data[0] == OTA_FRAME_MAGIC;
+}
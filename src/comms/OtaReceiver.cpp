@@ -0,0 +1,358 @@
+#include "OtaReceiver.h"
+#include <SPIFFS.h>
+#include <Preferences.h>
+#include <esp_crc.h>
+#include <esp_ota_ops.h>
+#include "ConfigUpdate.h"
+#include "logic/ZoneTable.h"
+
+#define OTA_SESSION_MAGIC 0x3141544F // "OTA1"
+
+OtaReceiver::OtaReceiver(const Config& config)
+    : _config(config),
+      _nodeHash(0),
+      _partition(nullptr),
+      _head(0),
+      _tail(0),
+      _sinceSave(0),
+      _statusDue(false),
+      _statusAtMs(0),
+      _lastFrameMs(0),
+      _rebootPending(false)
+{
+    memset(&_s, 0, sizeof(_s));
+    memset(_have, 0, sizeof(_have));
+}
+
+void OtaReceiver::begin() {
+    _nodeHash = ZoneTable::hashNodeId(_config.identity.nodeId.c_str());
+
+    Preferences prefs;
+    if (!prefs.begin(OTA_NVS_NS, true)) {
+        return;
+    }
+    if (prefs.getBytesLength("s") == sizeof(Session)) {
+        prefs.getBytes("s", &_s, sizeof(Session));
+    }
+    if (_s.magic != OTA_SESSION_MAGIC || _s.chunks > OTA_MAX_CHUNKS) {
+        memset(&_s, 0, sizeof(_s));
+    } else {
+        prefs.getBytes("b", _have, (_s.chunks + 7) / 8);
+    }
+    prefs.end();
+
+    if (_s.state == (uint8_t)OtaState::RECEIVING) {
+        if (_s.kind == (uint8_t)OtaKind::FIRMWARE) {
+            _partition = esp_ota_get_next_update_partition(nullptr);
+        }
+        // Les blocs reçus après la dernière sauvegarde seront simplement redemandés
+        _s.received = 0;
+        for (uint16_t i = 0; i < _s.chunks; i++) {
+            if (have(i)) _s.received++;
+        }
+        Serial.print("📥 OTA: reprise du transfert 0x");
+        Serial.print(_s.transferId, HEX);
+        Serial.print(" (");
+        Serial.print(_s.received);
+        Serial.print("/");
+        Serial.print(_s.chunks);
+        Serial.println(" blocs).");
+    }
+}
+
+void OtaReceiver::markAppValid() {
+    static bool done = false;
+    if (!done) {
+        done = true;
+        esp_ota_mark_app_valid_cancel_rollback();
+    }
+}
+
+bool OtaReceiver::isActive() const {
+    return _statusDue || _head != _tail ||
+           (_s.state == (uint8_t)OtaState::RECEIVING && millis() - _lastFrameMs < OTA_IDLE_TIMEOUT_MS);
+}
+
+uint32_t OtaReceiver::msUntilNext() const {
+    if (_head != _tail) {
+        return 0;
+    }
+    if (!_statusDue) {
+        return UINT32_MAX;
+    }
+    long wait = (long)(_statusAtMs - millis());
+    return wait > 0 ? (uint32_t)wait : 0;
+}
+
+void OtaReceiver::onFrame(const uint8_t* data, int len) {
+    if (len <= 0 || len > (int)sizeof(OtaChunk)) {
+        return;
+    }
+    uint8_t next = (_head + 1) % QUEUE_LEN;
+    if (next == _tail) {
+        return; // File pleine : le bloc sera redemandé
+    }
+    _queue[_head].len = (uint8_t)len;
+    memcpy(_queue[_head].data, data, len);
+    _head = next;
+}
+
+void OtaReceiver::update(CommManager& comms, bool radioIdle) {
+    while (_tail != _head) {
+        const Slot& slot = _queue[_tail];
+        const OtaHeader* h = (const OtaHeader*)slot.data;
+        switch ((OtaFrameType)h->type) {
+            case OtaFrameType::OFFER:
+                if (slot.len >= sizeof(OtaOffer)) {
+                    handleOffer(*(const OtaOffer*)slot.data);
+                }
+                break;
+            case OtaFrameType::CHUNK:
+                if (slot.len > OTA_CHUNK_HEADER_SIZE) {
+                    handleChunk(*(const OtaChunk*)slot.data, slot.len);
+                }
+                break;
+            case OtaFrameType::ABORT:
+                if (h->transferId == _s.transferId && _s.state == (uint8_t)OtaState::RECEIVING) {
+                    Serial.println("📥 OTA: transfert annulé par le Master.");
+                    _s.state = (uint8_t)OtaState::IDLE;
+                    save();
+                }
+                break;
+            default:
+                break;
+        }
+        _tail = (_tail + 1) % QUEUE_LEN;
+    }
+
+    if (_statusDue && radioIdle && (long)(millis() - _statusAtMs) >= 0) {
+        _statusDue = false;
+        sendStatus(comms);
+        if (_s.state == (uint8_t)OtaState::COMPLETE && _s.kind == (uint8_t)OtaKind::FIRMWARE &&
+            esp_ota_get_boot_partition() != esp_ota_get_running_partition()) {
+            _rebootPending = true; // Nouveau firmware sélectionné, pas encore démarré
+        }
+    }
+}
+
+void OtaReceiver::handleOffer(const OtaOffer& o) {
+    _lastFrameMs = millis();
+    if (_s.magic != OTA_SESSION_MAGIC || o.h.transferId != _s.transferId ||
+        _s.state == (uint8_t)OtaState::IDLE) {
+        openSession(o);
+    }
+    // Réponse étalée : les Followers qui reçoivent la même diffusion ne se percutent pas
+    _statusDue = true;
+    _statusAtMs = millis() + (o.slotMs > 0 ? esp_random() % o.slotMs : 0);
+}
+
+void OtaReceiver::openSession(const OtaOffer& o) {
+    memset(&_s, 0, sizeof(_s));
+    memset(_have, 0, sizeof(_have));
+    _sinceSave = 0;
+    _s.magic = OTA_SESSION_MAGIC;
+    _s.transferId = o.h.transferId;
+    _s.kind = o.kind;
+    _s.size = o.size;
+    _s.imageCrc = o.imageCrc;
+    _s.chunks = (uint16_t)((o.size + OTA_CHUNK_SIZE - 1) / OTA_CHUNK_SIZE);
+
+    if (o.chunkSize != OTA_CHUNK_SIZE || o.size == 0 || o.size > OTA_MAX_IMAGE_SIZE) {
+        fail("taille ou format de bloc non supporté");
+        return;
+    }
+
+    if (o.kind == (uint8_t)OtaKind::FIRMWARE) {
+        _partition = esp_ota_get_next_update_partition(nullptr);
+        if (_partition == nullptr || o.size > _partition->size) {
+            fail("partition OTA absente ou trop petite");
+            return;
+        }
+    } else if (o.kind == (uint8_t)OtaKind::CONFIG) {
+        if (o.size > OTA_MAX_CONFIG_SIZE) {
+            fail("config trop grande");
+            return;
+        }
+        // Fichier pré-alloué : les blocs arrivent dans le désordre
+        File f = SPIFFS.open(OTA_CONFIG_FILE, "w");
+        if (!f) {
+            fail("SPIFFS");
+            return;
+        }
+        uint8_t zeros[64] = {0};
+        for (uint32_t written = 0; written < o.size; written += sizeof(zeros)) {
+            f.write(zeros, min((uint32_t)sizeof(zeros), o.size - written));
+        }
+        f.close();
+    } else {
+        fail("type d'image inconnu");
+        return;
+    }
+
+    _s.state = (uint8_t)OtaState::RECEIVING;
+    save();
+    Serial.print("📥 OTA: réception de ");
+    Serial.print(o.kind == (uint8_t)OtaKind::FIRMWARE ? "firmware" : "config");
+    Serial.print(" (");
+    Serial.print(o.size);
+    Serial.print(" octets, ");
+    Serial.print(_s.chunks);
+    Serial.println(" blocs).");
+}
+
+void OtaReceiver::handleChunk(const OtaChunk& c, int len) {
+    if (_s.state != (uint8_t)OtaState::RECEIVING || c.h.transferId != _s.transferId ||
+        c.index >= _s.chunks) {
+        return;
+    }
+    _lastFrameMs = millis();
+    if (have(c.index)) {
+        return; // Doublon (retransmission demandée par un autre Follower)
+    }
+
+    size_t dataLen = len - OTA_CHUNK_HEADER_SIZE;
+    size_t expected = (c.index == _s.chunks - 1) ? _s.size - (uint32_t)c.index * OTA_CHUNK_SIZE
+                                                 : OTA_CHUNK_SIZE;
+    if (dataLen != expected || esp_crc32_le(0, c.data, dataLen) != c.crc) {
+        return; // Bloc corrompu : il restera manquant et sera redemandé
+    }
+    if (!writeChunk(c.index, c.data, dataLen)) {
+        fail("écriture flash");
+        return;
+    }
+
+    _have[c.index >> 3] |= 1 << (c.index & 7);
+    _s.received++;
+    if (++_sinceSave >= SAVE_EVERY) {
+        save();
+    }
+    if (_s.received == _s.chunks) {
+        finish();
+    }
+}
+
+bool OtaReceiver::writeChunk(uint16_t index, const uint8_t* data, size_t len) {
+    uint32_t offset = (uint32_t)index * OTA_CHUNK_SIZE;
+
+    if (_s.kind == (uint8_t)OtaKind::FIRMWARE) {
+        // Effacement paresseux : chaque secteur l'est juste avant sa première écriture
+        for (uint32_t sector = offset / OTA_SECTOR_SIZE; sector <= (offset + len - 1) / OTA_SECTOR_SIZE; sector++) {
+            if (!(_s.erased[sector >> 3] & (1 << (sector & 7)))) {
+                if (esp_partition_erase_range(_partition, sector * OTA_SECTOR_SIZE, OTA_SECTOR_SIZE) != ESP_OK) {
+                    return false;
+                }
+                _s.erased[sector >> 3] |= 1 << (sector & 7);
+            }
+        }
+        return esp_partition_write(_partition, offset, data, len) == ESP_OK;
+    }
+
+    File f = SPIFFS.open(OTA_CONFIG_FILE, "r+");
+    if (!f) {
+        return false;
+    }
+    bool ok = f.seek(offset) && f.write(data, len) == len;
+    f.close();
+    return ok;
+}
+
+bool OtaReceiver::verifyImage() {
+    uint8_t block[256];
+    uint32_t crc = 0;
+
+    if (_s.kind == (uint8_t)OtaKind::FIRMWARE) {
+        for (uint32_t off = 0; off < _s.size; off += sizeof(block)) {
+            size_t n = min((uint32_t)sizeof(block), _s.size - off);
+            if (esp_partition_read(_partition, off, block, n) != ESP_OK) {
+                return false;
+            }
+            crc = esp_crc32_le(crc, block, n);
+        }
+        return crc == _s.imageCrc;
+    }
+
+    File f = SPIFFS.open(OTA_CONFIG_FILE, "r");
+    if (!f) {
+        return false;
+    }
+    size_t n;
+    while ((n = f.read(block, sizeof(block))) > 0) {
+        crc = esp_crc32_le(crc, block, n);
+    }
+    f.close();
+    return crc == _s.imageCrc;
+}
+
+void OtaReceiver::finish() {
+    if (!verifyImage()) {
+        fail("CRC de l'image");
+        return;
+    }
+
+    if (_s.kind == (uint8_t)OtaKind::FIRMWARE) {
+        // Bascule A/B : l'image est validée par l'IDF avant d'être sélectionnée
+        if (esp_ota_set_boot_partition(_partition) != ESP_OK) {
+            fail("image firmware refusée");
+            return;
+        }
+        Serial.println("✅ OTA: firmware reçu et sélectionné, redémarrage après acquittement.");
+    } else {
+        uint32_t changes = 0;
+        String error;
+        if (!ConfigUpdate::stageFile(OTA_CONFIG_FILE, changes, error)) {
+            fail(error.c_str());
+            return;
+        }
+        Serial.println("✅ OTA: configuration reçue et validée.");
+    }
+
+    _s.state = (uint8_t)OtaState::COMPLETE;
+    save();
+    _statusDue = true; // Le Master est prévenu sans attendre sa prochaine demande
+    _statusAtMs = millis();
+}
+
+void OtaReceiver::fail(const char* reason) {
+    Serial.print("❌ OTA: échec (");
+    Serial.print(reason);
+    Serial.println(").");
+    _s.state = (uint8_t)OtaState::FAILED;
+    save();
+    _statusDue = true;
+    _statusAtMs = millis();
+}
+
+void OtaReceiver::save() {
+    _sinceSave = 0;
+    Preferences prefs;
+    if (!prefs.begin(OTA_NVS_NS, false)) {
+        return;
+    }
+    // Bitmap d'abord : une session sauvegardée ne décrit jamais plus de blocs qu'il n'y en a
+    prefs.putBytes("b", _have, (_s.chunks + 7) / 8);
+    prefs.putBytes("s", &_s, sizeof(Session));
+    prefs.end();
+}
+
+void OtaReceiver::sendStatus(CommManager& comms) {
+    OtaStatus st;
+    st.h.magic = OTA_FRAME_MAGIC;
+    st.h.type = (uint8_t)OtaFrameType::STATUS;
+    st.h.transferId = _s.transferId;
+    st.nodeHash = _nodeHash;
+    st.state = _s.state;
+    st.received = _s.received;
+
+    uint16_t first = 0;
+    while (first < _s.chunks && have(first)) {
+        first++;
+    }
+    st.firstMissing = first;
+    st.missing = 0;
+    for (uint16_t i = 0; i < OTA_STATUS_BITS && first + i < _s.chunks; i++) {
+        if (!have(first + i)) {
+            st.missing |= 1ULL << i;
+        }
+    }
+    comms.sendBytes((const uint8_t*)&st, sizeof(st));
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "ConfigLoader.h"
+#include "comms/CommManager.h"
+#include "comms/OtaProtocol.h"
+
+#define OTA_SECTOR_SIZE 4096
+#define OTA_MAX_SECTORS ((OTA_MAX_IMAGE_SIZE + OTA_SECTOR_SIZE - 1) / OTA_SECTOR_SIZE)
+#define OTA_NVS_NS "ota"
+#define OTA_CONFIG_FILE "/ota.cfg"
+#define OTA_IDLE_TIMEOUT_MS 60000UL // Transfert considéré interrompu après ce silence
+
+/**
+ * @brief Réception d'une image découpée en blocs (Follower).
+ * Les trames arrivent dans le callback radio : elles sont copiées dans une
+ * petite file et écrites en flash depuis la loop. Les blocs reçus sont notés
+ * dans un bitmap sauvegardé en NVS, ce qui permet de reprendre un transfert
+ * interrompu (coupure, redémarrage) là où il s'était arrêté.
+ * Un firmware est écrit dans la partition OTA inactive, qui devient la
+ * partition de démarrage (bascule A/B) une fois le CRC de l'image vérifié.
+ * Une config est validée puis appliquée comme un patch reçu par MQTT.
+ */
+class OtaReceiver {
+public:
+    OtaReceiver(const Config& config);
+
+    /**
+     * @brief Recharge la session en cours depuis la NVS (reprise).
+     */
+    void begin();
+
+    /**
+     * @brief À appeler depuis le callback radio : copie la trame, sans écriture flash.
+     */
+    void onFrame(const uint8_t* data, int len);
+
+    /**
+     * @brief À appeler dans la loop() : écrit les blocs reçus et répond aux demandes d'état.
+     * @param radioIdle false si un envoi applicatif attend encore son acquittement
+     */
+    void update(CommManager& comms, bool radioIdle);
+
+    /**
+     * @brief true pendant un transfert (le Follower ne doit pas dormir).
+     */
+    bool isActive() const;
+
+    /**
+     * @brief Délai avant la prochaine réponse d'état due (UINT32_MAX si aucune).
+     */
+    uint32_t msUntilNext() const;
+
+    /**
+     * @brief Nouveau firmware prêt : redémarrer dès que possible.
+     */
+    bool rebootPending() const { return _rebootPending; }
+
+    /**
+     * @brief Confirme le firmware courant (annule le retour arrière automatique).
+     * À appeler une fois la liaison avec le Master établie.
+     */
+    static void markAppValid();
+
+private:
+    struct Session {
+        uint32_t magic;
+        uint32_t transferId;
+        uint8_t kind;          // OtaKind
+        uint8_t state;         // OtaState
+        uint16_t chunks;
+        uint16_t received;
+        uint32_t size;
+        uint32_t imageCrc;
+        uint8_t erased[(OTA_MAX_SECTORS + 7) / 8]; // Secteurs effacés (firmware)
+    };
+    struct Slot {
+        uint8_t len;
+        uint8_t data[sizeof(OtaChunk)];
+    };
+    static constexpr uint8_t QUEUE_LEN = 8;
+    static constexpr uint16_t SAVE_EVERY = 64; // Blocs entre deux sauvegardes NVS
+
+    const Config& _config;
+    uint32_t _nodeHash;
+    Session _s;
+    uint8_t _have[(OTA_MAX_CHUNKS + 7) / 8];   // Bit i : bloc i reçu
+    const esp_partition_t* _partition;
+
+    // File producteur (callback radio) / consommateur (loop)
+    Slot _queue[QUEUE_LEN];
+    volatile uint8_t _head;
+    volatile uint8_t _tail;
+
+    uint16_t _sinceSave;
+    bool _statusDue;
+    unsigned long _statusAtMs;
+    unsigned long _lastFrameMs;
+    bool _rebootPending;
+
+    bool have(uint16_t i) const { return _have[i >> 3] & (1 << (i & 7)); }
+    void handleOffer(const OtaOffer& o);
+    void handleChunk(const OtaChunk& c, int len);
+    void openSession(const OtaOffer& o);
+    bool writeChunk(uint16_t index, const uint8_t* data, size_t len);
+    bool verifyImage();
+    void finish();
+    void fail(const char* reason);
+    void save();
+    void sendStatus(CommManager& comms);
+};
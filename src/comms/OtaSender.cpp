@@ -0,0 +1,356 @@
+#include "OtaSender.h"
+#include <SPIFFS.h>
+#include <esp_crc.h>
+#include "logic/ZoneTable.h"
+
+OtaSender::OtaSender(CommManager& comms)
+    : _comms(comms),
+      _phase(Phase::IDLE),
+      _kind(OtaKind::CONFIG),
+      _transferId(0),
+      _size(0),
+      _imageCrc(0),
+      _chunks(0),
+      _frontier(0),
+      _numTargets(0),
+      _windowLen(0),
+      _windowPos(0),
+      _phaseAtMs(0),
+      _lastTxMs(0),
+      _slotMs(0),
+      _gapMs(0),
+      _statusHead(0),
+      _statusTail(0)
+{
+}
+
+bool OtaSender::start(OtaKind kind, const char* path, const char* const* nodeIds, uint8_t count) {
+    if (_phase != Phase::IDLE) {
+        Serial.println("❌ OTA: un transfert est déjà en cours.");
+        return false;
+    }
+    if (count == 0) {
+        Serial.println("❌ OTA: aucun Follower visé.");
+        return false;
+    }
+
+    _file = SPIFFS.open(path, "r");
+    if (!_file) {
+        Serial.print("❌ OTA: fichier introuvable: ");
+        Serial.println(path);
+        return false;
+    }
+    _size = _file.size();
+    uint32_t limit = (kind == OtaKind::CONFIG) ? OTA_MAX_CONFIG_SIZE : OTA_MAX_IMAGE_SIZE;
+    if (_size == 0 || _size > limit) {
+        Serial.println("❌ OTA: taille d'image invalide.");
+        _file.close();
+        return false;
+    }
+
+    // CRC de l'image, lu par blocs
+    uint8_t block[256];
+    size_t n;
+    _imageCrc = 0;
+    while ((n = _file.read(block, sizeof(block))) > 0) {
+        _imageCrc = esp_crc32_le(_imageCrc, block, n);
+    }
+    _kind = kind;
+    _transferId = esp_crc32_le(_imageCrc, (const uint8_t*)&_size, sizeof(_size)) ^ (uint32_t)kind;
+    _chunks = (uint16_t)((_size + OTA_CHUNK_SIZE - 1) / OTA_CHUNK_SIZE);
+    _frontier = 0;
+
+    _numTargets = 0;
+    for (uint8_t i = 0; i < count && _numTargets < OTA_MAX_TARGETS; i++) {
+        Target& t = _targets[_numTargets++];
+        strncpy(t.nodeId, nodeIds[i], NODE_ID_MAX_LEN - 1);
+        t.nodeId[NODE_ID_MAX_LEN - 1] = '\0';
+        t.nodeHash = ZoneTable::hashNodeId(t.nodeId);
+        t.state = OtaState::IDLE;
+        t.answered = false;
+        t.silentPolls = 0;
+        t.received = 0;
+        t.firstMissing = 0;
+        t.missing = 0;
+    }
+
+    // Cadence selon la liaison : ESP-NOW encaisse une rafale, LoRa (9600 bauds) non
+    bool lora = _comms.getActiveMode() == CommMode::LORA;
+    _gapMs = lora ? 50 : 4;
+    _slotMs = lora ? 4000 : 300;
+
+    Serial.print("📤 OTA: diffusion de ");
+    Serial.print(path);
+    Serial.print(" (");
+    Serial.print(_size);
+    Serial.print(" octets, ");
+    Serial.print(_chunks);
+    Serial.print(" blocs) vers ");
+    Serial.print(_numTargets);
+    Serial.println(" Follower(s).");
+
+    _phase = Phase::OFFER;
+    _phaseAtMs = millis();
+    sendOffer();
+    return true;
+}
+
+void OtaSender::abort() {
+    if (_phase == Phase::IDLE) {
+        return;
+    }
+    OtaHeader h;
+    h.magic = OTA_FRAME_MAGIC;
+    h.type = (uint8_t)OtaFrameType::ABORT;
+    h.transferId = _transferId;
+    _comms.broadcastBytes((const uint8_t*)&h, sizeof(h));
+    for (uint8_t i = 0; i < _numTargets; i++) {
+        if (_targets[i].state != OtaState::COMPLETE && _targets[i].state != OtaState::FAILED) {
+            finishTarget(_targets[i], OtaState::FAILED);
+        }
+    }
+    stop();
+}
+
+void OtaSender::stop() {
+    _file.close();
+    _phase = Phase::IDLE;
+}
+
+void OtaSender::onFrame(const uint8_t* data, int len) {
+    if (len < (int)sizeof(OtaStatus) || data[1] != (uint8_t)OtaFrameType::STATUS) {
+        return;
+    }
+    uint8_t next = (_statusHead + 1) % STATUS_QUEUE_LEN;
+    if (next == _statusTail) {
+        return; // Le Follower sera relevé de nouveau
+    }
+    memcpy(&_statusQueue[_statusHead], data, sizeof(OtaStatus));
+    _statusHead = next;
+}
+
+void OtaSender::sendOffer() {
+    OtaOffer o;
+    o.h.magic = OTA_FRAME_MAGIC;
+    o.h.type = (uint8_t)OtaFrameType::OFFER;
+    o.h.transferId = _transferId;
+    o.kind = (uint8_t)_kind;
+    o.size = _size;
+    o.chunkSize = OTA_CHUNK_SIZE;
+    o.imageCrc = _imageCrc;
+    o.slotMs = _slotMs;
+    for (uint8_t i = 0; i < _numTargets; i++) {
+        _targets[i].answered = false;
+    }
+    _comms.broadcastBytes((const uint8_t*)&o, sizeof(o));
+    _lastTxMs = millis();
+}
+
+bool OtaSender::sendChunk(uint16_t index) {
+    OtaChunk c;
+    c.h.magic = OTA_FRAME_MAGIC;
+    c.h.type = (uint8_t)OtaFrameType::CHUNK;
+    c.h.transferId = _transferId;
+    c.index = index;
+    uint32_t offset = (uint32_t)index * OTA_CHUNK_SIZE;
+    size_t len = min((uint32_t)OTA_CHUNK_SIZE, _size - offset);
+    if (!_file.seek(offset) || _file.read(c.data, len) != len) {
+        return false;
+    }
+    c.crc = esp_crc32_le(0, c.data, len);
+    _lastTxMs = millis();
+    // Un échec d'émission (file radio pleine) n'est pas fatal : le bloc sera redemandé
+    _comms.broadcastBytes((const uint8_t*)&c, OTA_CHUNK_HEADER_SIZE + len);
+    return true;
+}
+
+void OtaSender::applyStatus(const OtaStatus& st) {
+    if (st.h.transferId != _transferId) {
+        return;
+    }
+    for (uint8_t i = 0; i < _numTargets; i++) {
+        Target& t = _targets[i];
+        if (t.nodeHash != st.nodeHash || t.state == OtaState::COMPLETE || t.state == OtaState::FAILED) {
+            continue;
+        }
+        t.answered = true;
+        t.silentPolls = 0;
+        t.received = st.received;
+        t.firstMissing = st.firstMissing;
+        t.missing = st.missing;
+        t.state = (OtaState)st.state;
+        if (t.state == OtaState::COMPLETE || t.state == OtaState::FAILED) {
+            finishTarget(t, t.state);
+        }
+        return;
+    }
+}
+
+bool OtaSender::needsChunk(const Target& t, uint16_t index) const {
+    if (t.state != OtaState::RECEIVING || index < t.firstMissing) {
+        return false;
+    }
+    uint32_t offset = index - t.firstMissing;
+    if (offset < OTA_STATUS_BITS) {
+        return (t.missing >> offset) & 1;
+    }
+    // Au-delà de l'état rapporté : seuls les blocs jamais émis sont supposés manquants
+    return index >= _frontier;
+}
+
+/**
+ * @param answeredOnly Après une fenêtre, seuls les Followers qui ont répondu au
+ * relevé comptent : l'état d'un Follower muet date d'avant la fenêtre, et le
+ * suivre renverrait toute la fenêtre (ses blocs manquants seront redemandés
+ * à sa prochaine réponse).
+ */
+bool OtaSender::buildWindow(bool answeredOnly) {
+    const Target* serve[OTA_MAX_TARGETS];
+    uint8_t numServe = 0;
+    uint16_t from = _chunks;
+    for (uint8_t i = 0; i < _numTargets; i++) {
+        const Target& t = _targets[i];
+        if (t.state == OtaState::RECEIVING && (t.answered || !answeredOnly)) {
+            serve[numServe++] = &t;
+            from = min(from, t.firstMissing);
+        }
+    }
+
+    _windowLen = 0;
+    _windowPos = 0;
+    for (uint16_t index = from; index < _chunks && _windowLen < OTA_WINDOW; index++) {
+        bool needed = false;
+        for (uint8_t i = 0; i < numServe && !needed; i++) {
+            needed = needsChunk(*serve[i], index);
+        }
+        if (needed) {
+            _window[_windowLen++] = index;
+        }
+    }
+    if (_windowLen > 0 && _window[_windowLen - 1] >= _frontier) {
+        _frontier = _window[_windowLen - 1] + 1;
+    }
+    return _windowLen > 0;
+}
+
+bool OtaSender::allDone() const {
+    for (uint8_t i = 0; i < _numTargets; i++) {
+        if (_targets[i].state != OtaState::COMPLETE && _targets[i].state != OtaState::FAILED) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void OtaSender::finishTarget(Target& t, OtaState state) {
+    t.state = state;
+    Serial.print(state == OtaState::COMPLETE ? "✅ OTA terminée pour " : "❌ OTA abandonnée pour ");
+    Serial.print(t.nodeId);
+    Serial.print(" (");
+    Serial.print(t.received);
+    Serial.print("/");
+    Serial.print(_chunks);
+    Serial.println(" blocs).");
+    if (_onResult) {
+        _onResult(t.nodeId, state, t.received, _chunks);
+    }
+}
+
+uint32_t OtaSender::msUntilNext() const {
+    if (_phase == Phase::IDLE) {
+        return UINT32_MAX;
+    }
+    if (_phase != Phase::SEND) {
+        return 50; // Réponses aux relevés : réveil par événement radio, délais de l'ordre de slotMs
+    }
+    uint32_t elapsed = millis() - _lastTxMs;
+    return elapsed >= _gapMs ? 0 : _gapMs - elapsed;
+}
+
+void OtaSender::update() {
+    while (_statusTail != _statusHead) {
+        applyStatus(_statusQueue[_statusTail]);
+        _statusTail = (_statusTail + 1) % STATUS_QUEUE_LEN;
+    }
+    if (_phase == Phase::IDLE) {
+        return;
+    }
+    if (allDone()) {
+        Serial.println("📤 OTA: transfert terminé.");
+        stop();
+        return;
+    }
+
+    unsigned long now = millis();
+    switch (_phase) {
+        case Phase::OFFER: {
+            // Tous les Followers visés ont répondu, ou délai écoulé : on sert ceux qui ont répondu
+            bool allAnswered = true;
+            bool anyReceiving = false;
+            for (uint8_t i = 0; i < _numTargets; i++) {
+                allAnswered &= _targets[i].state != OtaState::IDLE;
+                anyReceiving |= _targets[i].state == OtaState::RECEIVING;
+            }
+            if (allAnswered || now - _phaseAtMs >= OTA_OFFER_TIMEOUT_MS) {
+                for (uint8_t i = 0; i < _numTargets; i++) {
+                    if (_targets[i].state == OtaState::IDLE) {
+                        finishTarget(_targets[i], OtaState::FAILED);
+                    }
+                }
+                if (!anyReceiving || !buildWindow(false)) {
+                    abort();
+                    return;
+                }
+                _phase = Phase::SEND;
+            } else if (now - _lastTxMs >= (unsigned long)_slotMs + 500) {
+                sendOffer();
+            }
+            break;
+        }
+
+        case Phase::SEND:
+            if (now - _lastTxMs >= _gapMs) {
+                if (!sendChunk(_window[_windowPos])) {
+                    Serial.println("❌ OTA: lecture de l'image impossible.");
+                    abort();
+                    return;
+                }
+                if (++_windowPos >= _windowLen) {
+                    // Fin de fenêtre : relevé d'état
+                    _phase = Phase::POLL;
+                    _phaseAtMs = now;
+                    sendOffer();
+                }
+            }
+            break;
+
+        case Phase::POLL: {
+            bool allAnswered = true;
+            for (uint8_t i = 0; i < _numTargets; i++) {
+                if (_targets[i].state == OtaState::RECEIVING && !_targets[i].answered) {
+                    allAnswered = false;
+                }
+            }
+            if (!allAnswered && now - _phaseAtMs < (unsigned long)_slotMs + 500) {
+                break;
+            }
+            for (uint8_t i = 0; i < _numTargets; i++) {
+                Target& t = _targets[i];
+                if (t.state == OtaState::RECEIVING && !t.answered && ++t.silentPolls >= OTA_MAX_SILENT_POLLS) {
+                    finishTarget(t, OtaState::FAILED); // Reprendra au prochain transfert
+                }
+            }
+            if (buildWindow(true)) {
+                _phase = Phase::SEND;
+            } else {
+                // Rien à renvoyer (aucune réponse, ou vérification en cours côté Follower) : nouveau relevé
+                _phaseAtMs = now;
+                sendOffer();
+            }
+            break;
+        }
+
+        case Phase::IDLE:
+            break;
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <Arduino.h>
+#include <FS.h>
+#include <functional>
+#include "comms/CommManager.h"
+#include "comms/NodeDirectory.h"
+#include "comms/OtaProtocol.h"
+
+#define OTA_MAX_TARGETS 16
+#define OTA_OFFER_TIMEOUT_MS 15000UL // Followers muets après ce délai : transfert abandonné
+#define OTA_MAX_SILENT_POLLS 10       // Relevés consécutifs sans réponse avant d'écarter un Follower
+                                      // (à 5, jusqu'à 1 sur 4 était écarté à 20 % de pertes : test_ota_broadcast)
+
+/**
+ * @brief Diffusion d'une image (config ou firmware) vers un groupe de Followers (Master).
+ * Transfert fenêtré : OTA_WINDOW blocs sont diffusés, puis une OFFER demande
+ * l'état de chaque Follower. La fenêtre suivante reprend les blocs signalés
+ * manquants par au moins un Follower, complétée par des blocs neufs : une
+ * seule diffusion sert tous les nœuds à portée. L'identifiant de transfert
+ * dérive du contenu de l'image, ce qui permet aux Followers de reprendre
+ * après un redémarrage de part ou d'autre.
+ */
+class OtaSender {
+public:
+    // Appelé une fois par Follower, quand son transfert se termine (COMPLETE ou FAILED)
+    using ResultCallback = std::function<void(const char* nodeId, OtaState state, uint16_t received, uint16_t chunks)>;
+
+    OtaSender(CommManager& comms);
+
+    /**
+     * @brief Démarre la diffusion d'un fichier SPIFFS.
+     * @param nodeIds Followers visés (tous doivent répondre à l'offre pour être servis)
+     * @return false si un transfert est déjà en cours ou si le fichier est invalide
+     */
+    bool start(OtaKind kind, const char* path, const char* const* nodeIds, uint8_t count);
+
+    void abort();
+
+    /**
+     * @brief À appeler depuis le callback radio pour les trames OTA (STATUS).
+     */
+    void onFrame(const uint8_t* data, int len);
+
+    /**
+     * @brief À appeler dans la loop() : cadence l'émission des blocs et les relevés d'état.
+     */
+    void update();
+
+    bool isActive() const { return _phase != Phase::IDLE; }
+    uint32_t msUntilNext() const; // Délai avant la prochaine émission (UINT32_MAX au repos)
+    void registerResultCallback(ResultCallback cb) { _onResult = cb; }
+
+private:
+    enum class Phase : uint8_t { IDLE, OFFER, SEND, POLL };
+
+    struct Target {
+        char nodeId[NODE_ID_MAX_LEN];
+        uint32_t nodeHash;
+        OtaState state;
+        bool answered;        // Réponse au dernier relevé
+        uint8_t silentPolls;
+        uint16_t received;
+        uint16_t firstMissing;
+        uint64_t missing;
+    };
+
+    CommManager& _comms;
+    Phase _phase;
+    File _file;
+    OtaKind _kind;
+    uint32_t _transferId;
+    uint32_t _size;
+    uint32_t _imageCrc;
+    uint16_t _chunks;
+    uint16_t _frontier;       // Premier bloc jamais émis
+
+    Target _targets[OTA_MAX_TARGETS];
+    uint8_t _numTargets;
+
+    uint16_t _window[OTA_WINDOW];
+    uint8_t _windowLen;
+    uint8_t _windowPos;
+
+    unsigned long _phaseAtMs;
+    unsigned long _lastTxMs;
+    uint16_t _slotMs;         // Fenêtre de réponse aux relevés
+    uint16_t _gapMs;          // Écart entre deux blocs
+
+    // File des STATUS reçus (callback radio -> loop)
+    static constexpr uint8_t STATUS_QUEUE_LEN = 8;
+    OtaStatus _statusQueue[STATUS_QUEUE_LEN];
+    volatile uint8_t _statusHead;
+    volatile uint8_t _statusTail;
+
+    ResultCallback _onResult;
+
+    void sendOffer();
+    bool sendChunk(uint16_t index); // false si l'image ne peut pas être relue
+    void applyStatus(const OtaStatus& st);
+    bool needsChunk(const Target& t, uint16_t index) const;
+    bool buildWindow(bool answeredOnly);
+    bool allDone() const;
+    void finishTarget(Target& t, OtaState state);
+    void stop();
+};
@@ -0,0 +1,16 @@
+#pragma once
+#include <stdint.h>
+
+enum class CommMode {
+    NONE,
+    ESP_NOW,
+    LORA
+};
+
+struct SenderInfo {
+    CommMode mode;
+    const uint8_t* macAddress;
+    uint16_t loraAddress;     // Adresse 16 bits (lora_node_addr)
+    int64_t rxLocalMs;        // Réception : horloge locale (ClockSync::localMs)...
+    int64_t rxEpochMs;        // ...et heure système (epoch ms), relevées avant la mise en file
+};
@@ -1,4 +1,5 @@
 #include "WifiManager.h"
+#include <sys/time.h>
 
 // Initialisation du pointeur statique
 WifiManager* WifiManager::_instance = nullptr;
@@ -17,7 +18,7 @@ void WifiManager::begin(const ConfigNetwork& netConfig) {
     _isEnabled = _netConfig->enableMqtt;
     
     Serial.print("Connexion au Wi-Fi: ");
-    Serial.println(_netConfig->wifi_ssid);
+    Serial.println(_netConfig->wifi_ssid.c_str());
     WiFi.begin(_netConfig->wifi_ssid.c_str(), 
                _netConfig->wifi_password.c_str());
     
@@ -41,11 +42,20 @@ void WifiManager::begin(const ConfigNetwork& netConfig) {
    if (_isEnabled) {
         _mqttClient.setServer(_netConfig->mqtt_broker.c_str(), _netConfig->mqtt_port);
         _mqttClient.setCallback(mqttCallback_static);
+        // Le tampon par défaut (256) est trop petit pour une trame enveloppée
+        _mqttClient.setBufferSize(MQTT_BUFFER_SIZE);
     } else {
         Serial.println("MQTT est désactivé dans la configuration.");
     }
 }
 
+void WifiManager::end() {
+    if (_mqttClient.connected()) {
+        _mqttClient.disconnect();
+    }
+    WiFi.disconnect();
+}
+
 bool WifiManager::isTimeSynced() {
    
     return time(nullptr) > 1672531200; 
@@ -55,6 +65,12 @@ uint32_t WifiManager::getEpochTime() {
     return time(nullptr);
 }
 
+int64_t WifiManager::getEpochMs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
 void WifiManager::registerCommandCallback(MqttCommandCallback cb) {
     _commandCallback = cb;
 }
@@ -100,7 +116,7 @@ bool WifiManager::connectMqtt() {
         // S'abonne au topic de commandes
         _mqttClient.subscribe(_netConfig->topic_commands_down.c_str());
         Serial.print("Abonné à: ");
-        Serial.println(_netConfig->topic_commands_down);
+        Serial.println(_netConfig->topic_commands_down.c_str());
         return true;
     } else {
         Serial.print("Échec, rc=");
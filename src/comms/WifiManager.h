@@ -2,7 +2,7 @@
 #include <WiFi.h>
 #include <PubSubClient.h>
 #include <functional>
-#include "ConfigLoader.h"
+#include "ConfigLoader.h" // MQTT_BUFFER_SIZE
 
 class WifiManager {
 public:
@@ -16,6 +16,11 @@ public:
      */
     void begin(const ConfigNetwork& netConfig);
 
+    /**
+     * @brief Coupe MQTT et Wi-Fi (avant un begin() avec de nouveaux identifiants)
+     */
+    void end();
+
     /**
      * @brief S'abonne au callback de commande
      */
@@ -38,6 +43,11 @@ public:
      */
     uint32_t getEpochTime();
 
+    /**
+     * @brief Récupère l'heure actuelle en millisecondes (epoch)
+     */
+    int64_t getEpochMs();
+
     bool isMqttConnected();
     bool isEnabled() const;
 
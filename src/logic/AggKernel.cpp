@@ -0,0 +1,96 @@
+#include "AggKernel.h"
+
+#if CONFIG_IDF_TARGET_ESP32S3
+// Noyau PIE (AggKernelS3.S) : n8 blocs de 8 échantillons, v aligné sur 16 octets.
+// lanes reçoit 8 minimums puis 8 maximums par voie ; sum reçoit la somme.
+extern "C" void agg_reduce_s16_pie(const int16_t* v, int n8, int16_t* lanes, int32_t* sum);
+static bool s_useSimd = true;
+#endif
+
+void aggReduceScalar(const int16_t* v, size_t n, AggResult* out) {
+    int16_t mn = v[0];
+    int16_t mx = v[0];
+    int32_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (v[i] < mn) mn = v[i];
+        if (v[i] > mx) mx = v[i];
+        sum += v[i];
+    }
+    out->min = mn;
+    out->max = mx;
+    out->sum = sum;
+}
+
+void aggReduce(const int16_t* v, size_t n, AggResult* out) {
+#if CONFIG_IDF_TARGET_ESP32S3
+    size_t n8 = n / 8;
+    if (s_useSimd && n8 > 0 && ((uintptr_t)v & 0xF) == 0) {
+        alignas(16) int16_t lanes[16];
+        int32_t sum = 0;
+        agg_reduce_s16_pie(v, (int)n8, lanes, &sum);
+
+        int16_t mn = lanes[0];
+        int16_t mx = lanes[8];
+        for (int i = 1; i < 8; i++) {
+            if (lanes[i] < mn) mn = lanes[i];
+            if (lanes[8 + i] > mx) mx = lanes[8 + i];
+        }
+        // Reste (< 8 échantillons) en scalaire
+        for (size_t i = n8 * 8; i < n; i++) {
+            if (v[i] < mn) mn = v[i];
+            if (v[i] > mx) mx = v[i];
+            sum += v[i];
+        }
+        out->min = mn;
+        out->max = mx;
+        out->sum = sum;
+        return;
+    }
+#endif
+    aggReduceScalar(v, n, out);
+}
+
+bool aggSelfTest() {
+#if CONFIG_IDF_TARGET_ESP32S3
+    alignas(16) int16_t data[256];
+    uint32_t seed = 12345;
+    bool ok = true;
+
+    // Plusieurs tailles, dont des restes non multiples de 8
+    static const size_t sizes[] = {8, 13, 64, 201, 256};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]) && ok; s++) {
+        size_t n = sizes[s];
+        for (size_t i = 0; i < n; i++) {
+            seed = seed * 1103515245u + 12345u;
+            data[i] = (int16_t)((seed >> 8) % 20001) - 10000; // -100.00..100.00
+        }
+        AggResult ref, simd;
+        aggReduceScalar(data, n, &ref);
+        aggReduce(data, n, &simd);
+        ok = ref.min == simd.min && ref.max == simd.max && ref.sum == simd.sum;
+    }
+
+    // Cycles CPU sur 256 échantillons, pour chaque chemin
+    AggResult r;
+    uint32_t c0 = ESP.getCycleCount();
+    aggReduceScalar(data, 256, &r);
+    uint32_t c1 = ESP.getCycleCount();
+    aggReduce(data, 256, &r);
+    uint32_t c2 = ESP.getCycleCount();
+
+    Serial.print("Agrégation: auto-test PIE ");
+    Serial.print(ok ? "OK" : "ÉCHEC (chemin scalaire forcé)");
+    Serial.print(", cycles/256 éch. scalaire=");
+    Serial.print(c1 - c0);
+    Serial.print(" PIE=");
+    Serial.println(c2 - c1);
+
+    if (!ok) {
+        s_useSimd = false;
+    }
+    return ok;
+#else
+    Serial.println("Agrégation: chemin scalaire (pas de PIE sur cette cible).");
+    return true;
+#endif
+}
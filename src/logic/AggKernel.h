@@ -0,0 +1,30 @@
+#pragma once
+#include <Arduino.h>
+
+// Résultat d'une réduction sur une fenêtre d'échantillons (centièmes d'unité)
+struct AggResult {
+    int16_t min;
+    int16_t max;
+    int32_t sum;
+};
+
+/**
+ * @brief Réduction min/max/somme d'un tableau int16.
+ * Sur ESP32-S3, utilise les instructions vectorielles PIE (8 voies de 16 bits)
+ * si le tableau est aligné sur 16 octets ; sinon, chemin scalaire portable.
+ * @param v Échantillons (n >= 1)
+ */
+void aggReduce(const int16_t* v, size_t n, AggResult* out);
+
+/**
+ * @brief Version scalaire (référence).
+ */
+void aggReduceScalar(const int16_t* v, size_t n, AggResult* out);
+
+/**
+ * @brief Compare le chemin vectoriel au chemin scalaire sur des données
+ * pseudo-aléatoires et affiche les cycles CPU de chaque chemin.
+ * Le chemin vectoriel est désactivé s'il diverge.
+ * @return true si les deux chemins concordent (ou si seul le scalaire existe).
+ */
+bool aggSelfTest();
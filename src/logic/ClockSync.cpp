@@ -0,0 +1,120 @@
+#include "ClockSync.h"
+#include <esp_private/esp_clk.h>
+#include <sys/time.h>
+
+ClockSync::ClockSync()
+    : _synced(false),
+      _anchorLocal(0),
+      _anchorMaster(0),
+      _refLocal(0),
+      _refMaster(0),
+      _driftPpm(0.0f),
+      _rttMs(0),
+      _minRttMs(MAX_RTT_MS),
+      _driftKnown(false) {}
+
+int64_t ClockSync::localMs() {
+    // Temps RTC calibré (µs) : non remis à zéro par le deep sleep, contrairement à esp_timer
+    return (int64_t)(esp_clk_rtc_time() / 1000);
+}
+
+void ClockSync::exportState(ClockSyncState& out) const {
+    out.synced = _synced;
+    out.anchorLocal = _anchorLocal;
+    out.anchorMaster = _anchorMaster;
+    out.refLocal = _refLocal;
+    out.refMaster = _refMaster;
+    out.driftPpm = _driftPpm;
+    out.rttMs = _rttMs;
+    out.minRttMs = _minRttMs;
+    out.driftKnown = _driftKnown;
+}
+
+void ClockSync::importState(const ClockSyncState& in) {
+    _synced = in.synced;
+    _anchorLocal = in.anchorLocal;
+    _anchorMaster = in.anchorMaster;
+    _refLocal = in.refLocal;
+    _refMaster = in.refMaster;
+    _driftPpm = in.driftPpm;
+    _rttMs = in.rttMs;
+    _minRttMs = in.minRttMs;
+    _driftKnown = in.driftKnown;
+}
+
+int64_t ClockSync::toMasterMs(int64_t local) const {
+    int64_t elapsed = local - _anchorLocal;
+    return _anchorMaster + elapsed + (int64_t)((double)elapsed * _driftPpm / 1e6);
+}
+
+bool ClockSync::addExchange(int64_t t1, int64_t t2, int64_t t3, int64_t t4) {
+    int32_t rtt = (int32_t)((t4 - t1) - (t3 - t2));
+    if (rtt < 0 || rtt > MAX_RTT_MS) {
+        Serial.print("⏰ Échange horaire ignoré (RTT=");
+        Serial.print(rtt);
+        Serial.println(" ms).");
+        return false;
+    }
+    _rttMs = rtt;
+
+    // Trajets peu retardés : l'asymétrie, qui fausse l'offset, est bornée par le RTT
+    bool tight = rtt <= _minRttMs + RTT_MARGIN_MS;
+    if (rtt < _minRttMs) {
+        _minRttMs = rtt;
+    } else if (_minRttMs < MAX_RTT_MS) {
+        _minRttMs++; // Le meilleur RTT peut remonter (trajet radio changé)
+    }
+
+    // Offset NTP classique : ((t2 - t1) + (t3 - t4)) / 2, exprimé ici en
+    // couple (local, master) au moment de la réception t4.
+    int64_t offset = ((t2 - t1) + (t3 - t4)) / 2;
+    addSample(t4, t4 + offset, tight);
+    return true;
+}
+
+void ClockSync::addBeacon(int64_t masterMs, int64_t localRxMs) {
+    // Latence aller estimée à RTT/2 (dernier échange bidirectionnel)
+    addSample(localRxMs, masterMs + _rttMs / 2, false);
+}
+
+void ClockSync::addSample(int64_t local, int64_t master, bool tight) {
+    if (!_synced) {
+        _anchorLocal = _refLocal = local;
+        _anchorMaster = _refMaster = master;
+        _synced = true;
+        return;
+    }
+
+    // Échantillon de référence : l'offset le suit ; sinon, correction partielle
+    int64_t predicted = toMasterMs(local);
+    _anchorLocal = local;
+    _anchorMaster = tight ? master : predicted + ((master - predicted) >> LOOSE_GAIN_SHIFT);
+    if (!tight) {
+        return;
+    }
+
+    // Dérive mesurée depuis une référence fixe : la base s'allonge à chaque
+    // échange, et la mesure pèse d'autant plus qu'elle est longue
+    int64_t span = local - _refLocal;
+    if (span >= MIN_DRIFT_SPAN_MS) {
+        float measured = (float)((double)((master - _refMaster) - span) * 1e6 / (double)span);
+        float gain = (!_driftKnown || span >= DRIFT_FULL_SPAN_MS) ? 1.0f : (float)span / DRIFT_FULL_SPAN_MS;
+        _driftPpm += gain * (measured - _driftPpm);
+        _driftKnown = true;
+        if (span >= DRIFT_FULL_SPAN_MS) {
+            _refLocal = local;
+            _refMaster = master;
+        }
+    }
+}
+
+void ClockSync::applyToSystemClock() const {
+    if (!_synced) {
+        return;
+    }
+    int64_t now = nowMs();
+    struct timeval tv;
+    tv.tv_sec = (time_t)(now / 1000);
+    tv.tv_usec = (suseconds_t)((now % 1000) * 1000);
+    settimeofday(&tv, nullptr);
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <Arduino.h>
+
+// État exportable (conservé en mémoire RTC pendant le deep sleep)
+struct ClockSyncState {
+    bool synced;
+    int64_t anchorLocal;
+    int64_t anchorMaster;
+    int64_t refLocal;
+    int64_t refMaster;
+    float driftPpm;
+    int32_t rttMs;
+    int32_t minRttMs;
+    bool driftKnown;
+};
+
+/**
+ * @brief Estimation de l'heure du Master côté Follower.
+ * Combine les échanges bidirectionnels (offset + RTT) et les beacons diffusés
+ * pour suivre l'offset et la dérive de l'horloge locale (en ppm).
+ * Seuls les échanges proches du meilleur RTT récent (trajets peu retardés,
+ * donc peu asymétriques) servent de point d'ancrage et de référence de dérive ;
+ * les autres échantillons et les beacons, dont la latence n'est pas mesurée,
+ * ne corrigent qu'une fraction de l'écart observé.
+ * L'horloge locale de référence est le compteur RTC, qui continue de compter
+ * pendant le deep sleep : sa dérive est suivie comme celle de l'horloge active,
+ * sans cumuler à chaque réveil le temps de démarrage et l'erreur du minuteur
+ * de réveil.
+ */
+class ClockSync {
+public:
+    ClockSync();
+
+    /**
+     * @brief Horloge locale monotone (ms), conservée pendant le deep sleep.
+     * Indépendante de settimeofday().
+     */
+    static int64_t localMs();
+
+    void exportState(ClockSyncState& out) const;
+    void importState(const ClockSyncState& in);
+
+    /**
+     * @brief Intègre un échange bidirectionnel timeReq/timeResp.
+     * t1/t4 : horloge locale (émission/réception), t2/t3 : heure Master (epoch ms).
+     * @return true si l'échantillon a été retenu (RTT acceptable).
+     */
+    bool addExchange(int64_t t1, int64_t t2, int64_t t3, int64_t t4);
+
+    /**
+     * @brief Intègre un beacon diffusé (heure Master à l'émission).
+     * La latence estimée lors du dernier échange est compensée ; le beacon ne
+     * corrige qu'une fraction de l'écart (latence réelle inconnue).
+     */
+    void addBeacon(int64_t masterMs, int64_t localRxMs);
+
+    bool isSynced() const { return _synced; }
+
+    /**
+     * @brief Heure Master estimée (epoch ms) pour l'heure locale donnée.
+     */
+    int64_t toMasterMs(int64_t local) const;
+    int64_t nowMs() const { return toMasterMs(localMs()); }
+
+    float driftPpm() const { return _driftPpm; }
+    bool driftKnown() const { return _driftKnown; }
+    int32_t lastRttMs() const { return _rttMs; }
+
+    /**
+     * @brief Règle l'horloge système (settimeofday) à la milliseconde.
+     */
+    void applyToSystemClock() const;
+
+private:
+    static constexpr int32_t MAX_RTT_MS = 40;              // Échantillons plus lents ignorés
+    static constexpr int64_t MIN_DRIFT_SPAN_MS = 300000;   // Base minimale pour mesurer la dérive (5 min)
+    static constexpr int64_t DRIFT_FULL_SPAN_MS = 3600000; // Base à partir de laquelle une mesure remplace l'estimation
+    static constexpr int32_t RTT_MARGIN_MS = 4;            // Échange de référence : RTT <= meilleur RTT + marge
+    static constexpr uint8_t LOOSE_GAIN_SHIFT = 2;         // Autres échantillons : 1/4 de l'écart corrigé
+
+    bool _synced;
+    int64_t _anchorLocal;   // Point d'ancrage : heure locale...
+    int64_t _anchorMaster;  // ...et heure Master correspondante
+    int64_t _refLocal;      // Référence de mesure de la dérive
+    int64_t _refMaster;
+    float _driftPpm;
+    int32_t _rttMs;
+    int32_t _minRttMs;      // Meilleur RTT récent, relâché d'1 ms à chaque échange moins bon
+    bool _driftKnown;       // Au moins une mesure de dérive sur MIN_DRIFT_SPAN_MS
+
+    void addSample(int64_t local, int64_t master, bool tight);
+};
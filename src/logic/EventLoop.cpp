@@ -0,0 +1,220 @@
+#include "EventLoop.h"
+#include <esp_timer.h>
+#include "logic/Metrics.h"
+
+EventLoop::Task EventLoop::_tasks[EVENT_LOOP_MAX_TASKS];
+uint8_t EventLoop::_numTasks = 0;
+TaskHandle_t EventLoop::_loopTask = nullptr;
+
+portMUX_TYPE EventLoop::_mux = portMUX_INITIALIZER_UNLOCKED;
+volatile uint32_t EventLoop::_pending = 0;
+volatile int64_t EventLoop::_postedUs[EVT_COUNT];
+
+int64_t EventLoop::_windowStartUs = 0;
+int64_t EventLoop::_idleUs = 0;
+uint64_t EventLoop::_idleTotalUs = 0;
+uint32_t EventLoop::_latencyCount = 0;
+uint64_t EventLoop::_latencySumUs = 0;
+uint32_t EventLoop::_latencyMaxUs = 0;
+
+void EventLoop::begin() {
+    _loopTask = xTaskGetCurrentTaskHandle();
+    _windowStartUs = esp_timer_get_time();
+}
+
+int8_t EventLoop::addTask(const char* name, uint32_t events, uint32_t periodMs, uint32_t budgetUs, Handler handler) {
+    if (_numTasks >= EVENT_LOOP_MAX_TASKS) {
+        Serial.print("❌ Boucle: table des tâches pleine, tâche ignorée: ");
+        Serial.println(name);
+        return -1;
+    }
+    Task& t = _tasks[_numTasks];
+    t.name = name;
+    t.events = events;
+    t.periodMs = periodMs;
+    t.budgetUs = budgetUs;
+    t.handler = handler;
+    t.nextDueMs = millis(); // Première exécution immédiate
+    t.timed = true;
+    t.runs = 0;
+    t.overruns = 0;
+    t.maxRunUs = 0;
+    t.maxLateMs = 0;
+    return (int8_t)_numTasks++;
+}
+
+void EventLoop::wakeIn(int8_t task, uint32_t ms) {
+    if (task < 0 || task >= _numTasks) {
+        return;
+    }
+    Task& t = _tasks[task];
+    uint32_t due = millis() + ms;
+    if (!t.timed || (int32_t)(due - t.nextDueMs) < 0) {
+        t.nextDueMs = due;
+        t.timed = true;
+    }
+}
+
+void IRAM_ATTR EventLoop::stamp(uint32_t events, int64_t nowUs) {
+    // Seul le premier post compte : la latence mesurée est celle du plus ancien
+    for (uint8_t b = 0; b < EVT_COUNT; b++) {
+        uint32_t bit = 1UL << b;
+        if ((events & bit) && !(_pending & bit)) {
+            _postedUs[b] = nowUs;
+        }
+    }
+    _pending |= events;
+}
+
+void EventLoop::post(uint32_t events) {
+    if (_loopTask == nullptr) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&_mux);
+    stamp(events, now);
+    portEXIT_CRITICAL(&_mux);
+    xTaskNotify(_loopTask, events, eSetBits);
+}
+
+void IRAM_ATTR EventLoop::postFromISR(uint32_t events) {
+    if (_loopTask == nullptr) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL_ISR(&_mux);
+    stamp(events, now);
+    portEXIT_CRITICAL_ISR(&_mux);
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(_loopTask, events, eSetBits, &woken);
+    if (woken == pdTRUE) {
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+void EventLoop::runOnce() {
+    // Attente bornée par la prochaine échéance
+    uint32_t now = millis();
+    uint32_t waitMs = EVENT_LOOP_MAX_WAIT_MS;
+    for (uint8_t i = 0; i < _numTasks; i++) {
+        if (!_tasks[i].timed) {
+            continue;
+        }
+        int32_t d = (int32_t)(_tasks[i].nextDueMs - now);
+        if (d <= 0) {
+            waitMs = 0;
+            break;
+        }
+        if ((uint32_t)d < waitMs) {
+            waitMs = d;
+        }
+    }
+
+    uint32_t bits = 0;
+    TickType_t ticks = 0;
+    if (waitMs > 0) {
+        ticks = pdMS_TO_TICKS(waitMs);
+        if (ticks == 0) {
+            ticks = 1;
+        }
+    }
+    int64_t waitStartUs = esp_timer_get_time();
+    xTaskNotifyWait(0, 0xFFFFFFFFUL, &bits, ticks);
+    int64_t wokeUs = esp_timer_get_time();
+    _idleUs += wokeUs - waitStartUs;
+    _idleTotalUs += wokeUs - waitStartUs;
+
+    // Événements à traiter et leurs horodatages
+    int64_t postedUs[EVT_COUNT];
+    portENTER_CRITICAL(&_mux);
+    bits |= _pending;
+    _pending = 0;
+    for (uint8_t b = 0; b < EVT_COUNT; b++) {
+        postedUs[b] = _postedUs[b];
+    }
+    portEXIT_CRITICAL(&_mux);
+
+    now = millis();
+    for (uint8_t i = 0; i < _numTasks; i++) {
+        Task& t = _tasks[i];
+        uint32_t fired = t.events & bits;
+        bool due = t.timed && (int32_t)(now - t.nextDueMs) >= 0;
+        if (fired == 0 && !due) {
+            continue;
+        }
+
+        int64_t startUs = esp_timer_get_time();
+        for (uint8_t b = 0; b < EVT_COUNT; b++) {
+            if (fired & (1UL << b)) {
+                uint32_t latencyUs = (uint32_t)(startUs - postedUs[b]);
+                _latencyCount++;
+                _latencySumUs += latencyUs;
+                if (latencyUs > _latencyMaxUs) {
+                    _latencyMaxUs = latencyUs;
+                }
+                Metrics::observe(MH_EVENT_LATENCY_US, latencyUs);
+            }
+        }
+        if (due && now - t.nextDueMs > t.maxLateMs) {
+            t.maxLateMs = now - t.nextDueMs;
+        }
+
+        // Échéance par défaut, que le handler peut avancer avec wakeIn()
+        t.timed = t.periodMs > 0;
+        t.nextDueMs = now + t.periodMs;
+        t.handler();
+
+        uint32_t runUs = (uint32_t)(esp_timer_get_time() - startUs);
+        t.runs++;
+        if (runUs > t.maxRunUs) {
+            t.maxRunUs = runUs;
+        }
+        if (t.budgetUs > 0 && runUs > t.budgetUs) {
+            t.overruns++;
+        }
+        Metrics::observe(MH_TASK_RUN_US, runUs);
+    }
+
+    int64_t endUs = esp_timer_get_time();
+    if (endUs - _windowStartUs >= (int64_t)EVENT_LOOP_REPORT_MS * 1000) {
+        report(endUs);
+    }
+}
+
+void EventLoop::report(int64_t nowUs) {
+    int64_t windowUs = nowUs - _windowStartUs;
+    Serial.print("⏱️ Boucle: inactive ");
+    Serial.print(100.0 * _idleUs / windowUs, 1);
+    Serial.print(" %, latence événement -> traitement moy. ");
+    Serial.print(_latencyCount > 0 ? (uint32_t)(_latencySumUs / _latencyCount) : 0);
+    Serial.print(" µs, max ");
+    Serial.print(_latencyMaxUs);
+    Serial.print(" µs (");
+    Serial.print(_latencyCount);
+    Serial.println(" événements).");
+
+    for (uint8_t i = 0; i < _numTasks; i++) {
+        Task& t = _tasks[i];
+        Serial.print("   - ");
+        Serial.print(t.name);
+        Serial.print(": ");
+        Serial.print(t.runs);
+        Serial.print(" exécutions, max ");
+        Serial.print(t.maxRunUs);
+        Serial.print(" µs, ");
+        Serial.print(t.overruns);
+        Serial.print(" dépassement(s), retard max ");
+        Serial.print(t.maxLateMs);
+        Serial.println(" ms.");
+        t.runs = 0;
+        t.overruns = 0;
+        t.maxRunUs = 0;
+        t.maxLateMs = 0;
+    }
+
+    _windowStartUs = nowUs;
+    _idleUs = 0;
+    _latencyCount = 0;
+    _latencySumUs = 0;
+    _latencyMaxUs = 0;
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+
+// Événements (bits de notification de la tâche loop)
+#define EVT_RADIO  (1UL << 0)  // Trame reçue ou fin d'envoi (callbacks radio)
+#define EVT_SENSOR (1UL << 1)  // Échantillon dû (esp_timer) ou trame DHT capturée (ISR)
+#define EVT_CONFIG (1UL << 2)  // Configuration prête à être basculée
+#define EVT_COUNT 3
+
+#define EVENT_LOOP_MAX_TASKS 6
+#define EVENT_LOOP_MAX_WAIT_MS 1000   // Attente maximale (réarmement du watchdog)
+#define EVENT_LOOP_REPORT_MS 60000UL  // Période du bilan (inactivité, latences)
+
+/**
+ * @brief Ordonnanceur coopératif de la loop() (exécution jusqu'au bout).
+ * Chaque tâche est réveillée par des événements (bits postés depuis une ISR
+ * ou un callback radio) et/ou par une échéance. Entre deux exécutions, la
+ * tâche loop est bloquée sur sa notification FreeRTOS jusqu'au prochain
+ * événement ou à la prochaine échéance, au lieu de tourner à cadence fixe.
+ * Bilan périodique : part d'inactivité, latence événement -> traitement,
+ * dépassements du budget d'exécution de chaque tâche.
+ */
+class EventLoop {
+public:
+    using Handler = std::function<void()>;
+
+    /**
+     * @brief À appeler depuis setup() : la tâche courante devient la tâche notifiée.
+     */
+    static void begin();
+
+    /**
+     * @brief Enregistre une tâche.
+     * @param events Bits EVT_* qui déclenchent la tâche (0 = échéances seules)
+     * @param periodMs Échéance par défaut après chaque exécution (0 = événements seuls)
+     * @param budgetUs Durée d'exécution au-delà de laquelle un dépassement est compté
+     * @return Identifiant de la tâche, -1 si la table est pleine
+     */
+    static int8_t addTask(const char* name, uint32_t events, uint32_t periodMs, uint32_t budgetUs, Handler handler);
+
+    /**
+     * @brief Avance la prochaine exécution d'une tâche (au plus tard dans ms).
+     * Appelable depuis le handler lui-même pour affiner sa période.
+     */
+    static void wakeIn(int8_t task, uint32_t ms);
+
+    /**
+     * @brief Poste des événements depuis une tâche (callback radio, esp_timer).
+     */
+    static void post(uint32_t events);
+
+    /**
+     * @brief Poste des événements depuis une routine d'interruption.
+     */
+    static void IRAM_ATTR postFromISR(uint32_t events);
+
+    /**
+     * @brief Attend le prochain événement ou la prochaine échéance, puis
+     * exécute les tâches concernées. À appeler dans la loop().
+     */
+    static void runOnce();
+
+    /**
+     * @brief Temps cumulé passé bloqué en attente depuis le démarrage (µs).
+     */
+    static uint64_t idleUs() { return _idleTotalUs; }
+
+private:
+    struct Task {
+        const char* name;
+        uint32_t events;
+        uint32_t periodMs;
+        uint32_t budgetUs;
+        Handler handler;
+        uint32_t nextDueMs;
+        bool timed;           // nextDueMs valide
+        // Statistiques de la période de bilan
+        uint32_t runs;
+        uint32_t overruns;
+        uint32_t maxRunUs;
+        uint32_t maxLateMs;   // Retard sur l'échéance
+    };
+
+    static Task _tasks[EVENT_LOOP_MAX_TASKS];
+    static uint8_t _numTasks;
+    static TaskHandle_t _loopTask;
+
+    // Horodatage du premier post de chaque événement non encore traité
+    static portMUX_TYPE _mux;
+    static volatile uint32_t _pending;
+    static volatile int64_t _postedUs[EVT_COUNT];
+
+    // Bilan
+    static int64_t _windowStartUs;
+    static int64_t _idleUs;
+    static uint64_t _idleTotalUs;
+    static uint32_t _latencyCount;
+    static uint64_t _latencySumUs;
+    static uint32_t _latencyMaxUs;
+
+    static void IRAM_ATTR stamp(uint32_t events, int64_t nowUs);
+    static void report(int64_t nowUs);
+};
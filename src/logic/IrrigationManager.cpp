@@ -1,4 +1,6 @@
 #include "IrrigationManager.h"
+#include "logic/ZoneTable.h"
+#include "logic/ValveScheduler.h"
 
 IrrigationManager::IrrigationManager(const ConfigLogic& logic, Electrovanne* valves[MAX_VALVES])
     : _logic(logic) 
@@ -6,53 +8,175 @@ IrrigationManager::IrrigationManager(const ConfigLogic& logic, Electrovanne* val
     // Copie les pointeurs de vannes
     for (int i = 0; i < MAX_VALVES; i++) {
         _valves[i] = valves[i];
+        _holdUntil[i] = 0;
     }
+    resetZones();
+}
+
+void IrrigationManager::resetZones() {
+    for (int z = 0; z < MAX_ZONES; z++) {
+        for (int p = 0; p < MAX_ZONE_PROBES; p++) {
+            _probeValue[z][p] = NAN;
+            _probeAtMs[z][p] = 0;
+        }
+    }
+}
+
+void IrrigationManager::hold(int valveIndex, uint32_t durationMs) {
+    if (valveIndex < 1 || valveIndex > MAX_VALVES) {
+        return;
+    }
+    // 0 est réservé à "aucune suspension"
+    _holdUntil[valveIndex - 1] = durationMs > 0 ? (millis() + durationMs) | 1 : 0;
+}
+
+bool IrrigationManager::anyValveOpen() const {
+    for (int i = 0; i < MAX_VALVES; i++) {
+        if (_valves[i] != nullptr && _valves[i]->isOpen()) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void IrrigationManager::processSensorData(int sensorIndex, float humidity) {
-    // Vérifie que l'index est valide (1-5)
-    if (sensorIndex < 1 || sensorIndex > MAX_VALVES) {
+    // Correspondance historique : sonde i -> vanne i, seuils globaux
+    regulate(sensorIndex, humidity, _logic.humidity_thresholdMin, _logic.humidity_thresholdMax,
+             _logic.defaultIrrigationDurationMs);
+}
+
+void IrrigationManager::processReading(const char* nodeId, int sensorIndex, float humidity) {
+    if (_logic.zones.count == 0) {
+        processSensorData(sensorIndex, humidity);
+        return;
+    }
+
+    const ZoneRoute* route = ZoneTable::lookup(_logic.zones, nodeId, sensorIndex);
+    if (route == nullptr) {
+        return; // Sonde hors de toute zone
+    }
+    _probeValue[route->zone][route->probe] = humidity;
+    _probeAtMs[route->zone][route->probe] = millis();
+
+    float level;
+    if (!zoneLevel(route->zone, level)) {
+        return;
+    }
+    const ConfigZone& zone = _logic.zones.zones[route->zone];
+    for (uint8_t v = 0; v < zone.num_valves; v++) {
+        regulate(zone.valves[v], level, zone.threshold_min, zone.threshold_max, zone.duration_ms);
+    }
+}
+
+bool IrrigationManager::zoneLevel(uint8_t zone, float& level) const {
+    const ConfigZone& cfg = _logic.zones.zones[zone];
+    unsigned long now = millis();
+
+    float values[MAX_ZONE_PROBES];
+    uint8_t n = 0;
+    for (uint8_t p = 0; p < cfg.num_probes; p++) {
+        if (isnan(_probeValue[zone][p]) || now - _probeAtMs[zone][p] > _logic.zones.stale_ms) {
+            continue;
+        }
+        // Insertion triée (au plus MAX_ZONE_PROBES valeurs)
+        float v = _probeValue[zone][p];
+        int8_t j = n - 1;
+        while (j >= 0 && values[j] > v) {
+            values[j + 1] = values[j];
+            j--;
+        }
+        values[j + 1] = v;
+        n++;
+    }
+    if (n == 0) {
+        return false;
+    }
+
+    switch (cfg.policy) {
+        case ZonePolicy::MEAN: {
+            float sum = 0;
+            for (uint8_t i = 0; i < n; i++) sum += values[i];
+            level = sum / n;
+            break;
+        }
+        case ZonePolicy::MEDIAN:
+            level = (n & 1) ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2.0f;
+            break;
+        default:
+            level = values[0]; // La sonde la plus sèche décide
+            break;
+    }
+    return true;
+}
+
+void IrrigationManager::regulate(int valveIndex, float humidity, float thresholdMin, float thresholdMax,
+                                 uint32_t durationMs) {
+    // Vérifie que l'index est valide
+    if (valveIndex < 1 || valveIndex > MAX_VALVES) {
         return;
     }
     
     // Récupère la bonne vanne (index 1 -> tableau 0)
-    Electrovanne* valve = _valves[sensorIndex - 1];
+    Electrovanne* valve = _valves[valveIndex - 1];
     if (valve == nullptr) {
         return;
     }
 
+    // Commande manuelle en cours : la logique automatique ne touche pas à la vanne
+    unsigned long& holdUntil = _holdUntil[valveIndex - 1];
+    if (holdUntil != 0) {
+        if ((long)(millis() - holdUntil) < 0) {
+            return;
+        }
+        holdUntil = 0;
+    }
+
+    bool queued = _scheduler && _scheduler->isQueued(valveIndex);
+
     // --- CŒUR DE VOTRE LOGIQUE DE SECOURS ---
 
     // 1. Si l'humidité est TROP BASSE (ex: < 40%)
-    if (humidity < _logic.humidity_thresholdMin) {
+    if (humidity < thresholdMin) {
+        if (queued) {
+            // Déjà en attente : la priorité suit le déficit courant
+            _scheduler->request(valveIndex, durationMs, thresholdMin - humidity);
+        }
         // Et que la vanne n'est pas déjà ouverte...
-        if (!valve->isOpen()) {
+        else if (!valve->isOpen()) {
             Serial.print("[LOGIQUE SECOURS] Humidité (");
             Serial.print(humidity, 1);
             Serial.print("%) < min (");
-            Serial.print(_logic.humidity_thresholdMin, 1);
+            Serial.print(thresholdMin, 1);
             Serial.print("%). OUVERTURE vanne #");
-            Serial.println(sensorIndex);
+            Serial.println(valveIndex);
             
-            // Ouvre la vanne pour la durée par défaut
-            valve->open(_logic.defaultIrrigationDurationMs);
+            // Ouvre la vanne pour la durée configurée (priorité = déficit d'humidité)
+            if (_scheduler) {
+                _scheduler->request(valveIndex, durationMs, thresholdMin - humidity);
+            } else {
+                valve->open(durationMs);
+            }
         }
     }
     // 2. Si l'humidité est TROP HAUTE (ex: > 60%)
-    else if (humidity > _logic.humidity_thresholdMax) {
-        // Et que la vanne est ouverte...
-        if (valve->isOpen()) {
+    else if (humidity > thresholdMax) {
+        // Et que la vanne est ouverte (ou en attente)...
+        if (valve->isOpen() || queued) {
             Serial.print("[LOGIQUE SECOURS] Humidité (");
             Serial.print(humidity, 1);
             Serial.print("%) > max (");
-            Serial.print(_logic.humidity_thresholdMax, 1);
+            Serial.print(thresholdMax, 1);
             Serial.print("%). FERMETURE vanne #");
-            Serial.println(sensorIndex);
+            Serial.println(valveIndex);
             
             // Force la fermeture de la vanne
-            valve->close();
+            if (_scheduler) {
+                _scheduler->release(valveIndex);
+            } else {
+                valve->close();
+            }
         }
     }
     // 3. Si l'humidité est dans la plage (entre 40% et 60%)
     // On ne fait rien, on laisse la vanne terminer son cycle si elle est ouverte.
-}
\ No newline at end of file
+}
@@ -5,12 +5,14 @@
 
 #define MAX_VALVES 20 
 
+class ValveScheduler;
+
 class IrrigationManager {
 public:
     /**
      * @brief Constructeur
-     * @param logic La configuration logique (seuils, durée)
-     * @param valves Un tableau de pointeurs vers les 5 objets Electrovanne
+     * @param logic La configuration logique (seuils, durée, zones)
+     * @param valves Un tableau de pointeurs vers les objets Electrovanne
      */
     IrrigationManager(const ConfigLogic& logic, Electrovanne* valves[MAX_VALVES]);
 
@@ -22,7 +24,53 @@ public:
      */
     void processSensorData(int sensorIndex, float humidity);
 
+    /**
+     * @brief Traite une mesure en tenant compte de son nœud d'origine.
+     * La paire (nodeId, sonde) est rattachée à sa zone via la table compilée ;
+     * sans zone configurée, on retombe sur processSensorData().
+     */
+    void processReading(const char* nodeId, int sensorIndex, float humidity);
+
+    /**
+     * @brief Suspend la logique automatique d'une vanne (commande manuelle).
+     * @param valveIndex L'index de la vanne (1 à MAX_VALVES)
+     * @param durationMs Durée de la suspension (0 = reprise immédiate)
+     */
+    void hold(int valveIndex, uint32_t durationMs);
+
+    /**
+     * @brief Fait passer les ouvertures par l'arbitre hydraulique (file de priorité).
+     */
+    void setScheduler(ValveScheduler* scheduler) { _scheduler = scheduler; }
+
+    /**
+     * @brief true si au moins une vanne est ouverte.
+     */
+    bool anyValveOpen() const;
+
+    /**
+     * @brief Oublie les mesures de zone (découpage des zones modifié).
+     */
+    void resetZones();
+
 private:
     const ConfigLogic& _logic;
     Electrovanne* _valves[MAX_VALVES];
-};
\ No newline at end of file
+    unsigned long _holdUntil[MAX_VALVES]; // Fin de la commande manuelle (0 = aucune)
+    ValveScheduler* _scheduler = nullptr;
+
+    // Dernière mesure de chaque sonde de zone
+    float _probeValue[MAX_ZONES][MAX_ZONE_PROBES];
+    unsigned long _probeAtMs[MAX_ZONES][MAX_ZONE_PROBES];
+
+    /**
+     * @brief Hystérésis sur une vanne : ouverture sous min, fermeture au-dessus de max.
+     */
+    void regulate(int valveIndex, float humidity, float thresholdMin, float thresholdMax, uint32_t durationMs);
+
+    /**
+     * @brief Humidité agrégée de la zone (min / moyenne / médiane des sondes récentes).
+     * @return false si aucune sonde récente
+     */
+    bool zoneLevel(uint8_t zone, float& level) const;
+};
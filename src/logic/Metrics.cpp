@@ -0,0 +1,111 @@
+#include "Metrics.h"
+#include <esp_timer.h>
+#include "Log.h"
+#include "logic/EventLoop.h"
+
+static const char* const COUNTER_KEYS[MC_COUNT] = {
+    "rx", "txOk", "txFail", "parseErr", "mqttPub", "mqttDrop"
+};
+static const char* const GAUGE_KEYS[MG_COUNT] = {
+    "heap", "heapMin", "blk", "stkLoop", "stkLog", "idle", "wdtMargin", "logQ", "backlog"
+};
+static const char* const HISTOGRAM_KEYS[MH_COUNT] = { "lat", "run" };
+
+std::atomic<uint32_t> Metrics::_counters[MC_COUNT];
+int32_t Metrics::_gauges[MG_COUNT];
+Metrics::Histogram Metrics::_histograms[MH_COUNT];
+
+uint32_t Metrics::_wdtTimeoutMs = 0;
+uint32_t Metrics::_lastFeedMs = 0;
+uint32_t Metrics::_maxFeedGapMs = 0;
+uint64_t Metrics::_idleAtWindowUs = 0;
+int64_t Metrics::_windowStartUs = 0;
+
+void Metrics::begin(uint32_t watchdogTimeoutMs) {
+    _wdtTimeoutMs = watchdogTimeoutMs;
+    _lastFeedMs = millis();
+    resetWindow();
+}
+
+void Metrics::observe(MetricHistogram h, uint32_t v) {
+    Histogram& hist = _histograms[h];
+    uint8_t b = 0;
+    uint32_t bound = METRICS_FIRST_BOUND;
+    while (b < METRICS_BUCKETS - 1 && v >= bound) {
+        b++;
+        bound <<= METRICS_BOUND_SHIFT;
+    }
+    hist.buckets[b]++;
+    hist.count++;
+    if (v > hist.max) {
+        hist.max = v;
+    }
+}
+
+void Metrics::watchdogFed() {
+    uint32_t now = millis();
+    uint32_t gap = now - _lastFeedMs;
+    if (gap > _maxFeedGapMs) {
+        _maxFeedGapMs = gap;
+    }
+    _lastFeedMs = now;
+}
+
+void Metrics::sample() {
+    _gauges[MG_FREE_HEAP] = ESP.getFreeHeap();
+    _gauges[MG_MIN_FREE_HEAP] = ESP.getMinFreeHeap();
+    _gauges[MG_LARGEST_BLOCK] = ESP.getMaxAllocHeap();
+    _gauges[MG_LOOP_STACK_FREE] = uxTaskGetStackHighWaterMark(nullptr); // Appelé depuis la loop
+    if (Log::taskHandle() != nullptr) {
+        _gauges[MG_LOG_STACK_FREE] = uxTaskGetStackHighWaterMark(Log::taskHandle());
+    }
+    _gauges[MG_LOG_QUEUE] = Log::pending();
+
+    int64_t windowUs = esp_timer_get_time() - _windowStartUs;
+    if (windowUs > 0) {
+        _gauges[MG_LOOP_IDLE_PCT] = (int32_t)((EventLoop::idleUs() - _idleAtWindowUs) * 100 / windowUs);
+    }
+
+    // L'intervalle en cours compte aussi : une boucle bloquée se voit avant le redémarrage
+    uint32_t gap = max(_maxFeedGapMs, (uint32_t)(millis() - _lastFeedMs));
+    _gauges[MG_WDT_MARGIN_MS] = (int32_t)_wdtTimeoutMs - (int32_t)gap;
+}
+
+void Metrics::writeSnapshot(JsonObject out) {
+    out["up"] = millis() / 1000;
+
+    JsonObject c = out["c"].to<JsonObject>();
+    for (uint8_t i = 0; i < MC_COUNT; i++) {
+        c[COUNTER_KEYS[i]] = _counters[i].load(std::memory_order_relaxed);
+    }
+    JsonObject g = out["g"].to<JsonObject>();
+    for (uint8_t i = 0; i < MG_COUNT; i++) {
+        g[GAUGE_KEYS[i]] = _gauges[i];
+    }
+    JsonObject h = out["h"].to<JsonObject>();
+    for (uint8_t i = 0; i < MH_COUNT; i++) {
+        JsonObject hist = h[HISTOGRAM_KEYS[i]].to<JsonObject>();
+        JsonArray b = hist["b"].to<JsonArray>();
+        for (uint8_t k = 0; k < METRICS_BUCKETS; k++) {
+            b.add(_histograms[i].buckets[k]);
+        }
+        hist["max"] = _histograms[i].max;
+    }
+}
+
+void Metrics::writeCompact(JsonArray out) {
+    out.add(_gauges[MG_FREE_HEAP] / 1024);
+    out.add(_gauges[MG_LARGEST_BLOCK] / 1024);
+    out.add(_gauges[MG_LOOP_STACK_FREE]);
+    out.add(_gauges[MG_LOOP_IDLE_PCT]);
+    out.add(_histograms[MH_EVENT_LATENCY_US].max);
+    out.add(_counters[MC_RADIO_TX_FAIL].load(std::memory_order_relaxed));
+    out.add(_gauges[MG_WDT_MARGIN_MS] / 1000);
+}
+
+void Metrics::resetWindow() {
+    memset(_histograms, 0, sizeof(_histograms));
+    _maxFeedGapMs = 0;
+    _idleAtWindowUs = EventLoop::idleUs();
+    _windowStartUs = esp_timer_get_time();
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <atomic>
+
+// Compteurs cumulés depuis le démarrage (le serveur en déduit les débits)
+enum MetricCounter : uint8_t {
+    MC_RADIO_RX,        // Trames reçues
+    MC_RADIO_TX_OK,     // Envois acquittés
+    MC_RADIO_TX_FAIL,   // Envois en échec (pas d'ACK, file pleine)
+    MC_PARSE_ERRORS,    // Messages JSON illisibles
+    MC_MQTT_PUBLISHED,  // Messages publiés (Master)
+    MC_MQTT_DROPPED,    // Messages perdus, file d'attente pleine (Master)
+    MC_COUNT
+};
+
+// Jauges : valeur instantanée, relevée par sample() ou fixée par le nœud
+enum MetricGauge : uint8_t {
+    MG_FREE_HEAP,       // Octets
+    MG_MIN_FREE_HEAP,   // Minimum depuis le démarrage
+    MG_LARGEST_BLOCK,   // Plus grand bloc allouable (fragmentation)
+    MG_LOOP_STACK_FREE, // Marge de pile de la tâche loop (octets jamais utilisés)
+    MG_LOG_STACK_FREE,  // Marge de pile de la tâche de vidage du journal
+    MG_LOOP_IDLE_PCT,   // Part du temps où la boucle est bloquée en attente
+    MG_WDT_MARGIN_MS,   // Délai du watchdog moins le plus long intervalle entre deux réarmements
+    MG_LOG_QUEUE,       // Enregistrements en attente dans l'anneau du journal
+    MG_TX_BACKLOG,      // Messages en attente d'émission (file MQTT / tampon hors ligne)
+    MG_COUNT
+};
+
+// Histogrammes à seaux fixes, remis à zéro à chaque instantané
+enum MetricHistogram : uint8_t {
+    MH_EVENT_LATENCY_US, // Événement posté -> début du traitement
+    MH_TASK_RUN_US,      // Durée d'exécution d'une tâche de la boucle
+    MH_COUNT
+};
+
+// Seaux : < 64 µs, < 256, < 1 ms, < 4 ms, < 16 ms, < 64 ms, < 256 ms, au-delà
+#define METRICS_BUCKETS 8
+#define METRICS_FIRST_BOUND 64UL
+#define METRICS_BOUND_SHIFT 2   // Bornes successives x4
+
+/**
+ * @brief Registre des métriques de santé et de performance.
+ * Les identifiants sont fixés à la compilation : une mise à jour coûte un
+ * accès indexé (incrément atomique pour les compteurs, alimentés aussi
+ * depuis la tâche Wi-Fi). Le Master publie un instantané complet, les
+ * Followers joignent une version condensée à leur télémétrie.
+ */
+class Metrics {
+public:
+    /**
+     * @param watchdogTimeoutMs Délai du watchdog de tâche (calcul de la marge)
+     */
+    static void begin(uint32_t watchdogTimeoutMs);
+
+    static void inc(MetricCounter c, uint32_t n = 1) { _counters[c].fetch_add(n, std::memory_order_relaxed); }
+    static void set(MetricGauge g, int32_t v) { _gauges[g] = v; }
+    static void observe(MetricHistogram h, uint32_t v);
+
+    /**
+     * @brief À appeler à chaque réarmement du watchdog.
+     */
+    static void watchdogFed();
+
+    /**
+     * @brief Relève les jauges système (tas, piles, inactivité, watchdog, journal).
+     */
+    static void sample();
+
+    /**
+     * @brief Instantané complet : {"up","c":{..},"g":{..},"h":{"lat":{"b":[..],"max"},..}}
+     */
+    static void writeSnapshot(JsonObject out);
+
+    /**
+     * @brief Version condensée pour la télémétrie d'un Follower :
+     * [tas ko, plus grand bloc ko, pile loop, inactivité %, latence max µs,
+     *  envois en échec, marge watchdog s]
+     */
+    static void writeCompact(JsonArray out);
+
+    /**
+     * @brief Nouvelle fenêtre : histogrammes, intervalle watchdog et inactivité.
+     */
+    static void resetWindow();
+
+private:
+    struct Histogram {
+        uint32_t buckets[METRICS_BUCKETS];
+        uint32_t count;
+        uint32_t max;
+    };
+
+    static std::atomic<uint32_t> _counters[MC_COUNT];
+    static int32_t _gauges[MG_COUNT];
+    static Histogram _histograms[MH_COUNT];
+
+    static uint32_t _wdtTimeoutMs;
+    static uint32_t _lastFeedMs;
+    static uint32_t _maxFeedGapMs;
+    static uint64_t _idleAtWindowUs;
+    static int64_t _windowStartUs;
+};
@@ -0,0 +1,128 @@
+#include "OfflineStore.h"
+#include <SPIFFS.h>
+
+// Anneau en mémoire RTC, conservé pendant le deep sleep
+RTC_DATA_ATTR static StoredReading s_ring[OFFLINE_RTC_CAPACITY];
+RTC_DATA_ATTR static uint16_t s_ringHead = 0;  // Plus ancien relevé
+RTC_DATA_ATTR static uint16_t s_ringCount = 0;
+RTC_DATA_ATTR static uint32_t s_dropped = 0;
+
+OfflineStore::OfflineStore()
+    : _flashRead(0),
+      _flashCount(0) {}
+
+void OfflineStore::begin(bool coldBoot) {
+    if (coldBoot) {
+        s_ringHead = 0;
+        s_ringCount = 0;
+        s_dropped = 0;
+    }
+
+    // Le fichier survit aux redémarrages : relire la position de lecture
+    File data = SPIFFS.open(OFFLINE_FLASH_FILE, "r");
+    if (data) {
+        _flashCount = data.size() / sizeof(StoredReading);
+        data.close();
+        File idx = SPIFFS.open(OFFLINE_FLASH_INDEX, "r");
+        if (idx) {
+            idx.readBytes((char*)&_flashRead, sizeof(_flashRead));
+            idx.close();
+        }
+        if (_flashRead > _flashCount) {
+            _flashRead = _flashCount;
+        }
+    }
+
+    if (count() > 0) {
+        Serial.print("📦 Tampon hors ligne: ");
+        Serial.print(count());
+        Serial.println(" relevé(s) en attente.");
+    }
+}
+
+uint32_t OfflineStore::count() const {
+    return (_flashCount - _flashRead) + s_ringCount;
+}
+
+uint32_t OfflineStore::dropped() const {
+    return s_dropped;
+}
+
+void OfflineStore::push(const StoredReading& r) {
+    if (s_ringCount == OFFLINE_RTC_CAPACITY) {
+        spillOldestToFlash();
+    }
+    s_ring[(s_ringHead + s_ringCount) % OFFLINE_RTC_CAPACITY] = r;
+    s_ringCount++;
+}
+
+void OfflineStore::spillOldestToFlash() {
+    if (_flashCount >= OFFLINE_FLASH_MAX_RECORDS) {
+        // Flash pleine : le relevé le plus ancien de l'anneau est perdu
+        s_dropped++;
+    } else {
+        File f = SPIFFS.open(OFFLINE_FLASH_FILE, "a");
+        if (f && f.write((const uint8_t*)&s_ring[s_ringHead], sizeof(StoredReading)) == sizeof(StoredReading)) {
+            _flashCount++;
+        } else {
+            s_dropped++;
+        }
+        if (f) f.close();
+    }
+    s_ringHead = (s_ringHead + 1) % OFFLINE_RTC_CAPACITY;
+    s_ringCount--;
+}
+
+uint16_t OfflineStore::peek(StoredReading* out, uint16_t max) {
+    uint16_t n = 0;
+
+    // 1. Les plus anciens sont en flash
+    if (_flashRead < _flashCount) {
+        File f = SPIFFS.open(OFFLINE_FLASH_FILE, "r");
+        if (f && f.seek(_flashRead * sizeof(StoredReading))) {
+            while (n < max && _flashRead + n < _flashCount &&
+                   f.readBytes((char*)&out[n], sizeof(StoredReading)) == sizeof(StoredReading)) {
+                n++;
+            }
+        }
+        if (f) f.close();
+        if (_flashRead + n < _flashCount) {
+            return n; // Ne pas mélanger avec l'anneau tant que la flash n'est pas vidée
+        }
+    }
+
+    // 2. Puis l'anneau RTC
+    for (uint16_t i = 0; n < max && i < s_ringCount; i++) {
+        out[n++] = s_ring[(s_ringHead + i) % OFFLINE_RTC_CAPACITY];
+    }
+    return n;
+}
+
+void OfflineStore::pop(uint16_t n) {
+    uint32_t fromFlash = min((uint32_t)n, _flashCount - _flashRead);
+    if (fromFlash > 0) {
+        _flashRead += fromFlash;
+        if (_flashRead >= _flashCount) {
+            // Fichier entièrement transmis
+            SPIFFS.remove(OFFLINE_FLASH_FILE);
+            SPIFFS.remove(OFFLINE_FLASH_INDEX);
+            _flashRead = 0;
+            _flashCount = 0;
+        } else {
+            saveFlashIndex();
+        }
+        n -= fromFlash;
+    }
+
+    uint16_t fromRing = min(n, s_ringCount);
+    s_ringHead = (s_ringHead + fromRing) % OFFLINE_RTC_CAPACITY;
+    s_ringCount -= fromRing;
+}
+
+void OfflineStore::saveFlashIndex() {
+    File idx = SPIFFS.open(OFFLINE_FLASH_INDEX, "w");
+    if (idx) {
+        idx.write((const uint8_t*)&_flashRead, sizeof(_flashRead));
+        idx.close();
+    }
+}
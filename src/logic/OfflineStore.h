@@ -0,0 +1,54 @@
+#pragma once
+#include <Arduino.h>
+#include "ConfigLoader.h" // MAX_SOIL_SENSORS
+
+#define OFFLINE_RTC_CAPACITY 64        // Relevés conservés en mémoire RTC
+#define OFFLINE_FLASH_MAX_RECORDS 2048 // Débordement borné en flash
+#define OFFLINE_FLASH_FILE "/backlog.bin"
+#define OFFLINE_FLASH_INDEX "/backlog.idx"
+#define OFFLINE_VALUE_ABSENT INT16_MIN
+
+// Relevé compact (centièmes), 16 octets
+struct StoredReading {
+    uint32_t timestamp;                  // Epoch (s), 0 si non synchronisé
+    int16_t humidity[MAX_SOIL_SENSORS];
+    int16_t temp;
+};
+
+/**
+ * @brief Tampon des relevés non transmis côté Follower.
+ * Les relevés sont d'abord gardés en mémoire RTC (survivent au deep sleep) ;
+ * quand elle est pleine, les plus anciens débordent dans un fichier SPIFFS.
+ * La lecture se fait toujours dans l'ordre chronologique (flash puis RTC).
+ */
+class OfflineStore {
+public:
+    OfflineStore();
+
+    /**
+     * @brief Initialise l'état RTC (démarrage à froid) et relit l'index flash.
+     */
+    void begin(bool coldBoot);
+
+    void push(const StoredReading& r);
+
+    /**
+     * @brief Copie jusqu'à max relevés les plus anciens, sans les retirer.
+     */
+    uint16_t peek(StoredReading* out, uint16_t max);
+
+    /**
+     * @brief Retire les n relevés les plus anciens (après acquittement).
+     */
+    void pop(uint16_t n);
+
+    uint32_t count() const;
+    uint32_t dropped() const;
+
+private:
+    uint32_t _flashRead;   // Index du prochain relevé à lire dans le fichier
+    uint32_t _flashCount;  // Nombre total de relevés écrits dans le fichier
+
+    void spillOldestToFlash();
+    void saveFlashIndex();
+};
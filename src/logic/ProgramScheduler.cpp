@@ -0,0 +1,232 @@
+#include "ProgramScheduler.h"
+#include <SPIFFS.h>
+#include <time.h>
+
+ProgramScheduler::ProgramScheduler(Electrovanne* valves[MAX_VALVES])
+    : _numPrograms(0),
+      _lastTickMs(0)
+{
+    for (int i = 0; i < MAX_VALVES; i++) {
+        _valves[i] = valves[i];
+    }
+    resetState();
+}
+
+void ProgramScheduler::resetState() {
+    for (int i = 0; i < MAX_PROGRAMS; i++) {
+        _state[i].running = false;
+        _state[i].step = 0;
+        _state[i].stepStartMs = 0;
+        _state[i].lastRunYday = -1;
+    }
+}
+
+void ProgramScheduler::begin() {
+    File f = SPIFFS.open(PROGRAMS_FILE, "r");
+    if (!f) {
+        Serial.println("Programmes: aucune table enregistrée.");
+        return;
+    }
+
+    uint32_t magic = 0;
+    uint8_t count = 0;
+    bool ok = f.readBytes((char*)&magic, sizeof(magic)) == sizeof(magic) &&
+              magic == FILE_MAGIC &&
+              f.readBytes((char*)&count, 1) == 1 &&
+              count <= MAX_PROGRAMS &&
+              f.readBytes((char*)_programs, count * sizeof(IrrigationProgram)) ==
+                  count * sizeof(IrrigationProgram);
+    f.close();
+
+    if (!ok) {
+        Serial.println("⚠️ Programmes: fichier invalide, table ignorée.");
+        _numPrograms = 0;
+        return;
+    }
+
+    _numPrograms = count;
+    Serial.print("Programmes: ");
+    Serial.print(_numPrograms);
+    Serial.println(" programme(s) chargé(s) depuis la flash.");
+}
+
+bool ProgramScheduler::save() const {
+    File f = SPIFFS.open(PROGRAMS_FILE, "w");
+    if (!f) {
+        return false;
+    }
+    uint32_t magic = FILE_MAGIC;
+    f.write((const uint8_t*)&magic, sizeof(magic));
+    f.write(&_numPrograms, 1);
+    f.write((const uint8_t*)_programs, _numPrograms * sizeof(IrrigationProgram));
+    f.close();
+    return true;
+}
+
+bool ProgramScheduler::loadFromJson(JsonObjectConst doc) {
+    JsonArrayConst list = doc["programs"];
+    if (list.isNull()) {
+        Serial.println("❌ Programmes: champ 'programs' manquant.");
+        return false;
+    }
+
+    // Validation complète dans une table temporaire avant de remplacer l'active
+    IrrigationProgram parsed[MAX_PROGRAMS];
+    uint8_t n = 0;
+
+    for (JsonObjectConst p : list) {
+        if (n >= MAX_PROGRAMS) {
+            Serial.println("❌ Programmes: trop de programmes.");
+            return false;
+        }
+
+        IrrigationProgram& prog = parsed[n];
+        prog.id = p["id"] | (n + 1);
+        prog.weekdays = p["days"] | 0x7F;
+
+        const char* start = p["start"];
+        unsigned hh, mm;
+        if (start == nullptr || sscanf(start, "%u:%u", &hh, &mm) != 2 || hh > 23 || mm > 59) {
+            Serial.println("❌ Programmes: heure 'start' invalide (HH:MM).");
+            return false;
+        }
+        prog.startMinute = hh * 60 + mm;
+
+        prog.numSteps = 0;
+        for (JsonObjectConst s : p["steps"].as<JsonArrayConst>()) {
+            if (prog.numSteps >= MAX_PROGRAM_STEPS) {
+                Serial.println("❌ Programmes: trop d'étapes.");
+                return false;
+            }
+            uint8_t valve = s["valve"] | 0;
+            uint16_t duration = s["duration"] | 0;
+            if (valveFor(valve) == nullptr || duration == 0) {
+                Serial.println("❌ Programmes: étape invalide (vanne inconnue ou durée nulle).");
+                return false;
+            }
+            prog.steps[prog.numSteps].valve = valve;
+            prog.steps[prog.numSteps].durationSec = duration;
+            prog.numSteps++;
+        }
+        if (prog.numSteps == 0) {
+            Serial.println("❌ Programmes: programme sans étape.");
+            return false;
+        }
+        n++;
+    }
+
+    // Arrêter proprement ce qui tourne avant de remplacer la table
+    for (uint8_t i = 0; i < _numPrograms; i++) {
+        if (_state[i].running) {
+            stopStep(i);
+        }
+    }
+    memcpy(_programs, parsed, n * sizeof(IrrigationProgram));
+    _numPrograms = n;
+    resetState();
+
+    if (!save()) {
+        Serial.println("⚠️ Programmes: échec d'écriture en flash (table active en RAM).");
+    }
+
+    Serial.print("✅ Programmes: ");
+    Serial.print(_numPrograms);
+    Serial.println(" programme(s) installé(s).");
+    return true;
+}
+
+Electrovanne* ProgramScheduler::valveFor(uint8_t valveNum) const {
+    if (valveNum < 1 || valveNum > MAX_VALVES) {
+        return nullptr;
+    }
+    return _valves[valveNum - 1];
+}
+
+void ProgramScheduler::startStep(uint8_t p) {
+    const ProgramStep& step = _programs[p].steps[_state[p].step];
+    Electrovanne* valve = valveFor(step.valve);
+    _state[p].stepStartMs = millis();
+    if (valve) {
+        // Le minuteur de la vanne sert de sécurité si la boucle se bloque
+        if (_scheduler) {
+            _scheduler->request(step.valve, (uint32_t)step.durationSec * 1000UL, VALVE_PRIORITY_PROGRAM);
+        } else {
+            valve->open((uint32_t)step.durationSec * 1000UL);
+        }
+    }
+
+    Serial.print("💧 Programme #");
+    Serial.print(_programs[p].id);
+    Serial.print(" étape ");
+    Serial.print(_state[p].step + 1);
+    Serial.print(": vanne ");
+    Serial.print(step.valve);
+    Serial.print(" pour ");
+    Serial.print(step.durationSec);
+    Serial.println(" s");
+}
+
+void ProgramScheduler::stopStep(uint8_t p) {
+    uint8_t valveNum = _programs[p].steps[_state[p].step].valve;
+    if (_scheduler) {
+        _scheduler->release(valveNum);
+    } else if (valveFor(valveNum)) {
+        valveFor(valveNum)->close();
+    }
+}
+
+void ProgramScheduler::update() {
+    unsigned long nowMs = millis();
+    if (nowMs - _lastTickMs < TICK_MS) {
+        return;
+    }
+    _lastTickMs = nowMs;
+
+    time_t now = time(nullptr);
+    bool timeValid = now > 1672531200;
+    struct tm timeinfo;
+    if (timeValid) {
+        localtime_r(&now, &timeinfo);
+    }
+
+    for (uint8_t p = 0; p < _numPrograms; p++) {
+        RunState& st = _state[p];
+        const IrrigationProgram& prog = _programs[p];
+
+        if (st.running) {
+            // Enchaîner les étapes (arithmétique millis() sûre au débordement)
+            const ProgramStep& step = prog.steps[st.step];
+            if (_scheduler && _scheduler->isQueued(step.valve)) {
+                st.stepStartMs = nowMs; // Vanne pas encore ouverte : la durée ne court pas
+                continue;
+            }
+            if (nowMs - st.stepStartMs >= (uint32_t)step.durationSec * 1000UL) {
+                stopStep(p);
+                st.step++;
+                if (st.step < prog.numSteps) {
+                    startStep(p);
+                } else {
+                    st.running = false;
+                    Serial.print("✅ Programme #");
+                    Serial.print(prog.id);
+                    Serial.println(" terminé.");
+                }
+            }
+            continue;
+        }
+
+        // Démarrage : nécessite l'heure locale (RTC entretenue même hors ligne)
+        if (!timeValid) {
+            continue;
+        }
+        int minuteOfDay = timeinfo.tm_hour * 60 + timeinfo.tm_min;
+        if (minuteOfDay == prog.startMinute &&
+            (prog.weekdays & (1 << timeinfo.tm_wday)) &&
+            st.lastRunYday != timeinfo.tm_yday) {
+            st.lastRunYday = timeinfo.tm_yday;
+            st.running = true;
+            st.step = 0;
+            startStep(p);
+        }
+    }
+}
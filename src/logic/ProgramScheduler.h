@@ -0,0 +1,85 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "actuators/Electrovanne.h"
+#include "logic/IrrigationManager.h" // MAX_VALVES
+#include "logic/ValveScheduler.h"
+
+#define MAX_PROGRAMS 16
+#define MAX_PROGRAM_STEPS 8
+#define PROGRAMS_FILE "/programs.bin"
+
+// Une étape : une vanne ouverte pendant une durée, puis l'étape suivante
+struct ProgramStep {
+    uint8_t valve;        // Numéro de vanne (1..MAX_VALVES)
+    uint16_t durationSec;
+};
+
+// Un programme : heure de départ, jours de la semaine, séquence d'étapes
+struct IrrigationProgram {
+    uint8_t id;
+    uint8_t weekdays;     // bit 0 = dimanche ... bit 6 = samedi (tm_wday)
+    uint16_t startMinute; // Minutes depuis minuit (heure locale)
+    uint8_t numSteps;
+    ProgramStep steps[MAX_PROGRAM_STEPS];
+};
+
+/**
+ * @brief Table de programmes d'arrosage exécutée localement par le Master.
+ * La table est reçue en un seul message MQTT, stockée sur SPIFFS et exécutée
+ * même sans connexion au serveur.
+ */
+class ProgramScheduler {
+public:
+    ProgramScheduler(Electrovanne* valves[MAX_VALVES]);
+
+    /**
+     * @brief Charge la table depuis SPIFFS (si présente).
+     */
+    void begin();
+
+    /**
+     * @brief Remplace la table à partir d'un message MQTT et la persiste.
+     * Format: {"type":"programs","programs":[{"id":1,"start":"06:30","days":127,
+     *          "steps":[{"valve":1,"duration":600}, ...]}, ...]}
+     * @return true si la table est valide et enregistrée.
+     */
+    bool loadFromJson(JsonObjectConst doc);
+
+    /**
+     * @brief À appeler dans la loop() : démarre les programmes et enchaîne les étapes.
+     */
+    void update();
+
+    uint8_t count() const { return _numPrograms; }
+
+    /**
+     * @brief Fait passer les étapes par l'arbitre hydraulique.
+     * Une étape en attente ne décompte sa durée qu'à l'ouverture effective.
+     */
+    void setScheduler(ValveScheduler* scheduler) { _scheduler = scheduler; }
+
+private:
+    struct RunState {
+        bool running;
+        uint8_t step;
+        unsigned long stepStartMs;
+        int lastRunYday;      // Jour (tm_yday) du dernier démarrage
+    };
+
+    Electrovanne* _valves[MAX_VALVES];
+    IrrigationProgram _programs[MAX_PROGRAMS];
+    RunState _state[MAX_PROGRAMS];
+    uint8_t _numPrograms;
+    unsigned long _lastTickMs;
+    ValveScheduler* _scheduler = nullptr;
+
+    static constexpr unsigned long TICK_MS = 1000;
+    static constexpr uint32_t FILE_MAGIC = 0x47505249; // "IRPG"
+
+    Electrovanne* valveFor(uint8_t valveNum) const;
+    void startStep(uint8_t p);
+    void stopStep(uint8_t p);
+    bool save() const;
+    void resetState();
+};
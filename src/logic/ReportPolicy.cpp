@@ -0,0 +1,131 @@
+#include "ReportPolicy.h"
+
+#define REPORT_STATE_MAGIC 0x52505431 // "RPT1"
+
+// Référence conservée à travers le deep sleep
+struct ReportPolicyState {
+    uint32_t magic;
+    bool hasReport;
+    bool hasEval;
+    uint32_t lastReportS;
+    uint32_t lastEvalS;
+    float reported[MAX_SOIL_SENSORS]; // Valeurs du dernier envoi acquitté
+    int8_t band[MAX_SOIL_SENSORS];    // Bande de seuils au dernier envoi
+    float prevEval[MAX_SOIL_SENSORS]; // Valeurs de l'évaluation précédente (pente)
+};
+
+RTC_DATA_ATTR static ReportPolicyState s_state;
+
+ReportPolicy::ReportPolicy(const ConfigReporting& cfg) : _cfg(cfg) {
+    reload();
+}
+
+void ReportPolicy::reload() {
+    // Copie triée des seuils (tri par insertion, au plus 4 valeurs)
+    for (uint8_t i = 0; i < _cfg.num_thresholds; i++) {
+        float t = _cfg.thresholds[i];
+        int8_t j = i - 1;
+        while (j >= 0 && _thresholds[j] > t) {
+            _thresholds[j + 1] = _thresholds[j];
+            j--;
+        }
+        _thresholds[j + 1] = t;
+    }
+    // Bandes mémorisées invalides si le nombre de seuils a changé : on repart d'un envoi
+    for (uint8_t i = 0; i < MAX_SOIL_SENSORS; i++) {
+        s_state.band[i] = constrain(s_state.band[i], (int8_t)0, (int8_t)_cfg.num_thresholds);
+    }
+}
+
+void ReportPolicy::begin(bool coldBoot) {
+    if (coldBoot || s_state.magic != REPORT_STATE_MAGIC) {
+        memset(&s_state, 0, sizeof(s_state));
+        s_state.magic = REPORT_STATE_MAGIC;
+    }
+}
+
+int8_t ReportPolicy::bandOf(float value, int8_t current) const {
+    int8_t n = _cfg.num_thresholds;
+    int8_t band = constrain(current, 0, n);
+    while (band < n && value >= _thresholds[band] + _cfg.hysteresis) {
+        band++;
+    }
+    while (band > 0 && value < _thresholds[band - 1] - _cfg.hysteresis) {
+        band--;
+    }
+    return band;
+}
+
+ReportReason ReportPolicy::evaluate(const float* values, uint8_t n, uint32_t nowS) {
+    n = min(n, (uint8_t)MAX_SOIL_SENSORS);
+
+    // Pente depuis l'évaluation précédente (%/min)
+    float maxSlope = 0.0f;
+    if (s_state.hasEval && nowS > s_state.lastEvalS) {
+        float dtMin = (nowS - s_state.lastEvalS) / 60.0f;
+        for (uint8_t i = 0; i < n; i++) {
+            if (!isnan(values[i]) && !isnan(s_state.prevEval[i])) {
+                maxSlope = max(maxSlope, fabsf(values[i] - s_state.prevEval[i]) / dtMin);
+            }
+        }
+    }
+    memcpy(s_state.prevEval, values, n * sizeof(float));
+    s_state.lastEvalS = nowS;
+    s_state.hasEval = true;
+
+    if (!s_state.hasReport) {
+        return ReportReason::HEARTBEAT;
+    }
+
+    uint32_t sinceReportS = nowS - s_state.lastReportS;
+    if (sinceReportS * 1000UL < _cfg.min_interval_ms) {
+        return ReportReason::NONE;
+    }
+
+    bool significant = false;
+    for (uint8_t i = 0; i < n; i++) {
+        if (isnan(values[i])) {
+            continue;
+        }
+        if (bandOf(values[i], s_state.band[i]) != s_state.band[i]) {
+            return ReportReason::THRESHOLD;
+        }
+        if (isnan(s_state.reported[i]) || fabsf(values[i] - s_state.reported[i]) >= _cfg.min_delta) {
+            significant = true;
+        }
+    }
+
+    if (maxSlope >= _cfg.max_slope_per_min) {
+        return ReportReason::SLOPE;
+    }
+    if (significant) {
+        return ReportReason::DELTA;
+    }
+    if (sinceReportS >= _cfg.heartbeat_ms / 1000) {
+        return ReportReason::HEARTBEAT;
+    }
+    return ReportReason::NONE;
+}
+
+void ReportPolicy::markReported(const float* values, uint8_t n, uint32_t nowS) {
+    n = min(n, (uint8_t)MAX_SOIL_SENSORS);
+    for (uint8_t i = 0; i < n; i++) {
+        s_state.reported[i] = values[i];
+        if (!isnan(values[i])) {
+            // Premier envoi : bande calculée depuis zéro
+            s_state.band[i] = bandOf(values[i], s_state.hasReport ? s_state.band[i] : 0);
+        }
+    }
+    s_state.lastReportS = nowS;
+    s_state.hasReport = true;
+}
+
+const char* ReportPolicy::reasonName(ReportReason r) {
+    switch (r) {
+        case ReportReason::THRESHOLD: return "threshold";
+        case ReportReason::SLOPE:     return "slope";
+        case ReportReason::DELTA:     return "delta";
+        case ReportReason::HEARTBEAT: return "heartbeat";
+        default:                      return "none";
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <Arduino.h>
+#include "ConfigLoader.h"
+
+// Motif d'un envoi décidé par la politique
+enum class ReportReason : uint8_t {
+    NONE,       // Rien de significatif : envoi supprimé
+    THRESHOLD,  // Franchissement d'un seuil (urgent)
+    SLOPE,      // Variation plus rapide que la pente maximale (urgent)
+    DELTA,      // Écart significatif depuis le dernier envoi
+    HEARTBEAT   // Silence trop long (ou premier envoi)
+};
+
+/**
+ * @brief Politique d'envoi événementielle du Follower.
+ * Compare les mesures courantes à celles du dernier envoi acquitté : envoi
+ * immédiat sur franchissement de seuil (avec hystérésis) ou pente excessive,
+ * envoi normal sur variation significative, sinon silence jusqu'au heartbeat.
+ * L'état de référence vit en mémoire RTC pour survivre au deep sleep.
+ */
+class ReportPolicy {
+public:
+    ReportPolicy(const ConfigReporting& cfg);
+
+    /**
+     * @brief Réinitialise l'état RTC au démarrage à froid.
+     */
+    void begin(bool coldBoot);
+
+    /**
+     * @brief Relit les seuils après une mise à jour de configuration.
+     */
+    void reload();
+    bool isEnabled() const { return _cfg.event_driven; }
+
+    /**
+     * @brief Évalue les mesures courantes.
+     * @param values Humidités (%), NAN ignorées
+     * @param nowS Horloge en secondes (continue à travers le sommeil)
+     */
+    ReportReason evaluate(const float* values, uint8_t n, uint32_t nowS);
+
+    /**
+     * @brief Enregistre les valeurs effectivement transmises (après ACK).
+     */
+    void markReported(const float* values, uint8_t n, uint32_t nowS);
+
+    static bool isUrgent(ReportReason r) { return r == ReportReason::THRESHOLD || r == ReportReason::SLOPE; }
+    static const char* reasonName(ReportReason r);
+
+private:
+    const ConfigReporting& _cfg;
+    float _thresholds[MAX_REPORT_THRESHOLDS]; // Triés par ordre croissant
+
+    // Bande (nombre de seuils franchis) en partant de la bande courante
+    int8_t bandOf(float value, int8_t current) const;
+};
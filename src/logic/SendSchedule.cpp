@@ -0,0 +1,83 @@
+#include "SendSchedule.h"
+
+SendSchedule::SendSchedule(const ConfigSchedule& schedule)
+    : _s(schedule) {}
+
+void SendSchedule::clear(ConfigSchedule& s) {
+    memset(s.minute_bitmap, 0, sizeof(s.minute_bitmap));
+    s.count = 0;
+}
+
+void SendSchedule::addMinute(ConfigSchedule& s, uint16_t minuteOfDay, uint8_t weekdays) {
+    if (minuteOfDay >= MINUTES_PER_DAY) {
+        return;
+    }
+    uint32_t bit = 1UL << (minuteOfDay & 31);
+    for (uint8_t d = 0; d < 7; d++) {
+        if ((weekdays & (1 << d)) && !(s.minute_bitmap[d][minuteOfDay >> 5] & bit)) {
+            s.minute_bitmap[d][minuteOfDay >> 5] |= bit;
+            s.count++;
+        }
+    }
+}
+
+bool SendSchedule::addInterval(ConfigSchedule& s, uint16_t startMin, uint16_t endMin, uint16_t intervalMin,
+                               uint8_t weekdays) {
+    if (intervalMin == 0 || startMin >= MINUTES_PER_DAY || endMin >= MINUTES_PER_DAY || endMin < startMin) {
+        return false;
+    }
+    for (uint16_t m = startMin; m <= endMin; m += intervalMin) {
+        addMinute(s, m, weekdays);
+    }
+    return true;
+}
+
+bool SendSchedule::isDue(const struct tm& now) const {
+    return test(now.tm_wday, now.tm_hour * 60 + now.tm_min);
+}
+
+int SendSchedule::nextMinute(uint8_t wday, uint16_t fromMinute) const {
+    if (fromMinute >= MINUTES_PER_DAY) {
+        return -1;
+    }
+    const uint32_t* bitmap = _s.minute_bitmap[wday];
+    uint16_t word = fromMinute >> 5;
+    // Masquer les minutes déjà passées dans le premier mot
+    uint32_t bits = bitmap[word] & (0xFFFFFFFFUL << (fromMinute & 31));
+    while (true) {
+        if (bits) {
+            return word * 32 + __builtin_ctz(bits);
+        }
+        if (++word >= SCHEDULE_WORDS) {
+            return -1;
+        }
+        bits = bitmap[word];
+    }
+}
+
+uint32_t SendSchedule::msUntilNext(const struct timeval& now, uint32_t offsetMs) const {
+    if (isEmpty()) {
+        return UINT32_MAX;
+    }
+
+    time_t t = now.tv_sec;
+    struct tm tmNow;
+    localtime_r(&t, &tmNow);
+
+    uint32_t minuteOfDay = tmNow.tm_hour * 60 + tmNow.tm_min;
+    uint32_t msInMinute = tmNow.tm_sec * 1000UL + now.tv_usec / 1000;
+    uint32_t nowMsOfDay = minuteOfDay * 60000UL + msInMinute;
+
+    // Si le créneau de la minute courante n'est pas encore passé, elle compte
+    uint16_t from = (msInMinute < offsetMs) ? minuteOfDay : minuteOfDay + 1;
+
+    for (uint8_t day = 0; day <= 7; day++) {
+        uint8_t wday = (tmNow.tm_wday + day) % 7;
+        int m = nextMinute(wday, day == 0 ? from : 0);
+        if (m >= 0) {
+            uint32_t at = (uint32_t)m * 60000UL + offsetMs;
+            return day * 86400000UL + at - nowMsOfDay;
+        }
+    }
+    return UINT32_MAX;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <Arduino.h>
+#include <time.h>
+#include <sys/time.h>
+#include "ConfigLoader.h"
+
+/**
+ * @brief Moteur de planning d'envoi compilé.
+ * Le planning (liste send_times ou expression intervalle/fenêtre/jours) est
+ * compilé au chargement en un bitmap de 1440 minutes par jour de la semaine
+ * (chaque fenêtre garde ses propres jours).
+ * Le test "est-ce l'heure ?" est en O(1) et le calcul du prochain envoi
+ * parcourt au plus quelques mots de 32 bits par jour.
+ */
+class SendSchedule {
+public:
+    SendSchedule(const ConfigSchedule& schedule);
+
+    // --- Construction (utilisée par le ConfigLoader) ---
+    static void clear(ConfigSchedule& s);
+    /**
+     * @param weekdays Jours concernés : bit 0 = dimanche ... bit 6 = samedi
+     */
+    static void addMinute(ConfigSchedule& s, uint16_t minuteOfDay, uint8_t weekdays = 0x7F);
+    /**
+     * @brief Ajoute un envoi toutes les intervalMin minutes de startMin à endMin inclus,
+     * les jours de weekdays seulement.
+     */
+    static bool addInterval(ConfigSchedule& s, uint16_t startMin, uint16_t endMin, uint16_t intervalMin,
+                            uint8_t weekdays = 0x7F);
+
+    bool isEmpty() const { return _s.count == 0; }
+
+    /**
+     * @brief true si la minute courante est une minute d'envoi.
+     */
+    bool isDue(const struct tm& now) const;
+
+    /**
+     * @brief Délai (ms) jusqu'au prochain envoi, décalé de offsetMs dans la minute
+     * (créneau TDMA). Retourne UINT32_MAX si le planning est vide.
+     */
+    uint32_t msUntilNext(const struct timeval& now, uint32_t offsetMs) const;
+
+private:
+    const ConfigSchedule& _s;
+
+    bool test(uint8_t wday, uint16_t minuteOfDay) const {
+        return (_s.minute_bitmap[wday][minuteOfDay >> 5] >> (minuteOfDay & 31)) & 1;
+    }
+    // Première minute d'envoi >= fromMinute du jour wday, -1 sinon
+    int nextMinute(uint8_t wday, uint16_t fromMinute) const;
+};
@@ -0,0 +1,99 @@
+#include "SlotScheduler.h"
+
+static_assert((MAX_TDMA_NODES & (MAX_TDMA_NODES - 1)) == 0, "MAX_TDMA_NODES doit être une puissance de 2");
+
+SlotScheduler::SlotScheduler(uint32_t windowMs, uint32_t expiryMs)
+    : _windowMs(windowMs),
+      _expiryMs(expiryMs),
+      _count(0) {
+    memset(_nodes, 0, sizeof(_nodes));
+}
+
+void SlotScheduler::makeKey(const SenderInfo& sender, uint8_t key[6]) {
+    memset(key, 0, 6);
+    if (sender.mode == CommMode::ESP_NOW && sender.macAddress != nullptr) {
+        memcpy(key, sender.macAddress, 6);
+    } else {
+        key[4] = (uint8_t)(sender.loraAddress >> 8);
+        key[5] = (uint8_t)(sender.loraAddress & 0xFF);
+    }
+}
+
+int SlotScheduler::find(CommMode mode, const uint8_t key[6]) const {
+    for (size_t i = 0; i < MAX_TDMA_NODES; i++) {
+        if (_nodes[i].used && _nodes[i].mode == mode && memcmp(_nodes[i].key, key, 6) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+int SlotScheduler::registerNode(const SenderInfo& sender, unsigned long nowMs) {
+    uint8_t key[6];
+    makeKey(sender, key);
+
+    int slot = find(sender.mode, key);
+    if (slot >= 0) {
+        _nodes[slot].lastSeenMs = nowMs;
+        return slot;
+    }
+
+    // Nouveau nœud : premier créneau libre, les autres nœuds gardent le leur
+    for (size_t i = 0; i < MAX_TDMA_NODES; i++) {
+        NodeEntry& e = _nodes[i];
+        if (e.used) {
+            continue;
+        }
+        e.used = true;
+        e.mode = sender.mode;
+        memcpy(e.key, key, 6);
+        e.lastSeenMs = nowMs;
+        _count++;
+
+        Serial.print("📅 TDMA: nouveau nœud au créneau ");
+        Serial.print(i);
+        Serial.print(", ");
+        Serial.print(_count);
+        Serial.println(" créneaux occupés.");
+        return (int)i;
+    }
+
+    Serial.println("⚠️ TDMA: table des nœuds pleine, pas de créneau attribué.");
+    return -1;
+}
+
+bool SlotScheduler::expire(unsigned long nowMs) {
+    size_t freed = 0;
+    for (size_t i = 0; i < MAX_TDMA_NODES; i++) {
+        if (_nodes[i].used && nowMs - _nodes[i].lastSeenMs > _expiryMs) {
+            _nodes[i].used = false; // Créneau libéré, réattribuable
+            freed++;
+        }
+    }
+
+    if (freed == 0) {
+        return false;
+    }
+
+    _count -= freed;
+    Serial.print("📅 TDMA: ");
+    Serial.print(freed);
+    Serial.print(" nœud(s) expiré(s), ");
+    Serial.print(_count);
+    Serial.println(" créneaux occupés.");
+    return true;
+}
+
+uint32_t SlotScheduler::slotOffsetMs(int slot) const {
+    if (slot < 0 || slot >= MAX_TDMA_NODES) {
+        return 0;
+    }
+    // Index à bits inversés : les premiers créneaux se répartissent sur toute la fenêtre
+    uint32_t position = 0;
+    for (uint32_t bit = 1, rev = MAX_TDMA_NODES >> 1; bit < MAX_TDMA_NODES; bit <<= 1, rev >>= 1) {
+        if ((uint32_t)slot & bit) {
+            position |= rev;
+        }
+    }
+    return (uint32_t)(((uint64_t)_windowMs * position) / MAX_TDMA_NODES);
+}
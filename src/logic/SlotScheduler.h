@@ -0,0 +1,59 @@
+#pragma once
+#include <Arduino.h>
+#include "comms/SenderInfo.h"
+
+#define MAX_TDMA_NODES 256 // Puissance de 2 (subdivision de la fenêtre)
+
+/**
+ * @brief Planificateur TDMA côté Master.
+ * Attribue à chaque Follower un créneau d'émission dans la fenêtre de reporting,
+ * pour éviter que tous les nœuds émettent dans la même seconde.
+ * Chaque créneau a une position fixe dans la fenêtre, obtenue par subdivision
+ * binaire (index à bits inversés : 0, 1/2, 1/4, 3/4, 1/8...) : un nouveau nœud
+ * occupe le premier créneau libre et un départ libère le sien, sans déplacer les
+ * autres nœuds. Avec n nœuds sur les n premiers créneaux, l'écart entre deux
+ * créneaux occupés reste >= fenêtre / (2n).
+ */
+class SlotScheduler {
+public:
+    /**
+     * @param windowMs Largeur de la fenêtre d'émission (à partir du début de la minute)
+     * @param expiryMs Durée sans message après laquelle un nœud est retiré du plan
+     */
+    SlotScheduler(uint32_t windowMs, uint32_t expiryMs);
+
+    /**
+     * @brief Enregistre un message reçu d'un nœud (ajout si nouveau).
+     * @return L'index du créneau attribué, -1 si la table est pleine.
+     */
+    int registerNode(const SenderInfo& sender, unsigned long nowMs);
+
+    /**
+     * @brief Retire les nœuds silencieux depuis plus de expiryMs.
+     * @return true si des créneaux ont été libérés.
+     */
+    bool expire(unsigned long nowMs);
+
+    /**
+     * @brief Décalage (ms) du créneau dans la fenêtre d'émission (fixe pour un index donné).
+     */
+    uint32_t slotOffsetMs(int slot) const;
+
+    size_t count() const { return _count; }
+
+private:
+    struct NodeEntry {
+        bool used;
+        CommMode mode;
+        uint8_t key[6];           // MAC (ESP-NOW) ou adresse LoRa 16 bits dans key[4..5]
+        unsigned long lastSeenMs;
+    };
+
+    uint32_t _windowMs;
+    uint32_t _expiryMs;
+    NodeEntry _nodes[MAX_TDMA_NODES]; // Indexé par créneau
+    size_t _count;
+
+    static void makeKey(const SenderInfo& sender, uint8_t key[6]);
+    int find(CommMode mode, const uint8_t key[6]) const;
+};
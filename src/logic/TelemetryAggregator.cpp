@@ -0,0 +1,113 @@
+#include "TelemetryAggregator.h"
+#include "logic/AggKernel.h"
+
+static const char* const CHANNEL_KEYS[AGG_CHANNELS] = {
+    "soilHumidity1", "soilHumidity2", "soilHumidity3", "soilHumidity4", "soilHumidity5", "temp"
+};
+
+TelemetryAggregator::TelemetryAggregator(uint32_t periodMs)
+    : _periodMs(periodMs),
+      _windowStartMs(0),
+      _emit(nullptr),
+      _numNodes(0)
+{
+    memset(_counts, 0, sizeof(_counts));
+}
+
+void TelemetryAggregator::registerEmitCallback(EmitCallback cb) {
+    _emit = cb;
+}
+
+int TelemetryAggregator::nodeIndex(const char* nodeId) {
+    for (uint8_t i = 0; i < _numNodes; i++) {
+        if (strncmp(_nodeIds[i], nodeId, AGG_NODE_ID_LEN) == 0) {
+            return i;
+        }
+    }
+    if (_numNodes >= MAX_AGG_NODES) {
+        return -1;
+    }
+    strncpy(_nodeIds[_numNodes], nodeId, AGG_NODE_ID_LEN - 1);
+    _nodeIds[_numNodes][AGG_NODE_ID_LEN - 1] = '\0';
+    return _numNodes++;
+}
+
+void TelemetryAggregator::addSample(const char* nodeId, uint8_t channel, float value) {
+    if (!isEnabled() || nodeId == nullptr || channel >= AGG_CHANNELS || isnan(value)) {
+        return;
+    }
+
+    int node = nodeIndex(nodeId);
+    if (node < 0) {
+        Serial.println("⚠️ Agrégation: trop de nœuds, échantillon ignoré.");
+        return;
+    }
+
+    // Fenêtre pleine avant la fin de la période : on émet ce nœud tout de suite
+    if (_counts[channel][node] >= AGG_WINDOW) {
+        emitNode(node);
+    }
+
+    float scaled = constrain(value * 100.0f, -32768.0f, 32767.0f);
+    _samples[channel][node][_counts[channel][node]++] = (int16_t)lroundf(scaled);
+}
+
+void TelemetryAggregator::emitNode(uint8_t node) {
+    char* json = _json;
+    const size_t size = sizeof(_json);
+    int pos = snprintf(json, size, "{\"type\":\"agg\",\"nodeId\":\"%s\",\"s\":{", _nodeIds[node]);
+    bool first = true;
+
+    for (uint8_t ch = 0; ch < AGG_CHANNELS; ch++) {
+        uint8_t n = _counts[ch][node];
+        if (n == 0) {
+            continue;
+        }
+        const int16_t* row = _samples[ch][node];
+        AggResult r;
+        aggReduce(row, n, &r);
+
+        // [min, max, moyenne, dernière, nombre]
+        int written = snprintf(json + pos, size - pos, "%s\"%s\":[%.2f,%.2f,%.2f,%.2f,%u]",
+                               first ? "" : ",", CHANNEL_KEYS[ch],
+                               r.min / 100.0f, r.max / 100.0f, (r.sum / (float)n) / 100.0f,
+                               row[n - 1] / 100.0f, n);
+        if (written < 0 || pos + written >= (int)size - 3) {
+            Serial.println("⚠️ Agrégation: trame trop grande, canaux restants ignorés.");
+            break;
+        }
+        pos += written;
+        first = false;
+    }
+
+    // Nouvelle fenêtre pour tous les canaux du nœud
+    for (uint8_t ch = 0; ch < AGG_CHANNELS; ch++) {
+        _counts[ch][node] = 0;
+    }
+
+    if (first) {
+        return; // Rien à émettre pour ce nœud
+    }
+    json[pos++] = '}';
+    json[pos++] = '}';
+    json[pos] = '\0';
+
+    if (_emit) {
+        _emit(json, pos);
+    }
+}
+
+void TelemetryAggregator::update() {
+    if (!isEnabled()) {
+        return;
+    }
+    unsigned long now = millis();
+    if (now - _windowStartMs < _periodMs) {
+        return;
+    }
+    _windowStartMs = now;
+
+    for (uint8_t node = 0; node < _numNodes; node++) {
+        emitNode(node);
+    }
+}
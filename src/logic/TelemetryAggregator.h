@@ -0,0 +1,54 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+#include "ConfigLoader.h"
+
+#define MAX_AGG_NODES 32
+#define AGG_WINDOW 64                          // Échantillons max par fenêtre (multiple de 8)
+#define AGG_CHANNELS (MAX_SOIL_SENSORS + 1)    // Humidités + température
+#define AGG_TEMP_CHANNEL MAX_SOIL_SENSORS
+#define AGG_NODE_ID_LEN 32
+
+/**
+ * @brief Étage d'agrégation du Master : min, max, moyenne et dernière valeur
+ * par nœud et par capteur, sur une fenêtre glissante de période configurable.
+ * Les échantillons sont stockés en structure de tableaux (une ligne contiguë
+ * et alignée par canal/nœud) pour la réduction vectorielle (AggKernel).
+ */
+class TelemetryAggregator {
+public:
+    // Appelé pour chaque agrégat prêt (JSON terminé par '\0')
+    using EmitCallback = std::function<void(const char* json, size_t len)>;
+
+    TelemetryAggregator(uint32_t periodMs);
+
+    void registerEmitCallback(EmitCallback cb);
+
+    bool isEnabled() const { return _periodMs > 0; }
+
+    /**
+     * @brief Ajoute un échantillon pour un nœud et un canal.
+     * @param channel 0..MAX_SOIL_SENSORS-1 = humidité, AGG_TEMP_CHANNEL = température
+     */
+    void addSample(const char* nodeId, uint8_t channel, float value);
+
+    /**
+     * @brief À appeler dans la loop() : émet les agrégats en fin de période.
+     */
+    void update();
+
+private:
+    uint32_t _periodMs;
+    unsigned long _windowStartMs;
+    EmitCallback _emit;
+
+    // --- Structure de tableaux ---
+    alignas(16) int16_t _samples[AGG_CHANNELS][MAX_AGG_NODES][AGG_WINDOW]; // centièmes
+    uint8_t _counts[AGG_CHANNELS][MAX_AGG_NODES];
+    char _nodeIds[MAX_AGG_NODES][AGG_NODE_ID_LEN];
+    uint8_t _numNodes;
+    char _json[MQTT_BUFFER_SIZE];    // Agrégat publié en MQTT uniquement (pas de limite radio)
+
+    int nodeIndex(const char* nodeId);
+    void emitNode(uint8_t node);
+};
@@ -0,0 +1,155 @@
+#include "ValveScheduler.h"
+
+ValveScheduler::ValveScheduler(const ConfigHydraulics& cfg, const Config& config, Electrovanne* valves[MAX_VALVES])
+    : _cfg(cfg),
+      _config(config),
+      _activeCount(0),
+      _activeFlow(0.0f),
+      _lastStartMs(0),
+      _started(false)
+{
+    for (int i = 0; i < MAX_VALVES; i++) {
+        _valves[i] = valves[i];
+        _pending[i].queued = false;
+        _active[i] = false;
+        _lastWaitMs[i] = 0;
+    }
+}
+
+float ValveScheduler::flowOf(uint8_t index) const {
+    return index < _config.num_electrovalves ? _config.electrovalves[index].flow : 0.0f;
+}
+
+bool ValveScheduler::fits(uint8_t index) const {
+    if (_cfg.max_concurrent > 0 && _activeCount >= _cfg.max_concurrent) {
+        return false;
+    }
+    // Une vanne plus gourmande que le budget entier peut s'ouvrir seule
+    if (_cfg.flow_budget > 0 && _activeCount > 0 && _activeFlow + flowOf(index) > _cfg.flow_budget) {
+        return false;
+    }
+    return !_started || millis() - _lastStartMs >= _cfg.stagger_ms;
+}
+
+uint8_t ValveScheduler::queuedCount() const {
+    uint8_t n = 0;
+    for (int i = 0; i < MAX_VALVES; i++) {
+        if (_pending[i].queued) n++;
+    }
+    return n;
+}
+
+bool ValveScheduler::request(uint8_t valve, uint32_t durationMs, float priority) {
+    if (valve < 1 || valve > MAX_VALVES || _valves[valve - 1] == nullptr) {
+        return false;
+    }
+    uint8_t index = valve - 1;
+
+    if (_active[index]) {
+        // Déjà ouverte par l'arbitre : simple prolongation
+        _valves[index]->open(durationMs);
+        return true;
+    }
+
+    Pending& p = _pending[index];
+    bool wasQueued = p.queued;
+    if (!wasQueued) {
+        p.requestedAtMs = millis();
+    }
+    p.priority = priority;
+    p.durationMs = durationMs;
+    p.queued = true;
+
+    // Même règle que update() : ouverture immédiate seulement en tête de file
+    reclaim();
+    if (head() == index && fits(index)) {
+        p.queued = false;
+        start(index, durationMs, p.requestedAtMs);
+        return true;
+    }
+
+    if (!wasQueued) {
+        Serial.print("⏳ Vanne #");
+        Serial.print(valve);
+        Serial.print(" en attente (");
+        Serial.print(_activeCount);
+        Serial.print(" ouverte(s), ");
+        Serial.print(_activeFlow, 1);
+        Serial.println(" L/min).");
+    }
+    return true;
+}
+
+void ValveScheduler::release(uint8_t valve) {
+    if (valve < 1 || valve > MAX_VALVES || _valves[valve - 1] == nullptr) {
+        return;
+    }
+    uint8_t index = valve - 1;
+    _pending[index].queued = false;
+    _valves[index]->close();
+    reclaim();
+}
+
+void ValveScheduler::start(uint8_t index, uint32_t durationMs, unsigned long requestedAtMs) {
+    _valves[index]->open(durationMs);
+    _active[index] = true;
+    _activeCount++;
+    _activeFlow += flowOf(index);
+    _lastStartMs = millis();
+    _started = true;
+
+    uint32_t waitMs = _lastStartMs - requestedAtMs;
+    _lastWaitMs[index] = waitMs;
+    if (waitMs > 0) {
+        Serial.print("▶️ Vanne #");
+        Serial.print(index + 1);
+        Serial.print(" ouverte après ");
+        Serial.print(waitMs);
+        Serial.println(" ms d'attente.");
+    }
+    if (_onStart) {
+        _onStart(index + 1, waitMs);
+    }
+}
+
+void ValveScheduler::reclaim() {
+    // Vannes refermées (minuteur, commande, logique) : budget restitué
+    for (int i = 0; i < MAX_VALVES; i++) {
+        if (_active[i] && !_valves[i]->isOpen()) {
+            _active[i] = false;
+            _activeCount--;
+            _activeFlow -= flowOf(i);
+        }
+    }
+    if (_activeCount == 0) {
+        _activeFlow = 0.0f; // Pas de dérive d'arrondi
+    }
+}
+
+int ValveScheduler::head() const {
+    // Plus haute priorité, puis demande la plus ancienne
+    int best = -1;
+    for (int i = 0; i < MAX_VALVES; i++) {
+        if (!_pending[i].queued) {
+            continue;
+        }
+        if (best < 0 || _pending[i].priority > _pending[best].priority ||
+            (_pending[i].priority == _pending[best].priority &&
+             (long)(_pending[i].requestedAtMs - _pending[best].requestedAtMs) < 0)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void ValveScheduler::update() {
+    reclaim();
+
+    // Démarrer la tête de file si elle tient dans les limites, sinon attendre
+    // qu'elle tienne (une par appel : les démarrages sont de toute façon espacés)
+    int first = head();
+    if (first >= 0 && fits(first)) {
+        _pending[first].queued = false;
+        start(first, _pending[first].durationMs, _pending[first].requestedAtMs);
+    }
+}
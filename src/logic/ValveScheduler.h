@@ -0,0 +1,82 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+#include "ConfigLoader.h"
+#include "actuators/Electrovanne.h"
+#include "logic/IrrigationManager.h" // MAX_VALVES
+
+// Priorités des demandes non automatiques (les demandes automatiques
+// utilisent le déficit d'humidité, en %)
+#define VALVE_PRIORITY_MANUAL 1000000.0f
+#define VALVE_PRIORITY_PROGRAM 1000.0f
+
+/**
+ * @brief Arbitre des ouvertures de vannes sous contraintes hydrauliques.
+ * Toutes les ouvertures passent par request() : la vanne s'ouvre tout de suite
+ * si le nombre de vannes ouvertes, le budget de débit et l'écart minimal entre
+ * deux démarrages le permettent, sinon la demande attend dans une file triée
+ * par priorité (déficit d'humidité de la zone), puis par ancienneté.
+ * Politique stricte de tête de file : seule la demande en tête peut démarrer,
+ * même si une demande moins prioritaire tiendrait dans le budget restant
+ * (une grosse vanne prioritaire n'est jamais affamée par de petites).
+ * Au plus MAX_VALVES demandes : l'extraction par parcours linéaire reste la
+ * solution la plus simple.
+ */
+class ValveScheduler {
+public:
+    // Appelé à chaque ouverture effective : numéro de vanne (1..MAX_VALVES), attente subie
+    using StartCallback = std::function<void(uint8_t valve, uint32_t waitMs)>;
+
+    ValveScheduler(const ConfigHydraulics& cfg, const Config& config, Electrovanne* valves[MAX_VALVES]);
+
+    /**
+     * @brief Demande l'ouverture d'une vanne.
+     * Une demande déjà en attente voit sa priorité et sa durée mises à jour.
+     * @return true si la vanne est ouverte ou en attente
+     */
+    bool request(uint8_t valve, uint32_t durationMs, float priority);
+
+    /**
+     * @brief Ferme la vanne, ou retire sa demande de la file.
+     */
+    void release(uint8_t valve);
+
+    /**
+     * @brief À appeler dans la loop() : libère le budget des vannes refermées
+     * et démarre les demandes en attente qui tiennent dans les limites.
+     */
+    void update();
+
+    bool isQueued(uint8_t valve) const { return valve >= 1 && valve <= MAX_VALVES && _pending[valve - 1].queued; }
+    uint8_t queuedCount() const;
+    uint8_t activeCount() const { return _activeCount; }
+    uint32_t lastWaitMs(uint8_t valve) const { return valve >= 1 && valve <= MAX_VALVES ? _lastWaitMs[valve - 1] : 0; }
+
+    void registerStartCallback(StartCallback cb) { _onStart = cb; }
+
+private:
+    struct Pending {
+        bool queued;
+        float priority;
+        uint32_t durationMs;
+        unsigned long requestedAtMs;
+    };
+
+    const ConfigHydraulics& _cfg;
+    const Config& _config;
+    Electrovanne* _valves[MAX_VALVES];
+    Pending _pending[MAX_VALVES];
+    bool _active[MAX_VALVES];       // Ouverte par l'arbitre (compte dans le budget)
+    uint8_t _activeCount;
+    float _activeFlow;
+    unsigned long _lastStartMs;
+    bool _started;                  // Au moins un démarrage (écart minimal)
+    uint32_t _lastWaitMs[MAX_VALVES];
+    StartCallback _onStart;
+
+    float flowOf(uint8_t index) const;
+    bool fits(uint8_t index) const;
+    int head() const;
+    void start(uint8_t index, uint32_t durationMs, unsigned long requestedAtMs);
+    void reclaim();
+};
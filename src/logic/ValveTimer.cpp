@@ -0,0 +1,100 @@
+#include "ValveTimer.h"
+
+ValveTimer::ValveTimer(Clock clock)
+    : _clock(clock),
+      _size(0) {
+    for (int i = 0; i < MAX_VALVE_TIMERS; i++) {
+        _pos[i] = -1;
+    }
+}
+
+void ValveTimer::swap(uint8_t i, uint8_t j) {
+    Entry tmp = _heap[i];
+    _heap[i] = _heap[j];
+    _heap[j] = tmp;
+    _pos[_heap[i].id] = i;
+    _pos[_heap[j].id] = j;
+}
+
+void ValveTimer::siftUp(uint8_t i) {
+    while (i > 0) {
+        uint8_t parent = (i - 1) / 2;
+        if (!before(_heap[i], _heap[parent])) {
+            break;
+        }
+        swap(i, parent);
+        i = parent;
+    }
+}
+
+void ValveTimer::siftDown(uint8_t i) {
+    for (;;) {
+        uint8_t smallest = i;
+        uint8_t l = 2 * i + 1;
+        uint8_t r = l + 1;
+        if (l < _size && before(_heap[l], _heap[smallest])) smallest = l;
+        if (r < _size && before(_heap[r], _heap[smallest])) smallest = r;
+        if (smallest == i) {
+            return;
+        }
+        swap(i, smallest);
+        i = smallest;
+    }
+}
+
+void ValveTimer::removeAt(uint8_t i) {
+    _pos[_heap[i].id] = -1;
+    _size--;
+    if (i == _size) {
+        return;
+    }
+    _heap[i] = _heap[_size];
+    _pos[_heap[i].id] = i;
+    siftDown(i);
+    siftUp(i);
+}
+
+bool ValveTimer::schedule(uint8_t id, uint32_t durationMs, ExpiryFn fn, void* ctx) {
+    if (id >= MAX_VALVE_TIMERS || fn == nullptr) {
+        return false;
+    }
+    cancel(id);
+
+    Entry& e = _heap[_size];
+    e.startMs = _clock();
+    e.durationMs = min(durationMs, (uint32_t)INT32_MAX);
+    e.id = id;
+    e.fn = fn;
+    e.ctx = ctx;
+    _pos[id] = _size;
+    _size++;
+    siftUp(_size - 1);
+    return true;
+}
+
+void ValveTimer::cancel(uint8_t id) {
+    if (isArmed(id)) {
+        removeAt(_pos[id]);
+    }
+}
+
+uint8_t ValveTimer::poll() {
+    uint8_t fired = 0;
+    uint32_t now = _clock();
+    // Échéance atteinte : temps écoulé depuis le début >= durée (sans débordement)
+    while (_size > 0 && now - _heap[0].startMs >= _heap[0].durationMs) {
+        Entry e = _heap[0];
+        removeAt(0);
+        e.fn(e.ctx); // Peut réarmer un minuteur
+        fired++;
+    }
+    return fired;
+}
+
+uint32_t ValveTimer::msUntilNext() const {
+    if (_size == 0) {
+        return UINT32_MAX;
+    }
+    uint32_t elapsed = _clock() - _heap[0].startMs;
+    return elapsed >= _heap[0].durationMs ? 0 : _heap[0].durationMs - elapsed;
+}
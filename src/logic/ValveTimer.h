@@ -0,0 +1,65 @@
+#pragma once
+#include <Arduino.h>
+
+#define MAX_VALVE_TIMERS 20
+
+/**
+ * @brief Échéancier central des fermetures de vannes (tas binaire min).
+ * Chaque échéance est mémorisée sous forme (début, durée) et comparée par
+ * différence non signée : le passage à zéro de millis() (49,7 jours) est
+ * sans effet. La boucle ne consulte que la tête du tas, en O(1).
+ * L'horloge est injectable (horloge virtuelle pour les essais hors cible).
+ */
+class ValveTimer {
+public:
+    using Clock = uint32_t (*)();
+    using ExpiryFn = void (*)(void* ctx);
+
+    explicit ValveTimer(Clock clock = millisClock);
+
+    /**
+     * @brief Arme (ou réarme) le minuteur id pour durationMs.
+     * Durée bornée à 2^31-1 ms pour garder des comparaisons sans ambiguïté.
+     */
+    bool schedule(uint8_t id, uint32_t durationMs, ExpiryFn fn, void* ctx);
+    void cancel(uint8_t id);
+    bool isArmed(uint8_t id) const { return id < MAX_VALVE_TIMERS && _pos[id] >= 0; }
+
+    /**
+     * @brief Déclenche les échéances atteintes.
+     * @return Nombre de minuteurs expirés
+     */
+    uint8_t poll();
+
+    /**
+     * @brief Délai avant la prochaine échéance (UINT32_MAX si aucune).
+     */
+    uint32_t msUntilNext() const;
+
+    uint32_t now() const { return _clock(); }
+
+    static uint32_t millisClock() { return millis(); }
+
+private:
+    struct Entry {
+        uint32_t startMs;
+        uint32_t durationMs;
+        uint8_t id;
+        ExpiryFn fn;
+        void* ctx;
+    };
+
+    Clock _clock;
+    Entry _heap[MAX_VALVE_TIMERS];
+    uint8_t _size;
+    int8_t _pos[MAX_VALVE_TIMERS]; // Position de chaque id dans le tas (-1 = libre)
+
+    // Ordre des échéances, valide tant qu'elles sont à moins de 2^31 ms l'une de l'autre
+    static bool before(const Entry& a, const Entry& b) {
+        return (int32_t)((a.startMs + a.durationMs) - (b.startMs + b.durationMs)) < 0;
+    }
+    void swap(uint8_t i, uint8_t j);
+    void siftUp(uint8_t i);
+    void siftDown(uint8_t i);
+    void removeAt(uint8_t i);
+};
@@ -0,0 +1,67 @@
+#include "ZoneTable.h"
+
+void ZoneTable::clear(ConfigZones& z) {
+    z.count = 0;
+    memset(z.routes, 0, sizeof(z.routes));
+}
+
+uint32_t ZoneTable::hashNodeId(const char* nodeId) {
+    // FNV-1a 32 bits
+    uint32_t h = 2166136261u;
+    while (*nodeId) {
+        h ^= (uint8_t)*nodeId++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+ZonePolicy ZoneTable::parsePolicy(const char* name) {
+    if (strcmp(name, "mean") == 0) return ZonePolicy::MEAN;
+    if (strcmp(name, "median") == 0) return ZonePolicy::MEDIAN;
+    return ZonePolicy::MIN;
+}
+
+bool ZoneTable::addProbe(ConfigZones& z, const char* nodeId, uint8_t sensor, uint8_t zone, uint8_t probe) {
+    if (sensor == 0 || sensor > MAX_SOIL_SENSORS) {
+        return false;
+    }
+    uint32_t h = hashNodeId(nodeId);
+    uint16_t slot = slotOf(h, sensor);
+
+    // Sondage linéaire jusqu'à un emplacement libre
+    for (uint16_t n = 0; n < ZONE_ROUTE_SLOTS; n++) {
+        ZoneRoute& r = z.routes[slot];
+        if (r.sensor == 0) {
+            r.node_hash = h;
+            r.sensor = sensor;
+            r.zone = zone;
+            r.probe = probe;
+            return true;
+        }
+        if (r.node_hash == h && r.sensor == sensor) {
+            return false; // Une sonde n'appartient qu'à une seule zone
+        }
+        slot = (slot + 1) & (ZONE_ROUTE_SLOTS - 1);
+    }
+    return false;
+}
+
+const ZoneRoute* ZoneTable::lookup(const ConfigZones& z, const char* nodeId, uint8_t sensor) {
+    if (z.count == 0 || nodeId == nullptr) {
+        return nullptr;
+    }
+    uint32_t h = hashNodeId(nodeId);
+    uint16_t slot = slotOf(h, sensor);
+
+    for (uint16_t n = 0; n < ZONE_ROUTE_SLOTS; n++) {
+        const ZoneRoute& r = z.routes[slot];
+        if (r.sensor == 0) {
+            return nullptr;
+        }
+        if (r.node_hash == h && r.sensor == sensor) {
+            return &r;
+        }
+        slot = (slot + 1) & (ZONE_ROUTE_SLOTS - 1);
+    }
+    return nullptr;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <Arduino.h>
+#include "ConfigLoader.h"
+
+/**
+ * @brief Table de dispatch des zones d'irrigation.
+ * Les paires (nodeId, sonde) de la configuration sont compilées au chargement
+ * dans une table de hachage à adressage ouvert : chaque mesure reçue est
+ * rattachée à sa zone en O(1), sans comparaison de chaînes.
+ */
+class ZoneTable {
+public:
+    static void clear(ConfigZones& z);
+
+    /**
+     * @brief Rattache la sonde sensor du nœud nodeId à la sonde probe de la zone.
+     * @return false si la table est pleine ou la paire déjà utilisée
+     */
+    static bool addProbe(ConfigZones& z, const char* nodeId, uint8_t sensor, uint8_t zone, uint8_t probe);
+
+    /**
+     * @return L'entrée de la paire (nodeId, sensor), nullptr si elle n'appartient à aucune zone.
+     */
+    static const ZoneRoute* lookup(const ConfigZones& z, const char* nodeId, uint8_t sensor);
+
+    static uint32_t hashNodeId(const char* nodeId);
+    static ZonePolicy parsePolicy(const char* name);
+
+private:
+    static uint16_t slotOf(uint32_t nodeHash, uint8_t sensor) {
+        return (uint16_t)((nodeHash * 31u + sensor) & (ZONE_ROUTE_SLOTS - 1));
+    }
+};
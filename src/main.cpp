@@ -1,50 +1,94 @@
 #include <Arduino.h>
 #include <SPIFFS.h>       // Requis pour le système de fichiers
 #include "ConfigLoader.h" // Requis pour charger la config
+#include "ConfigUpdate.h"  // Mise à jour à chaud
+#include "logic/EventLoop.h"
+#include "Log.h"
+#include "logic/Metrics.h"
+#include "BootTrace.h"
 #include "node/Master.h"
 #include "node/Follower.h"
 #include <esp_task_wdt.h>
 
+#define WDT_TIMEOUT_S 20
+
+// Démarrage de production (build_flags = -DFAST_BOOT=1) : ni attente du moniteur
+// série, ni formatage si le montage échoue ; l'inventaire SPIFFS et le DHT sont
+// repoussés après le premier envoi (tâche "deferred")
+#ifndef FAST_BOOT
+#define FAST_BOOT 0
+#endif
+#define DEFERRED_BOOT_POLL_MS 50
+#define DEFERRED_BOOT_MAX_MS 5000 // Lancés quand même si rien n'est parti d'ici là
+
 // ... (vos pointeurs globaux) ...
 Config g_config;
 Master* g_master = nullptr;
 Follower* g_follower = nullptr;
 
+static void listSpiffs() {
+    File root = SPIFFS.open("/");
+    File file = root.openNextFile();
+    if (!file) {
+        Serial.println("ERREUR: Le système de fichiers SPIFFS est COMPLÈTEMENT VIDE.");
+    }
+    while(file){
+        Serial.print("Fichier trouvé: ");
+        Serial.println(file.name());
+        file = root.openNextFile();
+    }
+}
+
+#if FAST_BOOT
+static int8_t s_deferredTask = -1;
+
+// Trace de démarrage jointe au premier message sortant : le premier envoi est parti
+static void runDeferredBoot() {
+    if (BootTrace::unsent() && millis() < DEFERRED_BOOT_MAX_MS) {
+        EventLoop::wakeIn(s_deferredTask, DEFERRED_BOOT_POLL_MS);
+        return;
+    }
+    if (g_follower) {
+        g_follower->beginDeferred();
+    }
+    listSpiffs();
+}
+#endif
 
 void setup() {
     Serial.begin(115200);
-    delay(2000); 
+    Log::begin(); // Vidage différé du journal (tools/logdecode.py côté hôte)
+#if !FAST_BOOT
+    delay(2000); // Laisse le temps d'ouvrir le moniteur série
+#endif
     Serial.println("Démarrage du nœud...");
 
 
     Serial.println("Initialisation du Watchdog (10s timeout)...");
-    esp_task_wdt_init(20, true); // Timeout de 20s, "panic" (redémarrage) si déclenché
+    esp_task_wdt_init(WDT_TIMEOUT_S, true); // Timeout de 20s, "panic" (redémarrage) si déclenché
     esp_task_wdt_add(NULL);
+    Metrics::begin(WDT_TIMEOUT_S * 1000UL);
 
     // 3. Initialiser le système de fichiers
-    if (!SPIFFS.begin(true)) {
+    // En production, un formatage effacerait config.json : le nœud ne démarrerait pas davantage
+    if (!SPIFFS.begin(!FAST_BOOT)) {
         Serial.println("Échec montage SPIFFS. Blocage.");
         while(1) delay(100);
     }
 
-    
-   
-    File root = SPIFFS.open("/");
-    File file = root.openNextFile();
-    if (!file) {
-        Serial.println("ERREUR: Le système de fichiers SPIFFS est COMPLÈTEMENT VIDE.");
-    }
-    while(file){
-        Serial.print("Fichier trouvé: ");
-        file = root.openNextFile();
-    }
- 
+#if !FAST_BOOT
+    listSpiffs();
+#endif
+    BootTrace::mark("fs");
 
     // 4. Charger la config
     if (!loadConfig(g_config)) {
         Serial.println("Échec chargement config. Blocage.");
         while(1) delay(100); 
     }
+    BootTrace::mark("config");
+    ConfigUpdate::begin(&g_config);
+    EventLoop::begin(); // Les nœuds y enregistrent leurs tâches
     
 
     if (g_config.identity.isMaster) {
@@ -56,20 +100,21 @@ void setup() {
         g_follower = new Follower(g_config);
         g_follower->begin();
     }
+#if FAST_BOOT
+    s_deferredTask = EventLoop::addTask("deferred", 0, 0, 0, runDeferredBoot);
+#else
+    if (g_follower) {
+        g_follower->beginDeferred();
+    }
+#endif
     
+    BootTrace::finish();
     Serial.println("Initialisation terminée. Démarrage de la boucle.");
 }
 
 void loop() {
     esp_task_wdt_reset();
-    if (g_master) {
-        g_master->update();
-    } else if (g_follower) {
-        g_follower->update();
-    }
-    
-    if(g_master) g_master->getCommManager()->update(); 
-    if(g_follower) g_follower->getCommManager()->update(); 
-    delay(10);
-    
+    Metrics::watchdogFed();
+    // Bloque jusqu'au prochain événement (radio, capteur, config) ou à la prochaine échéance
+    EventLoop::runOnce();
 }
\ No newline at end of file
@@ -2,13 +2,51 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <time.h> // Nécessaire pour localtime() et time()
+#include <sys/time.h>
+#include <esp_sleep.h>
+#include <esp_wifi.h>
+
+#define RTC_STATE_MAGIC 0x464F4C31 // "FOL1"
+RTC_DATA_ATTR static FollowerRtcState s_rtc;
+
+// Clés pré-calculées (pas de String par envoi)
+static const char* const SOIL_KEYS[MAX_SOIL_SENSORS] = {
+    "soilHumidity1", "soilHumidity2", "soilHumidity3", "soilHumidity4", "soilHumidity5"
+};
+static const char* const SUMMARY_KEYS[MAX_SOIL_SENSORS] = { "h1", "h2", "h3", "h4", "h5" };
+
+// Ramène la télémétrie sous la taille radio en sacrifiant, dans l'ordre : la rafale
+// brute, les pentes des résumés, puis les résumés des dernières sondes
+static bool fitTelemetry(JsonDocument& doc, uint8_t numChannels) {
+    if (measureJson(doc) > MAX_PAYLOAD_SIZE) {
+        doc.remove("raw");
+    }
+    JsonObject sumObj = doc["sum"].as<JsonObject>();
+    if (!sumObj.isNull() && measureJson(doc) > MAX_PAYLOAD_SIZE) {
+        for (JsonPair kv : sumObj) {
+            kv.value().as<JsonArray>().remove(3); // [min, max, moyenne]
+        }
+    }
+    for (int i = numChannels - 1; i >= 0 && !sumObj.isNull() && measureJson(doc) > MAX_PAYLOAD_SIZE; i--) {
+        sumObj.remove(SUMMARY_KEYS[i]);
+    }
+    if (!sumObj.isNull() && sumObj.size() == 0) {
+        doc.remove("sum");
+    }
+    return measureJson(doc) <= MAX_PAYLOAD_SIZE;
+}
 
 
 Follower::Follower(const Config& config) 
     : config(config), 
+      schedule(config.logic.schedule),
       actuator(config.pins.led, config.pins.led_brightness),
       comms(&actuator),
       numSoilSensors(0), 
+      soilAcquisition(config.sensors.soil_settle_ms, config.sensors.soil_oversample),
+      sampler(soilAcquisition, config.logic.sample_period_ms),
+      reportPolicy(config.logic.reporting),
+      ota(config),
       tempSensor(nullptr),
       lastTimeCheck(0),
       alreadySentThisMinute(false), 
@@ -38,6 +76,7 @@ Follower::Follower(const Config& config)
                 s_cfg.dryValue,
                 s_cfg.wetValue
             );
+            soilAcquisition.addSensor(soilSensors[numSoilSensors]);
             numSoilSensors++; // Incrémenter le nombre de capteurs actifs
         }
     }
@@ -47,10 +86,65 @@ Follower::Follower(const Config& config)
     // 2. Capteur de température
     if (config.sensors.temp_sensor.enabled) {
         Serial.println("Activation capteur de température.");
-        tempSensor = new TemperatureSensor(config.sensors.temp_sensor.pin);
+        tempSensor = new TemperatureSensor(config.sensors.temp_sensor.pin,
+                                           config.sensors.temp_sensor.refresh_ms);
     } else {
         Serial.println("Capteur de température désactivé.");
     }
+
+    // 3. Électrovannes pilotées localement (régulation en bord de champ)
+    createValves();
+
+    encodeIdentity();
+}
+
+void Follower::createValves() {
+    if (config.logic.edge_irrigation_ms == 0) {
+        return;
+    }
+    uint8_t active = 0;
+    for (int i = 0; i < config.num_electrovalves && i < MAX_VALVES; i++) {
+        if (config.electrovalves[i].enabled) {
+            valves[i] = new Electrovanne(config.electrovalves[i].pin);
+            valves[i]->attachTimer(&valveTimer, i);
+            active++;
+        }
+    }
+    if (active > 0) {
+        valveScheduler = new ValveScheduler(config.logic.hydraulics, config, valves);
+        irrigation = new IrrigationManager(config.logic, valves);
+        irrigation->setScheduler(valveScheduler);
+        Serial.print(active);
+        Serial.println(" électrovanne(s) pilotée(s) localement.");
+    }
+}
+
+void Follower::destroyValves() {
+    // Toutes les vannes fermées (et leurs minuteurs annulés) avant de changer les broches
+    for (int i = 0; i < MAX_VALVES; i++) {
+        if (valves[i] != nullptr) {
+            valves[i]->close();
+        }
+    }
+    delete irrigation;
+    delete valveScheduler;
+    irrigation = nullptr;
+    valveScheduler = nullptr;
+    for (int i = 0; i < MAX_VALVES; i++) {
+        delete valves[i];
+        valves[i] = nullptr;
+    }
+    valveCmdMask = 0; // Commandes visant les anciennes vannes
+}
+
+void Follower::encodeIdentity() {
+    // Encodée au démarrage et à chaque changement d'identité (CFG_CHANGED_IDENTITY)
+    JsonDocument idDoc(&txPool);
+    idDoc["farmId"] = config.identity.farmId.c_str();
+    idDoc["zoneId"] = config.identity.zoneId.c_str();
+    idDoc["nodeId"] = config.identity.nodeId.c_str();
+    idDoc["isMaster"] = config.identity.isMaster;
+    identityJsonLen = serializeJson(idDoc, identityJson, sizeof(identityJson));
 }
 
 void Follower::begin() {
@@ -60,11 +154,21 @@ void Follower::begin() {
     for (int i = 0; i < numSoilSensors; i++) {
         soilSensors[i]->begin();
     }
-    if (tempSensor) {
-        tempSensor->begin();
+    // Timer d'échantillonnage armé dès maintenant : première acquisition une période
+    // plus tard, et isEnabled() décide déjà du mode de veille. Le DHT attend beginDeferred().
+    sampler.begin(numSoilSensors);
+    for (int i = 0; i < MAX_VALVES; i++) {
+        if (valves[i] != nullptr) {
+            valves[i]->begin();
+        }
+    }
+    for (int i = 0; i < MAX_SOIL_SENSORS; i++) {
+        edgeHumidities[i] = NAN;
     }
+    BootTrace::mark("sensors");
     
     comms.begin(config.network, config.pins, config.identity.isMaster);
+    BootTrace::mark("radio");
     
     comms.registerSendCallback([this](bool success) {
         this->onDataSent(success);
@@ -74,49 +178,191 @@ void Follower::begin() {
         this->onDataReceived(sender, data, len);
     });
     
+    bool warmBoot = restoreRtcState();
+    store.begin(!warmBoot);
+    reportPolicy.begin(!warmBoot);
+    ota.begin(); // Reprise d'un transfert interrompu
+
+    // Boucle événementielle : radio (LoRa interrogé, trames reçues traitées), puis logique du Follower
+    radioTask = EventLoop::addTask("radio", EVT_RADIO, comms.pollIntervalMs(), LOOP_BUDGET_US, [this]() {
+        this->comms.update();
+        // Période relue à chaque tour : la radio active peut changer (CFG_CHANGED_RADIO)
+        if (this->comms.pollIntervalMs() > 0) {
+            EventLoop::wakeIn(this->radioTask, this->comms.pollIntervalMs());
+        }
+    });
+    loopTask = EventLoop::addTask("follower", EVT_RADIO | EVT_SENSOR | EVT_CONFIG, LOOP_POLL_MS, LOOP_BUDGET_US, [this]() {
+        this->update();
+        this->scheduleWake();
+    });
+
     Serial.print("Follower démarré. Mode Comms: ");
     Serial.println(comms.getActiveMode() == CommMode::ESP_NOW ? "ESP-NOW" : "LORA");
 }
 
 
+void Follower::beginDeferred() {
+    if (tempSensor && !deferredStarted) {
+        tempSensor->begin(); // Première lecture 1 s plus tard (mise sous tension du DHT)
+    }
+    deferredStarted = true;
+}
+
+void Follower::scheduleWake() {
+    // Échéances plus proches que la période de la tâche
+    uint32_t next = min(valveTimer.msUntilNext(), ota.msUntilNext());
+    if (tempSensor && deferredStarted) {
+        next = min(next, tempSensor->msUntilNext());
+    }
+    if (slotSendPending) {
+        long wait = (long)(slotSendAtMs - millis());
+        next = min(next, wait > 0 ? (uint32_t)wait : 0U);
+    }
+    if (isSending) {
+        // Ré-essai programmé, ou délai de garde du callback d'envoi
+        long wait = (long)((retryPending ? retryAtMs : ackDeadlineMs) - millis());
+        next = min(next, wait > 0 ? (uint32_t)wait : 0U);
+    }
+    if (next != UINT32_MAX) {
+        EventLoop::wakeIn(loopTask, next);
+    }
+}
+
 void Follower::sendSensorData() {
-    StaticJsonDocument<384> doc; 
+    JsonDocument doc(&txPool);
     if (isSending) {
         Serial.println("⚠️ Envoi précédent toujours en cours, annulation.");
         return;
     }
 
-    // 1. Identité
-    doc["identity"]["farmId"] = config.identity.farmId;
-    doc["identity"]["zoneId"] = config.identity.zoneId;
-    doc["identity"]["nodeId"] = config.identity.nodeId;
-    doc["identity"]["isMaster"] = config.identity.isMaster;
+    // 1. Identité (déjà encodée, insérée telle quelle)
+    doc["identity"] = serialized(identityJson, identityJsonLen);
     
     // NOUVEAU: Ajouter un timestamp (0 si non synchronisé)
     doc["timestamp"] = timeIsSynced ? time(nullptr) : 0;
+    doc["seq"] = txSeq++;
+    doc["buf"] = store.count(); // Niveau du tampon hors ligne
+    if (irrigation) {
+        // État des vannes locales (bit i = vanne i+1 ouverte)
+        uint32_t mask = 0;
+        for (int i = 0; i < MAX_VALVES; i++) {
+            if (valves[i] != nullptr && valves[i]->isOpen()) {
+                mask |= 1UL << i;
+            }
+        }
+        doc["v"] = mask;
+    }
+    if (reportPolicy.isEnabled()) {
+        doc["why"] = ReportPolicy::reasonName(pendingReason);
+    }
+    if (config.logic.low_power) {
+        doc["awakeMs"] = s_rtc.lastAwakeMs; // Durée d'éveil du cycle précédent
+    }
   
     // 2. Capteurs
-    JsonObject sensorsObj = doc.createNestedObject("sensors");
-        
-    float firstHumidity = 0.0; // Pour la LED de statut
+    JsonObject sensorsObj = doc["sensors"].to<JsonObject>();
+
+    // Acquisition groupée : une seule stabilisation, canaux suréchantillonnés
+    float humidities[MAX_SOIL_SENSORS];
+    if (haveFreshHumidities) {
+        // Mesures déjà acquises par l'évaluation de la politique d'envoi
+        memcpy(humidities, freshHumidities, sizeof(humidities));
+        haveFreshHumidities = false;
+    } else {
+        soilAcquisition.acquire(humidities);
+    }
+
+    // Relevé compact conservé en cas d'échec d'envoi
+    lastReading.timestamp = timeIsSynced ? time(nullptr) : 0;
+    for (int i = 0; i < MAX_SOIL_SENSORS; i++) {
+        lastReading.humidity[i] = (i < numSoilSensors) ? (int16_t)lroundf(humidities[i] * 100.0f)
+                                                       : OFFLINE_VALUE_ABSENT;
+    }
+    lastReading.temp = OFFLINE_VALUE_ABSENT;
 
     for (int i = 0; i < numSoilSensors; i++) {
-        float h = soilSensors[i]->read();
-        String keyName = "soilHumidity" + String(i + 1); 
-        sensorsObj[keyName] = round(h * 100.0) / 100.0;
+        float h = humidities[i];
+        sensorsObj[SOIL_KEYS[i]] = round(h * 100.0) / 100.0;
     }
 
-    // Ajouter la température 
+    // Résumés de l'intervalle depuis le dernier envoi : [min, max, moyenne, pente %/min]
+    if (sampler.isEnabled()) {
+        JsonObject sumObj = doc["sum"].to<JsonObject>();
+        for (int i = 0; i < numSoilSensors; i++) {
+            SampleSummary s;
+            if (!sampler.summarize(i, s)) {
+                continue;
+            }
+            JsonArray arr = sumObj[SUMMARY_KEYS[i]].to<JsonArray>();
+            arr.add(round(s.min * 100.0) / 100.0);
+            arr.add(round(s.max * 100.0) / 100.0);
+            arr.add(round(s.mean * 100.0) / 100.0);
+            arr.add(round(s.slopePerMin * 1000.0) / 1000.0);
+        }
+
+        // Rafale brute optionnelle (sonde 1)
+        if (config.logic.raw_burst > 0) {
+            float raw[SAMPLER_CAPACITY];
+            uint8_t n = sampler.lastRaw(0, raw, min((int)config.logic.raw_burst, SAMPLER_CAPACITY));
+            JsonArray rawArr = doc["raw"].to<JsonArray>();
+            for (uint8_t i = 0; i < n; i++) {
+                rawArr.add(round(raw[i] * 10.0) / 10.0);
+            }
+        }
+    }
+
+    // Ajouter la température (valeur en cache, lue sans attente)
     if (tempSensor) {
         float t = tempSensor->read();
         sensorsObj["temp"] = round(t * 100.0) / 100.0;
+        if (!isnan(t)) {
+            lastReading.temp = (int16_t)lroundf(t * 100.0f);
+            doc["tAge"] = tempSensor->ageMs() / 1000; // Âge de la mesure (s)
+        }
     } else {
         sensorsObj["temp"] = nullptr; 
     }
     
-    char jsonString[384]; 
+    if (doc.overflowed()) {
+        // Pool plein : trame incomplète, le relevé attend le rattrapage
+        LOG_E("❌ Pool JSON de télémétrie plein (%u octets), relevé mis en tampon.", (unsigned)txPool.used());
+        store.push(lastReading);
+        return;
+    }
+    if (!fitTelemetry(doc, numSoilSensors)) {
+        // Même réduite, la trame ne passe pas : le relevé attend le rattrapage
+        LOG_E("❌ Télémétrie trop grande (%u octets), relevé mis en tampon.", (unsigned)measureJson(doc));
+        store.push(lastReading);
+        return;
+    }
+
+    // Durées des phases de démarrage, une fois par réveil (même règle de taille)
+    if (BootTrace::unsent()) {
+        BootTrace::writeCompact(doc["boot"].to<JsonArray>());
+        if (measureJson(doc) > MAX_PAYLOAD_SIZE) {
+            doc.remove("boot");
+        } else {
+            BootTrace::markSent();
+        }
+    }
+
+    // Santé du nœud, condensée, à la période configurée (sacrifiée elle aussi si la trame déborde)
+    uint32_t nowS = time(nullptr);
+    if (config.logic.metrics_interval_ms > 0 && nowS - s_rtc.lastMetricsS >= config.logic.metrics_interval_ms / 1000) {
+        Metrics::set(MG_TX_BACKLOG, store.count());
+        Metrics::sample();
+        Metrics::writeCompact(doc["m"].to<JsonArray>());
+        if (measureJson(doc) > MAX_PAYLOAD_SIZE) {
+            doc.remove("m");
+        } else {
+            s_rtc.lastMetricsS = nowS;
+            Metrics::resetWindow();
+        }
+    }
+
+    char jsonString[MAX_PAYLOAD_SIZE + 1];
     serializeJson(doc, jsonString, sizeof(jsonString));
-    lastJsonPayload = String(jsonString);
+    lastJsonPayload = jsonString;
     
     Serial.print("Envoi JSON (Tentative 1/ ");
     Serial.print(MAX_SEND_RETRIES);
@@ -124,19 +370,362 @@ void Follower::sendSensorData() {
     Serial.println(jsonString);
 
     isSending = true;
+    sendKind = SendKind::TELEMETRY;
     sendRetryCount = 1;
+    lastTxMs = millis();
 
-    if (!comms.sendData(lastJsonPayload.c_str())) {
+    if (!transmit()) {
         Serial.println("Erreur d'envoi (file pleine?)");
+        finishSend(false); // Aucun callback ne viendra : le relevé part au tampon hors ligne
+    }
+}
+
+void Follower::sendBackfill() {
+    StoredReading batch[MAX_BACKFILL_BATCH];
+    uint16_t n = store.peek(batch, MAX_BACKFILL_BATCH);
+    if (n == 0) {
+        return;
+    }
+
+    // {"type":"backfill","identity":{"nodeId":".."},"r":[[ts,h1..hn,t],...]} (centièmes)
+    char json[MAX_PAYLOAD_SIZE + 1];
+    int pos = snprintf(json, sizeof(json), "{\"type\":\"backfill\",\"identity\":{\"nodeId\":\"%s\"},\"r\":[",
+                       config.identity.nodeId.c_str());
+    uint16_t included = 0;
+
+    for (uint16_t r = 0; r < n; r++) {
+        char rec[96];
+        int len = snprintf(rec, sizeof(rec), "%s[%lu", included ? "," : "", (unsigned long)batch[r].timestamp);
+        for (int i = 0; i < numSoilSensors; i++) {
+            int16_t v = batch[r].humidity[i];
+            len += (v == OFFLINE_VALUE_ABSENT) ? snprintf(rec + len, sizeof(rec) - len, ",null")
+                                               : snprintf(rec + len, sizeof(rec) - len, ",%d", v);
+        }
+        len += (batch[r].temp == OFFLINE_VALUE_ABSENT) ? snprintf(rec + len, sizeof(rec) - len, ",null]")
+                                                        : snprintf(rec + len, sizeof(rec) - len, ",%d]", batch[r].temp);
+
+        // Garder la place pour "]}" final
+        if (pos + len + 2 > MAX_PAYLOAD_SIZE) {
+            break;
+        }
+        memcpy(json + pos, rec, len);
+        pos += len;
+        included++;
+    }
+    if (included == 0) {
+        return;
+    }
+    json[pos++] = ']';
+    json[pos++] = '}';
+    json[pos] = '\0';
+
+    Serial.print("📦 Rattrapage: envoi de ");
+    Serial.print(included);
+    Serial.print(" relevé(s), ");
+    Serial.print(store.count());
+    Serial.println(" en attente.");
+
+    lastJsonPayload = json;
+    isSending = true;
+    sendKind = SendKind::BACKFILL;
+    backfillBatch = included;
+    sendRetryCount = 1;
+    lastTxMs = millis();
+    lastBackfillMs = millis();
+
+    if (!transmit()) {
+        isSending = false;
+    }
+}
+
+void Follower::updateEdgeIrrigation(bool newSample) {
+    valveTimer.poll(); // Fermetures par minuteur
+    valveScheduler->update();
+
+    // Hystérésis appliquée à chaque échantillon, ou à la période configurée
+    bool due = false;
+    if (sampler.isEnabled()) {
+        if (newSample) {
+            for (int i = 0; i < numSoilSensors; i++) {
+                edgeHumidities[i] = sampler.latest(i);
+            }
+            due = true;
+        }
+    } else if (lastEdgeCheckMs == 0 || millis() - lastEdgeCheckMs >= config.logic.edge_irrigation_ms) {
+        lastEdgeCheckMs = millis();
+        soilAcquisition.acquire(edgeHumidities);
+        due = true;
+    }
+    if (due) {
+        for (int i = 0; i < numSoilSensors; i++) {
+            if (!isnan(edgeHumidities[i])) {
+                irrigation->processReading(config.identity.nodeId.c_str(), i + 1, edgeHumidities[i]);
+            }
+        }
+    }
+
+    // Détection des changements d'état (logique, minuteur ou commande du Master)
+    for (int i = 0; i < MAX_VALVES; i++) {
+        if (valves[i] == nullptr || valves[i]->isOpen() == valveWasOpen[i]) {
+            continue;
+        }
+        valveWasOpen[i] = valves[i]->isOpen();
+
+        uint8_t slot = (valveEventHead + valveEventCount) % MAX_VALVE_EVENTS;
+        if (valveEventCount == MAX_VALVE_EVENTS) {
+            // File pleine : l'événement le plus ancien est écrasé
+            valveEventHead = (valveEventHead + 1) % MAX_VALVE_EVENTS;
+        } else {
+            valveEventCount++;
+        }
+        ValveEvent& e = valveEvents[slot];
+        e.valve = i + 1;
+        e.open = valveWasOpen[i];
+        e.humidity = (i < numSoilSensors) ? edgeHumidities[i] : NAN;
+        e.timestamp = timeIsSynced ? time(nullptr) : 0;
+        e.waitMs = e.open ? valveScheduler->lastWaitMs(e.valve) : 0;
+    }
+}
+
+void Follower::sendValveEvent() {
+    const ValveEvent& e = valveEvents[valveEventHead];
+
+    JsonDocument doc(&txPool);
+    doc["type"] = "valveEvent";
+    doc["identity"]["nodeId"] = config.identity.nodeId.c_str();
+    doc["valve"] = e.valve;
+    doc["open"] = e.open;
+    if (!isnan(e.humidity)) {
+        doc["h"] = round(e.humidity * 100.0) / 100.0;
+    }
+    doc["ts"] = e.timestamp;
+    if (e.open) {
+        doc["waitMs"] = e.waitMs;
+    }
+
+    char json[192];
+    serializeJson(doc, json);
+    Serial.print("🚿 Vanne #");
+    Serial.print(e.valve);
+    Serial.println(e.open ? " ouverte, notification du Master." : " fermée, notification du Master.");
+
+    lastJsonPayload = json;
+    isSending = true;
+    sendKind = SendKind::VALVE_EVENT;
+    sendRetryCount = 1;
+    lastTxMs = millis();
+
+    if (!transmit()) {
+        isSending = false;
+    }
+}
+
+void Follower::queueValveCommand(JsonObjectConst cmd) {
+    int valveNum = cmd["valve"] | 0;
+    const char* action = cmd["action"];
+    uint32_t duration = cmd["duration"] | 0;
+
+    if (action == nullptr || valveNum < 1 || valveNum > MAX_VALVES || valves[valveNum - 1] == nullptr ||
+        (strcmp(action, "open") != 0 && strcmp(action, "close") != 0)) {
+        LOG_W("❌ Commande de vanne invalide.");
+        return;
+    }
+
+    // Un emplacement par vanne : la dernière commande reçue l'emporte
+    PendingValveCmd& p = pendingValveCmds[valveNum - 1];
+    p.open = strcmp(action, "open") == 0;
+    p.duration = duration;
+    // La logique locale est suspendue pendant la commande manuelle
+    // (par défaut : durée d'ouverture, ou 10 min pour une fermeture)
+    p.hold = cmd["hold"] | (duration > 0 ? duration : 600000UL);
+    valveCmdMask |= 1UL << (valveNum - 1);
+}
+
+void Follower::applyValveCommands() {
+    uint32_t mask = valveCmdMask;
+    valveCmdMask = 0;
+    for (int i = 0; i < MAX_VALVES; i++) {
+        if (!(mask & (1UL << i))) {
+            continue;
+        }
+        const PendingValveCmd& p = pendingValveCmds[i];
+        uint8_t valveNum = i + 1;
+        irrigation->hold(valveNum, p.hold);
+
+        if (p.open) {
+            Serial.print("✅ Commande Master: ouverture vanne #");
+            Serial.println(valveNum);
+            valveScheduler->request(valveNum, p.duration, VALVE_PRIORITY_MANUAL);
+        } else {
+            Serial.print("✅ Commande Master: fermeture vanne #");
+            Serial.println(valveNum);
+            valveScheduler->release(valveNum);
+        }
+    }
+}
+
+void Follower::handleConfigPatch() {
+    JsonDocument doc(&rxPool);
+    uint32_t changes = 0;
+    String error;
+    bool ok = false;
+    if (deserializeJson(doc, pendingConfig)) {
+        error = "json";
+    } else if (ConfigUpdate::hasStaged()) {
+        error = "update pending";
+    } else {
+        ok = ConfigUpdate::stage(doc["patch"].as<JsonObjectConst>(), changes, error);
+    }
+
+    Serial.print(ok ? "🔧 Patch de configuration accepté (changements 0x" : "❌ Patch de configuration refusé: ");
+    if (ok) {
+        Serial.print(changes, HEX);
+        Serial.println(").");
+    } else {
+        Serial.println(error);
+    }
+
+    JsonDocument ackDoc(&txPool);
+    ackDoc["type"] = "configAck";
+    ackDoc["identity"]["nodeId"] = config.identity.nodeId.c_str();
+    ackDoc["ok"] = ok;
+    if (ok) {
+        ackDoc["changes"] = changes;
+        ackDoc["reboot"] = (changes & CFG_CHANGED_REBOOT) != 0;
+    } else {
+        ackDoc["error"] = error;
+    }
+    serializeJson(ackDoc, configAck, sizeof(configAck));
+    configAckPending = true;
+}
+
+void Follower::applyConfigChanges(uint32_t changes) {
+    // Le planning d'envoi et le budget hydraulique sont relus par référence
+    if (changes & CFG_CHANGED_REBOOT) {
+        // LED, capteurs, périodes d'échantillonnage : fixés à la construction
+        restartPending = true;
+        return;
+    }
+    if (changes & CFG_CHANGED_RADIO) {
+        // Aucun envoi en vol (bascule différée) : la radio repart avec les nouveaux réglages
+        if (!comms.restart(config.network, config.pins, config.identity.isMaster)) {
+            Serial.println("❌ Radio indisponible avec la nouvelle configuration.");
+        }
+        linkUp = false;
+        EventLoop::wakeIn(radioTask, 0);
+    }
+    if (changes & CFG_CHANGED_IDENTITY) {
+        encodeIdentity();
+    }
+    if (changes & CFG_CHANGED_VALVES) {
+        Serial.println("🔧 Réinitialisation des vannes locales...");
+        destroyValves();
+        createValves();
+        for (int i = 0; i < MAX_VALVES; i++) {
+            if (valves[i] != nullptr) {
+                valves[i]->begin();
+            }
+        }
+    } else if ((changes & CFG_CHANGED_IRRIGATION) && irrigation) {
+        irrigation->resetZones();
+    }
+    if (changes & CFG_CHANGED_REPORTING) {
+        reportPolicy.reload();
+    }
+}
+
+void Follower::sendConfigAck() {
+    lastJsonPayload = configAck;
+    isSending = true;
+    sendKind = SendKind::CONFIG_ACK;
+    sendRetryCount = 1;
+    lastTxMs = millis();
+
+    if (!transmit()) {
+        isSending = false;
+        configAckPending = false;
     }
 }
 
 void Follower::update() {
+    // Issue de l'envoi en cours (notée par le callback radio) et ré-essai différé
+    handleSendOutcome();
+
+    // Mise à jour de configuration : validée puis basculée entre deux tours de boucle
+    if (configPending && !isSending) {
+        handleConfigPatch();
+        configPending = false;
+    }
+    // Bascule après l'acquittement, parti avec l'ancienne radio et l'ancienne identité
+    if (ConfigUpdate::hasStaged() && !configAckPending && !isSending) {
+        applyConfigChanges(ConfigUpdate::commitStagedConfig());
+    }
+    // Blocs OTA : écriture flash hors du callback radio
+    ota.update(comms, !isSending);
+    if (ota.rebootPending() && !isSending) {
+        Serial.println("🔄 Redémarrage sur le nouveau firmware...");
+        ESP.restart();
+    }
+    if (restartPending && !configAckPending && !isSending) {
+        Serial.println("🔄 Redémarrage pour appliquer la configuration...");
+        ESP.restart();
+    }
+
+    // Échantillonnage local cadencé par le timer (continue pendant les envois)
+    bool newSample = sampler.update();
+    if (tempSensor && deferredStarted) {
+        tempSensor->update(); // Mesure DHT en arrière-plan
+    }
+
+    // Régulation locale : indépendante de la radio et des envois en cours
+    if (irrigation) {
+        if (valveCmdMask != 0) {
+            applyValveCommands();
+        }
+        updateEdgeIrrigation(newSample);
+    }
 
     if (isSending) {
         return; 
     }
 
+    // 0e. Acquittement d'un patch de configuration
+    if (configAckPending && !slotSendPending) {
+        sendConfigAck();
+        return;
+    }
+
+    // 0d. Changements d'état des vannes : remontés en priorité
+    if (valveEventCount > 0 && !slotSendPending) {
+        sendValveEvent();
+        return;
+    }
+
+    // 0c. Rattrapage du tampon hors ligne, à débit limité
+    if (linkUp && !slotSendPending && store.count() > 0 &&
+        millis() - lastBackfillMs >= config.logic.backfill_interval_ms) {
+        sendBackfill();
+        return;
+    }
+
+    // 0a. Rien à faire avant le prochain envoi : dormir
+    maybeSleep();
+
+    // 0. Envoi différé jusqu'au créneau TDMA
+    if (slotSendPending) {
+        if ((long)(millis() - slotSendAtMs) >= 0) {
+            slotSendPending = false;
+            sendSensorData();
+        }
+        return;
+    }
+
+    // 0b. Échange horaire bidirectionnel périodique (offset + RTT)
+    if (timeIsSynced && millis() - lastTimeReqMs >= config.logic.time_resync_ms) {
+        lastTimeReqMs = millis();
+        sendTimeRequest();
+    }
+
     // 1. Gérer la logique si l'heure n'est PAS synchronisée
     if (!timeIsSynced) {
         unsigned long now = millis();
@@ -167,7 +756,6 @@ void Follower::update() {
     // ... (Récupérer l'heure et la minute actuelles) ...
     time_t now_epoch = time(nullptr);
     struct tm* timeinfo = localtime(&now_epoch);
-    int currentHour = timeinfo->tm_hour; 
     int currentMinute = timeinfo->tm_min;
 
     // ... (Détecter si la minute a changé) ...
@@ -176,18 +764,14 @@ void Follower::update() {
         lastCheckedMinute = currentMinute;
     }
 
-    // 4. Vérifier si on doit envoyer maintenant
-    bool shouldSend = false;
-    if (!alreadySentThisMinute) {
-        for (int i = 0; i < config.logic.num_send_times; i++) {
-            if (currentHour == config.logic.send_times[i].hour &&
-                currentMinute == config.logic.send_times[i].minute) {
-                
-                shouldSend = true;
-                break; 
-            }
-        }
+    // 3. Mode événementiel : la politique remplace le planning fixe
+    if (reportPolicy.isEnabled()) {
+        evaluateReporting(*timeinfo);
+        return;
     }
+
+    // 4. Vérifier si on doit envoyer maintenant (bitmap compilé, O(1))
+    bool shouldSend = !alreadySentThisMinute && schedule.isDue(*timeinfo);
     
     // 5. Si on doit envoyer
     if (shouldSend) {
@@ -197,51 +781,289 @@ void Follower::update() {
         
         Serial.println(") atteinte. Envoi des données...");
 
+        queueSend(*timeinfo);
+    }
+}
+
+void Follower::queueSend(const struct tm& timeinfo, bool waitNextMinute) {
+    if (hasSlot) {
+        // Attendre notre créneau : décalage mesuré depuis le début de la minute
+        struct timeval tv;
+        gettimeofday(&tv, nullptr);
+        uint32_t elapsedMs = (uint32_t)timeinfo.tm_sec * 1000UL + tv.tv_usec / 1000;
+        uint32_t waitMs = 0;
+        if (slotOffsetMs > elapsedMs) {
+            waitMs = slotOffsetMs - elapsedMs;
+        } else if (waitNextMinute) {
+            waitMs = slotOffsetMs + 60000UL - elapsedMs; // Créneau passé : minute suivante
+        }
+
+        Serial.print("📅 Créneau TDMA dans ");
+        Serial.print(waitMs);
+        Serial.println(" ms.");
+        slotSendPending = true;
+        slotSendAtMs = millis() + waitMs;
+    } else {
         // --- Appel de la fonction refactorisée ---
         sendSensorData();
     }
 }
 
+void Follower::evaluateReporting(const struct tm& timeinfo) {
+    if (policyEvaluated && millis() - lastPolicyEvalMs < config.logic.reporting.check_interval_ms) {
+        return;
+    }
+    policyEvaluated = true;
+    lastPolicyEvalMs = millis();
+
+    // Mesure courante : dernier échantillon si l'échantillonneur tourne, sinon acquisition
+    if (sampler.isEnabled()) {
+        for (int i = 0; i < numSoilSensors; i++) {
+            freshHumidities[i] = sampler.latest(i);
+        }
+        haveFreshHumidities = false; // L'envoi refera une mesure fraîche
+    } else {
+        soilAcquisition.acquire(freshHumidities);
+        haveFreshHumidities = true;
+    }
+
+    ReportReason reason = reportPolicy.evaluate(freshHumidities, numSoilSensors, (uint32_t)time(nullptr));
+    if (reason == ReportReason::NONE) {
+        haveFreshHumidities = false;
+        return;
+    }
+
+    pendingReason = reason;
+    Serial.print("📣 Envoi déclenché (");
+    Serial.print(ReportPolicy::reasonName(reason));
+    Serial.println(")");
+
+    if (ReportPolicy::isUrgent(reason)) {
+        // Réaction immédiate : pas d'attente du créneau TDMA
+        sendSensorData();
+    } else {
+        queueSend(timeinfo, true);
+    }
+}
+
 
 void Follower::onDataSent(bool success) {
+    // Callback radio (tâche Wi-Fi en ESP-NOW) : seule l'issue est notée, update() la traite
+    sendOutcome = success ? SendOutcome::ACKED : SendOutcome::FAILED;
+}
+
+bool Follower::transmit() {
+    sendOutcome = SendOutcome::NONE;
+    ackDeadlineMs = millis() + ACK_TIMEOUT_MS;
+    return comms.sendData(lastJsonPayload.c_str());
+}
+
+void Follower::handleSendOutcome() {
     if (!isSending) {
-        // Rien à faire si aucun envoi n'est en cours
+        sendOutcome = SendOutcome::NONE;
         return;
     }
 
-    if (success) {
-        Serial.println("Envoi OK");
-        isSending = false;
-        sendRetryCount = 0;
-        comms.sleepIfLora();
+    SendOutcome outcome = sendOutcome;
+    if (outcome == SendOutcome::NONE) {
+        if (retryPending) {
+            if ((long)(millis() - retryAtMs) >= 0) {
+                retryPending = false;
+                // Renvoyer le *dernier* payload
+                if (!transmit()) {
+                    LOG_E("   Erreur ré-envoi (file pleine?)");
+                    finishSend(false); // On arrête les envois pour ne pas rester bloqué
+                }
+            }
+            return;
+        }
+        if ((long)(millis() - ackDeadlineMs) < 0) {
+            return;
+        }
+        LOG_W("⚠️ Pas de retour de la radio pour l'envoi en cours, considéré en échec.");
+        outcome = SendOutcome::FAILED;
+    }
+    sendOutcome = SendOutcome::NONE;
+
+    if (outcome == SendOutcome::ACKED) {
+        LOG_D("Envoi OK");
+        finishSend(true);
         return;
     }
 
     // Ici: échec d'envoi (pas de ACK)
-    Serial.print("❌ Envoi Échoué (pas de ACK).");
-
     if (sendRetryCount < MAX_SEND_RETRIES) {
         sendRetryCount++;
-        Serial.print(" Nouvel essai (");
-        Serial.print(sendRetryCount);
-        Serial.print("/");
-        Serial.print(MAX_SEND_RETRIES);
-        Serial.println(")...");
-
-        // Attendre un petit peu avant de ré-essayer
-        delay(100); // 100ms
-
-        // Renvoyer le *dernier* payload
-        if (!comms.sendData(lastJsonPayload.c_str())) {
-            Serial.println("   Erreur ré-envoi (file pleine?)");
-            // On arrête les envois pour ne pas rester bloqué
-            isSending = false;
-        }
-        // Si l'envoi est accepté, on attend à nouveau le callback onDataSent
+        LOG_W("❌ Envoi Échoué (pas de ACK). Nouvel essai (%d/%d)...", sendRetryCount, MAX_SEND_RETRIES);
+
+        // Ré-essai différé, avec gigue pour désynchroniser les nœuds entrés en collision
+        retryPending = true;
+        retryAtMs = millis() + baseRetryDelayMs + esp_random() % baseRetryDelayMs;
     } else {
-        Serial.println(" Échec final après max de réessais.");
-        isSending = false; // On a échoué, on abandonne
+        LOG_E("❌ Envoi Échoué (pas de ACK). Échec final après max de réessais.");
+        finishSend(false); // On a échoué, on abandonne
+    }
+}
+
+void Follower::finishSend(bool success) {
+    isSending = false;
+    retryPending = false;
+    sendRetryCount = 0;
+
+    if (success) {
+        OtaReceiver::markAppValid(); // Liaison établie : le firmware courant est conservé
+        linkUp = true;
+        if (sendKind == SendKind::BACKFILL) {
+            store.pop(backfillBatch);
+        } else if (sendKind == SendKind::VALVE_EVENT) {
+            valveEventHead = (valveEventHead + 1) % MAX_VALVE_EVENTS;
+            valveEventCount--;
+        } else if (sendKind == SendKind::CONFIG_ACK) {
+            configAckPending = false;
+        } else {
+            sampler.markReported();
+            if (reportPolicy.isEnabled()) {
+                // Nouvelle référence : valeurs effectivement transmises
+                float sent[MAX_SOIL_SENSORS];
+                for (int i = 0; i < numSoilSensors; i++) {
+                    sent[i] = (lastReading.humidity[i] == OFFLINE_VALUE_ABSENT) ? NAN
+                                                                               : lastReading.humidity[i] / 100.0f;
+                }
+                reportPolicy.markReported(sent, numSoilSensors, (uint32_t)time(nullptr));
+            }
+        }
+        comms.sleepIfLora();
+        return;
+    }
+
+    linkUp = false;
+    if (sendKind == SendKind::TELEMETRY) {
+        // Le relevé n'est pas perdu : il sera rattrapé au retour du lien
+        store.push(lastReading);
+    } else if (sendKind == SendKind::VALVE_EVENT) {
+        // Événement abandonné : l'état courant des vannes part avec la télémétrie ("v")
+        valveEventHead = (valveEventHead + 1) % MAX_VALVE_EVENTS;
+        valveEventCount--;
+    } else if (sendKind == SendKind::CONFIG_ACK) {
+        configAckPending = false; // La configuration est appliquée de toute façon
+    }
+}
+
+bool Follower::restoreRtcState() {
+    if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_TIMER || s_rtc.magic != RTC_STATE_MAGIC) {
+        // Démarrage à froid : état RTC neuf
+        memset(&s_rtc, 0, sizeof(s_rtc));
+        s_rtc.magic = RTC_STATE_MAGIC;
+        s_rtc.txSeq = txSeq;
+        return false;
+    }
+
+    txSeq = s_rtc.txSeq;
+    timeIsSynced = s_rtc.timeIsSynced;
+    hasSlot = s_rtc.hasSlot;
+    slotOffsetMs = s_rtc.slotOffsetMs;
+    clock.importState(s_rtc.clock);
+    if (clock.isSynced()) {
+        clock.applyToSystemClock();
+        lastTimeReqMs = millis(); // Resynchro fine au rythme normal
+    }
+
+    // Canal ESP-NOW en cache (évite une nouvelle recherche)
+    if (s_rtc.channel != 0 && memcmp(s_rtc.peerMac, config.network.master_mac_bytes, 6) == 0) {
+        esp_wifi_set_channel(s_rtc.channel, WIFI_SECOND_CHAN_NONE);
+    }
+
+    Serial.print("💤 Réveil #");
+    Serial.print(s_rtc.cycles);
+    Serial.print(" (éveil précédent: ");
+    Serial.print(s_rtc.lastAwakeMs);
+    Serial.println(" ms)");
+    return true;
+}
+
+void Follower::saveRtcState() {
+    s_rtc.magic = RTC_STATE_MAGIC;
+    s_rtc.txSeq = txSeq;
+    s_rtc.timeIsSynced = timeIsSynced;
+    s_rtc.hasSlot = hasSlot;
+    s_rtc.slotOffsetMs = slotOffsetMs;
+    clock.exportState(s_rtc.clock);
+    memcpy(s_rtc.peerMac, config.network.master_mac_bytes, 6);
+    s_rtc.channel = WiFi.channel();
+}
+
+uint32_t Follower::msUntilNextSend() const {
+    if (reportPolicy.isEnabled()) {
+        // Mode événementiel : se réveiller pour la prochaine évaluation
+        uint32_t elapsed = millis() - lastPolicyEvalMs;
+        uint32_t interval = config.logic.reporting.check_interval_ms;
+        return (policyEvaluated && elapsed < interval) ? interval - elapsed : 0;
+    }
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return schedule.msUntilNext(tv, hasSlot ? slotOffsetMs : 0);
+}
+
+void Follower::maybeSleep() {
+    if (!config.logic.low_power || !timeIsSynced || isSending || slotSendPending) {
+        return;
+    }
+    // Vider le tampon hors ligne tant que le lien est disponible
+    if (linkUp && store.count() > 0) {
+        return;
+    }
+    // Vanne ouverte : rester éveillé pour la régulation et la fermeture
+    if (irrigation && irrigation->anyValveOpen()) {
+        return;
+    }
+    // Transfert OTA en cours
+    if (ota.isActive()) {
+        return;
+    }
+    // Ne pas interrompre une trame DHT en cours de capture
+    if (tempSensor && tempSensor->isBusy()) {
+        return;
+    }
+    // Laisser le temps au Master de répondre (timeSync, timeResp)
+    if (millis() - lastTxMs < REPLY_WINDOW_MS) {
+        return;
+    }
+
+    uint32_t untilSend = msUntilNextSend();
+    if (untilSend < config.logic.wake_lead_ms + config.logic.min_sleep_ms) {
+        return;
+    }
+    uint32_t sleepMs = untilSend - config.logic.wake_lead_ms;
+    bool deep = config.logic.deep_sleep;
+    if (sampler.isEnabled()) {
+        // Le tampon d'échantillons vit en RAM : sommeil léger jusqu'au prochain échantillon
+        sleepMs = min(sleepMs, sampler.periodMs());
+        deep = false;
+    }
+
+    s_rtc.lastAwakeMs = millis() - cycleStartMs;
+    s_rtc.cycles++;
+    saveRtcState();
+
+    Serial.print("💤 Sommeil ");
+    Serial.print(deep ? "profond" : "léger");
+    Serial.print(" pendant ");
+    Serial.print(sleepMs);
+    Serial.print(" ms (éveil: ");
+    Serial.print(s_rtc.lastAwakeMs);
+    Serial.println(" ms)");
+    Serial.flush();
+
+    comms.sleepIfLora();
+    esp_sleep_enable_timer_wakeup((uint64_t)sleepMs * 1000ULL);
+
+    if (deep) {
+        esp_deep_sleep_start(); // Ne revient pas : le réveil repasse par setup()
     }
+
+    // Light sleep : la RAM et esp_timer sont conservés, la boucle reprend ici
+    esp_light_sleep_start();
+    cycleStartMs = millis();
 }
 
 
@@ -249,39 +1071,112 @@ CommManager* Follower::getCommManager() {
     return &comms; 
 }
 
+void Follower::sendTimeRequest() {
+    JsonDocument doc(&txPool);
+    doc["type"] = "timeReq";
+    doc["t1"] = ClockSync::localMs();
+
+    char json[64];
+    serializeJson(doc, json);
+    if (!comms.sendData(json)) {
+        Serial.println("⚠️ Échec envoi timeReq.");
+    }
+}
+
 void Follower::onDataReceived(const SenderInfo& sender, const uint8_t* data, int len) {
-    
-    StaticJsonDocument<256> doc;
+    int64_t rxLocalMs = sender.rxLocalMs; // t4 / réception du beacon, relevé par la radio
+
+    // Trames binaires de distribution d'image
+    if (isOtaFrame(data, len)) {
+        ota.onFrame(data, len);
+        return;
+    }
+
+    JsonDocument doc(&rxPool);
     DeserializationError error = deserializeJson(doc, (const char*)data, len);
 
     if (error) {
-        Serial.println("Follower: Erreur JSON reçu.");
+        Metrics::inc(MC_PARSE_ERRORS);
+        LOG_W("Follower: Erreur JSON reçu.");
         return;
     }
 
     // Vérifier si c'est un message de synchro horaire
     const char* type = doc["type"];
-    if (type != nullptr && strcmp(type, "timeSync") == 0) {
+    if (type == nullptr) {
+        return;
+    }
+
+    if (strcmp(type, "config") == 0) {
+        // Traité dans la loop : un seul patch à la fois
+        if (!configPending && len > 0 && len <= MAX_PAYLOAD_SIZE) {
+            memcpy(pendingConfig, data, len);
+            pendingConfig[len] = '\0';
+            configPending = true;
+        }
+        return;
+    }
+
+    if (strcmp(type, "valveCmd") == 0) {
+        // Appliquée dans la loop, comme un patch de configuration
+        if (irrigation) {
+            queueValveCommand(doc.as<JsonObjectConst>());
+        }
+        return;
+    }
+
+    if (strcmp(type, "timeResp") == 0) {
+        if (clock.addExchange(doc["t1"].as<int64_t>(), doc["t2"].as<int64_t>(),
+                              doc["t3"].as<int64_t>(), rxLocalMs)) {
+            clock.applyToSystemClock();
+            timeIsSynced = true;
+            LOG_I("⏰ Synchro fine: RTT=%d ms, dérive=%.1f ppm", clock.lastRttMs(), clock.driftPpm());
+        }
+        return;
+    }
+
+    if (strcmp(type, "beacon") == 0) {
+        clock.addBeacon(doc["t"].as<int64_t>(), rxLocalMs);
+        clock.applyToSystemClock();
+        if (!timeIsSynced) {
+            // Premier beacon : on demande tout de suite un échange pour mesurer le RTT
+            timeIsSynced = true;
+            lastTimeReqMs = millis() - config.logic.time_resync_ms;
+        }
+        return;
+    }
+
+    if (strcmp(type, "timeSync") == 0) {
         
         uint32_t epoch = doc["epoch"];
         
-        // Régler l'horloge interne de l'ESP32
-        struct timeval tv;
-        tv.tv_sec = epoch;
-        tv.tv_usec = 0;
-        settimeofday(&tv, nullptr); // Nécessite <sys/time.h>
+        // Régler l'horloge interne de l'ESP32 (à la seconde), sauf si la
+        // synchro fine est déjà établie
+        if (!clock.isSynced()) {
+            struct timeval tv;
+            tv.tv_sec = epoch;
+            tv.tv_usec = 0;
+            settimeofday(&tv, nullptr); // Nécessite <sys/time.h>
+            // Affiner au plus vite par un échange bidirectionnel
+            lastTimeReqMs = millis() - config.logic.time_resync_ms;
+        }
 
         if (epoch > 1672531200) { 
             timeIsSynced = true;
             syncFails = 0;
+
+            if (!doc["slotMs"].isNull()) {
+                slotOffsetMs = doc["slotMs"];
+                hasSlot = true;
+                LOG_I("📅 Créneau TDMA attribué: +%u ms", slotOffsetMs);
+            }
             
-            Serial.print("--- HEURE SYNCHRONISÉE ---");
             time_t now_epoch = time(nullptr);
-            struct tm* timeinfo = localtime(&now_epoch);
-            Serial.print(" Heure locale: ");
-            Serial.print(asctime(timeinfo)); // 'asctime' ajoute un \n
+            char localTime[24];
+            strftime(localTime, sizeof(localTime), "%d/%m/%Y %H:%M:%S", localtime(&now_epoch));
+            LOG_I("--- HEURE SYNCHRONISÉE --- Heure locale: %s", localTime);
         } else {
-             Serial.println("Heure reçue invalide (epoch=0).");
+             LOG_W("Heure reçue invalide (epoch=0).");
         }
     }
 }
\ No newline at end of file
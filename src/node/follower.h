@@ -1,10 +1,42 @@
 #pragma once
 #include <ArduinoJson.h>
 #include "actuators/Actuator.h"
+#include "actuators/Electrovanne.h"
 #include "sensors/SoilHumiditySensor.h"
+#include "sensors/SoilAcquisition.h"
+#include "sensors/SensorSampler.h"
 #include "sensors/TemperatureSensor.h"
 #include "comms/CommManager.h"
+#include "comms/OtaReceiver.h"
 #include "ConfigLoader.h" // Contient MAX_SOIL_SENSORS
+#include "ConfigUpdate.h"
+#include "logic/ClockSync.h"
+#include "logic/SendSchedule.h"
+#include "logic/OfflineStore.h"
+#include "logic/ReportPolicy.h"
+#include "logic/IrrigationManager.h"
+#include "logic/ValveTimer.h"
+#include "logic/ValveScheduler.h"
+#include "logic/EventLoop.h"
+#include "Log.h"
+#include "logic/Metrics.h"
+#include "BootTrace.h"
+#include "JsonPool.h"
+
+// État du protocole conservé en mémoire RTC pendant le deep sleep
+struct FollowerRtcState {
+    uint32_t magic;
+    uint16_t txSeq;
+    bool timeIsSynced;
+    bool hasSlot;
+    uint32_t slotOffsetMs;
+    ClockSyncState clock;
+    uint8_t peerMac[6];       // Cache du peer ESP-NOW...
+    uint8_t channel;          // ...et de son canal Wi-Fi
+    uint32_t cycles;          // Nombre de cycles de réveil
+    uint32_t lastAwakeMs;     // Durée d'éveil du cycle précédent
+    uint32_t lastMetricsS;    // time() des dernières métriques jointes (survit au sommeil)
+};
 
 class Follower {
 public:
@@ -12,6 +44,8 @@ public:
     Follower(const Config& config);
     void begin();
     void update();
+    // Capteurs inutiles au premier envoi (DHT) : fin de setup(), ou après le premier envoi en FAST_BOOT
+    void beginDeferred();
     CommManager* getCommManager();
     
 
@@ -19,16 +53,24 @@ public:
 
 private:
     const Config& config; 
+    SendSchedule schedule;
     
     Actuator actuator;
     SoilHumiditySensor* soilSensors[MAX_SOIL_SENSORS];
     uint8_t numSoilSensors; 
+    SoilAcquisition soilAcquisition;
+    SensorSampler sampler;
     
     TemperatureSensor* tempSensor; 
     
     CommManager comms;
     unsigned long lastTimeCheck;
 
+    // Documents JSON sur pools fixes (aucune allocation sur le tas en régime établi).
+    // Tailles minimales : un bloc de variants ArduinoJson fait jusqu'à 2 Ko (v7.0, 32 bits).
+    JsonPool<3072> rxPool;            // Trames reçues du Master, patch de configuration
+    JsonPool<3072> txPool;            // Télémétrie, événements, acquittements
+
     // MODIFIÉ: Renommage pour gérer les minutes
     bool alreadySentThisMinute; 
     bool timeIsSynced;
@@ -38,12 +80,124 @@ private:
     bool isSending; 
     uint8_t sendRetryCount; 
     const uint8_t MAX_SEND_RETRIES = 5; 
-    String lastJsonPayload; 
+    FixedString<MAX_PAYLOAD_SIZE + 1> lastJsonPayload; // Dernière trame (ré-émise telle quelle), sans allocation
+    char identityJson[160];           // En-tête d'identité encodé une fois pour toutes
+    size_t identityJsonLen = 0;
+    void encodeIdentity();
+    void createValves();
+    void destroyValves();
     uint16_t txSeq = 1;
-    unsigned long ackDeadlineMs = 0;
+    unsigned long ackDeadlineMs = 0;  // Callback d'envoi attendu avant cette échéance
     uint16_t pendingAckSeq = 0;
     uint16_t baseRetryDelayMs = 120; // ESP-NOW
 
+    // Créneau TDMA attribué par le Master (décalage dans la minute d'envoi)
+    bool hasSlot = false;
+    uint32_t slotOffsetMs = 0;
+    bool slotSendPending = false;
+    unsigned long slotSendAtMs = 0;
+
+    // Synchro horaire fine (beacons + échanges bidirectionnels)
+    ClockSync clock;
+    unsigned long lastTimeReqMs = 0;
+
+    void sendTimeRequest();
+
+    // Mode basse consommation
+    unsigned long lastTxMs = 0;
+    unsigned long cycleStartMs = 0;      // Début du cycle d'éveil courant
+    static constexpr unsigned long REPLY_WINDOW_MS = 300; // Attente des réponses du Master
+    // Tampon hors ligne + rattrapage (backfill)
+    enum class SendKind { TELEMETRY, BACKFILL, VALVE_EVENT, CONFIG_ACK };
+    OfflineStore store;
+    StoredReading lastReading;        // Relevé du dernier envoi de télémétrie
+    SendKind sendKind = SendKind::TELEMETRY;
+    uint16_t backfillBatch = 0;       // Relevés dans la trame de rattrapage en vol
+    bool linkUp = false;              // Dernier envoi acquitté par le Master
+    unsigned long lastBackfillMs = 0;
+    static constexpr uint16_t MAX_BACKFILL_BATCH = 16;
+    void sendBackfill();
+
+    // Envois événementiels (seuils / pente / heartbeat)
+    ReportPolicy reportPolicy;
+    OtaReceiver ota;                  // Images (config, firmware) diffusées par le Master
+    ReportReason pendingReason = ReportReason::NONE;
+    unsigned long lastPolicyEvalMs = 0;
+    bool policyEvaluated = false;
+    float freshHumidities[MAX_SOIL_SENSORS]; // Mesures de l'évaluation, réutilisées par l'envoi
+    bool haveFreshHumidities = false;
+    void evaluateReporting(const struct tm& timeinfo);
+    // Envoi immédiat ou différé au créneau TDMA (minute suivante si le créneau est passé)
+    void queueSend(const struct tm& timeinfo, bool waitNextMinute = false);
+
+    // Régulation locale des vannes (Follower équipé d'électrovannes)
+    struct ValveEvent {
+        uint8_t valve;        // 1 à MAX_VALVES
+        bool open;
+        float humidity;       // Humidité de la sonde associée au moment du changement
+        uint32_t timestamp;
+        uint32_t waitMs;      // Attente dans la file hydraulique avant ouverture
+    };
+    static constexpr uint8_t MAX_VALVE_EVENTS = 8;
+    Electrovanne* valves[MAX_VALVES] = {nullptr};
+    ValveTimer valveTimer;
+    IrrigationManager* irrigation = nullptr;
+    ValveScheduler* valveScheduler = nullptr;
+    bool valveWasOpen[MAX_VALVES] = {false};
+    float edgeHumidities[MAX_SOIL_SENSORS];
+    unsigned long lastEdgeCheckMs = 0;
+    ValveEvent valveEvents[MAX_VALVE_EVENTS]; // File des changements d'état à remonter
+    uint8_t valveEventHead = 0;
+    uint8_t valveEventCount = 0;
+    void updateEdgeIrrigation(bool newSample);
+    void sendValveEvent();
+
+    // Commandes de vanne du Master : copiées à la réception, appliquées dans la loop
+    // (même tas de minuteurs que valveTimer.poll())
+    struct PendingValveCmd {
+        bool open;
+        uint32_t duration;
+        uint32_t hold;
+    };
+    PendingValveCmd pendingValveCmds[MAX_VALVES];
+    volatile uint32_t valveCmdMask = 0;   // Bit i : commande en attente pour la vanne i+1
+    void queueValveCommand(JsonObjectConst cmd);
+    void applyValveCommands();
+
+    // Mise à jour de configuration reçue du Master : copiée dans le callback radio,
+    // traitée dans la loop (écriture SPIFFS interdite dans la tâche Wi-Fi)
+    char pendingConfig[MAX_PAYLOAD_SIZE + 1];
+    volatile bool configPending = false;
+    char configAck[128];
+    bool configAckPending = false;
+    bool restartPending = false;      // Redémarrage après acquittement
+    void handleConfigPatch();
+    void applyConfigChanges(uint32_t changes);
+    void sendConfigAck();
+
+    bool restoreRtcState();
+    void saveRtcState();
+    uint32_t msUntilNextSend() const;
+    void maybeSleep();
+
+    bool deferredStarted = false;     // beginDeferred() appelé
+    int8_t loopTask = -1;             // Tâche de la boucle événementielle
+    int8_t radioTask = -1;
+    static constexpr uint32_t LOOP_POLL_MS = 50;        // Délais applicatifs (secondes) non signalés
+    static constexpr uint32_t LOOP_BUDGET_US = 50000;
+    void scheduleWake();
+
+    // Issue d'un envoi : notée par le callback (tâche Wi-Fi), traitée dans la loop
+    // (le tampon hors ligne écrit en SPIFFS, le ré-essai attend sans bloquer la radio)
+    enum class SendOutcome : uint8_t { NONE, ACKED, FAILED };
+    volatile SendOutcome sendOutcome = SendOutcome::NONE;
+    bool retryPending = false;
+    unsigned long retryAtMs = 0;
+    static constexpr unsigned long ACK_TIMEOUT_MS = 2000;
+    bool transmit();
+    void handleSendOutcome();
+    void finishSend(bool success);
+
     void onDataSent(bool success);
     void sendSensorData();
     void onDataReceived(const SenderInfo& sender, const uint8_t* data, int len); 
@@ -1,15 +1,36 @@
 #include "master.h"
 #include <Arduino.h>
 
+// Clés des capteurs d'humidité, pré-calculées (pas de String par message)
+static const char* const SOIL_KEYS[MAX_SOIL_SENSORS] = {
+    "soilHumidity1", "soilHumidity2", "soilHumidity3", "soilHumidity4", "soilHumidity5"
+};
+
 Master::Master(const Config& config)
     : config(config),
       actuator(config.pins.led, config.pins.led_brightness),
       wifi(),
       comms(&actuator),
       lastReceivedHumidity(0.0f),
-      irrigationManager(nullptr)
+      irrigationManager(nullptr),
+      programScheduler(nullptr),
+      valveScheduler(nullptr),
+      aggregator(config.logic.aggregate_period_ms),
+      slotScheduler(config.logic.tdma_window_ms, config.logic.tdma_node_expiry_ms),
+      ota(comms),
+      jsonDoc(&rxPool)
 {
-// Déclarer les pointeurs d'Electrovanne dans le Master.h, allouer ici:
+    createValves();
+
+    // Filtre du parsing de télémétrie : uniquement ce dont la logique a besoin
+    telemetryFilter["type"] = true;
+    telemetryFilter["t1"] = true;
+    telemetryFilter["identity"]["nodeId"] = true;
+    telemetryFilter["sensors"] = true;
+}
+
+void Master::createValves() {
+    // Déclarer les pointeurs d'Electrovanne dans le Master.h, allouer ici:
     size_t configValveCount = config.num_electrovalves;
     size_t maxIter = (configValveCount < MAX_VALVES) ? configValveCount : MAX_VALVES;
     
@@ -20,13 +41,48 @@ Master::Master(const Config& config)
         const auto& valveConfig = config.electrovalves[i];
         if (valveConfig.enabled) {
             valveArray[i] = new Electrovanne(valveConfig.pin);
+            valveArray[i]->attachTimer(&valveTimer, i);
             numValves++;
         } else {
             valveArray[i] = nullptr;
         }
     }
     
+    valveScheduler = new ValveScheduler(config.logic.hydraulics, config, valveArray);
     irrigationManager = new IrrigationManager(config.logic, valveArray);
+    irrigationManager->setScheduler(valveScheduler);
+    programScheduler = new ProgramScheduler(valveArray);
+    programScheduler->setScheduler(valveScheduler);
+
+    // Temps d'attente de chaque ouverture remonté au serveur
+    valveScheduler->registerStartCallback([this](uint8_t valve, uint32_t waitMs) {
+        char json[128];
+        int n = snprintf(json, sizeof(json),
+                         "{\"type\":\"valveStart\",\"identity\":{\"nodeId\":\"%s\"},\"valve\":%u,\"waitMs\":%lu}",
+                         config.identity.nodeId.c_str(), valve, (unsigned long)waitMs);
+        if (n > 0 && n < (int)sizeof(json)) {
+            this->publishOrQueue(json, n);
+        }
+    });
+}
+
+void Master::destroyValves() {
+    // Toutes les vannes fermées (et leurs minuteurs annulés) avant de changer les broches
+    for (size_t i = 0; i < MAX_VALVES; ++i) {
+        if (valveArray[i] != nullptr) {
+            valveArray[i]->close();
+        }
+    }
+    delete programScheduler;
+    delete irrigationManager;
+    delete valveScheduler;
+    programScheduler = nullptr;
+    irrigationManager = nullptr;
+    valveScheduler = nullptr;
+    for (size_t i = 0; i < MAX_VALVES; ++i) {
+        delete valveArray[i];
+        valveArray[i] = nullptr;
+    }
 }
 
 void Master::begin() {
@@ -37,12 +93,24 @@ void Master::begin() {
     actuator.begin();
     actuator.showSearching(); // Démarre en mode recherche
     
-    for (size_t i = 0; i < numValves; ++i) {
+    // Le tableau peut contenir des trous (vannes désactivées) : parcours complet
+    for (size_t i = 0; i < MAX_VALVES; ++i) {
             if (valveArray[i] != nullptr) {
                 valveArray[i]->begin();
             }
         }
     
+    // Étage d'agrégation : vérifier le noyau vectoriel au démarrage
+    if (aggregator.isEnabled()) {
+        aggSelfTest();
+        aggregator.registerEmitCallback([this](const char* json, size_t len) {
+            this->publishOrQueue(json, len);
+        });
+    }
+
+    // Programmes d'arrosage locaux (exécutés même hors ligne)
+    programScheduler->begin();
+
     // Démarrer le Wi-Fi AVANT ESP-NOW (pour le Master)
     //wifi.begin(config.network);
 
@@ -55,15 +123,44 @@ void Master::begin() {
         actuator.showIdle();
         while(1) delay(100);
     }
+    BootTrace::mark("radio");
 
     comms.registerRecvCallback([this](const SenderInfo& sender, const uint8_t* data, int len) {
         this->onDataReceived(sender, data, len);
     });
 
+    // Résultat de chaque Follower à la fin d'une diffusion OTA
+    ota.registerResultCallback([this](const char* nodeId, OtaState state, uint16_t received, uint16_t chunks) {
+        char json[160];
+        int n = snprintf(json, sizeof(json),
+                         "{\"type\":\"otaResult\",\"identity\":{\"nodeId\":\"%s\"},\"ok\":%s,\"received\":%u,\"chunks\":%u}",
+                         nodeId, state == OtaState::COMPLETE ? "true" : "false", received, chunks);
+        if (n > 0 && n < (int)sizeof(json)) {
+            this->publishOrQueue(json, n);
+        }
+    });
+
     wifi.registerCommandCallback([this](char* t, byte* p, unsigned int l) {
         this->onMqttCommandReceived(t, p, l);
     });
     
+    // Boucle événementielle : radio (LoRa interrogé, trames reçues traitées), puis logique du Master
+    radioTask = EventLoop::addTask("radio", EVT_RADIO, comms.pollIntervalMs(), LOOP_BUDGET_US, [this]() {
+        this->comms.update();
+        // Période relue à chaque tour : la radio active peut changer (CFG_CHANGED_RADIO)
+        if (this->comms.pollIntervalMs() > 0) {
+            EventLoop::wakeIn(this->radioTask, this->comms.pollIntervalMs());
+        }
+    });
+    loopTask = EventLoop::addTask("master", EVT_RADIO | EVT_CONFIG, LOOP_POLL_MS, LOOP_BUDGET_US, [this]() {
+        this->update();
+        this->scheduleWake();
+    });
+    // File hors ligne : échéances seules, armée par update() au retour de MQTT
+    drainTask = EventLoop::addTask("mqttq", 0, 0, LOOP_BUDGET_US, [this]() {
+        this->drainTelemetryQueue();
+    });
+
     Serial.print("✅ Master démarré. Mode Comms: ");
     if (comms.getActiveMode() == CommMode::ESP_NOW) {
         Serial.println("ESP-NOW");
@@ -77,15 +174,44 @@ void Master::begin() {
 }
 
 void Master::update() {
+    // Bascule de configuration entre deux tours de boucle : aucun module n'est en cours d'exécution
+    if (ConfigUpdate::hasStaged()) {
+        applyConfigChanges(ConfigUpdate::commitStagedConfig());
+    }
+    if (restartAtMs != 0 && (long)(millis() - restartAtMs) >= 0) {
+        Serial.println("🔄 Redémarrage pour appliquer la configuration...");
+        ESP.restart();
+    }
+
     actuator.update();
-    for (size_t i = 0; i < numValves; ++i) {
-            if (valveArray[i] != nullptr) {
-                valveArray[i]->update();
-            }
-        }   
+    valveTimer.poll(); // Seule la prochaine échéance est examinée
+    valveScheduler->update();
+
+    programScheduler->update();
+    aggregator.update();
+    ota.update();
     
     //wifi.update();
 
+    // Beacon horaire diffusé (ESP-NOW broadcast / LoRa canal dédié)
+    if (config.logic.beacon_interval_ms > 0 &&
+        millis() - lastBeaconTime >= config.logic.beacon_interval_ms) {
+        lastBeaconTime = millis();
+        sendTimeBeacon();
+    }
+
+    // Métriques de santé (instantané, jamais mis en file d'attente)
+    if (config.logic.metrics_interval_ms > 0 && millis() - lastMetricsMs >= config.logic.metrics_interval_ms) {
+        lastMetricsMs = millis();
+        publishMetrics();
+    }
+
+    // Retirer du plan TDMA les nœuds qui ne répondent plus
+    if (millis() - lastSlotExpiryCheck >= SLOT_EXPIRY_CHECK_MS) {
+        lastSlotExpiryCheck = millis();
+        slotScheduler.expire(lastSlotExpiryCheck);
+    }
+
         if (!wifiReady) {
         unsigned long now = millis();
         if (now - lastWifiAttempt >= WIFI_RETRY_INTERVAL_MS) {
@@ -106,123 +232,213 @@ void Master::update() {
         wifi.update();
     }
     
-    // Si MQTT reconnecté, vider la file d'attente
-    if (wifi.isMqttConnected() && !telemetryQueue.empty()) {
+    // Si MQTT reconnecté, vider la file d'attente sans bloquer la boucle
+    if (queueCount > 0 && !drainScheduled && wifi.isMqttConnected()) {
         Serial.print("📤 MQTT reconnecté. Envoi de ");
-        Serial.print(telemetryQueue.size());
+        Serial.print(queueCount);
         Serial.println(" messages en file d'attente...");
+        drainScheduled = true;
+        EventLoop::wakeIn(drainTask, 0);
+    }
+}
 
-        for (const auto& payload : telemetryQueue) {
-            wifi.publishTelemetry(payload.c_str(), payload.length());
-            delay(100);
+void Master::drainTelemetryQueue() {
+    // Une trame par exécution : le broker n'est pas inondé, la radio reste servie
+    if (queueCount > 0 && wifi.isMqttConnected()) {
+        const QueuedFrame& frame = telemetryQueue[queueHead];
+        if (wifi.publishTelemetry(frame.data, frame.len)) {
+            Metrics::inc(MC_MQTT_PUBLISHED);
+            queueHead = (queueHead + 1) % MAX_QUEUE_SIZE;
+            queueCount--;
+        } else {
+            LOG_W("→ ❌ Publication de la file interrompue (%u en attente).", queueCount);
+            drainScheduled = false; // Reprise au prochain retour de MQTT
+            return;
         }
-        telemetryQueue.clear();
+    }
+    if (queueCount > 0 && wifi.isMqttConnected()) {
+        EventLoop::wakeIn(drainTask, TELEMETRY_DRAIN_MS);
+    } else {
+        drainScheduled = false;
+    }
+}
+
+void Master::publishMetrics() {
+    Metrics::set(MG_TX_BACKLOG, queueCount);
+    Metrics::sample();
+
+    if (wifi.isMqttConnected()) {
+        JsonDocument doc(&txPool);
+        doc["type"] = "metrics";
+        doc["identity"]["nodeId"] = config.identity.nodeId.c_str();
+        Metrics::writeSnapshot(doc.as<JsonObject>());
+        bool withBoot = BootTrace::unsent();
+        if (withBoot) {
+            BootTrace::writeTo(doc["boot"].to<JsonObject>());
+        }
+
+        char json[768];
+        size_t len = serializeJson(doc, json, sizeof(json));
+        if (doc.overflowed() || len >= sizeof(json) - 1) {
+            LOG_W("⚠️ Métriques tronquées (pool %u/%u octets).", (unsigned)txPool.used(), (unsigned)txPool.capacity());
+        }
+        if (!wifi.publishTelemetry(json, len)) {
+            LOG_W("❌ Publication des métriques impossible.");
+        } else if (withBoot) {
+            BootTrace::markSent();
+        }
+    }
+    Metrics::resetWindow();
+}
+
+void Master::scheduleWake() {
+    // Échéances plus proches que la période de la tâche : fermeture de vanne, bloc OTA
+    uint32_t next = min(valveTimer.msUntilNext(), ota.msUntilNext());
+    if (next != UINT32_MAX) {
+        EventLoop::wakeIn(loopTask, next);
     }
 }
 
 void Master::onDataReceived(const SenderInfo& sender, const uint8_t* data, int len) {
-    DeserializationError error = deserializeJson(jsonDoc, (const char*)data, len);
+    int64_t rxMs = sender.rxEpochMs; // t2 de l'échange horaire, relevé à la réception radio
+
+    // État d'un Follower pendant une diffusion OTA (trame binaire)
+    if (isOtaFrame(data, len)) {
+        ota.onFrame(data, len);
+        return;
+    }
+
+    // Parsing filtré : seuls les champs utiles à la logique sont extraits,
+    // le message d'origine est ensuite transféré tel quel (sans re-sérialisation).
+    DeserializationError error = deserializeJson(jsonDoc, (const char*)data, len,
+                                                 DeserializationOption::Filter(telemetryFilter));
 
     if (error) {
-        Serial.print("❌ Erreur de parsing JSON ! ");
-        Serial.println(error.c_str());
+        Metrics::inc(MC_PARSE_ERRORS);
+        LOG_E("❌ Erreur de parsing JSON ! %s", error.c_str());
+        return;
+    }
+
+    // Requête de synchro horaire bidirectionnelle : réponse immédiate, pas de télémétrie
+    const char* type = jsonDoc["type"];
+    if (type != nullptr && strcmp(type, "timeReq") == 0) {
+        replyTimeRequest(sender, jsonDoc["t1"].as<int64_t>(), rxMs);
         return;
     }
 
     // Extraire les données
     const char* nodeId = jsonDoc["identity"]["nodeId"];
-    JsonObject sensorsObj = jsonDoc["sensors"]; 
+    if (nodeId == nullptr) {
+        LOG_W("❌ Message rejeté: 'identity.nodeId' manquant.");
+        return;
+    }
+
+    nodeDirectory.learn(nodeId, sender, millis());
+
+    // Rattrapage d'un follower (relevés historiques horodatés), changement d'état
+    // d'une vanne pilotée en local ou acquittement de configuration :
+    // toujours transférés bruts, jamais agrégés
+    if (type != nullptr && (strcmp(type, "backfill") == 0 || strcmp(type, "valveEvent") == 0 ||
+                            strcmp(type, "configAck") == 0)) {
+        if (type[0] == 'b') {
+            LOG_I("📦 Rattrapage reçu de %s", nodeId);
+        } else if (type[0] == 'v') {
+            LOG_I("🚿 Événement vanne reçu de %s", nodeId);
+        } else {
+            LOG_I("🔧 Acquittement de configuration reçu de %s", nodeId);
+        }
+        size_t frameLen = buildTelemetryFrame(sender, data, len);
+        if (frameLen == 0) {
+            LOG_W("→ ❌ Trame trop grande, message ignoré.");
+            return;
+        }
+        publishOrQueue(telemetryFrame, frameLen);
+        return;
+    }
+
+    JsonObject sensorsObj = jsonDoc["sensors"];
     float temp = sensorsObj["temp"];
 
-    Serial.print("✅ Données reçues de ");
-    Serial.print(nodeId);
-    Serial.print(": ");
+    LOG_I("✅ Données reçues de %s", nodeId);
 
     // Itérer sur toutes les humidités
-    Serial.print("Humidités: [");
-
+    bool mqttDown = !wifi.isMqttConnected() || WiFi.status() != WL_CONNECTED;
+    bool fallbackLogged = false;
     for (int i = 1; i <= MAX_SOIL_SENSORS; i++) {
-        String keyName = "soilHumidity" + String(i);
+        JsonVariant value = sensorsObj[SOIL_KEYS[i - 1]];
         
-        if (sensorsObj.containsKey(keyName)) {
-            float h = sensorsObj[keyName];
-            Serial.print(keyName);
-            Serial.print(": ");
-            Serial.print(h, 2);
-            Serial.print("%, ");
+        if (!value.isNull()) {
+            float h = value;
+            LOG_D("   Humidité #%d: %.2f %%", i, h);
             // Logique de secours si MQTT déconnecté
-            if (!wifi.isMqttConnected() || WiFi.status() != WL_CONNECTED) {
-                Serial.println("⚠️ MQTT déconnecté, activation logique de secours.");
+            if (mqttDown) {
+                if (!fallbackLogged) {
+                    LOG_W("⚠️ MQTT déconnecté, activation logique de secours.");
+                    fallbackLogged = true; // Une fois par trame, pas par sonde
+                }
                 if (irrigationManager) {
-                    irrigationManager->processSensorData(i, h);
+                    irrigationManager->processReading(nodeId, i, h);
                 }
             }
+            aggregator.addSample(nodeId, i - 1, h);
         }
     }
     
-    Serial.print("], ");
-
     // Imprimer la température 
     if (!sensorsObj["temp"].isNull()) {
-        Serial.print(temp, 2);
-        Serial.print("°C ");
+        LOG_D("   Temp: %.2f °C", temp);
     } else {
-        Serial.print("Temp: N/A ");
+        LOG_D("   Temp: N/A");
     }
 
     // --- TÉLÉMÉTRIE + FILE D'ATTENTE ---
-    char telemetryPayload[MAX_PAYLOAD_SIZE];
-    serializeJson(jsonDoc, telemetryPayload, sizeof(telemetryPayload));
-    int payloadLen = strlen(telemetryPayload);
-
-    if (wifi.isMqttConnected()) {
-        if (wifi.publishTelemetry(telemetryPayload, payloadLen)) {
-            Serial.println("→ 📡 Télémétrie transférée au serveur MQTT.");
-        } else {
-            Serial.println("→ ❌ Erreur envoi télémétrie (MQTT connecté).");
+    if (aggregator.isEnabled()) {
+        // Seuls les agrégats périodiques remontent au serveur
+        if (!sensorsObj["temp"].isNull()) {
+            aggregator.addSample(nodeId, AGG_TEMP_CHANNEL, temp);
         }
+        LOG_D("→ 📊 Échantillons ajoutés à l'agrégation.");
     } else {
-        Serial.println("→ 📦 MQTT déconnecté. Mise en file d'attente du message.");
-        if (telemetryQueue.size() < MAX_QUEUE_SIZE) {
-            telemetryQueue.push_back(std::string(telemetryPayload));
-        } else {
-            Serial.println("→ ⚠️ File d'attente pleine. Message de télémétrie perdu !");
+        size_t frameLen = buildTelemetryFrame(sender, data, len);
+        if (frameLen == 0) {
+            LOG_W("→ ❌ Trame de télémétrie trop grande, message ignoré.");
+            return;
         }
+        publishOrQueue(telemetryFrame, frameLen);
     }
 
     // Afficher le mode de communication
     if (sender.mode == CommMode::ESP_NOW) {
-        Serial.print("via [ESP-NOW]: ");
-        for (int i = 0; i < 6; i++) {
-            if (sender.macAddress[i] < 0x10) Serial.print("0");
-            Serial.print(sender.macAddress[i], HEX);
-            if (i < 5) Serial.print(":");
-        }
-        Serial.println();
+        LOG_D("via [ESP-NOW]: %02X:%02X:%02X:%02X:%02X:%02X", sender.macAddress[0], sender.macAddress[1],
+              sender.macAddress[2], sender.macAddress[3], sender.macAddress[4], sender.macAddress[5]);
     } else if (sender.mode == CommMode::LORA) {
-        Serial.print("via [LORA]: 0x");
-        Serial.println(sender.loraAddress, HEX);
+        LOG_D("via [LORA]: 0x%X", sender.loraAddress);
     }
 
     
+    // --- PLAN TDMA ---
+    int slot = slotScheduler.registerNode(sender, millis());
+
     // --- SYNCHRO HORAIRE ---
     if (wifi.isTimeSynced()) {
-        StaticJsonDocument<128> replyDoc;
+        JsonDocument replyDoc(&txPool);
         replyDoc["type"] = "timeSync";
         replyDoc["epoch"] = wifi.getEpochTime();
+        if (slot >= 0) {
+            // Décalage du créneau d'émission dans la fenêtre de reporting
+            replyDoc["slotMs"] = slotScheduler.slotOffsetMs(slot);
+        }
         
         char replyJson[128];
         serializeJson(replyDoc, replyJson);
         
-        Serial.print("⏰ Envoi de la synchro horaire au Follower...");
-        
         if (comms.sendDataToSender(sender, replyJson)) {
-            Serial.println(" ✅ OK.");
+            LOG_D("⏰ Synchro horaire envoyée au Follower ✅");
         } else {
-            Serial.println(" ❌ Échec.");
+            LOG_W("⏰ Envoi de la synchro horaire au Follower ❌ Échec.");
         }
     } else {
-        Serial.println("⚠️ Heure du Master non synchronisée, pas de réponse.");
+        LOG_W("⚠️ Heure du Master non synchronisée, pas de réponse.");
     }
 }
 
@@ -230,7 +446,7 @@ void Master::onMqttCommandReceived(char* topic, byte* payload, unsigned int leng
     Serial.print("📩 Commande MQTT reçue sur le topic: ");
     Serial.println(topic);
 
-    StaticJsonDocument<256> cmdDoc;
+    JsonDocument cmdDoc(&cmdPool);
     DeserializationError error = deserializeJson(cmdDoc, payload, length);
 
     if (error) {
@@ -239,6 +455,46 @@ void Master::onMqttCommandReceived(char* topic, byte* payload, unsigned int leng
         return;
     }
 
+    // Table de programmes complète : un seul message remplace tous les allers-retours
+    const char* type = cmdDoc["type"];
+    if (type != nullptr && strcmp(type, "programs") == 0) {
+        programScheduler->loadFromJson(cmdDoc.as<JsonObjectConst>());
+        return;
+    }
+
+    // Mise à jour de configuration (JSON merge patch) :
+    // {"type": "config", "patch": {"logic": {"humidity_thresholdMin": 35}}, "node": "NODE_x"}
+    if (type != nullptr && strcmp(type, "config") == 0) {
+        JsonObjectConst patch = cmdDoc["patch"];
+        const char* target = cmdDoc["node"];
+        if (patch.isNull()) {
+            publishConfigAck(false, 0, "missing patch");
+        } else if (target != nullptr && config.identity.nodeId != target) {
+            if (!forwardConfigPatch(target, patch)) {
+                publishConfigAck(false, 0, "forward failed");
+            }
+        } else {
+            handleConfigPatch(patch);
+        }
+        return;
+    }
+
+    // Diffusion d'une image déjà présente sur le SPIFFS du Master :
+    // {"type": "ota", "kind": "firmware", "file": "/fw.bin", "nodes": ["NODE_1", "NODE_2"]}
+    // {"type": "ota", "action": "abort"}
+    if (type != nullptr && strcmp(type, "ota") == 0) {
+        startOta(cmdDoc.as<JsonObjectConst>());
+        return;
+    }
+
+    // Commande destinée à un Follower qui pilote ses propres vannes :
+    // {"node": "NODE_x", "valve": 1, "action": "open", "duration": 30000, "hold": 600000}
+    const char* node = cmdDoc["node"];
+    if (node != nullptr && config.identity.nodeId != node) {
+        forwardValveCommand(node, cmdDoc.as<JsonObjectConst>());
+        return;
+    }
+
     // Format attendu: {"valve": 1, "action": "open", "duration": 30000}
     int valve_num = cmdDoc["valve"];
     const char* action = cmdDoc["action"];
@@ -249,11 +505,12 @@ void Master::onMqttCommandReceived(char* topic, byte* payload, unsigned int leng
         return;
     }
 
-    // Sélectionner la bonne vanne
+    // Sélectionner la bonne vanne : valveArray est indexé par numéro de vanne
+    // (emplacements vides possibles), numValves ne compte que les vannes allouées
     Electrovanne* targetValve = nullptr;
     size_t index = valve_num - 1;
 
-    if (index < numValves) {
+    if (valve_num >= 1 && index < MAX_VALVES) {
         targetValve = valveArray[index];
     }
 
@@ -269,13 +526,269 @@ void Master::onMqttCommandReceived(char* topic, byte* payload, unsigned int leng
         Serial.print(" pour ");
         Serial.print(duration);
         Serial.println("ms");
-        targetValve->open(duration);
+        valveScheduler->request(valve_num, duration, VALVE_PRIORITY_MANUAL);
     } 
     else if (strcmp(action, "close") == 0) {
         Serial.print("✅ Commande: Fermeture Vanne ");
         Serial.println(valve_num);
-        targetValve->close();
+        valveScheduler->release(valve_num);
+    }
+}
+
+void Master::publishOrQueue(const char* payload, size_t len) {
+    // File non vide : la trame passe derrière, l'ordre d'arrivée est conservé
+    if (wifi.isMqttConnected() && queueCount == 0) {
+        if (wifi.publishTelemetry(payload, len)) {
+            Metrics::inc(MC_MQTT_PUBLISHED);
+            LOG_D("→ 📡 Télémétrie transférée au serveur MQTT.");
+        } else {
+            LOG_E("→ ❌ Erreur envoi télémétrie (MQTT connecté).");
+        }
+    } else {
+        LOG_I("→ 📦 MQTT déconnecté ou file en cours de vidage. Mise en file d'attente du message.");
+        if (len > QUEUED_FRAME_SIZE) {
+            Metrics::inc(MC_MQTT_DROPPED);
+            LOG_W("→ ⚠️ Message trop grand pour la file (%u octets), perdu !", (unsigned)len);
+        } else if (queueCount < MAX_QUEUE_SIZE) {
+            QueuedFrame& frame = telemetryQueue[(queueHead + queueCount) % MAX_QUEUE_SIZE];
+            memcpy(frame.data, payload, len);
+            frame.len = (uint16_t)len;
+            queueCount++;
+        } else {
+            Metrics::inc(MC_MQTT_DROPPED);
+            LOG_W("→ ⚠️ File d'attente pleine. Message de télémétrie perdu !");
+        }
+    }
+}
+
+size_t Master::buildTelemetryFrame(const SenderInfo& sender, const uint8_t* data, int len) {
+    // Ignorer un éventuel '\0' final envoyé par le Follower
+    while (len > 0 && data[len - 1] == '\0') {
+        len--;
+    }
+    if (len <= 0) {
+        return 0;
+    }
+
+    size_t pos = 0;
+    if (config.network.telemetry_envelope) {
+        // Enveloppe : {"src":"AA:BB:CC:DD:EE:FF","rx":<epoch>,"msg":<octets d'origine>}
+        char src[18];
+        if (sender.mode == CommMode::ESP_NOW && sender.macAddress != nullptr) {
+            const uint8_t* m = sender.macAddress;
+            snprintf(src, sizeof(src), "%02X:%02X:%02X:%02X:%02X:%02X",
+                     m[0], m[1], m[2], m[3], m[4], m[5]);
+        } else {
+            snprintf(src, sizeof(src), "lora:%u", sender.loraAddress);
+        }
+        uint32_t rx = wifi.isTimeSynced() ? wifi.getEpochTime() : 0;
+        int n = snprintf(telemetryFrame, sizeof(telemetryFrame),
+                         "{\"src\":\"%s\",\"rx\":%lu,\"msg\":", src, (unsigned long)rx);
+        if (n < 0) {
+            return 0;
+        }
+        pos = (size_t)n;
+    }
+
+    size_t tail = config.network.telemetry_envelope ? 1 : 0;
+    if (pos + (size_t)len + tail >= sizeof(telemetryFrame)) {
+        return 0;
+    }
+
+    memcpy(telemetryFrame + pos, data, len);
+    pos += len;
+    if (tail) {
+        telemetryFrame[pos++] = '}';
+    }
+    telemetryFrame[pos] = '\0';
+    return pos;
+}
+
+void Master::sendTimeBeacon() {
+    if (!wifi.isTimeSynced()) {
+        return;
+    }
+    JsonDocument beaconDoc(&txPool);
+    beaconDoc["type"] = "beacon";
+    beaconDoc["t"] = wifi.getEpochMs();
+
+    char beaconJson[64];
+    serializeJson(beaconDoc, beaconJson);
+    if (!comms.broadcastData(beaconJson)) {
+        Serial.println("⚠️ Échec diffusion du beacon horaire.");
+    }
+}
+
+void Master::replyTimeRequest(const SenderInfo& sender, int64_t t1, int64_t t2) {
+    if (!wifi.isTimeSynced()) {
+        return;
+    }
+    JsonDocument replyDoc(&txPool);
+    replyDoc["type"] = "timeResp";
+    replyDoc["t1"] = t1;
+    replyDoc["t2"] = t2;
+    replyDoc["t3"] = wifi.getEpochMs(); // Au plus près de l'émission
+
+    char replyJson[128];
+    serializeJson(replyDoc, replyJson);
+    if (!comms.sendDataToSender(sender, replyJson)) {
+        Serial.println("⚠️ Échec réponse timeResp.");
+    }
+}
+
+bool Master::forwardValveCommand(const char* nodeId, JsonObjectConst cmd) {
+    SenderInfo target;
+    if (!nodeDirectory.lookup(nodeId, target)) {
+        Serial.print("❌ Nœud inconnu pour la commande de vanne: ");
+        Serial.println(nodeId);
+        return false;
+    }
+
+    JsonDocument fwdDoc(&txPool);
+    fwdDoc["type"] = "valveCmd";
+    fwdDoc["valve"] = cmd["valve"];
+    fwdDoc["action"] = cmd["action"];
+    fwdDoc["duration"] = cmd["duration"] | 0;
+    if (!cmd["hold"].isNull()) {
+        fwdDoc["hold"] = cmd["hold"];
+    }
+
+    char fwdJson[128];
+    serializeJson(fwdDoc, fwdJson);
+    bool ok = comms.sendDataToSender(target, fwdJson);
+    Serial.print(ok ? "✅ Commande de vanne transmise à " : "❌ Échec transmission commande de vanne à ");
+    Serial.println(nodeId);
+    return ok;
+}
+
+void Master::handleConfigPatch(JsonObjectConst patch) {
+    if (ConfigUpdate::hasStaged()) {
+        publishConfigAck(false, 0, "update pending");
+        return;
+    }
+    uint32_t changes = 0;
+    String error;
+    if (!ConfigUpdate::stage(patch, changes, error)) {
+        Serial.print("❌ Patch de configuration refusé: ");
+        Serial.println(error);
+        publishConfigAck(false, 0, error.c_str());
+        return;
+    }
+    Serial.print("🔧 Patch de configuration accepté (changements 0x");
+    Serial.print(changes, HEX);
+    Serial.println("), application au prochain tour de boucle.");
+    publishConfigAck(true, changes, nullptr);
+}
+
+void Master::applyConfigChanges(uint32_t changes) {
+    // Planning, budget hydraulique et paramètres "OTHER" sont relus par référence : rien à faire
+    if (changes & CFG_CHANGED_REBOOT) {
+        // LED, fenêtre TDMA, période d'agrégation : fixées à la construction des modules
+        restartAtMs = millis() + 1000; // Laisse partir l'acquittement MQTT
+        return;
+    }
+    if (changes & CFG_CHANGED_RADIO) {
+        // L'acquittement part par MQTT : la radio peut repartir tout de suite.
+        // Les peers ESP-NOW sont réajoutés au premier envoi vers chaque Follower.
+        if (!comms.restart(config.network, config.pins, config.identity.isMaster)) {
+            Serial.println("❌ Radio indisponible avec la nouvelle configuration.");
+        }
+        EventLoop::wakeIn(radioTask, 0);
+    }
+    if (changes & CFG_CHANGED_VALVES) {
+        Serial.println("🔧 Réinitialisation des vannes...");
+        destroyValves();
+        createValves();
+        for (size_t i = 0; i < MAX_VALVES; ++i) {
+            if (valveArray[i] != nullptr) {
+                valveArray[i]->begin();
+            }
+        }
+        programScheduler->begin();
+    } else if (changes & CFG_CHANGED_IRRIGATION) {
+        irrigationManager->resetZones(); // Découpage des sondes peut-être différent
+    }
+    if (changes & CFG_CHANGED_WIFI) {
+        Serial.println("🔧 Reconnexion Wi-Fi / MQTT avec la nouvelle configuration...");
+        wifi.end();
+        wifiReady = false;
+        lastWifiAttempt = millis() - WIFI_RETRY_INTERVAL_MS; // Tentative immédiate
+    }
+}
+
+void Master::publishConfigAck(bool ok, uint32_t changes, const char* error) {
+    JsonDocument ackDoc(&txPool);
+    ackDoc["type"] = "configAck";
+    ackDoc["identity"]["nodeId"] = config.identity.nodeId.c_str();
+    ackDoc["ok"] = ok;
+    if (ok) {
+        ackDoc["changes"] = changes;
+        ackDoc["reboot"] = (changes & CFG_CHANGED_REBOOT) != 0;
+    } else {
+        ackDoc["error"] = error;
+    }
+    char ackJson[192];
+    size_t n = serializeJson(ackDoc, ackJson, sizeof(ackJson));
+    publishOrQueue(ackJson, n);
+}
+
+bool Master::forwardConfigPatch(const char* nodeId, JsonObjectConst patch) {
+    SenderInfo target;
+    if (!nodeDirectory.lookup(nodeId, target)) {
+        Serial.print("❌ Nœud inconnu pour le patch de configuration: ");
+        Serial.println(nodeId);
+        return false;
+    }
+
+    JsonDocument fwdDoc(&txPool);
+    fwdDoc["type"] = "config";
+    fwdDoc["patch"] = patch;
+
+    // Le patch doit tenir dans une trame radio
+    char fwdJson[MAX_PAYLOAD_SIZE];
+    if (fwdDoc.overflowed() || measureJson(fwdDoc) >= sizeof(fwdJson)) {
+        Serial.println("❌ Patch trop grand pour une trame radio.");
+        return false;
+    }
+    serializeJson(fwdDoc, fwdJson, sizeof(fwdJson));
+    bool ok = comms.sendDataToSender(target, fwdJson);
+    Serial.print(ok ? "✅ Patch de configuration transmis à " : "❌ Échec transmission patch de configuration à ");
+    Serial.println(nodeId);
+    return ok;
+}
+
+void Master::startOta(JsonObjectConst cmd) {
+    const char* action = cmd["action"];
+    if (action != nullptr && strcmp(action, "abort") == 0) {
+        ota.abort();
+        return;
+    }
+
+    const char* file = cmd["file"];
+    const char* kind = cmd["kind"] | "firmware";
+    if (file == nullptr) {
+        Serial.println("❌ Commande OTA invalide: 'file' manquant.");
+        return;
     }
+
+    // Sans liste explicite : tous les Followers connus de l'annuaire
+    const char* nodes[OTA_MAX_TARGETS];
+    uint8_t count = 0;
+    JsonArrayConst list = cmd["nodes"];
+    if (!list.isNull()) {
+        for (JsonVariantConst v : list) {
+            const char* id = v.as<const char*>();
+            if (id != nullptr && count < OTA_MAX_TARGETS) {
+                nodes[count++] = id;
+            }
+        }
+    } else {
+        for (size_t i = 0; i < nodeDirectory.count() && count < OTA_MAX_TARGETS; i++) {
+            nodes[count++] = nodeDirectory.nodeIdAt(i);
+        }
+    }
+
+    ota.start(strcmp(kind, "config") == 0 ? OtaKind::CONFIG : OtaKind::FIRMWARE, file, nodes, count);
 }
 
 CommManager* Master::getCommManager() {
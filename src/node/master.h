@@ -4,10 +4,22 @@
 #include "comms/CommManager.h"
 #include "actuators/Electrovanne.h"
 #include "comms/WifiManager.h"
+#include "comms/NodeDirectory.h"
+#include "comms/OtaSender.h"
 #include "ConfigLoader.h"
+#include "ConfigUpdate.h"
 #include "logic/IrrigationManager.h"
-#include <vector>
-#include <string>
+#include "logic/SlotScheduler.h"
+#include "logic/ProgramScheduler.h"
+#include "logic/TelemetryAggregator.h"
+#include "logic/AggKernel.h"
+#include "logic/ValveTimer.h"
+#include "logic/ValveScheduler.h"
+#include "logic/EventLoop.h"
+#include "Log.h"
+#include "logic/Metrics.h"
+#include "BootTrace.h"
+#include "JsonPool.h"
 #define MAX_VALVES 20
 
 class Master {
@@ -27,6 +39,7 @@ private:
     float lastReceivedHumidity;
     Electrovanne* valveArray[MAX_VALVES] = {nullptr};
     size_t numValves = 0;
+    ValveTimer valveTimer;            // Fermetures automatiques de toutes les vannes
     
 
 
@@ -34,11 +47,54 @@ private:
 
  
     IrrigationManager* irrigationManager;
+    ProgramScheduler* programScheduler;
+    ValveScheduler* valveScheduler;   // Arbitre des ouvertures (simultanéité, débit)
+    TelemetryAggregator aggregator;
+    SlotScheduler slotScheduler;
+    NodeDirectory nodeDirectory;      // nodeId -> adresse, pour les commandes descendantes
+    OtaSender ota;                    // Diffusion d'images (config, firmware) aux Followers
+    int8_t loopTask = -1;             // Tâche de la boucle événementielle
+    int8_t radioTask = -1;
+    static constexpr uint32_t LOOP_POLL_MS = 20;        // Client MQTT interrogé (pas d'événement)
+    static constexpr uint32_t LOOP_BUDGET_US = 50000;
+    void scheduleWake();
 
+    unsigned long lastMetricsMs = 0;
+    void publishMetrics();
+    unsigned long lastSlotExpiryCheck = 0;
+    static constexpr unsigned long SLOT_EXPIRY_CHECK_MS = 60UL * 1000UL;
+    unsigned long lastBeaconTime = 0;
 
-    StaticJsonDocument<MAX_PAYLOAD_SIZE> jsonDoc;
-    std::vector<std::string> telemetryQueue;
-    const size_t MAX_QUEUE_SIZE = 20; 
+
+    // Documents JSON sur pools fixes (aucune allocation sur le tas en régime établi).
+    // Un pool par usage : une commande MQTT peut émettre des trames pendant qu'elle est lue.
+    // Tailles minimales : un bloc de variants ArduinoJson fait jusqu'à 2 Ko (v7.0, 32 bits).
+    JsonPool<3072> rxPool;              // Trames radio reçues (parsing filtré)
+    JsonPool<8192> cmdPool;             // Commandes MQTT (jusqu'à MQTT_BUFFER_SIZE octets)
+    JsonPool<3072> txPool;              // Messages construits (métriques, synchro, acquittements)
+    JsonDocument jsonDoc;
+    JsonDocument telemetryFilter;       // Construit une fois au démarrage
+
+    // Tampon de publication : enveloppe optionnelle + octets reçus
+    static constexpr size_t MAX_TELEMETRY_FRAME = MAX_PAYLOAD_SIZE + 64;
+    char telemetryFrame[MAX_TELEMETRY_FRAME];
+
+    // File hors ligne (MQTT déconnecté) : anneau de trames de taille fixe, vidé
+    // par une tâche de la boucle à raison d'une trame toutes les TELEMETRY_DRAIN_MS
+    static constexpr uint8_t MAX_QUEUE_SIZE = 20;
+    static constexpr size_t QUEUED_FRAME_SIZE = 384;    // Trame transférée, agrégat ou acquittement
+    static constexpr uint32_t TELEMETRY_DRAIN_MS = 100;
+    static_assert(QUEUED_FRAME_SIZE >= MAX_TELEMETRY_FRAME, "trame transférée hors file");
+    struct QueuedFrame {
+        uint16_t len;
+        char data[QUEUED_FRAME_SIZE];
+    };
+    QueuedFrame telemetryQueue[MAX_QUEUE_SIZE];
+    uint8_t queueHead = 0;              // Plus ancienne trame
+    uint8_t queueCount = 0;
+    int8_t drainTask = -1;
+    bool drainScheduled = false;        // Tâche de vidage armée
+    void drainTelemetryQueue();
 
     unsigned long lastWifiAttempt = 0;
     static constexpr unsigned long WIFI_RETRY_INTERVAL_MS = 10UL * 60UL * 1000UL; // 10 minutes
@@ -47,6 +103,31 @@ private:
     
     void onDataReceived(const SenderInfo& sender, const uint8_t* data, int len);
 
+    /**
+     * @brief Construit la trame MQTT dans telemetryFrame à partir des octets reçus.
+     * @return La longueur de la trame, 0 si elle ne tient pas dans le tampon.
+     */
+    size_t buildTelemetryFrame(const SenderInfo& sender, const uint8_t* data, int len);
+
+    void publishOrQueue(const char* payload, size_t len);
+    void sendTimeBeacon();
+    void replyTimeRequest(const SenderInfo& sender, int64_t t1, int64_t t2);
+    bool forwardValveCommand(const char* nodeId, JsonObjectConst cmd);
+    bool forwardConfigPatch(const char* nodeId, JsonObjectConst patch);
+    void startOta(JsonObjectConst cmd);
+
+    // Mise à jour de configuration à chaud
+    unsigned long restartAtMs = 0;     // Redémarrage différé (0 = aucun)
+    void handleConfigPatch(JsonObjectConst patch);
+    void applyConfigChanges(uint32_t changes);
+    void publishConfigAck(bool ok, uint32_t changes, const char* error);
+
+    /**
+     * @brief Alloue les vannes et les modules qui en dépendent à partir de la config.
+     */
+    void createValves();
+    void destroyValves();
+
     
 
     void onMqttCommandReceived(char* topic, byte* payload, unsigned int length);
@@ -0,0 +1,117 @@
+#include "SensorSampler.h"
+#include "logic/EventLoop.h"
+
+SensorSampler::SensorSampler(SoilAcquisition& acquisition, uint32_t periodMs)
+    : _acquisition(acquisition),
+      _numChannels(0),
+      _periodMs(periodMs),
+      _timer(nullptr),
+      _due(false),
+      _head(0),
+      _size(0),
+      _sinceReport(0) {}
+
+void SensorSampler::begin(uint8_t numChannels) {
+    _numChannels = numChannels;
+    if (!isEnabled()) {
+        return;
+    }
+    esp_timer_create_args_t args = {};
+    args.callback = &SensorSampler::onTimer;
+    args.arg = this;
+    args.name = "sampler";
+    if (esp_timer_create(&args, &_timer) != ESP_OK ||
+        esp_timer_start_periodic(_timer, (uint64_t)_periodMs * 1000ULL) != ESP_OK) {
+        Serial.println("❌ Échantillonneur: échec création du timer.");
+        _periodMs = 0;
+        return;
+    }
+    Serial.print("Échantillonneur: une acquisition toutes les ");
+    Serial.print(_periodMs);
+    Serial.println(" ms.");
+}
+
+void SensorSampler::onTimer(void* arg) {
+    // Contexte timer : on se contente de lever le drapeau, l'acquisition
+    // (alimentation + stabilisation des sondes) se fait dans la loop().
+    static_cast<SensorSampler*>(arg)->_due = true;
+    EventLoop::post(EVT_SENSOR);
+}
+
+bool SensorSampler::update() {
+    if (!_due) {
+        return false;
+    }
+    _due = false;
+
+    float values[MAX_SOIL_SENSORS];
+    uint8_t n = _acquisition.acquire(values);
+    for (uint8_t ch = 0; ch < _numChannels; ch++) {
+        float v = (ch < n) ? values[ch] : 0.0f;
+        _values[ch][_head] = (int16_t)lroundf(v * 100.0f);
+    }
+    _timesMs[_head] = millis();
+
+    _head = (_head + 1) % SAMPLER_CAPACITY;
+    if (_size < SAMPLER_CAPACITY) _size++;
+    if (_sinceReport < SAMPLER_CAPACITY) _sinceReport++;
+    return true;
+}
+
+uint16_t SensorSampler::indexFromOldest(uint16_t i, uint16_t n) const {
+    // i-ème des n derniers échantillons (0 = le plus ancien)
+    return (_head + SAMPLER_CAPACITY - n + i) % SAMPLER_CAPACITY;
+}
+
+bool SensorSampler::summarize(uint8_t channel, SampleSummary& out) const {
+    uint16_t n = _sinceReport;
+    if (channel >= _numChannels || n == 0) {
+        return false;
+    }
+
+    // Min / max / moyenne + régression linéaire valeur = f(temps)
+    uint32_t t0 = _timesMs[indexFromOldest(0, n)];
+    int16_t mn = INT16_MAX, mx = INT16_MIN;
+    float sumV = 0, sumT = 0, sumTT = 0, sumTV = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        uint16_t idx = indexFromOldest(i, n);
+        int16_t v = _values[channel][idx];
+        float t = (_timesMs[idx] - t0) / 60000.0f; // minutes
+        if (v < mn) mn = v;
+        if (v > mx) mx = v;
+        sumV += v;
+        sumT += t;
+        sumTT += t * t;
+        sumTV += t * v;
+    }
+
+    out.count = n;
+    out.min = mn / 100.0f;
+    out.max = mx / 100.0f;
+    out.mean = sumV / n / 100.0f;
+    float denom = n * sumTT - sumT * sumT;
+    out.slopePerMin = (n > 1 && denom > 0.0f) ? (n * sumTV - sumT * sumV) / denom / 100.0f : 0.0f;
+    return true;
+}
+
+uint8_t SensorSampler::lastRaw(uint8_t channel, float* out, uint8_t n) const {
+    if (channel >= _numChannels) {
+        return 0;
+    }
+    if (n > _size) n = _size;
+    for (uint8_t i = 0; i < n; i++) {
+        out[i] = _values[channel][indexFromOldest(i, n)] / 100.0f;
+    }
+    return n;
+}
+
+float SensorSampler::latest(uint8_t channel) const {
+    if (channel >= _numChannels || _size == 0) {
+        return NAN;
+    }
+    return _values[channel][(_head + SAMPLER_CAPACITY - 1) % SAMPLER_CAPACITY] / 100.0f;
+}
+
+void SensorSampler::markReported() {
+    _sinceReport = 0;
+}
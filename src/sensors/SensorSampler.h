@@ -0,0 +1,77 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "sensors/SoilAcquisition.h"
+
+#define SAMPLER_CAPACITY 128
+
+// Résumé d'un canal sur l'intervalle entre deux envois
+struct SampleSummary {
+    uint16_t count;
+    float min;
+    float max;
+    float mean;
+    float slopePerMin; // Pente (moindres carrés), en %/min
+};
+
+/**
+ * @brief Échantillonnage local à cadence fixe sur le Follower.
+ * Un timer matériel (esp_timer) cadence les acquisitions, qui remplissent un
+ * tampon circulaire ; chaque envoi transporte un résumé de l'intervalle
+ * (min, max, moyenne, pente) et éventuellement les dernières valeurs brutes.
+ */
+class SensorSampler {
+public:
+    SensorSampler(SoilAcquisition& acquisition, uint32_t periodMs);
+
+    /**
+     * @brief Démarre le timer d'échantillonnage.
+     * @param numChannels Nombre de sondes actives
+     */
+    void begin(uint8_t numChannels);
+    bool isEnabled() const { return _periodMs > 0 && _numChannels > 0; }
+    uint32_t periodMs() const { return _periodMs; }
+
+    /**
+     * @brief À appeler dans la loop() : effectue l'acquisition si le timer l'a demandée.
+     * @return true si un échantillon a été ajouté.
+     */
+    bool update();
+
+    /**
+     * @brief Résumé d'un canal depuis le dernier envoi.
+     */
+    bool summarize(uint8_t channel, SampleSummary& out) const;
+
+    /**
+     * @brief Copie les n dernières valeurs brutes (plus ancienne en premier).
+     * @return Nombre de valeurs copiées
+     */
+    uint8_t lastRaw(uint8_t channel, float* out, uint8_t n) const;
+
+    /**
+     * @brief Dernière valeur d'un canal (NAN si aucune).
+     */
+    float latest(uint8_t channel) const;
+
+    /**
+     * @brief Démarre un nouvel intervalle de résumé (après un envoi réussi).
+     */
+    void markReported();
+
+private:
+    SoilAcquisition& _acquisition;
+    uint8_t _numChannels;
+    uint32_t _periodMs;
+    esp_timer_handle_t _timer;
+    volatile bool _due;
+
+    int16_t _values[MAX_SOIL_SENSORS][SAMPLER_CAPACITY]; // Centièmes de %
+    uint32_t _timesMs[SAMPLER_CAPACITY];
+    uint16_t _head;       // Prochain emplacement d'écriture
+    uint16_t _size;       // Nombre d'échantillons valides
+    uint16_t _sinceReport; // Échantillons depuis le dernier envoi
+
+    static void onTimer(void* arg);
+    uint16_t indexFromOldest(uint16_t i, uint16_t n) const;
+};
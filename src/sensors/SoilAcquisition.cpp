@@ -0,0 +1,201 @@
+#include "SoilAcquisition.h"
+#include <algorithm>
+#include "Log.h"
+
+#if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32C3
+#include <driver/adc.h>
+#define SOIL_ADC_DMA 1
+#define SOIL_DMA_SAMPLE_HZ 20000
+#define SOIL_DMA_TIMEOUT_MS 50
+#endif
+
+SoilAcquisition::SoilAcquisition(uint16_t settleMs, uint8_t oversample)
+    : _numSensors(0),
+      _settleMs(settleMs),
+      _oversample(constrain(oversample, (uint8_t)1, (uint8_t)SOIL_MAX_OVERSAMPLE)),
+      _lastWallTimeUs(0),
+      _reportCycles(0),
+      _reportWallUs(0),
+      _reportedOnce(false)
+{
+    memset(_counts, 0, sizeof(_counts));
+    memset(_reportVariance, 0, sizeof(_reportVariance));
+}
+
+void SoilAcquisition::addSensor(SoilHumiditySensor* sensor) {
+    if (sensor != nullptr && _numSensors < MAX_SOIL_SENSORS) {
+        _sensors[_numSensors++] = sensor;
+    }
+}
+
+uint8_t SoilAcquisition::acquire(float* out) {
+    if (_numSensors == 0) {
+        return 0;
+    }
+    uint32_t start = micros();
+
+    // 1. Alimenter toutes les sondes, une seule fenêtre de stabilisation
+    for (uint8_t i = 0; i < _numSensors; i++) {
+        digitalWrite(_sensors[i]->powerPin(), HIGH);
+    }
+    delay(_settleMs);
+
+    // 2. Échantillonner tous les canaux
+    memset(_counts, 0, sizeof(_counts));
+    bool dmaOk = sampleDma();
+    for (uint8_t i = 0; i < _numSensors; i++) {
+        if (_counts[i] < _oversample) {
+            samplePolling(i); // Canal hors DMA (ADC2) ou DMA indisponible
+        }
+    }
+
+    for (uint8_t i = 0; i < _numSensors; i++) {
+        digitalWrite(_sensors[i]->powerPin(), LOW);
+    }
+    _lastWallTimeUs = micros() - start;
+
+    // 3. Réduction robuste, bruit cumulé pour le rapport
+    for (uint8_t i = 0; i < _numSensors; i++) {
+        float variance = 0.0f;
+        float raw = trimmedMean(i, &variance);
+        out[i] = _sensors[i]->rawToHumidity(raw);
+        _reportVariance[i] += variance;
+    }
+    _reportWallUs += _lastWallTimeUs;
+    _reportCycles++;
+    if (!_reportedOnce || _reportCycles >= SOIL_REPORT_EVERY) {
+        report(dmaOk);
+    }
+
+    return _numSensors;
+}
+
+void SoilAcquisition::report(bool dma) {
+    // Ancien chemin : une stabilisation par sonde, lectures uniques négligeables
+    LOG_I("🌱 Acquisition sol (%s, %u cycles): %.1f ms, ancien chemin séquentiel >= %u ms",
+          dma ? "DMA" : "polling", _reportCycles, _reportWallUs / 1000.0f / _reportCycles,
+          (unsigned)_numSensors * _settleMs);
+    for (uint8_t i = 0; i < _numSensors; i++) {
+        // Variance d'une lecture unique (ancien chemin) contre celle de la moyenne de _oversample lectures
+        float variance = _reportVariance[i] / _reportCycles;
+        LOG_I("   #%d variance %.1f -> %.2f", i + 1, variance, variance / _oversample);
+        _reportVariance[i] = 0.0f;
+    }
+    _reportCycles = 0;
+    _reportWallUs = 0;
+    _reportedOnce = true;
+}
+
+bool SoilAcquisition::sampleDma() {
+#if SOIL_ADC_DMA
+    uint16_t mask = 0;
+    int8_t channels[MAX_SOIL_SENSORS];
+    adc_digi_pattern_config_t pattern[MAX_SOIL_SENSORS];
+    uint8_t numPatterns = 0;
+
+    for (uint8_t i = 0; i < _numSensors; i++) {
+        channels[i] = digitalPinToAnalogChannel(_sensors[i]->sensorPin());
+        // Le mode continu n'est utilisé que pour l'ADC1
+        if (channels[i] < 0 || channels[i] >= SOC_ADC_MAX_CHANNEL_NUM) {
+            channels[i] = -1;
+            continue;
+        }
+        mask |= (1 << channels[i]);
+        pattern[numPatterns].atten = ADC_ATTEN_DB_11;
+        pattern[numPatterns].channel = channels[i];
+        pattern[numPatterns].unit = 0; // ADC1
+        pattern[numPatterns].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+        numPatterns++;
+    }
+    if (numPatterns == 0) {
+        return false;
+    }
+
+    const uint32_t frameBytes = (uint32_t)numPatterns * _oversample * SOC_ADC_DIGI_RESULT_BYTES;
+    adc_digi_init_config_t initCfg = {};
+    initCfg.max_store_buf_size = frameBytes * 2;
+    initCfg.conv_num_each_intr = frameBytes;
+    initCfg.adc1_chan_mask = mask;
+    initCfg.adc2_chan_mask = 0;
+    if (adc_digi_initialize(&initCfg) != ESP_OK) {
+        return false;
+    }
+
+    adc_digi_configuration_t digCfg = {};
+    digCfg.conv_limit_en = 0;
+    digCfg.conv_limit_num = 250;
+    digCfg.pattern_num = numPatterns;
+    digCfg.adc_pattern = pattern;
+    digCfg.sample_freq_hz = SOIL_DMA_SAMPLE_HZ;
+    digCfg.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    digCfg.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+    adc_digi_controller_configure(&digCfg);
+    adc_digi_start();
+
+    uint8_t buf[SOC_ADC_DIGI_RESULT_BYTES * MAX_SOIL_SENSORS * SOIL_MAX_OVERSAMPLE];
+    unsigned long t0 = millis();
+    bool done = false;
+    while (!done && millis() - t0 < SOIL_DMA_TIMEOUT_MS) {
+        uint32_t got = 0;
+        if (adc_digi_read_bytes(buf, frameBytes, &got, SOIL_DMA_TIMEOUT_MS) != ESP_OK) {
+            continue;
+        }
+        for (uint32_t b = 0; b + SOC_ADC_DIGI_RESULT_BYTES <= got; b += SOC_ADC_DIGI_RESULT_BYTES) {
+            const adc_digi_output_data_t* d = (const adc_digi_output_data_t*)&buf[b];
+            for (uint8_t i = 0; i < _numSensors; i++) {
+                if (channels[i] == (int8_t)d->type2.channel && _counts[i] < _oversample) {
+                    _samples[i][_counts[i]++] = d->type2.data;
+                }
+            }
+        }
+        done = true;
+        for (uint8_t i = 0; i < _numSensors; i++) {
+            if (channels[i] >= 0 && _counts[i] < _oversample) {
+                done = false;
+            }
+        }
+    }
+
+    adc_digi_stop();
+    adc_digi_deinitialize();
+    return done;
+#else
+    return false;
+#endif
+}
+
+void SoilAcquisition::samplePolling(uint8_t idx) {
+    uint8_t pin = _sensors[idx]->sensorPin();
+    while (_counts[idx] < _oversample) {
+        _samples[idx][_counts[idx]++] = analogRead(pin);
+    }
+}
+
+float SoilAcquisition::trimmedMean(uint8_t idx, float* variance) {
+    uint8_t n = _counts[idx];
+    uint16_t* s = _samples[idx];
+    std::sort(s, s + n);
+
+    // Moyenne tronquée : 25 % retirés de chaque côté
+    uint8_t lo = n / 4;
+    uint8_t hi = n - lo;
+    uint32_t sum = 0;
+    for (uint8_t i = lo; i < hi; i++) {
+        sum += s[i];
+    }
+    float mean = (float)sum / (hi - lo);
+
+    // Variance brute sur tous les échantillons (bruit du capteur)
+    float acc = 0.0f;
+    float fullMean = 0.0f;
+    for (uint8_t i = 0; i < n; i++) {
+        fullMean += s[i];
+    }
+    fullMean /= n;
+    for (uint8_t i = 0; i < n; i++) {
+        float d = s[i] - fullMean;
+        acc += d * d;
+    }
+    *variance = (n > 1) ? acc / (n - 1) : 0.0f;
+    return mean;
+}
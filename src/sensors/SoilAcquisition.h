@@ -0,0 +1,55 @@
+#pragma once
+#include <Arduino.h>
+#include "sensors/SoilHumiditySensor.h"
+#include "ConfigLoader.h" // MAX_SOIL_SENSORS
+
+#define SOIL_MAX_OVERSAMPLE 64
+#define SOIL_REPORT_EVERY 32 // Acquisitions résumées par rapport (LOG_I), plus la première après le démarrage
+
+/**
+ * @brief Acquisition groupée des sondes d'humidité.
+ * Toutes les sondes sont alimentées ensemble pour une seule fenêtre de
+ * stabilisation, puis chaque canal est suréchantillonné (ADC continu/DMA sur
+ * les canaux ADC1 quand la cible le permet, analogRead sinon) et réduit par
+ * une moyenne tronquée (25 % retirés de chaque côté).
+ * Un rapport périodique compare durée et bruit à l'ancien chemin (une sonde
+ * après l'autre, chacune avec sa stabilisation et une lecture unique).
+ */
+class SoilAcquisition {
+public:
+    SoilAcquisition(uint16_t settleMs, uint8_t oversample);
+
+    void addSensor(SoilHumiditySensor* sensor);
+
+    /**
+     * @brief Acquiert toutes les sondes.
+     * @param out Humidités (%) dans l'ordre d'ajout des sondes
+     * @return Nombre de valeurs écrites
+     */
+    uint8_t acquire(float* out);
+
+    uint32_t lastWallTimeUs() const { return _lastWallTimeUs; }
+
+private:
+    SoilHumiditySensor* _sensors[MAX_SOIL_SENSORS];
+    uint8_t _numSensors;
+    uint16_t _settleMs;
+    uint8_t _oversample;
+    uint32_t _lastWallTimeUs;
+
+    // Échantillons bruts par canal
+    uint16_t _samples[MAX_SOIL_SENSORS][SOIL_MAX_OVERSAMPLE];
+    uint8_t _counts[MAX_SOIL_SENSORS];
+
+    // Cumuls du rapport périodique
+    uint16_t _reportCycles;
+    uint32_t _reportWallUs;
+    float _reportVariance[MAX_SOIL_SENSORS]; // Variance d'un échantillon unique
+    bool _reportedOnce;
+
+    void report(bool dma);
+
+    bool sampleDma();
+    void samplePolling(uint8_t idx);
+    float trimmedMean(uint8_t idx, float* variance);
+};
@@ -11,13 +11,10 @@ void SoilHumiditySensor::begin() {
     digitalWrite(_powerPin, LOW);
 }
 
-float SoilHumiditySensor::read() {
-
-    digitalWrite(_powerPin, HIGH);
-    delay(50); 
-    int rawValue = analogRead(_sensorPin);
-    digitalWrite(_powerPin, LOW);
-    int humidity = map(rawValue, _dryValue, _wetValue, 0, 100);
-    humidity = constrain(humidity, 0, 100);
-    return (float)humidity;
+float SoilHumiditySensor::rawToHumidity(float raw) const {
+    if (_dryValue == _wetValue) {
+        return 0.0f;
+    }
+    float humidity = (raw - _dryValue) * 100.0f / ((float)_wetValue - (float)_dryValue);
+    return constrain(humidity, 0.0f, 100.0f);
 }
\ No newline at end of file
@@ -7,7 +7,15 @@ public:
     SoilHumiditySensor(uint8_t sensorPin, uint8_t powerPin, uint16_t dry, uint16_t wet);
     
     void begin();
-    float read();
+
+    /**
+     * @brief Convertit une valeur ADC (éventuellement moyennée) en humidité (%),
+     * sans l'arrondi entier de map().
+     */
+    float rawToHumidity(float raw) const;
+
+    uint8_t sensorPin() const { return _sensorPin; }
+    uint8_t powerPin() const { return _powerPin; }
 
 private:
     uint8_t _sensorPin;
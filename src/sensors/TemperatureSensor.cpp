@@ -1,21 +1,139 @@
 #include "TemperatureSensor.h"
+#include "logic/EventLoop.h"
 
+// Chronogramme DHT11 (datasheet)
+static constexpr uint32_t DHT_START_LOW_MS = 20;     // Impulsion de réveil (>= 18 ms)
+static constexpr uint32_t DHT_CAPTURE_MS = 10;       // Trame complète ~5 ms
+static constexpr uint32_t DHT_BIT_THRESHOLD_US = 100; // Période bit : ~78 µs (0) / ~120 µs (1)
+static constexpr uint32_t DHT_MIN_INTERVAL_MS = 1100; // Intervalle minimal entre deux lectures
+static constexpr uint32_t DHT_POWERUP_MS = 1000;      // Stabilisation après mise sous tension
 
-TemperatureSensor::TemperatureSensor(uint8_t pin)
-    : sensorPin(pin), dht(pin, DHT11) {}
+TemperatureSensor::TemperatureSensor(uint8_t pin, uint32_t refreshMs)
+    : sensorPin(pin), refreshMs(max(refreshMs, DHT_MIN_INTERVAL_MS)) {}
 
 void TemperatureSensor::begin() {
-    dht.begin();
+    pinMode(sensorPin, INPUT_PULLUP);
+    state = State::IDLE;
+    nextReadMs = millis() + DHT_POWERUP_MS;
 }
 
-float TemperatureSensor::read() {
+void IRAM_ATTR TemperatureSensor::onEdge(void* arg) {
+    TemperatureSensor* self = static_cast<TemperatureSensor*>(arg);
+    uint8_t n = self->edgeCount;
+    if (n < DHT_FRAME_EDGES) {
+        self->edges[n] = micros();
+        self->edgeCount = n + 1;
+        if (n + 1 == DHT_FRAME_EDGES) {
+            EventLoop::postFromISR(EVT_SENSOR); // Trame complète : décodage sans attendre
+        }
+    }
+}
+
+void TemperatureSensor::update() {
+    unsigned long now = millis();
+
+    switch (state) {
+    case State::IDLE:
+        if ((long)(now - nextReadMs) >= 0) {
+            // Impulsion de réveil : ligne tirée à l'état bas, sans bloquer
+            pinMode(sensorPin, OUTPUT);
+            digitalWrite(sensorPin, LOW);
+            stateMs = now;
+            state = State::START_LOW;
+        }
+        break;
+
+    case State::START_LOW:
+        if (now - stateMs >= DHT_START_LOW_MS) {
+            // Relâcher la ligne et horodater les fronts de la réponse
+            edgeCount = 0;
+            pinMode(sensorPin, INPUT_PULLUP);
+            attachInterruptArg(digitalPinToInterrupt(sensorPin), onEdge, this, FALLING);
+            stateMs = now;
+            state = State::CAPTURE;
+        }
+        break;
+
+    case State::CAPTURE:
+        if (edgeCount >= DHT_FRAME_EDGES || now - stateMs >= DHT_CAPTURE_MS) {
+            detachInterrupt(digitalPinToInterrupt(sensorPin));
+            float t = NAN;
+            bool ok = decode(t);
+            finishAttempt(ok, t);
+        }
+        break;
+    }
+}
+
+uint32_t TemperatureSensor::msUntilNext() const {
+    unsigned long now = millis();
+    uint32_t elapsed = now - stateMs;
+    switch (state) {
+    case State::IDLE:
+        return (long)(now - nextReadMs) >= 0 ? 0 : nextReadMs - now;
+    case State::START_LOW:
+        return elapsed >= DHT_START_LOW_MS ? 0 : DHT_START_LOW_MS - elapsed;
+    case State::CAPTURE:
+        return elapsed >= DHT_CAPTURE_MS ? 0 : DHT_CAPTURE_MS - elapsed;
+    }
+    return 0;
+}
+
+bool TemperatureSensor::decode(float& temperature) {
+    if (edgeCount < DHT_FRAME_EDGES) {
+        return false;
+    }
+
+    // edges[0] = début de la réponse, edges[1..41] = début de chaque bit puis fin de trame
+    uint8_t bytes[5] = {0, 0, 0, 0, 0};
+    for (uint8_t bit = 0; bit < 40; bit++) {
+        uint32_t period = edges[bit + 2] - edges[bit + 1];
+        bytes[bit / 8] <<= 1;
+        if (period > DHT_BIT_THRESHOLD_US) {
+            bytes[bit / 8] |= 1;
+        }
+    }
+
+    uint8_t sum = bytes[0] + bytes[1] + bytes[2] + bytes[3];
+    if (sum != bytes[4]) {
+        return false;
+    }
+
+    // DHT11 : partie entière + dixièmes, bit 7 des dixièmes = signe
+    temperature = bytes[2] + (bytes[3] & 0x0F) * 0.1f;
+    if (bytes[3] & 0x80) {
+        temperature = -temperature;
+    }
+    return true;
+}
+
+void TemperatureSensor::finishAttempt(bool ok, float temperature) {
+    unsigned long now = millis();
+    state = State::IDLE;
 
-    float t = dht.readTemperature();
-    
-    if (isnan(t)) {
-        Serial.println("Erreur de lecture du capteur DHT11 !");
-        return NAN;
+    if (ok) {
+        cachedTemp = temperature;
+        cachedAtMs = now;
+        valid = true;
+        consecutiveFailures = 0;
+        nextReadMs = now + refreshMs;
+        return;
     }
-    
-    return t;
-}
\ No newline at end of file
+
+    // Échec : nouvel essai au plus tôt, le cache précédent reste disponible
+    consecutiveFailures++;
+    nextReadMs = now + DHT_MIN_INTERVAL_MS;
+    if (consecutiveFailures == 1 || consecutiveFailures % 10 == 0) {
+        Serial.print("Erreur de lecture du capteur DHT11 ! (");
+        Serial.print(consecutiveFailures);
+        Serial.println(" échec(s) consécutif(s))");
+    }
+}
+
+float TemperatureSensor::read() const {
+    return valid ? cachedTemp : NAN;
+}
+
+uint32_t TemperatureSensor::ageMs() const {
+    return valid ? (uint32_t)(millis() - cachedAtMs) : UINT32_MAX;
+}
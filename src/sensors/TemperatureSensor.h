@@ -1,23 +1,63 @@
 #pragma once
 #include <Arduino.h>
-#include <DHT.h>
 
+// Nombre de fronts descendants d'une trame DHT11 : réponse + 40 bits + fin
+#define DHT_FRAME_EDGES 42
+
+/**
+ * @brief Pilote DHT11 asynchrone.
+ *
+ * La trame est capturée par interruption (horodatage micros() des fronts
+ * descendants) au lieu d'être lue en boucle active interruptions coupées.
+ * update() fait avancer la machine à états ; read() renvoie instantanément
+ * la dernière valeur valide en cache.
+ */
 class TemperatureSensor {
 public:
     /**
-     * @brief 
-     * @param pin 
+     * @brief
+     * @param pin Broche DATA du DHT11
+     * @param refreshMs Période de rafraîchissement du cache
      */
-    TemperatureSensor(uint8_t pin);
+    TemperatureSensor(uint8_t pin, uint32_t refreshMs = 10000);
     void begin();
-    
+
+    /**
+     * @brief Fait avancer la machine à états (à appeler dans la boucle)
+     */
+    void update();
+
     /**
-     * @brief 
-     * @return 
+     * @brief Dernière température valide, sans attente
+     * @return °C, ou NAN si aucune mesure valide
      */
-    float read(); 
+    float read() const;
+
+    bool isValid() const { return valid; }
+    uint32_t ageMs() const;            // Âge de la valeur en cache (UINT32_MAX si aucune)
+    uint16_t failures() const { return consecutiveFailures; }
+    bool isBusy() const { return state != State::IDLE; } // Mesure en cours (ne pas dormir)
+    uint32_t msUntilNext() const;      // Délai avant la prochaine transition de la machine à états
 
 private:
+    enum class State { IDLE, START_LOW, CAPTURE };
+
     uint8_t sensorPin;
-    DHT dht; 
-};
\ No newline at end of file
+    uint32_t refreshMs;
+    State state = State::IDLE;
+    unsigned long stateMs = 0;         // Entrée dans l'état courant (ms)
+    unsigned long nextReadMs = 0;
+
+    float cachedTemp = NAN;
+    bool valid = false;
+    unsigned long cachedAtMs = 0;
+    uint16_t consecutiveFailures = 0;
+
+    // Capture sous interruption
+    volatile uint32_t edges[DHT_FRAME_EDGES];
+    volatile uint8_t edgeCount = 0;
+
+    static void IRAM_ATTR onEdge(void* arg);
+    bool decode(float& temperature);
+    void finishAttempt(bool ok, float temperature);
+};
@@ -0,0 +1,127 @@
+#pragma once
+// Substitut minimal du cœur Arduino pour les essais hors cible ([env:native]).
+// Horloge virtuelle : millis()/micros() n'avancent que par delay() ou advanceMs().
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+using std::isnan;
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define HEX 16
+#define DEC 10
+
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define IRAM_ATTR
+
+// --- FreeRTOS : types seulement (la boucle événementielle n'est pas exécutée) ---
+typedef void* TaskHandle_t;
+typedef struct { int owner; } portMUX_TYPE;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// --- Horloge virtuelle ---
+inline uint64_t& virtualClockUs() {
+    static uint64_t us = 0;
+    return us;
+}
+inline void setMillis(uint32_t ms) { virtualClockUs() = (uint64_t)ms * 1000ULL; }
+inline void advanceMs(uint32_t ms) { virtualClockUs() += (uint64_t)ms * 1000ULL; }
+inline unsigned long millis() { return (uint32_t)(virtualClockUs() / 1000ULL); }
+inline unsigned long micros() { return (uint32_t)virtualClockUs(); }
+inline void delay(uint32_t ms) { advanceMs(ms); }
+inline void delayMicroseconds(uint32_t us) { virtualClockUs() += us; }
+
+// --- Broches : sans effet, dernier niveau écrit conservé ---
+inline uint8_t* pinLevels() {
+    static uint8_t levels[64];
+    return levels;
+}
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t pin, uint8_t level) { pinLevels()[pin & 63] = level; }
+inline int digitalRead(uint8_t pin) { return pinLevels()[pin & 63]; }
+inline int analogRead(uint8_t) { return 0; }
+
+// --- Aléa : suite reproductible d'un essai à l'autre ---
+inline uint32_t& shimRandomState() {
+    static uint32_t state = 12345;
+    return state;
+}
+inline uint32_t esp_random() {
+    shimRandomState() = shimRandomState() * 1103515245u + 12345u;
+    return shimRandomState() >> 8;
+}
+
+// --- String : sous-ensemble utilisé par le code (messages d'erreur) ---
+class String {
+public:
+    String(const char* s = "") : _s(s ? s : "") {}
+    const char* c_str() const { return _s.c_str(); }
+    size_t length() const { return _s.length(); }
+    bool isEmpty() const { return _s.empty(); }
+    String& operator=(const char* s) { _s = s ? s : ""; return *this; }
+    String& operator+=(const char* s) { _s += s ? s : ""; return *this; }
+    String& operator+=(const String& o) { _s += o._s; return *this; }
+    bool operator==(const char* s) const { return s != nullptr && _s == s; }
+
+private:
+    std::string _s;
+};
+
+// --- Serial : sortie muette (SHIM_VERBOSE pour la voir) ---
+class ShimSerial {
+public:
+    void begin(unsigned long) {}
+    template <typename T>
+    size_t print(const T& v) { return write(v); }
+    template <typename T>
+    size_t print(const T& v, int) { return write(v); }
+    template <typename T>
+    size_t println(const T& v) { return write(v) + println(); }
+    template <typename T>
+    size_t println(const T& v, int) { return write(v) + println(); }
+    size_t println() { return out("\n"); }
+    void flush() {}
+
+private:
+    size_t write(const char* s) { return out(s ? s : "(null)"); }
+    size_t write(char* s) { return write((const char*)s); }
+    size_t write(char c) { char s[2] = {c, 0}; return out(s); }
+    size_t write(bool b) { return out(b ? "1" : "0"); }
+    size_t write(double d) { char s[32]; snprintf(s, sizeof(s), "%.2f", d); return out(s); }
+    size_t write(float f) { return write((double)f); }
+    template <typename T>
+    size_t write(const T& v) { char s[32]; snprintf(s, sizeof(s), "%lld", (long long)v); return out(s); }
+
+    size_t out(const char* s) {
+#ifdef SHIM_VERBOSE
+        fputs(s, stdout);
+#endif
+        return strlen(s);
+    }
+};
+static ShimSerial Serial __attribute__((unused));
+
+// --- ESP : tas et cycles fictifs ---
+class ShimEsp {
+public:
+    uint32_t getFreeHeap() const { return 200000; }
+    uint32_t getMinFreeHeap() const { return 200000; }
+    uint32_t getMaxAllocHeap() const { return 100000; }
+    uint32_t getCycleCount() const { return (uint32_t)micros() * 160; }
+};
+static ShimEsp ESP __attribute__((unused));
@@ -0,0 +1,79 @@
+#pragma once
+// Fichier en mémoire pour les essais hors cible : flux Arduino (read, readBytes,
+// find, findUntil), donc aussi lisible par deserializeJson(), et écriture à
+// la position courante pour les fichiers ouverts en "w" ou "r+".
+#include <Arduino.h>
+#include <string>
+
+class File {
+public:
+    File() : _data(nullptr), _pos(0), _writable(false) {}
+    File(std::string* data, bool writable) : _data(data), _pos(0), _writable(writable) {}
+
+    explicit operator bool() const { return _data != nullptr; }
+    size_t size() const { return _data ? _data->size() : 0; }
+    size_t position() const { return _pos; }
+    int available() const { return _data ? (int)(_data->size() - _pos) : 0; }
+    void close() { _data = nullptr; }
+
+    bool seek(uint32_t pos) {
+        if (!_data || pos > _data->size()) {
+            return false;
+        }
+        _pos = pos;
+        return true;
+    }
+
+    int read() { return available() > 0 ? (uint8_t)(*_data)[_pos++] : -1; }
+    int peek() const { return available() > 0 ? (uint8_t)(*_data)[_pos] : -1; }
+    size_t read(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+
+    size_t readBytes(char* buffer, size_t length) {
+        size_t n = min(length, (size_t)available());
+        if (n > 0) {
+            memcpy(buffer, _data->data() + _pos, n);
+            _pos += n;
+        }
+        return n;
+    }
+
+    size_t write(const uint8_t* buffer, size_t length) {
+        if (!_data || !_writable) {
+            return 0;
+        }
+        if (_pos + length > _data->size()) {
+            _data->resize(_pos + length);
+        }
+        memcpy(&(*_data)[_pos], buffer, length);
+        _pos += length;
+        return length;
+    }
+    size_t write(uint8_t c) { return write(&c, 1); }
+
+    // Consomme le flux jusqu'à la fin de target (Stream::find)
+    bool find(const char* target) { return findUntil(target, nullptr); }
+
+    // Consomme jusqu'à target ou terminator, le premier rencontré (Stream::findUntil)
+    bool findUntil(const char* target, const char* terminator) {
+        if (!_data) {
+            return false;
+        }
+        size_t t = _data->find(target, _pos);
+        size_t end = terminator ? _data->find(terminator, _pos) : std::string::npos;
+        if (end != std::string::npos && (t == std::string::npos || end < t)) {
+            _pos = end + strlen(terminator);
+            return false;
+        }
+        if (t == std::string::npos) {
+            _pos = _data->size();
+            return false;
+        }
+        _pos = t + strlen(target);
+        return true;
+    }
+
+private:
+    std::string* _data;
+    size_t _pos;
+    bool _writable;
+};
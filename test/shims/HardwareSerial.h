@@ -0,0 +1,12 @@
+#pragma once
+// UART sans effet (liaison LoRa simulée par les essais)
+#include <Arduino.h>
+
+class HardwareSerial {
+public:
+    void begin(unsigned long, uint32_t = 0, int8_t = -1, int8_t = -1) {}
+    int available() { return 0; }
+    int read() { return -1; }
+    size_t write(const uint8_t*, size_t len) { return len; }
+    size_t write(uint8_t) { return 1; }
+};
@@ -0,0 +1,52 @@
+#pragma once
+// NVS en mémoire pour les essais hors cible : espaces de noms et clés binaires
+#include <Arduino.h>
+#include <map>
+#include <string>
+
+class Preferences {
+public:
+    Preferences() : _open(false), _readOnly(true) {}
+
+    bool begin(const char* ns, bool readOnly = false) {
+        _ns = ns;
+        _open = true;
+        _readOnly = readOnly;
+        return true;
+    }
+    void end() { _open = false; }
+
+    size_t putBytes(const char* key, const void* value, size_t len) {
+        if (!_open || _readOnly) {
+            return 0;
+        }
+        store()[slot(key)].assign((const char*)value, len);
+        return len;
+    }
+    size_t getBytesLength(const char* key) {
+        std::map<std::string, std::string>::iterator it = store().find(slot(key));
+        return (_open && it != store().end()) ? it->second.size() : 0;
+    }
+    size_t getBytes(const char* key, void* buf, size_t maxLen) {
+        size_t len = getBytesLength(key);
+        if (len == 0 || len > maxLen) {
+            return 0;
+        }
+        memcpy(buf, store()[slot(key)].data(), len);
+        return len;
+    }
+    bool remove(const char* key) { return _open && !_readOnly && store().erase(slot(key)) > 0; }
+
+    // Essais : contenu brut de la NVS
+    static std::map<std::string, std::string>& store() {
+        static std::map<std::string, std::string> nvs;
+        return nvs;
+    }
+
+private:
+    std::string slot(const char* key) const { return _ns + "/" + key; }
+
+    std::string _ns;
+    bool _open;
+    bool _readOnly;
+};
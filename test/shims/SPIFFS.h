@@ -0,0 +1,55 @@
+#pragma once
+// SPIFFS en mémoire pour les essais hors cible (fichiers de FS.h)
+#include <FS.h>
+#include <map>
+#include <string>
+
+class ShimSpiffs {
+public:
+    bool begin(bool = false) { return true; }
+
+    // Modes "r" (lecture), "r+" (lecture/écriture) et "w" (création ou troncature)
+    File open(const char* path, const char* mode = "r") {
+        if (strcmp(mode, "w") == 0) {
+            std::string& data = _files[path];
+            data.clear();
+            return File(&data, true);
+        }
+        std::map<std::string, std::string>::iterator it = _files.find(path);
+        if (it == _files.end()) {
+            return File();
+        }
+        return File(&it->second, strcmp(mode, "r+") == 0);
+    }
+    bool exists(const char* path) const { return _files.count(path) > 0; }
+    bool remove(const char* path) { return _files.erase(path) > 0; }
+    bool rename(const char* from, const char* to) {
+        std::map<std::string, std::string>::iterator it = _files.find(from);
+        if (it == _files.end() || _failRenameFrom == from) {
+            return false;
+        }
+        _files[to] = it->second;
+        _files.erase(from);
+        return true;
+    }
+
+    // Essais : contenu des fichiers
+    void put(const char* path, const std::string& content) { _files[path] = content; }
+    const std::string& get(const char* path) { return _files[path]; }
+    void reset() {
+        _files.clear();
+        _failRenameFrom.clear();
+    }
+    // Essais : les renommages depuis ce chemin échouent (secteur défectueux, FS plein)
+    void failRenameFrom(const char* path) { _failRenameFrom = path; }
+
+private:
+    std::map<std::string, std::string> _files;
+    std::string _failRenameFrom;
+};
+
+inline ShimSpiffs& shimSpiffs() {
+    static ShimSpiffs fs;
+    return fs;
+}
+#define SPIFFS shimSpiffs()
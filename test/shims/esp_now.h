@@ -0,0 +1,5 @@
+#pragma once
+// Types ESP-NOW seulement : la radio est simulée par les essais
+#include <esp_err.h>
+
+typedef enum { ESP_NOW_SEND_SUCCESS = 0, ESP_NOW_SEND_FAIL } esp_now_send_status_t;
@@ -0,0 +1,29 @@
+#pragma once
+// Bascule A/B simulée : les essais choisissent la partition inactive renvoyée
+// (une par nœud simulé) et relisent la partition de démarrage sélectionnée.
+#include <esp_partition.h>
+
+struct ShimOta {
+    esp_partition_t running;
+    const esp_partition_t* next;
+    const esp_partition_t* boot;
+};
+
+inline ShimOta& shimOta() {
+    static ShimOta ota = {{0x10000, 0x180000, "app0", false}, nullptr, nullptr};
+    return ota;
+}
+
+inline const esp_partition_t* esp_ota_get_running_partition() { return &shimOta().running; }
+inline const esp_partition_t* esp_ota_get_boot_partition() {
+    return shimOta().boot ? shimOta().boot : &shimOta().running;
+}
+inline const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t*) { return shimOta().next; }
+inline esp_err_t esp_ota_set_boot_partition(const esp_partition_t* p) {
+    if (p == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    shimOta().boot = p;
+    return ESP_OK;
+}
+inline esp_err_t esp_ota_mark_app_valid_cancel_rollback() { return ESP_OK; }
@@ -0,0 +1,50 @@
+#pragma once
+// Partitions en mémoire. L'écriture suit la flash NOR : elle ne peut que
+// faire passer des bits de 1 à 0, un secteur doit être effacé avant réécriture.
+#include <esp_err.h>
+#include <map>
+#include <vector>
+#include <string.h>
+
+typedef struct {
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+    bool encrypted;
+} esp_partition_t;
+
+inline std::vector<uint8_t>& shimPartitionData(const esp_partition_t* p) {
+    static std::map<const esp_partition_t*, std::vector<uint8_t> > flash;
+    std::vector<uint8_t>& data = flash[p];
+    if (data.size() != p->size) {
+        data.assign(p->size, 0x00); // Contenu précédent quelconque : effacement obligatoire
+    }
+    return data;
+}
+
+inline esp_err_t esp_partition_erase_range(const esp_partition_t* p, size_t offset, size_t size) {
+    if (p == nullptr || offset % 4096 != 0 || size % 4096 != 0 || offset + size > p->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(&shimPartitionData(p)[offset], 0xFF, size);
+    return ESP_OK;
+}
+
+inline esp_err_t esp_partition_write(const esp_partition_t* p, size_t offset, const void* src, size_t size) {
+    if (p == nullptr || offset + size > p->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint8_t* dst = &shimPartitionData(p)[offset];
+    for (size_t i = 0; i < size; i++) {
+        dst[i] &= ((const uint8_t*)src)[i];
+    }
+    return ESP_OK;
+}
+
+inline esp_err_t esp_partition_read(const esp_partition_t* p, size_t offset, void* dst, size_t size) {
+    if (p == nullptr || offset + size > p->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(dst, &shimPartitionData(p)[offset], size);
+    return ESP_OK;
+}
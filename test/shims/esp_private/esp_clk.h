@@ -0,0 +1,10 @@
+#pragma once
+// Compteur RTC simulé (µs) : les essais le font avancer, dérive comprise,
+// indépendamment de l'horloge virtuelle millis()
+#include <stdint.h>
+
+inline uint64_t& shimRtcTimeUs() {
+    static uint64_t us = 0;
+    return us;
+}
+inline uint64_t esp_clk_rtc_time() { return shimRtcTimeUs(); }
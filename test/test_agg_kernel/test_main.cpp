@@ -0,0 +1,155 @@
+// Noyau de réduction (chemin scalaire) et étage d'agrégation du Master.
+// Sur cible S3, l'équivalence PIE / scalaire est vérifiée au démarrage (aggSelfTest).
+#include <unity.h>
+#include <chrono>
+#include "logic/AggKernel.cpp"
+#include "logic/TelemetryAggregator.cpp"
+
+static uint32_t s_seed = 12345;
+
+static int16_t randomSample() {
+    s_seed = s_seed * 1103515245u + 12345u;
+    return (int16_t)(s_seed >> 16);
+}
+
+// Référence naïve, somme sur 64 bits
+static void reference(const int16_t* v, size_t n, int16_t& mn, int16_t& mx, int64_t& sum) {
+    mn = INT16_MAX;
+    mx = INT16_MIN;
+    sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        mn = min(mn, v[i]);
+        mx = max(mx, v[i]);
+        sum += v[i];
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_scalar_matches_reference() {
+    alignas(16) int16_t data[AGG_WINDOW + 8];
+    for (size_t n = 1; n <= AGG_WINDOW; n++) {
+        for (size_t offset = 0; offset < 8; offset++) { // Tableaux alignés ou non
+            int16_t* v = data + offset;
+            for (size_t i = 0; i < n; i++) {
+                v[i] = randomSample();
+            }
+            int16_t mn, mx;
+            int64_t sum;
+            reference(v, n, mn, mx, sum);
+
+            AggResult scalar, dispatched;
+            aggReduceScalar(v, n, &scalar);
+            aggReduce(v, n, &dispatched);
+            TEST_ASSERT_EQUAL_INT16(mn, scalar.min);
+            TEST_ASSERT_EQUAL_INT16(mx, scalar.max);
+            TEST_ASSERT_EQUAL_INT32(sum, scalar.sum);
+            TEST_ASSERT_EQUAL_INT16(scalar.min, dispatched.min);
+            TEST_ASSERT_EQUAL_INT16(scalar.max, dispatched.max);
+            TEST_ASSERT_EQUAL_INT32(scalar.sum, dispatched.sum);
+        }
+    }
+}
+
+static void test_extreme_values() {
+    alignas(16) int16_t v[AGG_WINDOW];
+    for (size_t i = 0; i < AGG_WINDOW; i++) {
+        v[i] = (i & 1) ? INT16_MAX : INT16_MIN;
+    }
+    AggResult r;
+    aggReduceScalar(v, AGG_WINDOW, &r);
+    TEST_ASSERT_EQUAL_INT16(INT16_MIN, r.min);
+    TEST_ASSERT_EQUAL_INT16(INT16_MAX, r.max);
+    TEST_ASSERT_EQUAL_INT32(-(AGG_WINDOW / 2), r.sum);
+
+    for (size_t i = 0; i < AGG_WINDOW; i++) {
+        v[i] = INT16_MAX; // Somme maximale d'une fenêtre : tient sur 32 bits
+    }
+    aggReduceScalar(v, AGG_WINDOW, &r);
+    TEST_ASSERT_EQUAL_INT32((int32_t)INT16_MAX * AGG_WINDOW, r.sum);
+}
+
+static char s_emitted[MQTT_BUFFER_SIZE];
+static size_t s_emittedLen;
+static int s_emits;
+
+static void capture(const char* json, size_t len) {
+    memcpy(s_emitted, json, len + 1);
+    s_emittedLen = len;
+    s_emits++;
+}
+
+static int countOf(const char* haystack, const char* needle) {
+    int n = 0;
+    for (const char* p = strstr(haystack, needle); p; p = strstr(p + 1, needle)) {
+        n++;
+    }
+    return n;
+}
+
+// Pire cas : identifiant maximal, six canaux aux valeurs extrêmes, fenêtre pleine
+static void test_worst_case_frame_keeps_every_channel() {
+    static TelemetryAggregator agg(60000);
+    agg.registerEmitCallback(capture);
+    s_emits = 0;
+    const char* node = "NODE_0123456789_0123456789_0123"; // 31 caractères
+    for (int k = 0; k < AGG_WINDOW; k++) {
+        for (uint8_t ch = 0; ch < AGG_CHANNELS; ch++) {
+            agg.addSample(node, ch, (k & 1) ? -327.68f : 327.67f);
+        }
+    }
+    setMillis(60000);
+    agg.update();
+
+    TEST_ASSERT_EQUAL_INT(1, s_emits);
+    TEST_ASSERT_EQUAL_UINT32(strlen(s_emitted), s_emittedLen);
+    TEST_ASSERT_EQUAL_INT(AGG_CHANNELS, countOf(s_emitted, "\":["));
+    TEST_ASSERT_TRUE(strstr(s_emitted, "\"temp\":[-327.68,327.67,") != nullptr);
+    TEST_ASSERT_EQUAL_STRING("}}", s_emitted + s_emittedLen - 2);
+}
+
+static void test_full_window_emits_early() {
+    static TelemetryAggregator agg(60000);
+    agg.registerEmitCallback(capture);
+    s_emits = 0;
+    for (int k = 0; k <= AGG_WINDOW; k++) {
+        agg.addSample("NODE_1", 0, k);
+    }
+    TEST_ASSERT_EQUAL_INT(1, s_emits);
+    // [min, max, moyenne, dernière, nombre] de la fenêtre pleine
+    TEST_ASSERT_TRUE(strstr(s_emitted, "\"soilHumidity1\":[0.00,63.00,31.50,63.00,64]") != nullptr);
+}
+
+static void test_benchmark_scalar_kernel() {
+    alignas(16) int16_t v[AGG_WINDOW];
+    for (size_t i = 0; i < AGG_WINDOW; i++) {
+        v[i] = randomSample();
+    }
+    const int rounds = 200000;
+    volatile int32_t sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < rounds; k++) {
+        AggResult r;
+        v[k & (AGG_WINDOW - 1)] ^= 1; // Empêche le calcul d'être sorti de la boucle
+        aggReduceScalar(v, AGG_WINDOW, &r);
+        sink = sink + r.sum;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / rounds;
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "aggReduceScalar : %.1f ns / fenêtre de %d (hôte)", ns, AGG_WINDOW);
+    TEST_MESSAGE(msg);
+    (void)sink;
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_scalar_matches_reference);
+    RUN_TEST(test_extreme_values);
+    RUN_TEST(test_worst_case_frame_keeps_every_channel);
+    RUN_TEST(test_full_window_emits_early);
+    RUN_TEST(test_benchmark_scalar_kernel);
+    return UNITY_END();
+}
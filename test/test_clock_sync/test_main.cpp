@@ -0,0 +1,168 @@
+// Synchronisation horaire à travers le deep sleep : l'état exporté en mémoire RTC
+// et le compteur RTC, qui dérive, suffisent à viser le créneau au réveil
+#include <unity.h>
+#include "logic/ClockSync.cpp"
+
+// Heure Master au début de l'essai (epoch ms)
+static const int64_t EPOCH_MS = 1704067200000LL;
+
+static int64_t s_trueMs;      // Temps écoulé vrai (ms)
+static double s_driftPpm;     // Avance du compteur RTC sur le temps vrai
+static uint32_t s_seed;
+
+static void advanceTrue(int64_t ms) {
+    s_trueMs += ms;
+    shimRtcTimeUs() = (uint64_t)((double)s_trueMs * 1000.0 * (1.0 + s_driftPpm / 1e6));
+}
+
+static int64_t masterNow() {
+    return EPOCH_MS + s_trueMs;
+}
+
+static uint32_t draw(uint32_t n) {
+    s_seed = s_seed * 1103515245u + 12345u;
+    return (s_seed >> 16) % n;
+}
+
+// Échange timeReq/timeResp : trajets de 2 à 14 ms, asymétriques
+static bool exchange(ClockSync& clock) {
+    int64_t t1 = ClockSync::localMs();
+    advanceTrue(2 + draw(12));
+    int64_t t2 = masterNow();
+    advanceTrue(1);
+    int64_t t3 = masterNow();
+    advanceTrue(2 + draw(12));
+    return clock.addExchange(t1, t2, t3, ClockSync::localMs());
+}
+
+void setUp() {
+    s_trueMs = 0;
+    s_driftPpm = 0;
+    s_seed = 3;
+    advanceTrue(0);
+}
+
+void tearDown() {}
+
+static void test_first_exchange_syncs_offset() {
+    ClockSync clock;
+    TEST_ASSERT_FALSE(clock.isSynced());
+    advanceTrue(123456);
+    TEST_ASSERT_TRUE(exchange(clock));
+    TEST_ASSERT_TRUE(clock.isSynced());
+    TEST_ASSERT_INT32_WITHIN(10, 0, (int32_t)(clock.nowMs() - masterNow()));
+}
+
+static void test_slow_exchange_rejected() {
+    ClockSync clock;
+    int64_t t1 = ClockSync::localMs();
+    advanceTrue(60);
+    int64_t t2 = masterNow();
+    advanceTrue(1);
+    TEST_ASSERT_FALSE(clock.addExchange(t1, t2, masterNow(), ClockSync::localMs()));
+    TEST_ASSERT_FALSE(clock.isSynced());
+}
+
+// Échange accepté mais lent et asymétrique : il ne décale l'heure que d'une
+// fraction de son erreur, au lieu de la reprendre entière
+static void test_slow_exchange_only_nudges_offset() {
+    ClockSync clock;
+    for (int i = 0; i < 4; i++) {
+        exchange(clock);
+        advanceTrue(1000);
+    }
+    int64_t before = clock.nowMs() - masterNow();
+
+    int64_t t1 = ClockSync::localMs();
+    advanceTrue(34); // Aller retardé (réessais radio), retour direct : offset faussé de +16 ms
+    int64_t t2 = masterNow();
+    advanceTrue(1);
+    int64_t t3 = masterNow();
+    advanceTrue(2);
+    TEST_ASSERT_TRUE(clock.addExchange(t1, t2, t3, ClockSync::localMs()));
+    int64_t after = clock.nowMs() - masterNow();
+    TEST_ASSERT_INT32_WITHIN(5, (int32_t)before, (int32_t)after);
+}
+
+static void test_state_survives_export_import() {
+    ClockSync clock;
+    s_driftPpm = 200;
+    exchange(clock);
+    advanceTrue(600000);
+    exchange(clock);
+
+    ClockSyncState rtc;
+    clock.exportState(rtc);
+    ClockSync afterWake; // Deep sleep : seul l'état RTC est conservé
+    afterWake.importState(rtc);
+    TEST_ASSERT_TRUE(afterWake.isSynced());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, clock.driftPpm(), afterWake.driftPpm());
+    advanceTrue(3600000);
+    TEST_ASSERT_TRUE(clock.nowMs() == afterWake.nowMs());
+}
+
+// 24 h de cycles d'une minute en deep sleep, resynchronisation toutes les 15 min,
+// compteur RTC à +150 ppm : dès la première mesure de dérive (premier échange
+// à 5 min ou plus du précédent), l'heure estimée au réveil reste à 10 ms de
+// l'heure Master. Avant, rien ne permet de connaître la dérive : l'erreur
+// croît jusqu'à dérive x intervalle de resynchro (135 ms ici).
+static void test_duty_cycled_day() {
+    s_driftPpm = 150;
+    ClockSyncState rtc;
+    {
+        ClockSync clock;
+        TEST_ASSERT_TRUE(exchange(clock));
+        clock.exportState(rtc);
+    }
+
+    const int64_t periodMs = 60000;
+    const int64_t awakeMs = 250;
+    int64_t lastResync = s_trueMs;
+    int64_t maxErrLearned = 0;
+    int64_t maxErrCold = 0;
+    int exchanges = 1;
+    for (int cycle = 0; cycle < 24 * 60; cycle++) {
+        ClockSync clock; // Réveil : nouvel objet, état importé de la mémoire RTC
+        clock.importState(rtc);
+
+        int64_t err = clock.nowMs() - masterNow();
+        err = err < 0 ? -err : err;
+        if (!rtc.driftKnown) {
+            maxErrCold = max(maxErrCold, err);
+        } else {
+            maxErrLearned = max(maxErrLearned, err);
+        }
+
+        int64_t awakeStart = s_trueMs;
+        if (s_trueMs - lastResync >= 15 * 60000) {
+            if (exchange(clock)) {
+                exchanges++;
+            }
+            lastResync = s_trueMs;
+        }
+        advanceTrue(awakeMs - (s_trueMs - awakeStart));
+        clock.exportState(rtc);
+        advanceTrue(periodMs - awakeMs); // Deep sleep
+    }
+
+    char msg[192];
+    snprintf(msg, sizeof(msg),
+             "+150 ppm, resynchro 15 min : erreur au réveil %d ms avant la première mesure de dérive, "
+             "%d ms ensuite, dérive estimée %.1f ppm",
+             (int)maxErrCold, (int)maxErrLearned, (double)rtc.driftPpm);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_GREATER_THAN(90, exchanges);
+    TEST_ASSERT_FLOAT_WITHIN(5.0f, -150.0f, rtc.driftPpm); // Horloge locale en avance
+    TEST_ASSERT_LESS_OR_EQUAL(10, maxErrLearned);
+    TEST_ASSERT_LESS_OR_EQUAL(135 + 10, maxErrCold); // 150 ppm x 15 min, plus la gigue d'un échange
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_exchange_syncs_offset);
+    RUN_TEST(test_slow_exchange_rejected);
+    RUN_TEST(test_slow_exchange_only_nudges_offset);
+    RUN_TEST(test_state_survives_export_import);
+    RUN_TEST(test_duty_cycled_day);
+    return UNITY_END();
+}
@@ -0,0 +1,213 @@
+// Parsing filtré en flux de config.json, de 1 à 64 Ko
+#include <unity.h>
+#include <chrono>
+#include <string>
+#include "ConfigLoader.cpp"
+#include "logic/SendSchedule.cpp"
+#include "logic/ZoneTable.cpp"
+
+// Image binaire (NVS) hors du périmètre de ces essais
+bool configSourceStamp(ConfigSourceStamp&) { return false; }
+bool loadConfigSnapshot(Config&, const ConfigSourceStamp&) { return false; }
+bool saveConfigSnapshot(const Config&, const ConfigSourceStamp&) { return false; }
+
+static Config s_config;
+
+static const char* const HEAD =
+    "{\"identity\":{\"farmId\":\"FARM_1\",\"zoneId\":\"ZONE_A\",\"nodeId\":\"NODE_1\",\"isMaster\":true},"
+    "\"pins\":{\"led\":8,\"led_brightness\":20,\"lora_rx\":17,\"lora_tx\":18},"
+    "\"network\":{\"master_mac\":\"24:6F:28:AA:BB:CC\",\"enableMqtt\":true,"
+    "\"mqtt_broker\":\"broker.local\",\"mqtt_port\":1884,\"lora_node_addr\":513},"
+    "\"sensors_config\":{\"temperature_sensor\":{\"enabled\":true,\"pin\":4},"
+    "\"soil_humidity_sensors\":[{\"enabled\":true,\"sensorPin\":1,\"powerPin\":2,\"dryValue\":3000,\"wetValue\":1200},"
+    "{\"enabled\":true,\"sensorPin\":3,\"powerPin\":2,\"dryValue\":2900,\"wetValue\":1100}]},"
+    "\"electrovalves\":[{\"enabled\":true,\"pin\":5,\"flow\":4.5},{\"enabled\":true,\"pin\":6,\"flow\":2}],";
+
+/**
+ * @brief config.json d'au moins target octets : une moitié de sections ignorées
+ * par le filtre (notes d'interface), l'autre de send_times lus en flux.
+ * Le planning attendu est construit en parallèle dans expected.
+ */
+static std::string makeConfig(size_t target, ConfigSchedule& expected) {
+    SendSchedule::clear(expected);
+    std::string json = HEAD;
+
+    json += "\"ui\":{\"notes\":[";
+    for (int i = 0; json.size() < target / 2; i++) {
+        char note[96];
+        snprintf(note, sizeof(note), "%s\"note %04d : parcelle nord, goutte-à-goutte, contrôle visuel\"",
+                 i ? "," : "", i);
+        json += note;
+    }
+    json += "]},";
+
+    json += "\"logic\":{\"humidity_thresholdMin\":35,\"humidity_thresholdMax\":65,"
+            "\"schedule\":{\"start\":\"08:00\",\"end\":\"09:00\",\"interval_min\":30,\"weekdays\":62},"
+            "\"hydraulics\":{\"max_concurrent\":1,\"flow_budget\":6},"
+            "\"zones\":[{\"valves\":[1,2],\"policy\":\"median\",\"probes\":[{\"sensor\":1},{\"node\":\"NODE_2\",\"sensor\":2}]}],"
+            "\"send_times\":[";
+    SendSchedule::addInterval(expected, 8 * 60, 9 * 60, 30, 0x3E);
+    for (int i = 0; i == 0 || json.size() + 4 < target; i++) {
+        uint16_t minute = (uint16_t)((i * 7) % MINUTES_PER_DAY);
+        char entry[40];
+        snprintf(entry, sizeof(entry), "%s{\"hour\":%u,\"minute\":%u}", i ? "," : "",
+                 minute / 60, minute % 60);
+        json += entry;
+        SendSchedule::addMinute(expected, minute);
+    }
+    json += "]}}";
+    return json;
+}
+
+static void checkParsed(const ConfigSchedule& expected) {
+    TEST_ASSERT_EQUAL_STRING("NODE_1", s_config.identity.nodeId.c_str());
+    TEST_ASSERT_TRUE(s_config.identity.isMaster);
+    TEST_ASSERT_EQUAL_UINT8(8, s_config.pins.led);
+    TEST_ASSERT_EQUAL_UINT8(0xCC, s_config.network.master_mac_bytes[5]);
+    TEST_ASSERT_EQUAL_UINT16(1884, s_config.network.mqtt_port);
+    TEST_ASSERT_EQUAL_UINT16(513, s_config.network.lora_node_addr);
+    TEST_ASSERT_EQUAL_UINT8(2, s_config.sensors.num_soil_sensors);
+    TEST_ASSERT_EQUAL_UINT16(1100, s_config.sensors.soil_sensors[1].wetValue);
+    TEST_ASSERT_EQUAL_UINT8(2, s_config.num_electrovalves);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 4.5f, s_config.electrovalves[0].flow);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 35.0f, s_config.logic.humidity_thresholdMin);
+    TEST_ASSERT_EQUAL_UINT8(1, s_config.logic.hydraulics.max_concurrent);
+
+    TEST_ASSERT_EQUAL_UINT8(1, s_config.logic.zones.count);
+    TEST_ASSERT_EQUAL_UINT8(2, s_config.logic.zones.zones[0].num_probes);
+    TEST_ASSERT_NOT_NULL(ZoneTable::lookup(s_config.logic.zones, "NODE_2", 2));
+
+    TEST_ASSERT_EQUAL_UINT16(expected.count, s_config.logic.schedule.count);
+    TEST_ASSERT_EQUAL_MEMORY(expected.minute_bitmap, s_config.logic.schedule.minute_bitmap,
+                             sizeof(expected.minute_bitmap));
+}
+
+void setUp() {
+    SPIFFS.reset();
+    memset((void*)&s_config, 0, sizeof(s_config));
+}
+
+void tearDown() {}
+
+static void parseAtSize(size_t target) {
+    static ConfigSchedule expected;
+    std::string json = makeConfig(target, expected);
+    TEST_ASSERT_GREATER_OR_EQUAL(target, json.size());
+    SPIFFS.put(CONFIG_FILE, json);
+
+    auto t0 = std::chrono::steady_clock::now();
+    TEST_ASSERT_TRUE(parseConfigFile(s_config, CONFIG_FILE));
+    auto t1 = std::chrono::steady_clock::now();
+    checkParsed(expected);
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "%u octets : %.2f ms, pic JSON %u octets, %u envois par semaine (hôte)",
+             (unsigned)json.size(), std::chrono::duration<double, std::milli>(t1 - t0).count(),
+             (unsigned)configParsePeakBytes(), (unsigned)s_config.logic.schedule.count);
+    TEST_MESSAGE(msg);
+}
+
+static void test_parse_1k() { parseAtSize(1024); }
+static void test_parse_4k() { parseAtSize(4 * 1024); }
+static void test_parse_16k() { parseAtSize(16 * 1024); }
+static void test_parse_64k() { parseAtSize(64 * 1024); }
+
+// Sections ignorées et send_times lus en flux : le pic ne suit pas la taille du fichier
+static void test_peak_memory_bounded() {
+    static ConfigSchedule expected;
+    SPIFFS.put(CONFIG_FILE, makeConfig(1024, expected));
+    TEST_ASSERT_TRUE(parseConfigFile(s_config, CONFIG_FILE));
+    size_t small = configParsePeakBytes();
+    TEST_ASSERT_GREATER_THAN(0, small);
+
+    SPIFFS.put(CONFIG_FILE, makeConfig(64 * 1024, expected));
+    TEST_ASSERT_TRUE(parseConfigFile(s_config, CONFIG_FILE));
+    TEST_ASSERT_LESS_OR_EQUAL(small + small / 4, configParsePeakBytes());
+}
+
+// "send_times" ailleurs que sous logic (texte d'une valeur, autre objet) : ignoré
+static void test_send_times_anchored_to_logic() {
+    SPIFFS.put(CONFIG_FILE, "{\"identity\":{\"nodeId\":\"NODE_1\"},"
+                            "\"network\":{\"master_mac\":\"00:00:00:00:00:01\"},"
+                            "\"ui\":{\"help\":\"\\\"send_times\\\":[{\\\"hour\\\":1}]\","
+                            "\"old\":{\"send_times\":[{\"hour\":2,\"minute\":0}]}},"
+                            "\"logic\":{\"note\":\"send_times\",\"zones\":[{\"send_times\":[{\"hour\":3}]}]}}");
+    TEST_ASSERT_TRUE(parseConfigFile(s_config, CONFIG_FILE));
+    TEST_ASSERT_EQUAL_UINT16(0, s_config.logic.schedule.count);
+
+    // Même fichier avec un vrai logic.send_times après les leurres
+    SPIFFS.put(CONFIG_FILE, "{\"network\":{\"master_mac\":\"00:00:00:00:00:01\"},"
+                            "\"old\":{\"send_times\":[{\"hour\":2,\"minute\":0}]},"
+                            "\"logic\":{\"note\":\"send_times\", \"send_times\" : [{\"hour\":8,\"minute\":30}]}}");
+    TEST_ASSERT_TRUE(parseConfigFile(s_config, CONFIG_FILE));
+    TEST_ASSERT_EQUAL_UINT16(7, s_config.logic.schedule.count); // 08:30 chaque jour
+    ConfigSchedule expected;
+    SendSchedule::clear(expected);
+    SendSchedule::addMinute(expected, 8 * 60 + 30);
+    TEST_ASSERT_EQUAL_MEMORY(expected.minute_bitmap, s_config.logic.schedule.minute_bitmap,
+                             sizeof(expected.minute_bitmap));
+}
+
+static void test_missing_file() {
+    TEST_ASSERT_FALSE(parseConfigFile(s_config, CONFIG_FILE));
+}
+
+static void test_invalid_json() {
+    ConfigSchedule expected;
+    std::string json = makeConfig(1024, expected);
+    json.resize(json.size() / 2); // Fichier tronqué
+    SPIFFS.put(CONFIG_FILE, json);
+    TEST_ASSERT_FALSE(parseConfigFile(s_config, CONFIG_FILE));
+}
+
+static void test_invalid_mac() {
+    SPIFFS.put(CONFIG_FILE, "{\"network\":{\"master_mac\":\"pas une adresse\"}}");
+    TEST_ASSERT_FALSE(parseConfigFile(s_config, CONFIG_FILE));
+}
+
+static void test_defaults_and_truncated_strings() {
+    SPIFFS.put(CONFIG_FILE, "{\"identity\":{\"nodeId\":\"NODE_0123456789_0123456789_0123456789\"},"
+                            "\"network\":{\"master_mac\":\"00:00:00:00:00:01\"}}");
+    TEST_ASSERT_TRUE(parseConfigFile(s_config, CONFIG_FILE));
+    TEST_ASSERT_EQUAL_UINT32(CONFIG_ID_LEN - 1, s_config.identity.nodeId.length());
+    TEST_ASSERT_EQUAL_STRING("farm/telemetry", s_config.network.topic_telemetry_up.c_str());
+    TEST_ASSERT_EQUAL_UINT32(50000, s_config.logic.tdma_window_ms);
+    TEST_ASSERT_EQUAL_UINT16(0, s_config.logic.schedule.count);
+    TEST_ASSERT_EQUAL_UINT8(0, s_config.logic.zones.count);
+}
+
+// Zone refusée (aucune vanne valide, ou aucune sonde retenue) : pas de route
+// résiduelle et son index revient à la zone valide suivante
+static void test_rejected_zones_leave_no_routes() {
+    SPIFFS.put(CONFIG_FILE, "{\"identity\":{\"nodeId\":\"NODE_1\"},"
+                            "\"network\":{\"master_mac\":\"00:00:00:00:00:01\"},"
+                            "\"logic\":{\"zones\":["
+                            "{\"valves\":[0,99],\"probes\":[{\"node\":\"NODE_A\",\"sensor\":1}]},"
+                            "{\"valves\":[1],\"probes\":[{\"node\":\"NODE_B\",\"sensor\":0}]},"
+                            "{\"valves\":[2],\"policy\":\"mean\",\"probes\":[{\"node\":\"NODE_C\",\"sensor\":1}]}]}}");
+    TEST_ASSERT_TRUE(parseConfigFile(s_config, CONFIG_FILE));
+    const ConfigZones& zones = s_config.logic.zones;
+    TEST_ASSERT_EQUAL_UINT8(1, zones.count);
+    TEST_ASSERT_EQUAL_UINT8(2, zones.zones[0].valves[0]);
+    TEST_ASSERT_EQUAL(ZonePolicy::MEAN, zones.zones[0].policy);
+    TEST_ASSERT_NULL(ZoneTable::lookup(zones, "NODE_A", 1));
+    const ZoneRoute* r = ZoneTable::lookup(zones, "NODE_C", 1);
+    TEST_ASSERT_NOT_NULL(r);
+    TEST_ASSERT_EQUAL_UINT8(0, r->zone);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_1k);
+    RUN_TEST(test_parse_4k);
+    RUN_TEST(test_parse_16k);
+    RUN_TEST(test_parse_64k);
+    RUN_TEST(test_peak_memory_bounded);
+    RUN_TEST(test_send_times_anchored_to_logic);
+    RUN_TEST(test_missing_file);
+    RUN_TEST(test_invalid_json);
+    RUN_TEST(test_invalid_mac);
+    RUN_TEST(test_defaults_and_truncated_strings);
+    RUN_TEST(test_rejected_zones_leave_no_routes);
+    return UNITY_END();
+}
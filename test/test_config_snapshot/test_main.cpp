@@ -0,0 +1,117 @@
+// Image binaire de Config en NVS : aller-retour, péremption, corruption
+#include <unity.h>
+#include <chrono>
+#include <string>
+#include "ConfigSnapshot.cpp"
+
+static Config s_config;
+static Config s_loaded;
+
+static void makeConfig(Config& c) {
+    memset((void*)&c, 0, sizeof(c));
+    c.identity.nodeId = "NODE_7";
+    c.identity.farmId = "FARM_1";
+    c.network.mqtt_broker = "broker.local";
+    c.network.mqtt_port = 1884;
+    c.num_electrovalves = 3;
+    c.electrovalves[2].flow = 4.5f;
+    c.logic.tdma_window_ms = 50000;
+    c.logic.schedule.count = 42;
+}
+
+static ConfigSourceStamp stampOf(const std::string& json) {
+    SPIFFS.put(CONFIG_FILE, json);
+    ConfigSourceStamp stamp;
+    TEST_ASSERT_TRUE(configSourceStamp(stamp));
+    return stamp;
+}
+
+void setUp() {
+    SPIFFS.reset();
+    Preferences::store().clear();
+    makeConfig(s_config);
+    memset((void*)&s_loaded, 0xA5, sizeof(s_loaded));
+}
+
+void tearDown() {}
+
+static void test_source_stamp_is_crc32_of_file() {
+    ConfigSourceStamp stamp = stampOf("123456789");
+    TEST_ASSERT_EQUAL_UINT32(9, stamp.size);
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926u, stamp.crc); // Valeur de contrôle CRC-32
+
+    // Lecture par blocs de 256 octets : même résultat qu'en un seul passage
+    std::string big(1000, 'x');
+    stamp = stampOf(big);
+    TEST_ASSERT_EQUAL_HEX32(esp_crc32_le(0, (const uint8_t*)big.data(), big.size()), stamp.crc);
+
+    SPIFFS.reset();
+    TEST_ASSERT_FALSE(configSourceStamp(stamp));
+}
+
+static void test_round_trip() {
+    ConfigSourceStamp stamp = stampOf("{\"identity\":{}}");
+    TEST_ASSERT_FALSE(loadConfigSnapshot(s_loaded, stamp)); // Aucune image
+    TEST_ASSERT_TRUE(saveConfigSnapshot(s_config, stamp));
+    TEST_ASSERT_TRUE(loadConfigSnapshot(s_loaded, stamp));
+    TEST_ASSERT_EQUAL_MEMORY(&s_config, &s_loaded, sizeof(Config));
+    TEST_ASSERT_EQUAL_STRING("NODE_7", s_loaded.identity.nodeId.c_str());
+}
+
+static void test_stale_when_source_changes() {
+    ConfigSourceStamp stamp = stampOf("{\"identity\":{}}");
+    saveConfigSnapshot(s_config, stamp);
+
+    ConfigSourceStamp edited = stampOf("{\"identity\":{ }}");
+    TEST_ASSERT_FALSE(loadConfigSnapshot(s_loaded, edited)); // Taille différente
+    edited = stampOf("{\"identity\":[]}");
+    TEST_ASSERT_EQUAL_UINT32(stamp.size, edited.size);
+    TEST_ASSERT_FALSE(loadConfigSnapshot(s_loaded, edited)); // Même taille, CRC différent
+}
+
+static void test_rejects_corruption_and_other_formats() {
+    ConfigSourceStamp stamp = stampOf("{}");
+    saveConfigSnapshot(s_config, stamp);
+    std::string& img = Preferences::store()[std::string(CONFIG_SNAPSHOT_NS) + "/img"];
+    std::string good = img;
+
+    img[img.size() - 1] ^= 0x01; // Un bit de la charge utile
+    TEST_ASSERT_FALSE(loadConfigSnapshot(s_loaded, stamp));
+
+    img = good;
+    img[4] ^= 0x01; // Version du format
+    TEST_ASSERT_FALSE(loadConfigSnapshot(s_loaded, stamp));
+
+    img = good.substr(0, good.size() - 4); // Config d'une autre taille
+    TEST_ASSERT_FALSE(loadConfigSnapshot(s_loaded, stamp));
+
+    img = good;
+    TEST_ASSERT_TRUE(loadConfigSnapshot(s_loaded, stamp));
+}
+
+static void test_benchmark_load() {
+    ConfigSourceStamp stamp = stampOf("{}");
+    saveConfigSnapshot(s_config, stamp);
+    const int rounds = 10000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < rounds; k++) {
+        TEST_ASSERT_TRUE(loadConfigSnapshot(s_loaded, stamp));
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double us = std::chrono::duration<double, std::micro>(t1 - t0).count() / rounds;
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "image de %u octets : chargement %.2f us (hôte, CRC compris)",
+             (unsigned)sizeof(Config), us);
+    TEST_MESSAGE(msg);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_source_stamp_is_crc32_of_file);
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_stale_when_source_changes);
+    RUN_TEST(test_rejects_corruption_and_other_formats);
+    RUN_TEST(test_benchmark_load);
+    return UNITY_END();
+}
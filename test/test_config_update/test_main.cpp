@@ -0,0 +1,213 @@
+// Mise à jour de configuration à chaud : sections touchées, fusion en flux
+// de config.json, remplacement du fichier et reprise après coupure
+#include <unity.h>
+#include <string>
+#include "ConfigUpdate.cpp"
+#include "ConfigLoader.cpp"
+#include "ConfigSnapshot.cpp"
+#include "logic/SendSchedule.cpp"
+#include "logic/ZoneTable.cpp"
+
+// Bascule signalée à la boucle événementielle : sans objet ici
+void EventLoop::post(uint32_t) {}
+
+static Config s_active;
+static Config s_other;
+
+static const char* const SEND_TIMES = "\"send_times\":[{\"hour\":8,\"minute\":0},{\"hour\":20,\"minute\":30}]";
+
+static std::string baseConfig() {
+    return std::string("{\"identity\":{\"farmId\":\"FARM_1\",\"zoneId\":\"ZONE_A\",\"nodeId\":\"NODE_1\",\"isMaster\":false},"
+                       "\"network\":{\"master_mac\":\"24:6F:28:AA:BB:CC\",\"lora_channel\":23},"
+                       "\"ui\":{\"color\":\"vert\"},"
+                       "\"logic\":{\"humidity_thresholdMin\":35,\"humidity_thresholdMax\":65,") +
+           SEND_TIMES + "}}";
+}
+
+static bool stagePatch(const char* json, uint32_t& changes, String& error) {
+    JsonDocument patch;
+    TEST_ASSERT_EQUAL(DeserializationError::Ok, deserializeJson(patch, json).code());
+    return ConfigUpdate::stage(patch.as<JsonObjectConst>(), changes, error);
+}
+
+static bool contains(const std::string& text, const char* part) {
+    return text.find(part) != std::string::npos;
+}
+
+void setUp() {
+    SPIFFS.reset();
+    Preferences::store().clear();
+    SPIFFS.put(CONFIG_FILE, baseConfig());
+    memset((void*)&s_active, 0, sizeof(s_active));
+    TEST_ASSERT_TRUE(parseConfigFile(s_active, CONFIG_FILE));
+    ConfigUpdate::begin(&s_active);
+    ConfigUpdate::commitStagedConfig(); // Rien de basculé d'un essai à l'autre
+}
+
+void tearDown() {}
+
+static void test_diff_by_section() {
+    s_other = s_active;
+    TEST_ASSERT_EQUAL_HEX32(0, ConfigUpdate::diff(s_active, s_other));
+
+    s_other.logic.humidity_thresholdMin = 30;
+    TEST_ASSERT_EQUAL_HEX32(CFG_CHANGED_IRRIGATION, ConfigUpdate::diff(s_active, s_other));
+
+    s_other = s_active;
+    SendSchedule::addMinute(s_other.logic.schedule, 12 * 60);
+    TEST_ASSERT_EQUAL_HEX32(CFG_CHANGED_SCHEDULE, ConfigUpdate::diff(s_active, s_other));
+
+    // Radio : réinitialisée à chaud, plus de redémarrage
+    s_other = s_active;
+    s_other.network.lora_channel = 5;
+    TEST_ASSERT_EQUAL_HEX32(CFG_CHANGED_RADIO, ConfigUpdate::diff(s_active, s_other));
+    s_other = s_active;
+    s_other.pins.lora_rx = 21;
+    TEST_ASSERT_EQUAL_HEX32(CFG_CHANGED_RADIO, ConfigUpdate::diff(s_active, s_other));
+
+    s_other = s_active;
+    s_other.identity.nodeId = "NODE_9";
+    TEST_ASSERT_EQUAL_HEX32(CFG_CHANGED_IDENTITY, ConfigUpdate::diff(s_active, s_other));
+
+    s_other = s_active;
+    s_other.electrovalves[0].flow = 3.0f;
+    TEST_ASSERT_EQUAL_HEX32(CFG_CHANGED_VALVES, ConfigUpdate::diff(s_active, s_other));
+    s_other = s_active;
+    s_other.logic.edge_irrigation_ms = 60000;
+    TEST_ASSERT_EQUAL_HEX32(CFG_CHANGED_VALVES, ConfigUpdate::diff(s_active, s_other));
+
+    s_other = s_active;
+    s_other.network.mqtt_port = 8883;
+    TEST_ASSERT_EQUAL_HEX32(CFG_CHANGED_WIFI, ConfigUpdate::diff(s_active, s_other));
+
+    s_other = s_active;
+    s_other.sensors.soil_settle_ms = 80;
+    TEST_ASSERT_EQUAL_HEX32(CFG_CHANGED_REBOOT, ConfigUpdate::diff(s_active, s_other));
+
+    // Relus à chaque usage, hors logic compris
+    s_other = s_active;
+    s_other.logic.beacon_interval_ms = 5000;
+    TEST_ASSERT_EQUAL_HEX32(CFG_CHANGED_OTHER, ConfigUpdate::diff(s_active, s_other));
+    s_other = s_active;
+    s_other.network.telemetry_envelope = true;
+    TEST_ASSERT_EQUAL_HEX32(CFG_CHANGED_OTHER, ConfigUpdate::diff(s_active, s_other));
+}
+
+static void test_stage_merges_and_keeps_send_times() {
+    uint32_t changes = 0;
+    String error;
+    TEST_ASSERT_TRUE(stagePatch("{\"logic\":{\"humidity_thresholdMin\":30},\"network\":{\"lora_channel\":5}}",
+                                changes, error));
+    TEST_ASSERT_EQUAL_HEX32(CFG_CHANGED_IRRIGATION | CFG_CHANGED_RADIO, changes);
+    TEST_ASSERT_TRUE(ConfigUpdate::hasStaged());
+
+    // send_times recopié tel quel, section inconnue conservée, ancienne version sauvegardée
+    const std::string& json = SPIFFS.get(CONFIG_FILE);
+    TEST_ASSERT_TRUE(contains(json, SEND_TIMES));
+    TEST_ASSERT_TRUE(contains(json, "\"ui\":{\"color\":\"vert\"}"));
+    TEST_ASSERT_TRUE(SPIFFS.get(CONFIG_BACKUP_FILE) == baseConfig());
+    TEST_ASSERT_FALSE(SPIFFS.exists(CONFIG_STAGING_FILE));
+
+    // La config active ne change qu'à la bascule, et correspond alors au fichier
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 35.0f, s_active.logic.humidity_thresholdMin);
+    TEST_ASSERT_EQUAL_HEX32(changes, ConfigUpdate::commitStagedConfig());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 30.0f, s_active.logic.humidity_thresholdMin);
+    TEST_ASSERT_EQUAL_UINT8(5, s_active.network.lora_channel);
+    TEST_ASSERT_EQUAL_UINT16(14, s_active.logic.schedule.count);
+
+    memset((void*)&s_other, 0, sizeof(s_other));
+    TEST_ASSERT_TRUE(parseConfigFile(s_other, CONFIG_FILE));
+    TEST_ASSERT_EQUAL_MEMORY(&s_active, &s_other, sizeof(Config));
+}
+
+static void test_patch_replaces_or_removes_send_times() {
+    uint32_t changes = 0;
+    String error;
+    TEST_ASSERT_TRUE(stagePatch("{\"logic\":{\"send_times\":[{\"hour\":6,\"minute\":15}]}}", changes, error));
+    TEST_ASSERT_EQUAL_HEX32(CFG_CHANGED_SCHEDULE, changes);
+    ConfigUpdate::commitStagedConfig();
+    TEST_ASSERT_EQUAL_UINT16(7, s_active.logic.schedule.count);
+    TEST_ASSERT_FALSE(contains(SPIFFS.get(CONFIG_FILE), "\"hour\":20"));
+
+    // null : planning historique supprimé, remplacé par une fenêtre
+    TEST_ASSERT_TRUE(stagePatch("{\"logic\":{\"send_times\":null,"
+                                "\"schedule\":{\"start\":\"10:00\",\"end\":\"10:30\",\"interval_min\":30}}}",
+                                changes, error));
+    ConfigUpdate::commitStagedConfig();
+    TEST_ASSERT_FALSE(contains(SPIFFS.get(CONFIG_FILE), "send_times"));
+    TEST_ASSERT_EQUAL_UINT16(14, s_active.logic.schedule.count); // 10:00 et 10:30, chaque jour
+}
+
+static void test_rejected_patch_leaves_config() {
+    uint32_t changes = 0;
+    String error;
+    TEST_ASSERT_FALSE(stagePatch("{\"logic\":{\"humidity_thresholdMin\":80}}", changes, error));
+    TEST_ASSERT_EQUAL_STRING("thresholdMin >= thresholdMax", error.c_str());
+    TEST_ASSERT_FALSE(ConfigUpdate::hasStaged());
+    TEST_ASSERT_TRUE(SPIFFS.get(CONFIG_FILE) == baseConfig());
+    TEST_ASSERT_FALSE(SPIFFS.exists(CONFIG_STAGING_FILE));
+    TEST_ASSERT_FALSE(SPIFFS.exists(CONFIG_BACKUP_FILE));
+}
+
+static void test_unchanged_patch_is_not_written() {
+    uint32_t changes = 1;
+    String error;
+    TEST_ASSERT_TRUE(stagePatch("{\"logic\":{\"humidity_thresholdMin\":35}}", changes, error));
+    TEST_ASSERT_EQUAL_HEX32(0, changes);
+    TEST_ASSERT_FALSE(ConfigUpdate::hasStaged());
+    TEST_ASSERT_TRUE(SPIFFS.get(CONFIG_FILE) == baseConfig());
+    TEST_ASSERT_FALSE(SPIFFS.exists(CONFIG_STAGING_FILE));
+}
+
+// Second renommage refusé : la version courante reprend sa place
+static void test_failed_rename_restores_current() {
+    SPIFFS.failRenameFrom(CONFIG_STAGING_FILE);
+    uint32_t changes = 0;
+    String error;
+    TEST_ASSERT_FALSE(stagePatch("{\"logic\":{\"humidity_thresholdMin\":30}}", changes, error));
+    TEST_ASSERT_EQUAL_STRING("spiffs rename", error.c_str());
+    TEST_ASSERT_FALSE(ConfigUpdate::hasStaged());
+    TEST_ASSERT_TRUE(SPIFFS.get(CONFIG_FILE) == baseConfig());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 35.0f, s_active.logic.humidity_thresholdMin);
+}
+
+// Coupure entre les deux renommages : config.json absent au démarrage suivant
+static void test_power_cut_between_renames() {
+    uint32_t changes = 0;
+    String error;
+    TEST_ASSERT_TRUE(stagePatch("{\"logic\":{\"humidity_thresholdMin\":30}}", changes, error));
+    ConfigUpdate::commitStagedConfig();
+    std::string next = SPIFFS.get(CONFIG_FILE);
+
+    // Sauvegarde présente : la version qui a déjà démarré ce nœud est préférée
+    SPIFFS.reset();
+    Preferences::store().clear();
+    SPIFFS.put(CONFIG_BACKUP_FILE, baseConfig());
+    SPIFFS.put(CONFIG_STAGING_FILE, next);
+    memset((void*)&s_other, 0, sizeof(s_other));
+    TEST_ASSERT_TRUE(loadConfig(s_other));
+    TEST_ASSERT_TRUE(SPIFFS.get(CONFIG_FILE) == baseConfig());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 35.0f, s_other.logic.humidity_thresholdMin);
+
+    // Seule la nouvelle version reste (validée avant le remplacement)
+    SPIFFS.reset();
+    Preferences::store().clear();
+    SPIFFS.put(CONFIG_STAGING_FILE, next);
+    memset((void*)&s_other, 0, sizeof(s_other));
+    TEST_ASSERT_TRUE(loadConfig(s_other));
+    TEST_ASSERT_FALSE(SPIFFS.exists(CONFIG_STAGING_FILE));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 30.0f, s_other.logic.humidity_thresholdMin);
+    TEST_ASSERT_EQUAL_UINT16(14, s_other.logic.schedule.count);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_diff_by_section);
+    RUN_TEST(test_stage_merges_and_keeps_send_times);
+    RUN_TEST(test_patch_replaces_or_removes_send_times);
+    RUN_TEST(test_rejected_patch_leaves_config);
+    RUN_TEST(test_unchanged_patch_is_not_written);
+    RUN_TEST(test_failed_rename_restores_current);
+    RUN_TEST(test_power_cut_between_renames);
+    return UNITY_END();
+}
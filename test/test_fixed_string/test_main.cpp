@@ -0,0 +1,198 @@
+// Chaînes à capacité fixe : troncature, comparaisons, copie brute de Config,
+// fragmentation du tas comparée aux String de l'ancienne Config
+#include <unity.h>
+#include <type_traits>
+#include "ConfigLoader.h"
+
+// Tas simulé : granules de 8 octets, premier emplacement libre suffisant,
+// voisins libres fusionnés d'office (un bloc libre = une suite de granules libres)
+#define SIM_HEAP_SIZE 16384
+#define SIM_GRANULE 8
+#define SIM_GRANULES (SIM_HEAP_SIZE / SIM_GRANULE)
+
+static uint16_t s_blockLen[SIM_GRANULES]; // Granules du bloc commençant ici, 0 = libre
+
+static int heapAlloc(size_t size) {
+    uint16_t need = (size + 4 + SIM_GRANULE - 1) / SIM_GRANULE; // En-tête de 4 octets, comme l'allocateur de l'IDF
+    uint16_t run = 0;
+    for (uint16_t g = 0; g < SIM_GRANULES;) {
+        if (s_blockLen[g]) {
+            g += s_blockLen[g];
+            run = 0;
+            continue;
+        }
+        if (++run == need) {
+            uint16_t start = g + 1 - need;
+            s_blockLen[start] = need;
+            return start;
+        }
+        g++;
+    }
+    return -1;
+}
+
+static void heapFree(int block) {
+    if (block >= 0) {
+        s_blockLen[block] = 0;
+    }
+}
+
+static size_t heapLargestFree() {
+    uint16_t best = 0;
+    uint16_t run = 0;
+    for (uint16_t g = 0; g < SIM_GRANULES;) {
+        if (s_blockLen[g]) {
+            g += s_blockLen[g];
+            run = 0;
+            continue;
+        }
+        run++;
+        best = run > best ? run : best;
+        g++;
+    }
+    return best * SIM_GRANULE;
+}
+
+static size_t heapFreeTotal() {
+    size_t used = 0;
+    for (uint16_t g = 0; g < SIM_GRANULES; g += s_blockLen[g] ? s_blockLen[g] : 1) {
+        used += s_blockLen[g];
+    }
+    return (SIM_GRANULES - used) * SIM_GRANULE;
+}
+
+// String Arduino : tampon ré-alloué quand la nouvelle valeur ne tient plus
+struct HeapString {
+    int block = -1;
+    size_t capacity = 0;
+
+    void assign(size_t len) {
+        if (len + 1 > capacity) {
+            heapFree(block);
+            block = heapAlloc(len + 1);
+            capacity = len + 1;
+        }
+    }
+};
+
+#define SIM_CONFIG_STRINGS 8 // farmId, zoneId, nodeId, ssid, password, broker, topic, master_mac
+#define SIM_CYCLES 2000
+
+// Un cycle : trame de télémétrie allouée (vit jusqu'au cycle suivant), puis toutes
+// les 10 trames un rechargement de config (réserve remplie, copiée, libérée) et
+// toutes les 100 une allocation durable (pair, session)
+static size_t runSoak(bool stringConfig, size_t& minLargest, size_t& freeTotal) {
+    memset(s_blockLen, 0, sizeof(s_blockLen));
+    HeapString active[SIM_CONFIG_STRINGS];
+    int frame = -1;
+    uint32_t seed = 12345;
+    minLargest = SIZE_MAX;
+    for (uint32_t cycle = 0; cycle < SIM_CYCLES; cycle++) {
+        seed = seed * 1103515245u + 12345u;
+        int next = heapAlloc(160 + (seed >> 16) % 120);
+        heapFree(frame);
+        frame = next;
+
+        if (stringConfig && cycle % 10 == 0) {
+            HeapString standby[SIM_CONFIG_STRINGS];
+            for (uint8_t i = 0; i < SIM_CONFIG_STRINGS; i++) {
+                size_t len = 6 + (seed >> (i + 8)) % (i < 3 ? 12 : 40);
+                standby[i].assign(len);
+                active[i].assign(len);
+            }
+            for (uint8_t i = 0; i < SIM_CONFIG_STRINGS; i++) {
+                heapFree(standby[i].block);
+            }
+        }
+        if (cycle % 100 == 50) {
+            heapAlloc(48);
+        }
+        size_t largest = heapLargestFree();
+        minLargest = largest < minLargest ? largest : minLargest;
+    }
+    freeTotal = heapFreeTotal();
+    return heapLargestFree();
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+static void test_assign_fits_and_truncates() {
+    FixedString<8> s;
+    TEST_ASSERT_TRUE(s.assign("NODE_1"));
+    TEST_ASSERT_EQUAL_STRING("NODE_1", s.c_str());
+    TEST_ASSERT_TRUE(s.assign("1234567")); // 7 caractères + '\0' : tient exactement
+    TEST_ASSERT_EQUAL_UINT32(7, s.length());
+    TEST_ASSERT_FALSE(s.assign("12345678"));
+    TEST_ASSERT_EQUAL_STRING("1234567", s.c_str());
+    TEST_ASSERT_EQUAL_UINT32(7, FixedString<8>::capacity());
+}
+
+static void test_assign_with_length_and_null() {
+    FixedString<16> s;
+    TEST_ASSERT_TRUE(s.assign("farm/telemetry", 4)); // Sous-chaîne sans '\0'
+    TEST_ASSERT_EQUAL_STRING("farm", s.c_str());
+    TEST_ASSERT_TRUE(s.assign(nullptr));
+    TEST_ASSERT_TRUE(s.isEmpty());
+    s = "broker.local";
+    TEST_ASSERT_EQUAL_STRING("broker.local", s.c_str());
+}
+
+static void test_comparisons() {
+    FixedString<16> a;
+    FixedString<16> b;
+    a = "ZONE_A";
+    b = "ZONE_A";
+    TEST_ASSERT_TRUE(a == "ZONE_A");
+    TEST_ASSERT_TRUE(a != "ZONE_B");
+    TEST_ASSERT_FALSE(a == nullptr);
+    TEST_ASSERT_TRUE(a == b);
+    b = "ZONE_B";
+    TEST_ASSERT_TRUE(a != b);
+}
+
+// Config reste copiable octet par octet (image NVS, copie de la config active)
+static void test_config_is_trivially_copyable() {
+    TEST_ASSERT_TRUE(std::is_trivially_copyable<FixedString<CONFIG_ID_LEN>>::value);
+    TEST_ASSERT_TRUE(std::is_trivially_copyable<Config>::value);
+
+    static Config a;
+    static Config b;
+    memset((void*)&a, 0, sizeof(a));
+    a.identity.nodeId = "NODE_42";
+    a.network.mqtt_broker = "broker.local";
+    memcpy(&b, &a, sizeof(Config));
+    TEST_ASSERT_TRUE(b.identity.nodeId == "NODE_42");
+    TEST_ASSERT_TRUE(b.network.mqtt_broker == a.network.mqtt_broker);
+}
+
+// Rechargements répétés : les String de l'ancienne Config laissent des trous entre
+// les trames et les allocations durables, la Config à chaînes fixes n'en ajoute aucun
+static void test_fixed_config_keeps_heap_contiguous() {
+    size_t oldMin, oldFree, newMin, newFree;
+    size_t oldLargest = runSoak(true, oldMin, oldFree);
+    size_t newLargest = runSoak(false, newMin, newFree);
+
+    char msg[200];
+    snprintf(msg, sizeof(msg),
+             "%u cycles, tas de %u o : plus grand bloc libre / libre total String %u / %u o (min %u), "
+             "fixe %u / %u o (min %u)",
+             (unsigned)SIM_CYCLES, (unsigned)SIM_HEAP_SIZE, (unsigned)oldLargest, (unsigned)oldFree,
+             (unsigned)oldMin, (unsigned)newLargest, (unsigned)newFree, (unsigned)newMin);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_GREATER_THAN(oldMin, newMin);
+    TEST_ASSERT_GREATER_OR_EQUAL(oldLargest, newLargest);
+    // Libre mais inutilisable : trous laissés entre blocs occupés
+    TEST_ASSERT_LESS_OR_EQUAL(oldFree - oldLargest, newFree - newLargest);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_assign_fits_and_truncates);
+    RUN_TEST(test_assign_with_length_and_null);
+    RUN_TEST(test_comparisons);
+    RUN_TEST(test_config_is_trivially_copyable);
+    RUN_TEST(test_fixed_config_keeps_heap_contiguous);
+    return UNITY_END();
+}
@@ -0,0 +1,247 @@
+// Pool fixe des JsonDocument : allocation en pile, récupération, débordement ;
+// transfert d'une trame Follower par le Master, ancien et nouveau chemin
+#include <unity.h>
+#include <chrono>
+#include <string>
+#include "JsonPool.h"
+
+// Sur l'hôte 64 bits, le premier bloc de variantes d'ArduinoJson 7 fait 4 Ko
+// (2 Ko sur ESP32) : les pools des documents sont doublés par rapport au firmware
+static const size_t DOC_POOL = 8192;
+
+// Trame de Follower::sendSensorData() : identité pré-encodée, puis capteurs
+static const char* const TELEMETRY =
+    "{\"identity\":{\"farmId\":\"FARM_1\",\"zoneId\":\"ZONE_A\",\"nodeId\":\"NODE_7\",\"isMaster\":false},"
+    "\"timestamp\":1704067200,\"seq\":1234,\"buf\":0,\"v\":0,\"sensors\":{\"soilHumidity1\":41.2,"
+    "\"soilHumidity2\":38.9,\"soilHumidity3\":44,\"soilHumidity4\":40.1,\"temp\":21.5},\"tAge\":12}";
+
+// Allocateur du tas qui compte ses appels (allocate et reallocate)
+class CountingAllocator : public ArduinoJson::Allocator {
+public:
+    size_t calls = 0;
+
+    void* allocate(size_t size) override {
+        calls++;
+        return malloc(size);
+    }
+    void deallocate(void* ptr) override { free(ptr); }
+    void* reallocate(void* ptr, size_t size) override {
+        calls++;
+        return realloc(ptr, size);
+    }
+};
+
+void setUp() {}
+
+void tearDown() {}
+
+static void test_blocks_are_aligned_and_accounted() {
+    JsonPool<256> pool;
+    uint8_t* a = (uint8_t*)pool.allocate(5);
+    uint8_t* b = (uint8_t*)pool.allocate(16);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t)a % 8);
+    TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t)b % 8);
+    TEST_ASSERT_EQUAL_UINT32(8 + 8 + 8 + 16, pool.used()); // En-tête + bloc arrondi
+    TEST_ASSERT_EQUAL_UINT32(256, JsonPool<256>::capacity());
+}
+
+static void test_exhaustion_returns_null() {
+    JsonPool<64> pool;
+    TEST_ASSERT_NOT_NULL(pool.allocate(40));
+    size_t used = pool.used();
+    TEST_ASSERT_NULL(pool.allocate(9)); // 8 + 16 > 64 - 48
+    TEST_ASSERT_EQUAL_UINT32(used, pool.used());
+    TEST_ASSERT_NOT_NULL(pool.allocate(8)); // Remplit exactement
+    TEST_ASSERT_EQUAL_UINT32(64, pool.used());
+}
+
+static void test_last_block_reclaimed_and_reset_when_empty() {
+    JsonPool<256> pool;
+    void* a = pool.allocate(32);
+    void* b = pool.allocate(32);
+    size_t afterA = pool.used() - 40;
+    pool.deallocate(b);
+    TEST_ASSERT_EQUAL_UINT32(afterA, pool.used()); // Dernier bloc : récupéré tout de suite
+    void* c = pool.allocate(16);
+    TEST_ASSERT_EQUAL_PTR(b, c);
+    pool.deallocate(a); // Bloc intermédiaire : attend la libération des suivants
+    TEST_ASSERT_GREATER_THAN(0, pool.used());
+    pool.deallocate(c);
+    TEST_ASSERT_EQUAL_UINT32(0, pool.used());
+    pool.deallocate(nullptr);
+    TEST_ASSERT_EQUAL_UINT32(0, pool.used());
+}
+
+static void test_reallocate_in_place_and_moved() {
+    JsonPool<256> pool;
+    char* a = (char*)pool.allocate(8);
+    memcpy(a, "abcdefg", 8);
+    // Dernier bloc : grandit puis rétrécit sur place
+    TEST_ASSERT_EQUAL_PTR(a, pool.reallocate(a, 64));
+    TEST_ASSERT_EQUAL_UINT32(8 + 64, pool.used());
+    TEST_ASSERT_EQUAL_PTR(a, pool.reallocate(a, 8));
+    TEST_ASSERT_EQUAL_UINT32(16, pool.used());
+    TEST_ASSERT_NULL(pool.reallocate(a, 512)); // Trop grand : bloc intact
+    TEST_ASSERT_EQUAL_STRING("abcdefg", a);
+
+    // Bloc recouvert par un autre : déplacé, contenu conservé
+    void* b = pool.allocate(8);
+    char* moved = (char*)pool.reallocate(a, 32);
+    TEST_ASSERT_NOT_NULL(moved);
+    TEST_ASSERT_TRUE(moved != a);
+    TEST_ASSERT_EQUAL_STRING("abcdefg", moved);
+    pool.deallocate(b);
+    pool.deallocate(moved);
+    TEST_ASSERT_EQUAL_UINT32(0, pool.used());
+
+    TEST_ASSERT_NOT_NULL(pool.reallocate(nullptr, 8)); // Équivaut à allocate
+}
+
+static void test_document_uses_pool_only() {
+    JsonPool<DOC_POOL> pool;
+    {
+        JsonDocument doc(&pool);
+        TEST_ASSERT_EQUAL(DeserializationError::Ok, deserializeJson(doc, TELEMETRY).code());
+        TEST_ASSERT_EQUAL_STRING("NODE_7", doc["identity"]["nodeId"].as<const char*>());
+        TEST_ASSERT_FLOAT_WITHIN(0.001f, 44.0f, doc["sensors"]["soilHumidity3"].as<float>());
+        TEST_ASSERT_GREATER_THAN(0, pool.used());
+        doc.clear();
+        TEST_ASSERT_EQUAL_UINT32(0, pool.used());
+
+        // Nouveau message dans le même pool, sans résidu du précédent
+        TEST_ASSERT_EQUAL(DeserializationError::Ok, deserializeJson(doc, TELEMETRY).code());
+        doc["ack"] = true;
+        TEST_ASSERT_FALSE(doc.overflowed());
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, pool.used()); // Document détruit : pool vide
+}
+
+static void test_overflow_is_reported() {
+    JsonPool<DOC_POOL> pool;
+    std::string big = "[";
+    for (int i = 0; i < 1000; i++) {
+        big += i ? ",\"valeur_" : "\"valeur_";
+        big += std::to_string(i) + "\"";
+    }
+    big += "]";
+    JsonDocument doc(&pool);
+    TEST_ASSERT_EQUAL(DeserializationError::NoMemory, deserializeJson(doc, big).code());
+
+    doc.clear();
+    JsonArray arr = doc.to<JsonArray>();
+    for (int i = 0; i < 1000; i++) {
+        arr.add(std::string("valeur_") + std::to_string(i));
+    }
+    TEST_ASSERT_TRUE(doc.overflowed());
+}
+
+static void test_documents_share_a_pool() {
+    JsonPool<2 * DOC_POOL> pool;
+    JsonDocument a(&pool);
+    JsonDocument b(&pool);
+    TEST_ASSERT_EQUAL(DeserializationError::Ok, deserializeJson(a, TELEMETRY).code());
+    TEST_ASSERT_EQUAL(DeserializationError::Ok, deserializeJson(b, TELEMETRY).code());
+    TEST_ASSERT_EQUAL_STRING("FARM_1", a["identity"]["farmId"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("FARM_1", b["identity"]["farmId"].as<const char*>());
+    a.clear();
+    TEST_ASSERT_GREATER_THAN(0, pool.used());
+    b.clear();
+    TEST_ASSERT_EQUAL_UINT32(0, pool.used());
+}
+
+// Ancien chemin du Master : parsing complet, puis trame re-sérialisée
+static size_t forwardReserialized(JsonDocument& doc, char* frame, size_t size) {
+    if (deserializeJson(doc, TELEMETRY)) {
+        return 0;
+    }
+    return serializeJson(doc, frame, size);
+}
+
+// Nouveau chemin : parsing filtré (champs utiles à la logique), trame d'origine
+// recopiée telle quelle, comme Master::buildTelemetryFrame() sans enveloppe
+static size_t forwardFiltered(JsonDocument& doc, JsonDocument& filter, char* frame, size_t size) {
+    size_t len = strlen(TELEMETRY);
+    if (deserializeJson(doc, TELEMETRY, len, DeserializationOption::Filter(filter)) || len >= size) {
+        return 0;
+    }
+    if (doc["identity"]["nodeId"].isNull() || doc["sensors"]["soilHumidity1"].isNull()) {
+        return 0;
+    }
+    memcpy(frame, TELEMETRY, len);
+    frame[len] = '\0';
+    return len;
+}
+
+static const int FORWARD_ROUNDS = 20000;
+
+template <typename Forward>
+static double forwardNs(Forward forward) {
+    char frame[512];
+    volatile size_t sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < FORWARD_ROUNDS; k++) {
+        sink = sink + forward(frame, sizeof(frame));
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / FORWARD_ROUNDS;
+}
+
+static void test_benchmark_forward_paths() {
+    JsonDocument filter; // Celui du constructeur du Master
+    filter["type"] = true;
+    filter["t1"] = true;
+    filter["identity"]["nodeId"] = true;
+    filter["sensors"] = true;
+
+    static JsonPool<DOC_POOL> pool;
+    CountingAllocator oldHeap;
+    CountingAllocator newHeap;
+    JsonDocument oldDoc(&oldHeap);
+    JsonDocument pooledDoc(&pool);
+    JsonDocument heapDoc(&newHeap);
+
+    // Les deux chemins transfèrent une trame équivalente ; le nouveau, octet pour octet
+    char a[512];
+    char b[512];
+    TEST_ASSERT_GREATER_THAN(0, forwardReserialized(oldDoc, a, sizeof(a)));
+    TEST_ASSERT_EQUAL_UINT32(strlen(TELEMETRY), forwardFiltered(pooledDoc, filter, b, sizeof(b)));
+    TEST_ASSERT_EQUAL_STRING(TELEMETRY, b);
+    JsonDocument check;
+    TEST_ASSERT_EQUAL(DeserializationError::Ok, deserializeJson(check, a).code());
+    TEST_ASSERT_EQUAL_STRING("NODE_7", check["identity"]["nodeId"].as<const char*>());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 40.1f, check["sensors"]["soilHumidity4"].as<float>());
+
+    oldHeap.calls = 0;
+    double oldNs = forwardNs([&](char* f, size_t n) { return forwardReserialized(oldDoc, f, n); });
+    double oldCalls = (double)oldHeap.calls / FORWARD_ROUNDS;
+    double pooledNs = forwardNs([&](char* f, size_t n) { return forwardFiltered(pooledDoc, filter, f, n); });
+    newHeap.calls = 0;
+    double heapNs = forwardNs([&](char* f, size_t n) { return forwardFiltered(heapDoc, filter, f, n); });
+    double newCalls = (double)newHeap.calls / FORWARD_ROUNDS;
+
+    char msg[256];
+    snprintf(msg, sizeof(msg),
+             "transfert d'une trame Follower : complet + re-sérialisé %.0f ns (%.1f alloc. tas/trame), "
+             "filtré + copie %.0f ns en pool (0 alloc.), %.0f ns sur le tas (%.1f alloc./trame) (hôte)",
+             oldNs, oldCalls, pooledNs, heapNs, newCalls);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(newCalls < oldCalls);
+    pooledDoc.clear();
+    TEST_ASSERT_EQUAL_UINT32(0, pool.used());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_blocks_are_aligned_and_accounted);
+    RUN_TEST(test_exhaustion_returns_null);
+    RUN_TEST(test_last_block_reclaimed_and_reset_when_empty);
+    RUN_TEST(test_reallocate_in_place_and_moved);
+    RUN_TEST(test_document_uses_pool_only);
+    RUN_TEST(test_overflow_is_reported);
+    RUN_TEST(test_documents_share_a_pool);
+    RUN_TEST(test_benchmark_forward_paths);
+    return UNITY_END();
+}
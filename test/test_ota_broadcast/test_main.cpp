@@ -0,0 +1,346 @@
+// Diffusion fenêtrée d'images vers un groupe de Followers, sur une radio simulée
+// avec pertes et corruption : complétude, coût en trames, reprise après coupure
+#include <unity.h>
+#include <string>
+#include "comms/OtaSender.cpp"
+#include "comms/OtaReceiver.cpp"
+#include "logic/ZoneTable.cpp"
+
+#define SIM_MAX_NODES 8
+#define SIM_PARTITION_SIZE 0x180000 // Comme app0/app1 sur la cible
+
+struct SimNode {
+    Config config;
+    esp_partition_t partition;
+    CommManager* comms;
+    OtaReceiver* ota;
+    bool online;
+    uint32_t chunksDelivered;
+    OtaState result;
+    uint16_t resultReceived;
+};
+
+static SimNode s_nodes[SIM_MAX_NODES];
+static uint8_t s_numNodes;
+static CommManager* s_masterComms;
+static OtaSender* s_sender;
+static std::string s_image;
+
+// Radio : pertes indépendantes par trame et par destinataire, dans les deux sens
+static CommMode s_mode;
+static uint32_t s_lossPct;
+static uint32_t s_corruptPct;
+static uint32_t s_seed;
+static uint32_t s_chunkFrames;
+static uint32_t s_offerFrames;
+static uint32_t s_statusFrames;
+static uint8_t s_staged;
+
+static uint32_t draw() {
+    s_seed = s_seed * 1103515245u + 12345u;
+    return (s_seed >> 16) % 100;
+}
+
+// --- Radio et dépendances du Follower, remplacées pour l'essai ---
+static HardwareSerial s_uart;
+
+ESPNowComms::ESPNowComms(Actuator* actuator) : actuator(actuator) {}
+LoraComms::LoraComms(HardwareSerial& serial, Actuator* actuator) : loraSerial(serial), actuator(actuator) {}
+CommManager::CommManager(Actuator* actuator)
+    : espNow(actuator), lora(s_uart, actuator), activeMode(s_mode), actuator(actuator) {}
+
+bool CommManager::broadcastBytes(const uint8_t* data, int len) {
+    OtaFrameType type = (OtaFrameType)data[1];
+    if (type == OtaFrameType::CHUNK) {
+        s_chunkFrames++;
+    } else if (type == OtaFrameType::OFFER) {
+        s_offerFrames++;
+    }
+    for (uint8_t i = 0; i < s_numNodes; i++) {
+        SimNode& n = s_nodes[i];
+        if (!n.online || draw() < s_lossPct) {
+            continue;
+        }
+        uint8_t frame[sizeof(OtaChunk)];
+        memcpy(frame, data, len);
+        if (type == OtaFrameType::CHUNK) {
+            if (draw() < s_corruptPct) {
+                frame[len - 1] ^= 0x10; // Bit altéré : rejeté par le CRC du bloc
+            }
+            n.chunksDelivered++;
+        }
+        n.ota->onFrame(frame, len);
+    }
+    return true;
+}
+
+bool CommManager::sendBytes(const uint8_t* data, int len) {
+    s_statusFrames++;
+    if (draw() >= s_lossPct) {
+        s_sender->onFrame(data, len);
+    }
+    return true;
+}
+
+bool ConfigUpdate::stageFile(const char* path, uint32_t& changes, String& error) {
+    s_staged++;
+    changes = 1;
+    if (!SPIFFS.exists(path)) {
+        error = "fichier absent";
+        return false;
+    }
+    return true;
+}
+
+// --- Mise en place ---
+static void makeImage(size_t size) {
+    s_image.resize(size);
+    uint32_t x = 2463534242u;
+    for (size_t i = 0; i < size; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        s_image[i] = (char)x;
+    }
+}
+
+static void bootNode(SimNode& n) {
+    shimOta().next = &n.partition;
+    n.ota = new OtaReceiver(n.config);
+    n.ota->begin();
+    n.online = true;
+}
+
+static void addNode() {
+    SimNode& n = s_nodes[s_numNodes++];
+    memset((void*)&n.config, 0, sizeof(n.config));
+    char nodeId[16];
+    snprintf(nodeId, sizeof(nodeId), "NODE_%u", s_numNodes);
+    n.config.identity.nodeId = nodeId;
+    n.partition = {0x50000, SIM_PARTITION_SIZE, "app1", false};
+    n.comms = new CommManager(nullptr);
+    n.chunksDelivered = 0;
+    n.result = OtaState::IDLE;
+    n.resultReceived = 0;
+    bootNode(n);
+}
+
+static void setupNetwork(CommMode mode, uint8_t nodes, uint32_t lossPct, uint32_t corruptPct) {
+    s_mode = mode;
+    s_lossPct = lossPct;
+    s_corruptPct = corruptPct;
+    s_masterComms = new CommManager(nullptr);
+    s_sender = new OtaSender(*s_masterComms);
+    s_sender->registerResultCallback([](const char* nodeId, OtaState state, uint16_t received, uint16_t) {
+        for (uint8_t i = 0; i < s_numNodes; i++) {
+            if (s_nodes[i].config.identity.nodeId == nodeId) {
+                s_nodes[i].result = state;
+                s_nodes[i].resultReceived = received;
+            }
+        }
+    });
+    for (uint8_t i = 0; i < nodes; i++) {
+        addNode();
+    }
+}
+
+static bool startTransfer(OtaKind kind, const char* path, uint8_t extraTargets = 0) {
+    SPIFFS.put(path, s_image);
+    static const char* ids[SIM_MAX_NODES + 2];
+    static const char* const GHOSTS[] = {"NODE_GHOST_1", "NODE_GHOST_2"};
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < s_numNodes; i++) {
+        ids[count++] = s_nodes[i].config.identity.nodeId.c_str();
+    }
+    for (uint8_t i = 0; i < extraTargets && i < 2; i++) {
+        ids[count++] = GHOSTS[i];
+    }
+    return s_sender->start(kind, path, ids, count);
+}
+
+// Boucles Master et Followers au pas de 1 ms jusqu'à la fin du transfert
+static uint32_t runUntilIdle(uint32_t limitMs, bool (*stop)() = nullptr) {
+    unsigned long t0 = millis();
+    while (s_sender->isActive() && millis() - t0 < limitMs) {
+        s_sender->update();
+        for (uint8_t i = 0; i < s_numNodes; i++) {
+            SimNode& n = s_nodes[i];
+            if (n.online) {
+                shimOta().next = &n.partition;
+                n.ota->update(*n.comms, true);
+            }
+        }
+        if (stop && stop()) {
+            break;
+        }
+        advanceMs(1);
+    }
+    return millis() - t0;
+}
+
+static void checkFirmwareReceived(const SimNode& n) {
+    TEST_ASSERT_EQUAL(OtaState::COMPLETE, n.result);
+    TEST_ASSERT_TRUE(n.ota->rebootPending());
+    TEST_ASSERT_EQUAL_MEMORY(s_image.data(), shimPartitionData(&n.partition).data(), s_image.size());
+}
+
+void setUp() {
+    setMillis(1000);
+    SPIFFS.reset();
+    Preferences::store().clear();
+    shimOta().boot = nullptr;
+    s_numNodes = 0;
+    s_seed = 7;
+    s_chunkFrames = 0;
+    s_offerFrames = 0;
+    s_statusFrames = 0;
+    s_staged = 0;
+}
+
+void tearDown() {
+    for (uint8_t i = 0; i < s_numNodes; i++) {
+        delete s_nodes[i].ota;
+        delete s_nodes[i].comms;
+    }
+    s_numNodes = 0;
+    delete s_sender;
+    s_sender = nullptr;
+    delete s_masterComms;
+    s_masterComms = nullptr;
+}
+
+// Liaison parfaite : chaque bloc n'est diffusé qu'une fois, pour tous les nœuds
+static void test_lossless_broadcast_sends_each_chunk_once() {
+    makeImage(40000);
+    setupNetwork(CommMode::ESP_NOW, 6, 0, 0);
+    TEST_ASSERT_TRUE(startTransfer(OtaKind::FIRMWARE, "/fw.bin"));
+    runUntilIdle(60000);
+
+    TEST_ASSERT_FALSE(s_sender->isActive());
+    uint16_t chunks = (s_image.size() + OTA_CHUNK_SIZE - 1) / OTA_CHUNK_SIZE;
+    TEST_ASSERT_EQUAL_UINT32(chunks, s_chunkFrames);
+    for (uint8_t i = 0; i < s_numNodes; i++) {
+        checkFirmwareReceived(s_nodes[i]);
+        TEST_ASSERT_EQUAL_UINT16(chunks, s_nodes[i].resultReceived);
+    }
+}
+
+// 8 Followers, 20 % de pertes et 2 % de blocs altérés : tous complets, pour bien
+// moins de trames qu'un envoi individuel à chaque nœud
+static void test_lossy_broadcast_completes() {
+    makeImage(64000);
+    setupNetwork(CommMode::ESP_NOW, 8, 20, 2);
+    TEST_ASSERT_TRUE(startTransfer(OtaKind::FIRMWARE, "/fw.bin"));
+    uint32_t elapsed = runUntilIdle(600000);
+
+    TEST_ASSERT_FALSE(s_sender->isActive());
+    for (uint8_t i = 0; i < s_numNodes; i++) {
+        checkFirmwareReceived(s_nodes[i]);
+    }
+    uint32_t chunks = (s_image.size() + OTA_CHUNK_SIZE - 1) / OTA_CHUNK_SIZE;
+    // Unicast : chaque nœud reçoit tous les blocs, retransmissions comprises
+    uint32_t unicast = chunks * s_numNodes * 100 / (100 - s_lossPct);
+    char msg[160];
+    snprintf(msg, sizeof(msg),
+             "8 Followers, 20 %% de pertes : %u blocs diffusés pour %u (x%.2f), %u relevés, "
+             "%u états, %.1f s ; unicast ~%u trames",
+             (unsigned)s_chunkFrames, (unsigned)chunks, (double)s_chunkFrames / chunks,
+             (unsigned)s_offerFrames, (unsigned)s_statusFrames, elapsed / 1000.0, (unsigned)unicast);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_LESS_THAN(chunks * 3, s_chunkFrames);
+    TEST_ASSERT_LESS_THAN(unicast / 2, s_chunkFrames + s_offerFrames + s_statusFrames);
+}
+
+// Config sur LoRa : cadence lente, fichier pré-alloué écrit dans le désordre
+static void test_config_over_lora() {
+    makeImage(12000);
+    setupNetwork(CommMode::LORA, 1, 10, 0);
+    TEST_ASSERT_TRUE(startTransfer(OtaKind::CONFIG, "/config.new.json"));
+    uint32_t elapsed = runUntilIdle(3600000);
+
+    TEST_ASSERT_EQUAL(OtaState::COMPLETE, s_nodes[0].result);
+    TEST_ASSERT_EQUAL_UINT8(1, s_staged);
+    TEST_ASSERT_TRUE(SPIFFS.get(OTA_CONFIG_FILE) == s_image);
+    TEST_ASSERT_FALSE(s_nodes[0].ota->rebootPending());
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "config de 12 Ko sur LoRa (10 %% de pertes) : %.1f s, %u blocs diffusés",
+             elapsed / 1000.0, (unsigned)s_chunkFrames);
+    TEST_MESSAGE(msg);
+}
+
+// Un Follower visé ne répond jamais : écarté à l'expiration de l'offre, les autres servis
+static void test_silent_target_is_dropped() {
+    makeImage(8000);
+    setupNetwork(CommMode::ESP_NOW, 2, 0, 0);
+    TEST_ASSERT_TRUE(startTransfer(OtaKind::FIRMWARE, "/fw.bin", 1));
+    uint32_t elapsed = runUntilIdle(120000);
+
+    TEST_ASSERT_FALSE(s_sender->isActive());
+    TEST_ASSERT_GREATER_OR_EQUAL(OTA_OFFER_TIMEOUT_MS, elapsed);
+    checkFirmwareReceived(s_nodes[0]);
+    checkFirmwareReceived(s_nodes[1]);
+}
+
+// Image de 1 Mo, 8 Followers, pertes de 0 à 30 % : relevés (tours), trames et durée
+// simulée à la cadence ESP-NOW du Master
+static void test_one_megabyte_loss_sweep() {
+    static const uint32_t LOSSES[] = {0, 5, 10, 20, 30};
+    makeImage(1024UL * 1024UL);
+    uint32_t chunks = (s_image.size() + OTA_CHUNK_SIZE - 1) / OTA_CHUNK_SIZE;
+    for (uint8_t k = 0; k < sizeof(LOSSES) / sizeof(LOSSES[0]); k++) {
+        tearDown();
+        setUp();
+        setupNetwork(CommMode::ESP_NOW, 8, LOSSES[k], 0);
+        TEST_ASSERT_TRUE(startTransfer(OtaKind::FIRMWARE, "/fw.bin"));
+        uint32_t elapsed = runUntilIdle(3600000);
+
+        TEST_ASSERT_FALSE(s_sender->isActive());
+        for (uint8_t i = 0; i < s_numNodes; i++) {
+            checkFirmwareReceived(s_nodes[i]);
+        }
+        char msg[160];
+        snprintf(msg, sizeof(msg),
+                 "1 Mo, %2u %% de pertes : %u tours, %u blocs diffusés pour %u (x%.2f), %u états, %.1f s",
+                 (unsigned)LOSSES[k], (unsigned)s_offerFrames, (unsigned)s_chunkFrames, (unsigned)chunks,
+                 (double)s_chunkFrames / chunks, (unsigned)s_statusFrames, elapsed / 1000.0);
+        TEST_MESSAGE(msg);
+        TEST_ASSERT_LESS_THAN(chunks * 3, s_chunkFrames);
+    }
+}
+
+static bool hundredChunksDelivered() {
+    return s_nodes[0].chunksDelivered >= 100;
+}
+
+// Redémarrage du Follower au milieu du transfert : reprise depuis la NVS, seuls
+// les blocs reçus après la dernière sauvegarde sont redemandés
+static void test_resume_after_follower_reboot() {
+    makeImage(60000);
+    setupNetwork(CommMode::ESP_NOW, 1, 0, 0);
+    TEST_ASSERT_TRUE(startTransfer(OtaKind::FIRMWARE, "/fw.bin"));
+    runUntilIdle(60000, hundredChunksDelivered);
+    TEST_ASSERT_TRUE(s_sender->isActive());
+
+    SimNode& n = s_nodes[0];
+    delete n.ota; // Coupure : la file et le bitmap en RAM sont perdus
+    n.online = false;
+    advanceMs(2000);
+    bootNode(n);
+    runUntilIdle(120000);
+
+    checkFirmwareReceived(n);
+    uint32_t chunks = (s_image.size() + OTA_CHUNK_SIZE - 1) / OTA_CHUNK_SIZE;
+    TEST_ASSERT_LESS_OR_EQUAL(chunks + 64, n.chunksDelivered); // SAVE_EVERY
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_lossless_broadcast_sends_each_chunk_once);
+    RUN_TEST(test_lossy_broadcast_completes);
+    RUN_TEST(test_config_over_lora);
+    RUN_TEST(test_silent_target_is_dropped);
+    RUN_TEST(test_one_megabyte_loss_sweep);
+    RUN_TEST(test_resume_after_follower_reboot);
+    return UNITY_END();
+}
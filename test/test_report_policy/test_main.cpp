@@ -0,0 +1,156 @@
+// Politique d'envoi événementielle : seuils avec hystérésis, pente, écart, heartbeat
+#include <unity.h>
+#include "logic/ReportPolicy.cpp"
+
+static ConfigReporting s_cfg;
+
+void setUp() {
+    memset(&s_cfg, 0, sizeof(s_cfg));
+    s_cfg.event_driven = true;
+    s_cfg.thresholds[0] = 60.0f; // Volontairement non triés
+    s_cfg.thresholds[1] = 40.0f;
+    s_cfg.num_thresholds = 2;
+    s_cfg.hysteresis = 1.0f;
+    s_cfg.min_delta = 2.0f;
+    s_cfg.max_slope_per_min = 0.5f;
+    s_cfg.check_interval_ms = 30000;
+    s_cfg.min_interval_ms = 10000;
+    s_cfg.heartbeat_ms = 3600000;
+}
+
+void tearDown() {}
+
+// Politique dont le dernier envoi acquitté vaut value à t0 (évaluation comprise)
+static void reportedAt(ReportPolicy& policy, float value, uint32_t t0) {
+    policy.begin(true);
+    float v[1] = {value};
+    TEST_ASSERT_EQUAL(ReportReason::HEARTBEAT, policy.evaluate(v, 1, t0)); // Premier envoi
+    policy.markReported(v, 1, t0);
+}
+
+static ReportReason evalAt(ReportPolicy& policy, float value, uint32_t t) {
+    float v[1] = {value};
+    return policy.evaluate(v, 1, t);
+}
+
+static void test_first_evaluation_is_heartbeat() {
+    ReportPolicy policy(s_cfg);
+    policy.begin(true);
+    float v[2] = {50.0f, 50.0f};
+    TEST_ASSERT_EQUAL(ReportReason::HEARTBEAT, policy.evaluate(v, 2, 100));
+}
+
+static void test_min_interval_suppresses() {
+    ReportPolicy policy(s_cfg);
+    reportedAt(policy, 50.0f, 1000);
+    TEST_ASSERT_EQUAL(ReportReason::NONE, evalAt(policy, 20.0f, 1005)); // 5 s < 10 s
+}
+
+static void test_threshold_with_hysteresis() {
+    ReportPolicy policy(s_cfg);
+    reportedAt(policy, 50.0f, 1000);
+    // 39,5 % : sous le seuil de 40 % mais dans l'hystérésis, seulement un écart
+    // (séchage lent : pente sous 0,5 %/min)
+    TEST_ASSERT_EQUAL(ReportReason::DELTA, evalAt(policy, 39.5f, 4000));
+    TEST_ASSERT_EQUAL(ReportReason::THRESHOLD, evalAt(policy, 38.9f, 5000));
+    TEST_ASSERT_TRUE(ReportPolicy::isUrgent(ReportReason::THRESHOLD));
+
+    // Seuil supérieur (trié par reload malgré l'ordre de la configuration)
+    reportedAt(policy, 50.0f, 10000);
+    TEST_ASSERT_EQUAL(ReportReason::THRESHOLD, evalAt(policy, 61.1f, 11000));
+}
+
+static void test_slope_and_delta() {
+    ReportPolicy policy(s_cfg);
+    reportedAt(policy, 50.0f, 1000);
+    TEST_ASSERT_EQUAL(ReportReason::NONE, evalAt(policy, 50.2f, 1060));
+    // +1,3 % en 60 s : pente de 1,3 %/min > 0,5 %/min
+    TEST_ASSERT_EQUAL(ReportReason::SLOPE, evalAt(policy, 51.5f, 1120));
+    // Variation lente mais cumulée >= 2 %
+    TEST_ASSERT_EQUAL(ReportReason::DELTA, evalAt(policy, 52.0f, 1300));
+}
+
+static void test_heartbeat_after_silence() {
+    ReportPolicy policy(s_cfg);
+    reportedAt(policy, 50.0f, 1000);
+    TEST_ASSERT_EQUAL(ReportReason::NONE, evalAt(policy, 50.0f, 1000 + 3599));
+    TEST_ASSERT_EQUAL(ReportReason::HEARTBEAT, evalAt(policy, 50.0f, 1000 + 3600));
+}
+
+static void test_nan_channels_ignored() {
+    ReportPolicy policy(s_cfg);
+    policy.begin(true);
+    float v[2] = {50.0f, NAN};
+    policy.evaluate(v, 2, 1000);
+    policy.markReported(v, 2, 1000);
+    float w[2] = {50.0f, 10.0f}; // Sonde 2 revenue : pas d'envoi de seuil sur une référence absente
+    TEST_ASSERT_EQUAL(ReportReason::DELTA, policy.evaluate(w, 2, 2000));
+}
+
+static void test_state_survives_deep_sleep() {
+    {
+        ReportPolicy policy(s_cfg);
+        reportedAt(policy, 50.0f, 1000);
+    }
+    ReportPolicy afterWake(s_cfg);
+    afterWake.begin(false); // Réveil : état RTC conservé
+    TEST_ASSERT_EQUAL(ReportReason::NONE, evalAt(afterWake, 50.2f, 1600));
+
+    ReportPolicy coldBoot(s_cfg);
+    coldBoot.begin(true);
+    TEST_ASSERT_EQUAL(ReportReason::HEARTBEAT, evalAt(coldBoot, 50.2f, 1700));
+}
+
+// Journée simulée : séchage lent puis arrosage rapide, évaluation toutes les 30 s.
+// Chaque franchissement de seuil part à la première évaluation, et la politique
+// envoie bien moins qu'un planning fixe à la minute.
+static void test_simulated_day() {
+    ReportPolicy policy(s_cfg);
+    policy.begin(true);
+    uint32_t sends = 0;
+    uint32_t thresholdSends = 0;
+    bool below = false;
+    for (uint32_t t = 0; t < 86400; t += 30) {
+        float h;
+        uint32_t phase = t % 21600; // Cycle de 6 h
+        if (phase < 20400) {
+            h = 65.0f - phase * (30.0f / 20400.0f); // 65 % -> 35 % en 5 h 40
+        } else {
+            h = 35.0f + (phase - 20400) * (30.0f / 1200.0f); // Arrosage : +30 % en 20 min
+        }
+        ReportReason r = evalAt(policy, h, t);
+        bool nowBelow = h < 40.0f - s_cfg.hysteresis;
+        if (nowBelow != below && t > 0) {
+            // Franchissement franc : l'envoi ne doit pas attendre
+            TEST_ASSERT_TRUE(ReportPolicy::isUrgent(r) || r == ReportReason::HEARTBEAT);
+        }
+        below = nowBelow;
+        if (r != ReportReason::NONE) {
+            float v[1] = {h};
+            policy.markReported(v, 1, t);
+            sends++;
+            if (r == ReportReason::THRESHOLD) {
+                thresholdSends++;
+            }
+        }
+    }
+    char msg[96];
+    snprintf(msg, sizeof(msg), "journée simulée : %u envois (%u de seuil) contre 1440 à la minute",
+             (unsigned)sends, (unsigned)thresholdSends);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_GREATER_OR_EQUAL(8, thresholdSends); // 2 seuils x 2 sens x 4 cycles, au moins
+    TEST_ASSERT_LESS_THAN(1440 / 4, sends);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_evaluation_is_heartbeat);
+    RUN_TEST(test_min_interval_suppresses);
+    RUN_TEST(test_threshold_with_hysteresis);
+    RUN_TEST(test_slope_and_delta);
+    RUN_TEST(test_heartbeat_after_silence);
+    RUN_TEST(test_nan_channels_ignored);
+    RUN_TEST(test_state_survives_deep_sleep);
+    RUN_TEST(test_simulated_day);
+    return UNITY_END();
+}
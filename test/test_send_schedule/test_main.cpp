@@ -0,0 +1,167 @@
+// Planning d'envoi compilé : jours par fenêtre, prochain envoi, passage au jour suivant
+#include <unity.h>
+#include <chrono>
+#include "logic/SendSchedule.cpp"
+
+// Lundi 1er janvier 2024, 00:00:00 UTC
+static const time_t MONDAY = 1704067200;
+static const uint8_t WEEKDAYS = 0x3E;  // Lundi..vendredi (bit 0 = dimanche)
+static const uint8_t SUNDAY = 0x01;
+
+static ConfigSchedule s_cfg;
+
+static struct timeval at(time_t t, uint32_t ms = 0) {
+    struct timeval tv;
+    tv.tv_sec = t;
+    tv.tv_usec = ms * 1000;
+    return tv;
+}
+
+static time_t hm(int day, int hour, int minute) {
+    return MONDAY + day * 86400 + hour * 3600 + minute * 60;
+}
+
+void setUp() {
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    SendSchedule::clear(s_cfg);
+}
+
+void tearDown() {}
+
+static void test_add_minute_counts_each_day_once() {
+    SendSchedule::addMinute(s_cfg, 8 * 60);
+    SendSchedule::addMinute(s_cfg, 8 * 60);
+    TEST_ASSERT_EQUAL_UINT16(7, s_cfg.count);
+    SendSchedule::addMinute(s_cfg, 9 * 60, WEEKDAYS);
+    TEST_ASSERT_EQUAL_UINT16(12, s_cfg.count);
+    SendSchedule::addMinute(s_cfg, MINUTES_PER_DAY); // Hors plage
+    TEST_ASSERT_EQUAL_UINT16(12, s_cfg.count);
+
+    TEST_ASSERT_FALSE(SendSchedule::addInterval(s_cfg, 10, 5, 1));
+    TEST_ASSERT_FALSE(SendSchedule::addInterval(s_cfg, 0, 10, 0));
+    TEST_ASSERT_TRUE(SendSchedule::addInterval(s_cfg, 0, 59, 15, SUNDAY)); // 0, 15, 30, 45
+    TEST_ASSERT_EQUAL_UINT16(16, s_cfg.count);
+}
+
+static void test_windows_keep_their_own_weekdays() {
+    SendSchedule::addInterval(s_cfg, 8 * 60, 18 * 60, 60, WEEKDAYS);
+    SendSchedule::addMinute(s_cfg, 12 * 60, SUNDAY);
+    SendSchedule schedule(s_cfg);
+
+    struct tm tm;
+    time_t t = hm(0, 9, 0); // Lundi 09:00
+    gmtime_r(&t, &tm);
+    TEST_ASSERT_TRUE(schedule.isDue(tm));
+    t = hm(5, 9, 0); // Samedi 09:00
+    gmtime_r(&t, &tm);
+    TEST_ASSERT_FALSE(schedule.isDue(tm));
+    t = hm(6, 12, 0); // Dimanche 12:00 : fenêtre propre au dimanche
+    gmtime_r(&t, &tm);
+    TEST_ASSERT_TRUE(schedule.isDue(tm));
+    t = hm(0, 12, 0); // Lundi 12:00 : dans la fenêtre de semaine
+    gmtime_r(&t, &tm);
+    TEST_ASSERT_TRUE(schedule.isDue(tm));
+    t = hm(6, 9, 0); // Dimanche 09:00 : pas dans la fenêtre de semaine
+    gmtime_r(&t, &tm);
+    TEST_ASSERT_FALSE(schedule.isDue(tm));
+}
+
+static void test_next_fire_same_day_and_slot_offset() {
+    SendSchedule::addMinute(s_cfg, 10 * 60);
+    SendSchedule::addMinute(s_cfg, 10 * 60 + 5);
+    SendSchedule schedule(s_cfg);
+
+    TEST_ASSERT_EQUAL_UINT32(3600000UL, schedule.msUntilNext(at(hm(0, 9, 0)), 0));
+    // Créneau TDMA à 20 s : la minute courante compte encore à 10:00:10,5
+    TEST_ASSERT_EQUAL_UINT32(9500, schedule.msUntilNext(at(hm(0, 10, 0) + 10, 500), 20000));
+    // Créneau passé : envoi suivant à 10:05:20
+    TEST_ASSERT_EQUAL_UINT32(5 * 60000UL - 5000, schedule.msUntilNext(at(hm(0, 10, 0) + 25), 20000));
+}
+
+static void test_next_fire_rolls_over_to_next_day() {
+    SendSchedule::addMinute(s_cfg, 6 * 60);
+    SendSchedule schedule(s_cfg);
+    // Lundi 23:59:30 -> mardi 06:00
+    TEST_ASSERT_EQUAL_UINT32(30000UL + 6 * 3600000UL, schedule.msUntilNext(at(hm(0, 23, 59) + 30), 0));
+    // Samedi -> dimanche (jour 6 -> jour 0 de la semaine)
+    TEST_ASSERT_EQUAL_UINT32(13 * 3600000UL, schedule.msUntilNext(at(hm(5, 17, 0)), 0));
+}
+
+static void test_next_fire_skips_excluded_days() {
+    SendSchedule::addInterval(s_cfg, 8 * 60, 17 * 60, 30, WEEKDAYS);
+    SendSchedule schedule(s_cfg);
+    // Vendredi 17:01 -> lundi 08:00
+    uint32_t expected = (2UL * 24 + 14) * 3600000UL + 59 * 60000UL;
+    TEST_ASSERT_EQUAL_UINT32(expected, schedule.msUntilNext(at(hm(4, 17, 1)), 0));
+}
+
+static void test_weekly_single_fire_and_empty() {
+    SendSchedule schedule(s_cfg);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, schedule.msUntilNext(at(hm(0, 0, 0)), 0));
+
+    SendSchedule::addMinute(s_cfg, 7 * 60, SUNDAY);
+    // Dimanche 07:00:01 -> dimanche suivant 07:00 (parcours jusqu'au 8e jour)
+    TEST_ASSERT_EQUAL_UINT32(7UL * 86400000UL - 1000, schedule.msUntilNext(at(hm(6, 7, 0) + 1), 0));
+}
+
+// Avance rapide : la boucle dort jusqu'au prochain envoi, 14 jours d'affilée ;
+// chaque réveil tombe sur une minute due et aucune minute due n'est sautée
+static void test_fast_forward_two_weeks() {
+    SendSchedule::addInterval(s_cfg, 7 * 60, 19 * 60, 20, WEEKDAYS);
+    SendSchedule::addInterval(s_cfg, 23 * 60 + 50, 23 * 60 + 59, 3); // Fin de journée, tous les jours
+    SendSchedule::addMinute(s_cfg, 0, SUNDAY);
+    SendSchedule schedule(s_cfg);
+    const uint32_t offsetMs = 12345;
+
+    uint32_t fires = 0;
+    int64_t nowMs = (int64_t)MONDAY * 1000;
+    const int64_t endMs = nowMs + 14LL * 86400000LL;
+    while (true) {
+        uint32_t wait = schedule.msUntilNext(at(nowMs / 1000, nowMs % 1000), offsetMs);
+        TEST_ASSERT_TRUE(wait > 0 && wait != UINT32_MAX);
+        nowMs += wait;
+        if (nowMs >= endMs) {
+            break;
+        }
+        TEST_ASSERT_EQUAL_INT(offsetMs, nowMs % 60000); // Au créneau TDMA
+        time_t t = nowMs / 1000;
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        TEST_ASSERT_TRUE(schedule.isDue(tm));
+        nowMs += 1; // Envoi fait : réveil suivant
+        fires++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(2 * s_cfg.count, fires);
+}
+
+static void test_benchmark_next_fire() {
+    SendSchedule::addMinute(s_cfg, 0, SUNDAY); // Pire cas : une semaine à parcourir
+    SendSchedule schedule(s_cfg);
+    const int rounds = 100000;
+    volatile uint32_t sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < rounds; k++) {
+        sink = sink + schedule.msUntilNext(at(hm(0, 0, 1) + (k & 1023)), 0);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / rounds;
+
+    char msg[80];
+    snprintf(msg, sizeof(msg), "msUntilNext (planning hebdomadaire) : %.0f ns (hôte)", ns);
+    TEST_MESSAGE(msg);
+    (void)sink;
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_add_minute_counts_each_day_once);
+    RUN_TEST(test_windows_keep_their_own_weekdays);
+    RUN_TEST(test_next_fire_same_day_and_slot_offset);
+    RUN_TEST(test_next_fire_rolls_over_to_next_day);
+    RUN_TEST(test_next_fire_skips_excluded_days);
+    RUN_TEST(test_weekly_single_fire_and_empty);
+    RUN_TEST(test_fast_forward_two_weeks);
+    RUN_TEST(test_benchmark_next_fire);
+    return UNITY_END();
+}
@@ -0,0 +1,163 @@
+// Plan TDMA : simulation de 100 à 500 Followers sur une fenêtre de 50 s
+#include <unity.h>
+#include "logic/SlotScheduler.cpp"
+
+static const uint32_t WINDOW_MS = 50000;
+static const uint32_t EXPIRY_MS = 30UL * 60UL * 1000UL;
+
+static uint8_t s_macs[600][6];
+
+static SenderInfo espNowNode(uint16_t i) {
+    uint8_t* mac = s_macs[i];
+    mac[0] = 0x24; mac[1] = 0x6F; mac[2] = 0x28;
+    mac[3] = (uint8_t)(i >> 8); mac[4] = (uint8_t)i; mac[5] = 0x5A;
+    SenderInfo s = {CommMode::ESP_NOW, mac, 0, 0, 0};
+    return s;
+}
+
+static SenderInfo loraNode(uint16_t address) {
+    SenderInfo s = {CommMode::LORA, nullptr, address, 0, 0};
+    return s;
+}
+
+// Plus petit écart entre deux créneaux occupés, sur la fenêtre circulaire
+static uint32_t minGapMs(const SlotScheduler& plan, const int* slots, size_t n) {
+    static uint32_t offsets[MAX_TDMA_NODES];
+    size_t m = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (slots[i] >= 0) {
+            offsets[m++] = plan.slotOffsetMs(slots[i]);
+        }
+    }
+    std::sort(offsets, offsets + m);
+    uint32_t gap = m > 1 ? WINDOW_MS - offsets[m - 1] + offsets[0] : WINDOW_MS;
+    for (size_t i = 1; i < m; i++) {
+        gap = min(gap, offsets[i] - offsets[i - 1]);
+    }
+    return gap;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void simulate(uint16_t nodes) {
+    static SlotScheduler plan(WINDOW_MS, EXPIRY_MS);
+    plan = SlotScheduler(WINDOW_MS, EXPIRY_MS);
+    static int slots[600];
+    for (uint16_t i = 0; i < nodes; i++) {
+        slots[i] = plan.registerNode(espNowNode(i), 1000);
+    }
+
+    size_t placed = min((size_t)nodes, (size_t)MAX_TDMA_NODES);
+    TEST_ASSERT_EQUAL_UINT32(placed, plan.count());
+    bool seen[MAX_TDMA_NODES] = {false};
+    for (uint16_t i = 0; i < nodes; i++) {
+        if (i < placed) {
+            TEST_ASSERT_TRUE(slots[i] >= 0 && slots[i] < MAX_TDMA_NODES);
+            TEST_ASSERT_FALSE(seen[slots[i]]);
+            seen[slots[i]] = true;
+        } else {
+            TEST_ASSERT_EQUAL_INT(-1, slots[i]); // Table pleine
+        }
+        // Un nœud déjà connu garde son créneau
+        TEST_ASSERT_EQUAL_INT(slots[i], plan.registerNode(espNowNode(i), 2000));
+    }
+
+    // Écart garanti entre émissions : >= fenêtre / (2n)
+    uint32_t gap = minGapMs(plan, slots, nodes);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(WINDOW_MS / (2 * placed), gap);
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "%u nœuds : %u créneaux, écart minimal %u ms",
+             (unsigned)nodes, (unsigned)placed, (unsigned)gap);
+    TEST_MESSAGE(msg);
+}
+
+static void test_simulation_100_nodes() { simulate(100); }
+static void test_simulation_256_nodes() { simulate(256); }
+static void test_simulation_500_nodes() { simulate(500); }
+
+static void test_first_slots_spread_over_window() {
+    SlotScheduler plan(WINDOW_MS, EXPIRY_MS);
+    TEST_ASSERT_EQUAL_UINT32(0, plan.slotOffsetMs(0));
+    TEST_ASSERT_EQUAL_UINT32(WINDOW_MS / 2, plan.slotOffsetMs(1));
+    TEST_ASSERT_EQUAL_UINT32(WINDOW_MS / 4, plan.slotOffsetMs(2));
+    TEST_ASSERT_EQUAL_UINT32(3 * WINDOW_MS / 4, plan.slotOffsetMs(3));
+    TEST_ASSERT_EQUAL_UINT32(0, plan.slotOffsetMs(-1));
+    TEST_ASSERT_EQUAL_UINT32(0, plan.slotOffsetMs(MAX_TDMA_NODES));
+}
+
+static void test_lora_addresses_keyed_on_16_bits() {
+    SlotScheduler plan(WINDOW_MS, EXPIRY_MS);
+    int a = plan.registerNode(loraNode(0x0001), 0);
+    int b = plan.registerNode(loraNode(0x0101), 0);
+    int c = plan.registerNode(loraNode(0xFF01), 0);
+    TEST_ASSERT_TRUE(a != b && b != c && a != c);
+    TEST_ASSERT_EQUAL_INT(b, plan.registerNode(loraNode(0x0101), 10));
+    TEST_ASSERT_EQUAL_UINT32(3, plan.count());
+}
+
+// Rotation : des nœuds se taisent, d'autres arrivent ; les nœuds restants ne bougent jamais
+static void test_churn_keeps_slots_fixed() {
+    SlotScheduler plan(WINDOW_MS, EXPIRY_MS);
+    static int slot[400];
+    static unsigned long lastTx[400];
+    static bool alive[400];
+    static bool placed[400];          // Créneau détenu (jusqu'à expiration)
+    memset(alive, 0, sizeof(alive));
+    memset(placed, 0, sizeof(placed));
+    uint32_t seed = 7;
+    uint16_t nextNode = 0;
+
+    for (unsigned long now = 0; now < 24UL * 3600UL * 1000UL; now += 60000) {
+        // Arrivées (400 nœuds au total, au-delà de la capacité du plan) et départs aléatoires
+        for (int k = 0; k < 3 && nextNode < 400; k++) {
+            alive[nextNode++] = true;
+        }
+        seed = seed * 1103515245u + 12345u;
+        uint16_t leaving = (seed >> 8) % max(nextNode, (uint16_t)1);
+        if (alive[leaving] && (seed & 1)) {
+            alive[leaving] = false;
+        }
+
+        for (uint16_t i = 0; i < nextNode; i++) {
+            if (!alive[i]) {
+                continue;
+            }
+            int s = plan.registerNode(espNowNode(i), now);
+            if (placed[i]) {
+                TEST_ASSERT_EQUAL_INT(slot[i], s);
+            }
+            slot[i] = s;
+            placed[i] = s >= 0;
+            lastTx[i] = now;
+        }
+        plan.expire(now);
+
+        // Créneaux occupés (nœuds non expirés) distincts et décompte exact
+        bool used[MAX_TDMA_NODES] = {false};
+        size_t n = 0;
+        for (uint16_t i = 0; i < nextNode; i++) {
+            if (placed[i] && now - lastTx[i] > EXPIRY_MS) {
+                placed[i] = false; // Retiré du plan
+            }
+            if (placed[i]) {
+                TEST_ASSERT_FALSE(used[slot[i]]);
+                used[slot[i]] = true;
+                n++;
+            }
+        }
+        TEST_ASSERT_EQUAL_UINT32(n, plan.count());
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_slots_spread_over_window);
+    RUN_TEST(test_lora_addresses_keyed_on_16_bits);
+    RUN_TEST(test_simulation_100_nodes);
+    RUN_TEST(test_simulation_256_nodes);
+    RUN_TEST(test_simulation_500_nodes);
+    RUN_TEST(test_churn_keeps_slots_fixed);
+    return UNITY_END();
+}
@@ -0,0 +1,229 @@
+// Arbitre hydraulique : limites de simultanéité, budget de débit, écart entre
+// démarrages et politique stricte de tête de file, sur l'horloge virtuelle
+#include <unity.h>
+#include "logic/ValveScheduler.cpp"
+#include "logic/ValveTimer.cpp"
+#include "actuators/Electrovanne.cpp"
+
+static Config s_config;
+static Electrovanne* s_valves[MAX_VALVES];
+static ValveTimer* s_timer;
+
+static uint8_t s_started[64];
+static uint32_t s_waits[64];
+static uint8_t s_startCount;
+
+static void setup(uint8_t numValves, uint8_t maxConcurrent, float budget, uint32_t staggerMs) {
+    memset((void*)&s_config, 0, sizeof(s_config));
+    s_config.num_electrovalves = numValves;
+    for (uint8_t i = 0; i < numValves; i++) {
+        s_config.electrovalves[i].enabled = true;
+        s_config.electrovalves[i].pin = i + 1;
+        s_config.electrovalves[i].flow = 1.0f;
+    }
+    ConfigHydraulics& h = s_config.logic.hydraulics;
+    h.max_concurrent = maxConcurrent;
+    h.flow_budget = budget;
+    h.stagger_ms = staggerMs;
+}
+
+static ValveScheduler* makeScheduler() {
+    for (uint8_t i = 0; i < MAX_VALVES; i++) {
+        s_valves[i] = nullptr;
+        if (i < s_config.num_electrovalves) {
+            s_valves[i] = new Electrovanne(s_config.electrovalves[i].pin);
+            s_valves[i]->attachTimer(s_timer, i);
+        }
+    }
+    ValveScheduler* scheduler = new ValveScheduler(s_config.logic.hydraulics, s_config, s_valves);
+    scheduler->registerStartCallback([](uint8_t valve, uint32_t waitMs) {
+        s_waits[s_startCount] = waitMs;
+        s_started[s_startCount++] = valve;
+    });
+    return scheduler;
+}
+
+static void step(ValveScheduler* scheduler, uint32_t ms) {
+    advanceMs(ms);
+    s_timer->poll();
+    scheduler->update();
+}
+
+void setUp() {
+    setMillis(100000);
+    s_startCount = 0;
+    s_timer = new ValveTimer();
+}
+
+void tearDown() {
+    for (uint8_t i = 0; i < MAX_VALVES; i++) {
+        delete s_valves[i];
+        s_valves[i] = nullptr;
+    }
+    delete s_timer;
+}
+
+static void test_max_concurrent() {
+    setup(4, 2, 0, 0);
+    ValveScheduler* vs = makeScheduler();
+    TEST_ASSERT_TRUE(vs->request(1, 10000, 10));
+    TEST_ASSERT_TRUE(vs->request(2, 20000, 10));
+    TEST_ASSERT_TRUE(vs->request(3, 10000, 10));
+    TEST_ASSERT_EQUAL_UINT8(2, vs->activeCount());
+    TEST_ASSERT_TRUE(vs->isQueued(3));
+
+    step(vs, 10000); // Vanne 1 refermée par son minuteur
+    TEST_ASSERT_FALSE(s_valves[0]->isOpen());
+    TEST_ASSERT_TRUE(s_valves[2]->isOpen());
+    TEST_ASSERT_EQUAL_UINT32(10000, vs->lastWaitMs(3));
+    TEST_ASSERT_EQUAL_UINT8(2, vs->activeCount());
+    delete vs;
+}
+
+static void test_strict_head_of_line() {
+    setup(3, 0, 10.0f, 0);
+    s_config.electrovalves[0].flow = 8.0f;
+    s_config.electrovalves[1].flow = 6.0f;
+    s_config.electrovalves[2].flow = 1.0f;
+    ValveScheduler* vs = makeScheduler();
+    vs->request(1, 30000, 10);
+    vs->request(2, 30000, 50);  // Prioritaire mais hors budget
+    vs->request(3, 30000, 5);   // Tiendrait dans le budget, mais pas en tête
+    step(vs, 1000);
+    TEST_ASSERT_FALSE(s_valves[2]->isOpen());
+    TEST_ASSERT_TRUE(vs->isQueued(2));
+    TEST_ASSERT_TRUE(vs->isQueued(3));
+
+    vs->release(1);
+    step(vs, 1);
+    TEST_ASSERT_TRUE(s_valves[1]->isOpen());
+    step(vs, 1);
+    TEST_ASSERT_TRUE(s_valves[2]->isOpen()); // 6 + 1 <= 10
+    TEST_ASSERT_EQUAL_UINT8(1, s_started[0]);
+    TEST_ASSERT_EQUAL_UINT8(2, s_started[1]);
+    TEST_ASSERT_EQUAL_UINT8(3, s_started[2]);
+    delete vs;
+}
+
+static void test_priority_then_age() {
+    setup(4, 1, 0, 0);
+    ValveScheduler* vs = makeScheduler();
+    vs->request(1, 1000, 1);
+    step(vs, 10);
+    vs->request(2, 1000, 5);
+    step(vs, 10);
+    vs->request(3, 1000, 20);
+    step(vs, 10);
+    vs->request(4, 1000, 5);
+
+    for (int i = 0; i < 4; i++) {
+        step(vs, 1000);
+    }
+    TEST_ASSERT_EQUAL_UINT8(4, s_startCount);
+    TEST_ASSERT_EQUAL_UINT8(1, s_started[0]);
+    TEST_ASSERT_EQUAL_UINT8(3, s_started[1]); // Plus forte priorité
+    TEST_ASSERT_EQUAL_UINT8(2, s_started[2]); // Priorité égale : la plus ancienne
+    TEST_ASSERT_EQUAL_UINT8(4, s_started[3]);
+    delete vs;
+}
+
+static void test_stagger_between_starts() {
+    setup(2, 0, 0, 2000);
+    ValveScheduler* vs = makeScheduler();
+    vs->request(1, 60000, 1);
+    vs->request(2, 60000, 1);
+    TEST_ASSERT_TRUE(vs->isQueued(2));
+    step(vs, 1999);
+    TEST_ASSERT_FALSE(s_valves[1]->isOpen());
+    step(vs, 1);
+    TEST_ASSERT_TRUE(s_valves[1]->isOpen());
+    TEST_ASSERT_EQUAL_UINT32(2000, s_waits[1]);
+    delete vs;
+}
+
+static void test_oversized_valve_opens_alone() {
+    setup(2, 0, 5.0f, 0);
+    s_config.electrovalves[0].flow = 12.0f;
+    ValveScheduler* vs = makeScheduler();
+    TEST_ASSERT_TRUE(vs->request(1, 5000, 1));
+    TEST_ASSERT_TRUE(s_valves[0]->isOpen());
+    vs->request(2, 5000, 1);
+    TEST_ASSERT_TRUE(vs->isQueued(2));
+    step(vs, 5000);
+    TEST_ASSERT_TRUE(s_valves[1]->isOpen());
+    delete vs;
+}
+
+static void test_release_queued_and_invalid() {
+    setup(2, 1, 0, 0);
+    ValveScheduler* vs = makeScheduler();
+    vs->request(1, 5000, 1);
+    vs->request(2, 5000, 1);
+    vs->release(2);
+    TEST_ASSERT_FALSE(vs->isQueued(2));
+    step(vs, 5000);
+    TEST_ASSERT_FALSE(s_valves[1]->isOpen());
+    TEST_ASSERT_FALSE(vs->request(0, 1000, 1));
+    TEST_ASSERT_FALSE(vs->request(3, 1000, 1)); // Emplacement sans vanne
+    delete vs;
+}
+
+// Simulation : 12 vannes, demandes aléatoires pendant 24 h virtuelles.
+// Limites toujours respectées et aucune demande affamée.
+static void test_simulated_day_respects_limits() {
+    setup(12, 3, 10.0f, 2000);
+    for (uint8_t i = 0; i < 12; i++) {
+        s_config.electrovalves[i].flow = 1.0f + (i % 4) * 2.0f; // 1, 3, 5, 7 L/min
+    }
+    ValveScheduler* vs = makeScheduler();
+    uint32_t seed = 99;
+    unsigned long lastStart = 0;
+    uint32_t maxWait = 0;
+    uint16_t starts = 0;
+    vs->registerStartCallback([&](uint8_t, uint32_t waitMs) {
+        TEST_ASSERT_TRUE(starts == 0 || millis() - lastStart >= 2000);
+        lastStart = millis();
+        maxWait = max(maxWait, waitMs);
+        starts++;
+    });
+
+    for (uint32_t t = 0; t < 24UL * 3600UL; t++) {
+        seed = seed * 1103515245u + 12345u;
+        if ((seed >> 16) % 120 == 0) {
+            uint8_t valve = 1 + (seed >> 8) % 12;
+            if (!s_valves[valve - 1]->isOpen() && !vs->isQueued(valve)) {
+                vs->request(valve, 60000 + (seed % 240000), (float)((seed >> 4) % 50));
+            }
+        }
+        step(vs, 1000);
+
+        float flow = 0;
+        uint8_t open = 0;
+        for (uint8_t i = 0; i < 12; i++) {
+            if (s_valves[i]->isOpen()) {
+                flow += s_config.electrovalves[i].flow;
+                open++;
+            }
+        }
+        TEST_ASSERT_LESS_OR_EQUAL(3, open);
+        TEST_ASSERT_TRUE(open <= 1 || flow <= 10.0f);
+    }
+    char msg[80];
+    snprintf(msg, sizeof(msg), "%u ouvertures, attente maximale %u s", starts, (unsigned)(maxWait / 1000));
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_GREATER_THAN(300, starts);
+    TEST_ASSERT_LESS_THAN(3600000UL, maxWait); // Aucune demande affamée
+    delete vs;
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_max_concurrent);
+    RUN_TEST(test_strict_head_of_line);
+    RUN_TEST(test_priority_then_age);
+    RUN_TEST(test_stagger_between_starts);
+    RUN_TEST(test_oversized_valve_opens_alone);
+    RUN_TEST(test_release_queued_and_invalid);
+    RUN_TEST(test_simulated_day_respects_limits);
+    return UNITY_END();
+}
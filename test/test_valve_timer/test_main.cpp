@@ -0,0 +1,179 @@
+// Échéancier des vannes sur horloge virtuelle (injectée ou millis() du substitut)
+#include <unity.h>
+#include "logic/ValveTimer.cpp"
+#include "actuators/Electrovanne.cpp"
+
+static uint32_t s_now;
+static uint32_t virtualClock() { return s_now; }
+
+static uint8_t s_fired[64];
+static uint8_t s_firedCount;
+static uint32_t s_firedAt[64];
+
+static void record(void* ctx) {
+    uint8_t id = (uint8_t)(uintptr_t)ctx;
+    s_firedAt[s_firedCount] = s_now;
+    s_fired[s_firedCount++] = id;
+}
+
+void setUp() {
+    s_now = 0;
+    s_firedCount = 0;
+    setMillis(0);
+}
+
+void tearDown() {}
+
+static void test_fires_in_deadline_order() {
+    ValveTimer timer(virtualClock);
+    timer.schedule(0, 300, record, (void*)0);
+    timer.schedule(1, 100, record, (void*)1);
+    timer.schedule(2, 200, record, (void*)2);
+    TEST_ASSERT_EQUAL_UINT32(100, timer.msUntilNext());
+
+    s_now = 99;
+    TEST_ASSERT_EQUAL_UINT8(0, timer.poll());
+    s_now = 250;
+    TEST_ASSERT_EQUAL_UINT8(2, timer.poll());
+    TEST_ASSERT_EQUAL_UINT8(1, s_fired[0]);
+    TEST_ASSERT_EQUAL_UINT8(2, s_fired[1]);
+    TEST_ASSERT_EQUAL_UINT32(50, timer.msUntilNext());
+    s_now = 300;
+    TEST_ASSERT_EQUAL_UINT8(1, timer.poll());
+    TEST_ASSERT_EQUAL_UINT8(0, s_fired[2]);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, timer.msUntilNext());
+}
+
+static void test_deadline_across_clock_wrap() {
+    ValveTimer timer(virtualClock);
+    s_now = 0xFFFFFF00UL;
+    timer.schedule(3, 0x200, record, (void*)3);
+    timer.schedule(4, 0x80, record, (void*)4);
+
+    s_now += 0x80;
+    TEST_ASSERT_EQUAL_UINT8(1, timer.poll());
+    TEST_ASSERT_EQUAL_UINT32(0x180, timer.msUntilNext());
+
+    s_now += 0x17F; // 0x0000007F : passage à zéro franchi
+    TEST_ASSERT_EQUAL_UINT8(0, timer.poll());
+    TEST_ASSERT_EQUAL_UINT32(1, timer.msUntilNext());
+    s_now += 1;
+    TEST_ASSERT_EQUAL_UINT8(1, timer.poll());
+    TEST_ASSERT_EQUAL_UINT8(3, s_fired[1]);
+}
+
+static void test_rearm_and_cancel() {
+    ValveTimer timer(virtualClock);
+    timer.schedule(5, 100, record, (void*)5);
+    s_now = 50;
+    timer.schedule(5, 100, record, (void*)5); // Réarmé : échéance à 150
+    TEST_ASSERT_TRUE(timer.isArmed(5));
+    s_now = 120;
+    TEST_ASSERT_EQUAL_UINT8(0, timer.poll());
+
+    timer.cancel(5);
+    TEST_ASSERT_FALSE(timer.isArmed(5));
+    s_now = 1000;
+    TEST_ASSERT_EQUAL_UINT8(0, timer.poll());
+    TEST_ASSERT_FALSE(timer.schedule(MAX_VALVE_TIMERS, 10, record, nullptr));
+}
+
+static void test_duration_clamped() {
+    ValveTimer timer(virtualClock);
+    timer.schedule(0, UINT32_MAX, record, (void*)0);
+    TEST_ASSERT_EQUAL_UINT32(INT32_MAX, timer.msUntilNext());
+}
+
+static uint8_t s_rearms;
+static ValveTimer* s_timer;
+static void rearm(void* ctx) {
+    record(ctx);
+    if (++s_rearms < 3) {
+        s_timer->schedule(7, 10, rearm, ctx);
+    }
+}
+
+static void test_callback_can_rearm() {
+    ValveTimer timer(virtualClock);
+    s_timer = &timer;
+    s_rearms = 0;
+    timer.schedule(7, 10, rearm, (void*)7);
+    for (int i = 0; i < 5; i++) {
+        s_now += 10;
+        timer.poll();
+    }
+    TEST_ASSERT_EQUAL_UINT8(3, s_firedCount);
+    TEST_ASSERT_EQUAL_UINT32(30, s_firedAt[2]);
+}
+
+// Simulation : 20 minuteurs réarmés au hasard pendant 49,7 jours et plus ;
+// la boucle ne se réveille qu'à msUntilNext() et chaque échéance tombe à l'heure
+static uint32_t s_deadline[MAX_VALVE_TIMERS];
+static uint32_t s_seed = 1;
+static uint32_t s_maxLate;
+static ValveTimer* s_sim;
+
+static uint32_t nextRandom() {
+    s_seed = s_seed * 1103515245u + 12345u;
+    return s_seed >> 8;
+}
+
+static void simExpired(void* ctx) {
+    uint8_t id = (uint8_t)(uintptr_t)ctx;
+    s_maxLate = max(s_maxLate, s_now - s_deadline[id]);
+    uint32_t duration = 1000 + nextRandom() % (6UL * 3600UL * 1000UL);
+    s_deadline[id] = s_now + duration;
+    s_sim->schedule(id, duration, simExpired, ctx);
+}
+
+static void test_virtual_clock_simulation() {
+    ValveTimer timer(virtualClock);
+    s_sim = &timer;
+    s_maxLate = 0;
+    s_now = 0xF0000000UL; // Passage à zéro pendant la simulation
+    for (uint8_t id = 0; id < MAX_VALVE_TIMERS; id++) {
+        uint32_t duration = 1000 + nextRandom() % 600000UL;
+        s_deadline[id] = s_now + duration;
+        timer.schedule(id, duration, simExpired, (void*)(uintptr_t)id);
+    }
+
+    uint32_t fired = 0;
+    uint64_t elapsed = 0;
+    while (elapsed < 60ULL * 24 * 3600 * 1000) {
+        uint32_t wait = timer.msUntilNext();
+        TEST_ASSERT_TRUE(wait != UINT32_MAX);
+        s_now += wait;
+        elapsed += wait;
+        fired += timer.poll();
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, s_maxLate);
+    TEST_ASSERT_GREATER_THAN(1000, fired);
+}
+
+static void test_valve_closed_by_timer_on_millis() {
+    ValveTimer timer; // Horloge par défaut : millis() du substitut
+    Electrovanne valve(4);
+    valve.attachTimer(&timer, 0);
+    setMillis(0xFFFFFFF0UL);
+    valve.open(100);
+    TEST_ASSERT_TRUE(valve.isOpen());
+    advanceMs(99);
+    timer.poll();
+    TEST_ASSERT_TRUE(valve.isOpen());
+    advanceMs(1);
+    timer.poll();
+    TEST_ASSERT_FALSE(valve.isOpen());
+    TEST_ASSERT_EQUAL_INT(LOW, digitalRead(4));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_fires_in_deadline_order);
+    RUN_TEST(test_deadline_across_clock_wrap);
+    RUN_TEST(test_rearm_and_cancel);
+    RUN_TEST(test_duration_clamped);
+    RUN_TEST(test_callback_can_rearm);
+    RUN_TEST(test_virtual_clock_simulation);
+    RUN_TEST(test_valve_closed_by_timer_on_millis);
+    return UNITY_END();
+}
@@ -0,0 +1,139 @@
+// Table de dispatch des zones : insertion, doublons, sondage linéaire, table pleine
+#include <unity.h>
+#include <chrono>
+#include "logic/ZoneTable.cpp"
+
+static ConfigZones s_zones;
+
+static void nodeName(char* buf, size_t len, int i) {
+    snprintf(buf, len, "NODE_%d", i);
+}
+
+void setUp() {
+    ZoneTable::clear(s_zones);
+}
+
+void tearDown() {}
+
+static void test_add_and_lookup() {
+    TEST_ASSERT_TRUE(ZoneTable::addProbe(s_zones, "NODE_1", 1, 0, 0));
+    TEST_ASSERT_TRUE(ZoneTable::addProbe(s_zones, "NODE_1", 2, 1, 0));
+    TEST_ASSERT_TRUE(ZoneTable::addProbe(s_zones, "NODE_2", 1, 1, 1));
+    // lookup n'interroge la table qu'une fois au moins une zone compilée
+    TEST_ASSERT_NULL(ZoneTable::lookup(s_zones, "NODE_1", 1));
+    s_zones.count = 2;
+
+    const ZoneRoute* r = ZoneTable::lookup(s_zones, "NODE_2", 1);
+    TEST_ASSERT_NOT_NULL(r);
+    TEST_ASSERT_EQUAL_UINT8(1, r->zone);
+    TEST_ASSERT_EQUAL_UINT8(1, r->probe);
+    TEST_ASSERT_EQUAL_UINT8(1, ZoneTable::lookup(s_zones, "NODE_1", 2)->zone);
+    TEST_ASSERT_NULL(ZoneTable::lookup(s_zones, "NODE_2", 2));
+    TEST_ASSERT_NULL(ZoneTable::lookup(s_zones, "NODE_3", 1));
+    TEST_ASSERT_NULL(ZoneTable::lookup(s_zones, nullptr, 1));
+}
+
+static void test_rejects_duplicates_and_bad_sensors() {
+    TEST_ASSERT_TRUE(ZoneTable::addProbe(s_zones, "NODE_1", 1, 0, 0));
+    TEST_ASSERT_FALSE(ZoneTable::addProbe(s_zones, "NODE_1", 1, 1, 0)); // Une seule zone par sonde
+    TEST_ASSERT_FALSE(ZoneTable::addProbe(s_zones, "NODE_1", 0, 0, 1));
+    TEST_ASSERT_FALSE(ZoneTable::addProbe(s_zones, "NODE_1", MAX_SOIL_SENSORS + 1, 0, 1));
+    s_zones.count = 1;
+    TEST_ASSERT_EQUAL_UINT8(0, ZoneTable::lookup(s_zones, "NODE_1", 1)->zone);
+}
+
+static void test_clear_drops_routes() {
+    ZoneTable::addProbe(s_zones, "NODE_1", 1, 0, 0);
+    s_zones.count = 1;
+    ZoneTable::clear(s_zones);
+    TEST_ASSERT_EQUAL_UINT8(0, s_zones.count);
+    s_zones.count = 1;
+    TEST_ASSERT_NULL(ZoneTable::lookup(s_zones, "NODE_1", 1));
+}
+
+static void test_parse_policy() {
+    TEST_ASSERT_EQUAL(ZonePolicy::MEAN, ZoneTable::parsePolicy("mean"));
+    TEST_ASSERT_EQUAL(ZonePolicy::MEDIAN, ZoneTable::parsePolicy("median"));
+    TEST_ASSERT_EQUAL(ZonePolicy::MIN, ZoneTable::parsePolicy("min"));
+    TEST_ASSERT_EQUAL(ZonePolicy::MIN, ZoneTable::parsePolicy("inconnue")); // Repli prudent
+}
+
+static void test_hash_is_fnv1a() {
+    TEST_ASSERT_EQUAL_HEX32(2166136261u, ZoneTable::hashNodeId(""));
+    TEST_ASSERT_EQUAL_HEX32(0xE40C292Cu, ZoneTable::hashNodeId("a"));
+}
+
+// Capacité nominale (MAX_ZONES x MAX_ZONE_PROBES) : toutes les routes restent
+// joignables malgré les collisions, les paires absentes donnent nullptr
+static void test_full_configuration_resolves() {
+    char node[16];
+    uint16_t added = 0;
+    for (int i = 0; added < MAX_ZONES * MAX_ZONE_PROBES; i++) {
+        nodeName(node, sizeof(node), i);
+        for (uint8_t s = 1; s <= 2; s++, added++) {
+            TEST_ASSERT_TRUE(ZoneTable::addProbe(s_zones, node, s, added / MAX_ZONE_PROBES, added % MAX_ZONE_PROBES));
+        }
+    }
+    s_zones.count = MAX_ZONES;
+
+    added = 0;
+    for (int i = 0; added < MAX_ZONES * MAX_ZONE_PROBES; i++) {
+        nodeName(node, sizeof(node), i);
+        for (uint8_t s = 1; s <= 2; s++, added++) {
+            const ZoneRoute* r = ZoneTable::lookup(s_zones, node, s);
+            TEST_ASSERT_NOT_NULL(r);
+            TEST_ASSERT_EQUAL_UINT8(added / MAX_ZONE_PROBES, r->zone);
+            TEST_ASSERT_EQUAL_UINT8(added % MAX_ZONE_PROBES, r->probe);
+        }
+        TEST_ASSERT_NULL(ZoneTable::lookup(s_zones, node, 3));
+    }
+}
+
+// Table saturée : l'insertion échoue et la recherche d'une paire absente se termine
+static void test_saturated_table() {
+    char node[16];
+    for (int i = 0; i < ZONE_ROUTE_SLOTS; i++) {
+        nodeName(node, sizeof(node), i);
+        TEST_ASSERT_TRUE(ZoneTable::addProbe(s_zones, node, 1, 0, 0));
+    }
+    TEST_ASSERT_FALSE(ZoneTable::addProbe(s_zones, "NODE_X", 1, 0, 0));
+    s_zones.count = 1;
+    TEST_ASSERT_NULL(ZoneTable::lookup(s_zones, "NODE_X", 1));
+}
+
+static void test_benchmark_lookup() {
+    char nodes[32][16];
+    for (int i = 0; i < 32; i++) {
+        nodeName(nodes[i], sizeof(nodes[i]), i);
+        ZoneTable::addProbe(s_zones, nodes[i], 1, i / MAX_ZONE_PROBES, i % MAX_ZONE_PROBES);
+        ZoneTable::addProbe(s_zones, nodes[i], 2, i / MAX_ZONE_PROBES, i % MAX_ZONE_PROBES);
+    }
+    s_zones.count = 4;
+    const int rounds = 1000000;
+    volatile uint32_t sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < rounds; k++) {
+        const ZoneRoute* r = ZoneTable::lookup(s_zones, nodes[k & 31], 1 + ((k >> 5) & 1));
+        sink = sink + (r ? r->zone : 0);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / rounds;
+
+    char msg[80];
+    snprintf(msg, sizeof(msg), "lookup (64 sondes) : %.0f ns (hôte)", ns);
+    TEST_MESSAGE(msg);
+    (void)sink;
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_add_and_lookup);
+    RUN_TEST(test_rejects_duplicates_and_bad_sensors);
+    RUN_TEST(test_clear_drops_routes);
+    RUN_TEST(test_parse_policy);
+    RUN_TEST(test_hash_is_fnv1a);
+    RUN_TEST(test_full_configuration_resolves);
+    RUN_TEST(test_saturated_table);
+    RUN_TEST(test_benchmark_lookup);
+    return UNITY_END();
+}
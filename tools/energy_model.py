@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""Modèle énergétique des Followers en mode low_power (logic.low_power).
+
+Estime l'autonomie sur batterie à partir de la télémétrie : chaque trame
+porte "awakeMs" (durée d'éveil du cycle précédent) et "timestamp" (epoch s),
+dont on tire la période d'envoi. Les lignes sont lues telles quelles ou
+préfixées (sortie de mosquitto_sub -v) ; l'enveloppe du Master
+({"src":..,"rx":..,"msg":{...}}) est dépliée.
+
+Usage :
+    mosquitto_sub -h broker.local -t 'farm/#' -v | python3 tools/energy_model.py
+    python3 tools/energy_model.py capture.log --battery-mah 2600 --mode light
+    python3 tools/energy_model.py --awake-ms 850 --period-s 300
+
+Les courants par défaut sont ceux d'un ESP32-C3 avec LoRa en veille ;
+les mesurer sur la carte (--active-ma, --sleep-ua, --light-sleep-ua).
+"""
+import argparse
+import json
+import statistics
+import sys
+
+
+def parse_line(line):
+    """Trame de télémétrie d'une ligne, ou None."""
+    start = line.find("{")
+    if start < 0:
+        return None
+    try:
+        msg = json.loads(line[start:])
+    except ValueError:
+        return None
+    if isinstance(msg, dict) and isinstance(msg.get("msg"), dict):
+        msg = msg["msg"]
+    if not isinstance(msg, dict) or "awakeMs" not in msg:
+        return None
+    return msg
+
+
+def collect(lines):
+    """Durées d'éveil et horodatages par nœud."""
+    nodes = {}
+    for line in lines:
+        msg = parse_line(line)
+        if msg is None:
+            continue
+        identity = msg.get("identity")
+        node_id = identity.get("nodeId", "?") if isinstance(identity, dict) else "?"
+        entry = nodes.setdefault(node_id, {"awake": [], "ts": []})
+        awake = msg.get("awakeMs") or 0
+        if awake > 0:  # 0 au premier cycle après un démarrage à froid
+            entry["awake"].append(float(awake))
+        ts = msg.get("timestamp") or 0
+        if ts > 0:  # 0 tant que l'heure n'est pas synchronisée
+            entry["ts"].append(int(ts))
+    return nodes
+
+
+def median_period(timestamps):
+    """Période médiane entre deux trames (s) : insensible aux trames perdues isolées."""
+    ts = sorted(set(timestamps))
+    deltas = [b - a for a, b in zip(ts, ts[1:]) if b > a]
+    return statistics.median(deltas) if deltas else None
+
+
+def percentile(values, p):
+    ordered = sorted(values)
+    k = min(len(ordered) - 1, max(0, int(round(p / 100.0 * (len(ordered) - 1)))))
+    return ordered[k]
+
+
+def estimate(awake_ms, period_s, args):
+    """Rapport cyclique (%), courant moyen (mA) et autonomie (jours)."""
+    period_ms = period_s * 1000.0
+    awake_ms = min(awake_ms, period_ms)
+    sleep_ma = (args.light_sleep_ua if args.mode == "light" else args.sleep_ua) / 1000.0
+    avg_ma = (args.active_ma * awake_ms + sleep_ma * (period_ms - awake_ms)) / period_ms
+    days = args.battery_mah * args.derate / avg_ma / 24.0
+    return 100.0 * awake_ms / period_ms, avg_ma, days
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Estime l'autonomie des Followers en low_power.")
+    parser.add_argument("files", nargs="*", help="captures de télémétrie (sinon entrée standard)")
+    parser.add_argument("--awake-ms", type=float, help="durée d'éveil par cycle, sans télémétrie")
+    parser.add_argument("--period-s", type=float, help="période d'envoi (s), avec --awake-ms ou pour forcer")
+    parser.add_argument("--mode", choices=("deep", "light"), default="deep", help="logic.sleep_mode")
+    parser.add_argument("--active-ma", type=float, default=45.0, help="courant éveillé (mA)")
+    parser.add_argument("--sleep-ua", type=float, default=10.0, help="courant en deep sleep (uA)")
+    parser.add_argument("--light-sleep-ua", type=float, default=250.0, help="courant en light sleep (uA)")
+    parser.add_argument("--battery-mah", type=float, default=2000.0)
+    parser.add_argument("--derate", type=float, default=0.8,
+                        help="part utile de la capacité (autodécharge, tension de coupure)")
+    args = parser.parse_args()
+
+    if args.awake_ms is not None:
+        if not args.period_s:
+            parser.error("--awake-ms demande --period-s")
+        duty, avg_ma, days = estimate(args.awake_ms, args.period_s, args)
+        print("éveil %.0f ms / %.0f s : %.3f %%, %.3f mA moyens, %.0f jours"
+              % (args.awake_ms, args.period_s, duty, avg_ma, days))
+        return
+
+    lines = []
+    if args.files:
+        for path in args.files:
+            with open(path, encoding="utf-8", errors="replace") as f:
+                lines.extend(f)
+    else:
+        lines = sys.stdin
+
+    nodes = collect(lines)
+    if not nodes:
+        sys.exit("Aucune trame avec 'awakeMs' (logic.low_power actif ?)")
+
+    print("%-16s %6s %9s %9s %9s %8s %9s %8s"
+          % ("nœud", "cycles", "éveil ms", "p95 ms", "période s", "cycle %", "moy. mA", "jours"))
+    for node_id in sorted(nodes):
+        entry = nodes[node_id]
+        period = args.period_s or median_period(entry["ts"])
+        if not entry["awake"] or not period:
+            print("%-16s %6d   (pas assez de trames horodatées)" % (node_id, len(entry["awake"])))
+            continue
+        mean = statistics.mean(entry["awake"])
+        p95 = percentile(entry["awake"], 95)
+        duty, avg_ma, days = estimate(mean, period, args)
+        print("%-16s %6d %9.0f %9.0f %9.0f %8.3f %9.3f %8.0f"
+              % (node_id, len(entry["awake"]), mean, p95, period, duty, avg_ma, days))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Décodeur du journal binaire (src/Log.h).
+
+Les trames binaires sont converties en texte ; le reste du flux (texte
+imprimé directement par Serial) est recopié tel quel.
+
+Usage :
+    python3 tools/logdecode.py .pio/build/Master/firmware.elf --port /dev/ttyUSB0
+    python3 tools/logdecode.py firmware.elf < capture.bin
+
+Dépendances : pyelftools (pip install pyelftools), pyserial pour --port.
+"""
+import argparse
+import re
+import struct
+import sys
+
+from elftools.elf.constants import SH_FLAGS
+from elftools.elf.elffile import ELFFile
+
+FRAME_START = 0xFE
+HEADER_SIZE = 11   # début, niveau, longueur, millis, format
+PAYLOAD_MAX = 36   # LOG_PAYLOAD_SIZE
+TRUNCATED = 0x80
+LEVELS = {1: "E", 2: "W", 3: "I", 4: "D"}
+
+SPEC = re.compile(r"%([-+ #0-9.]*)(hh|h|ll|l|z)?([a-zA-Z%])")
+
+
+class FormatTable:
+    """Chaînes de format résolues par adresse dans les sections chargées du .elf."""
+
+    def __init__(self, path):
+        self.sections = []
+        with open(path, "rb") as f:
+            elf = ELFFile(f)
+            for s in elf.iter_sections():
+                if s["sh_flags"] & SH_FLAGS.SHF_ALLOC and s["sh_type"] == "SHT_PROGBITS" and s["sh_size"]:
+                    self.sections.append((s["sh_addr"], s.data()))
+        self.cache = {}
+
+    def lookup(self, addr):
+        if addr in self.cache:
+            return self.cache[addr]
+        text = None
+        for base, data in self.sections:
+            if base <= addr < base + len(data):
+                end = data.find(b"\0", addr - base)
+                text = data[addr - base:end].decode("utf-8", "replace")
+                break
+        self.cache[addr] = text
+        return text
+
+
+def render(fmt, payload):
+    """Même décodage positionnel que Log::format() côté carte."""
+    pos = 0
+    out = []
+    last = 0
+    for m in SPEC.finditer(fmt):
+        out.append(fmt[last:m.start()])
+        last = m.end()
+        flags, length, conv = m.group(1), m.group(2), m.group(3)
+        if conv == "%":
+            out.append("%")
+            continue
+        spec = m.group(0)
+        try:
+            if conv == "s":
+                n = payload[pos]
+                if pos + 1 + n > len(payload):
+                    raise IndexError
+                value = payload[pos + 1:pos + 1 + n].decode("utf-8", "replace")
+                pos += 1 + n
+                out.append(("%" + flags + "s") % value)
+            elif conv in "feg":
+                (value,) = struct.unpack_from("<f", payload, pos)
+                pos += 4
+                out.append(("%" + flags + conv) % value)
+            elif conv in "cdiuxXo":
+                size = 8 if length == "ll" else 4
+                signed = conv in "di"
+                code = ("<q" if signed else "<Q") if size == 8 else ("<i" if signed else "<I")
+                (value,) = struct.unpack_from(code, payload, pos)
+                pos += size
+                if conv == "c":
+                    out.append(chr(value & 0xFF))
+                else:
+                    out.append(("%" + flags + ("d" if conv == "u" else conv)) % value)
+            else:
+                out.append(spec)
+        except (IndexError, struct.error):
+            out.append(spec)  # Argument tronqué
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+def decode(stream, table, write):
+    buf = bytearray()
+    text = bytearray()
+
+    def flush_text():
+        if text:
+            write(text.decode("utf-8", "replace"))
+            text.clear()
+
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            break
+        buf.extend(chunk)
+        while buf:
+            if buf[0] != FRAME_START:
+                start = buf.find(FRAME_START)
+                end = len(buf) if start < 0 else start
+                text.extend(buf[:end])
+                del buf[:end]
+                if b"\n" in text:
+                    cut = text.rindex(b"\n") + 1
+                    write(text[:cut].decode("utf-8", "replace"))
+                    del text[:cut]
+                continue
+            if len(buf) < HEADER_SIZE:
+                break
+            level, length = buf[1], buf[2]
+            if length > PAYLOAD_MAX:
+                text.append(buf.pop(0))
+                continue
+            if len(buf) < HEADER_SIZE + length + 1:
+                break
+            frame = bytes(buf[:HEADER_SIZE + length + 1])
+            ms, addr = struct.unpack_from("<II", frame, 3)
+            fmt = table.lookup(addr)
+            if sum(frame[1:-1]) & 0xFF != frame[-1] or fmt is None:
+                text.append(buf.pop(0))  # Faux début de trame : octet recopié
+                continue
+            del buf[:len(frame)]
+            flush_text()
+            line = render(fmt, frame[HEADER_SIZE:-1])
+            if level & TRUNCATED:
+                line += " [...]"
+            write("[%10.3f] %s %s\n" % (ms / 1000.0, LEVELS.get(level & 0x7F, "?"), line))
+    flush_text()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Décode le journal binaire d'un nœud.")
+    parser.add_argument("elf", help="firmware.elf de la version qui tourne sur la carte")
+    parser.add_argument("--port", help="port série (sinon lecture de l'entrée standard)")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    table = FormatTable(args.elf)
+    if args.port:
+        import serial
+
+        class SerialStream:
+            def __init__(self, port):
+                self.port = port
+
+            def read(self, n):
+                data = self.port.read(max(1, self.port.in_waiting or 1))
+                return data if data is not None else b""
+
+        port = serial.Serial(args.port, args.baud, timeout=None)
+        stream = SerialStream(port)
+    else:
+        stream = sys.stdin.buffer
+
+    def write(s):
+        sys.stdout.write(s)
+        sys.stdout.flush()
+
+    try:
+        decode(stream, table, write)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()